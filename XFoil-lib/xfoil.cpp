@@ -25,18 +25,136 @@
 #include <QCoreApplication>
 #include <QDataStream>
 #include <QDebug>
+#include <QMutex>
+#include <QVector>
 
 #include "xfoil.h"
 
 #define PI 3.141592654
 
-bool XFoil::s_bCancel = false;
+QAtomicInt XFoil::s_bCancel(0);
 bool XFoil::s_bFullReport = false;
-double XFoil::vaccel = 0.01;
+bool XFoil::s_bInfluenceCache = true;
+double XFoil::s_VAccel = 0.01;
+
+static QVector<XFoilWorkspace*> s_FreeWorkspace;   /**< the workspaces released by the deleted instances, available for reuse */
+static QMutex s_WorkspaceMutex;                     /**< protects the list of free workspaces */
+
+
+/** the types of the matrices kept in the influence cache */
+enum enumInfluence {FACTOREDAIJ, AIRFOILDIJ, WAKEDIJ};
+
+/**
+ * @struct InfluenceEntry
+ * A set of influence matrices calculated for one paneled geometry, shared read-only by the XFoil instances.
+ */
+struct InfluenceEntry
+{
+    int kind;                   /**< the type of the matrices, as an index in enumInfluence */
+    quint64 key;                /**< the hash of the signature, for a fast rejection of the other geometries */
+    QVector<double> signature;  /**< the paneled geometry for which the matrices have been calculated */
+    QVector<double> data;       /**< the coefficients of the matrices */
+    QVector<int> pivot;         /**< the pivot indexes of the factored aij matrix */
+    quint64 lastUse;            /**< the value of the use counter when the entry was last stored or read */
+};
+
+static QVector<InfluenceEntry> s_InfluenceCache;    /**< the influence matrices calculated by the instances, for reuse by those which analyze the same geometry */
+static QMutex s_InfluenceMutex;                     /**< protects the influence cache */
+static quint64 s_InfluenceUse = 0;                  /**< the use counter of the cache entries, to evict the least recently used */
+static qint64 s_InfluenceBytes = 0;                 /**< the memory used by the cache entries */
+
+
+static quint64 signatureKey(QVector<double> const &signature)
+{
+    // FNV-1a
+    quint64 key = 14695981039346656037ULL;
+    unsigned char const *pByte = reinterpret_cast<unsigned char const*>(signature.constData());
+    for(int i=0; i<signature.size()*int(sizeof(double)); i++)
+    {
+        key ^= pByte[i];
+        key *= 1099511628211ULL;
+    }
+    return key;
+}
+
+
+static qint64 entryBytes(InfluenceEntry const &entry)
+{
+    return qint64(entry.signature.size()+entry.data.size())*qint64(sizeof(double)) + qint64(entry.pivot.size())*qint64(sizeof(int));
+}
+
+
+/**
+ * Looks for matrices of the given type calculated for the given geometry.
+ * The arrays are implicitly shared with the cache entry, and are never modified once stored.
+ * @return true if the matrices have been found, false otherwise.
+ */
+static bool findInfluence(int kind, QVector<double> const &signature, QVector<double> &data, QVector<int> &pivot)
+{
+    quint64 key = signatureKey(signature);
+    QMutexLocker locker(&s_InfluenceMutex);
+    for(int i=0; i<s_InfluenceCache.size(); i++)
+    {
+        InfluenceEntry &entry = s_InfluenceCache[i];
+        if(entry.kind!=kind || entry.key!=key || entry.signature!=signature) continue;
+        entry.lastUse = ++s_InfluenceUse;
+        data  = entry.data;
+        pivot = entry.pivot;
+        return true;
+    }
+    return false;
+}
+
+
+/**
+ * Stores the matrices calculated for a geometry, and evicts the least recently used entries
+ * if the cache exceeds INFLUENCECACHESIZE.
+ */
+static void storeInfluence(int kind, QVector<double> const &signature, QVector<double> const &data, QVector<int> const &pivot)
+{
+    InfluenceEntry entry;
+    entry.kind      = kind;
+    entry.key       = signatureKey(signature);
+    entry.signature = signature;
+    entry.data      = data;
+    entry.pivot     = pivot;
+
+    qint64 maxBytes = qint64(INFLUENCECACHESIZE)*1024*1024;
+    qint64 bytes = entryBytes(entry);
+    if(bytes>maxBytes) return;
+
+    QMutexLocker locker(&s_InfluenceMutex);
+    for(int i=0; i<s_InfluenceCache.size(); i++)
+    {
+        InfluenceEntry const &other = s_InfluenceCache.at(i);
+        // already stored by another instance
+        if(other.kind==kind && other.key==entry.key && other.signature==signature) return;
+    }
+
+    while(s_InfluenceCache.size() && s_InfluenceBytes+bytes>maxBytes)
+    {
+        int iOldest = 0;
+        for(int i=1; i<s_InfluenceCache.size(); i++)
+        {
+            if(s_InfluenceCache.at(i).lastUse<s_InfluenceCache.at(iOldest).lastUse) iOldest = i;
+        }
+        s_InfluenceBytes -= entryBytes(s_InfluenceCache.at(iOldest));
+        s_InfluenceCache.removeAt(iOldest);
+    }
+
+    entry.lastUse = ++s_InfluenceUse;
+    s_InfluenceCache.append(entry);
+    s_InfluenceBytes += bytes;
+}
+
 
 XFoil::XFoil()
 {
     m_pOutStream = nullptr;
+
+    m_pWorkspace = nullptr;
+    aij = bij = dij = q = nullptr;
+    vm[0] = vm[1] = vm[2] = vm[3] = nullptr;
     //------ primary dimensioning limit parameters
 
     //------ derived dimensioning limit parameters
@@ -86,7 +204,7 @@ XFoil::XFoil()
     minf1 = 0.0;
 
     //---- drop tolerance for bl system solver
-    vaccel = 0.01;
+    vaccel = s_VAccel;
     //---- default viscous parameters
     retyp = 1;
     reinf1 = 0.0;
@@ -96,6 +214,142 @@ XFoil::XFoil()
 
 XFoil::~XFoil()
 {
+    if(m_pWorkspace)
+    {
+        // keep the workspace for the next instance, e.g. the next task of the same thread pool
+        QMutexLocker locker(&s_WorkspaceMutex);
+        s_FreeWorkspace.append(m_pWorkspace);
+    }
+}
+
+
+/**
+ * Ensures that the workspace is large enough for the current number of panel nodes,
+ * and sets the pointers of the aij, bij, dij, q and vm matrices.
+ * The workspace is taken from those released by the deleted instances if one is large enough,
+ * so that its memory is allocated only once per concurrent analysis.
+ * @return true if the workspace is available, false otherwise.
+ */
+bool XFoil::sizeWorkspace()
+{
+    int nwk = std::max(nw, std::min(n/8+2, IWX)); // same number of wake points as in xyWake()
+    int nq = n+7;                                 // the mixed-inverse jacobian uses the columns up to n+6
+    int nz = n+nwk+4;                             // the airfoil and wake nodes, plus the bl system's margin
+
+    if(m_pWorkspace && m_pWorkspace->nq>=nq && m_pWorkspace->nz>=nz) return true;
+
+    QMutexLocker locker(&s_WorkspaceMutex);
+
+    if(m_pWorkspace) s_FreeWorkspace.append(m_pWorkspace);
+    m_pWorkspace = nullptr;
+
+    // the matrices stored in the previous workspace are not available anymore
+    lqaij = ladij = lwdij = false;
+
+    // use the smallest free workspace which is large enough
+    int iBest = -1;
+    for(int i=0; i<s_FreeWorkspace.size(); i++)
+    {
+        XFoilWorkspace const *pWS = s_FreeWorkspace.at(i);
+        if(pWS->nq<nq || pWS->nz<nz) continue;
+        if(iBest<0 || pWS->nz<s_FreeWorkspace.at(iBest)->nz) iBest = i;
+    }
+
+    if(iBest>=0)
+    {
+        m_pWorkspace = s_FreeWorkspace.at(iBest);
+        s_FreeWorkspace.removeAt(iBest);
+    }
+    else
+    {
+        m_pWorkspace = new XFoilWorkspace;
+        m_pWorkspace->nq = nq;
+        m_pWorkspace->nz = nz;
+        // aij and q: nq x nq, bij: nq x nz, dij and the three vm blocks: nz x nz
+        m_pWorkspace->block = new double[size_t(2*nq*nq + nq*nz + 4*nz*nz)]();
+        m_pWorkspace->rows  = new double*[size_t(3*nq + 4*nz)];
+    }
+
+    nq = m_pWorkspace->nq;
+    nz = m_pWorkspace->nz;
+    double *pBlock = m_pWorkspace->block;
+    double **pRow  = m_pWorkspace->rows;
+
+    aij = pRow;
+    for(int i=0; i<nq; i++) {*pRow++ = pBlock;  pBlock += nq;}
+    q = pRow;
+    for(int i=0; i<nq; i++) {*pRow++ = pBlock;  pBlock += nq;}
+    bij = pRow;
+    for(int i=0; i<nq; i++) {*pRow++ = pBlock;  pBlock += nz;}
+    dij = pRow;
+    for(int i=0; i<nz; i++) {*pRow++ = pBlock;  pBlock += nz;}
+    // the rows of the three vm blocks for the same bl station are adjacent,
+    // since the elimination of a station in blsolve() works on the three of them together
+    vm[0] = nullptr;
+    for(int k=1; k<=3; k++)
+    {
+        vm[k] = pRow;
+        pRow += nz;
+    }
+    for(int i=0; i<nz; i++)
+    {
+        for(int k=1; k<=3; k++) {vm[k][i] = pBlock;  pBlock += nz;}
+    }
+
+    return true;
+}
+
+
+/**
+ * Deletes the workspaces released by the deleted instances.
+ * Called at the end of a batch, when the analyses are done, to return their memory to the system;
+ * the workspaces of the instances which are still running are not affected.
+ */
+void XFoil::releaseWorkspaces()
+{
+    QMutexLocker locker(&s_WorkspaceMutex);
+    for(int i=0; i<s_FreeWorkspace.size(); i++)
+    {
+        delete [] s_FreeWorkspace.at(i)->block;
+        delete [] s_FreeWorkspace.at(i)->rows;
+        delete s_FreeWorkspace.at(i);
+    }
+    s_FreeWorkspace.clear();
+}
+
+
+/**
+ * Deletes the influence matrices kept for reuse by the next instances.
+ * The instances which are running keep their own copy of the matrices, so that this may be called at any time.
+ */
+void XFoil::clearInfluenceCache()
+{
+    QMutexLocker locker(&s_InfluenceMutex);
+    s_InfluenceCache.clear();
+    s_InfluenceBytes = 0;
+}
+
+
+/**
+ * Builds the signature of the current paneled geometry, i.e. all the input data of the influence matrices.
+ * @param signature the array to fill
+ * @param bWake true if the wake's nodes should be included, false if only the airfoil's nodes are included.
+ */
+void XFoil::influenceSignature(QVector<double> &signature, bool bWake) const
+{
+    signature.clear();
+    signature.reserve(8*(n+nw)+8);
+    signature << double(n) << double(bWake ? nw : 0) << qinf << (sharp ? 1.0 : 0.0) << ante << aste << dste;
+    for(int i=1; i<=n; i++)
+    {
+        signature << x[i] << y[i] << xp[i] << yp[i] << s[i] << nx[i] << ny[i] << apanel[i];
+    }
+    if(!bWake) return;
+    // the spline derivatives are not defined on the wake
+    for(int i=n+1; i<=n+nw; i++)
+    {
+        signature << x[i] << y[i] << s[i] << nx[i] << ny[i] << apanel[i];
+    }
 }
 
 
@@ -113,10 +367,8 @@ bool XFoil::initialize()
     memset(Hk,     0, sizeof(Hk));
     memset(RTheta, 0, sizeof(RTheta));
 
-    memset(aij,    0, sizeof(aij));
     memset(aijpiv, 0, sizeof(aijpiv));
     memset(apanel, 0, sizeof(apanel));
-    memset(bij,    0, sizeof(bij));
     memset(blsav,  0, sizeof(blsav));
     memset(cij,    0, sizeof(cij));
     memset(cpi,    0, sizeof(cpi));
@@ -124,7 +376,6 @@ bool XFoil::initialize()
     memset(ctau,   0, sizeof(ctau));
     memset(ctq,    0, sizeof(ctq));
     memset(delt,   0, sizeof(delt));
-    memset(dij,    0, sizeof(dij));
     memset(dis,    0, sizeof(dis));
     memset(dq,     0, sizeof(dq));
     memset(dqdg,   0, sizeof(dqdg));
@@ -147,7 +398,6 @@ bool XFoil::initialize()
     memset(nbl,    0, sizeof(nbl));
     memset(nx,     0, sizeof(nx));
     memset(ny,     0, sizeof(ny));
-    memset(q,      0, sizeof(q));
     memset(qf0,    0, sizeof(qf0));
     memset(qf1,    0, sizeof(qf1));
     memset(qf2,    0, sizeof(qf2));
@@ -168,7 +418,11 @@ bool XFoil::initialize()
     memset(va,     0, sizeof(va));
     memset(vb,     0, sizeof(vb));
     memset(vdel,   0, sizeof(vdel));
-    memset(vm,     0, sizeof(vm));
+    if(m_pWorkspace)
+    {
+        int nq = m_pWorkspace->nq, nz = m_pWorkspace->nz;
+        memset(m_pWorkspace->block, 0, size_t(2*nq*nq + nq*nz + 4*nz*nz)*sizeof(double));
+    }
     memset(vs1,    0, sizeof(vs1));
     memset(vs2,    0, sizeof(vs2));
     memset(vsm,    0, sizeof(vsm));
@@ -644,7 +898,7 @@ bool XFoil::initialize()
     xpref2 = 1.0;
 
     //---- drop tolerance for bl system solver
-    vaccel = 0.01;
+    vaccel = s_VAccel;
 
 
 
@@ -1645,52 +1899,58 @@ bool XFoil::blsolve()
         //
         ivp = iv + 1;
         //
+        //------ the mass influence rows of the three equations of station iv
+        double *m1 = vm[1][iv];
+        double *m2 = vm[2][iv];
+        double *m3 = vm[3][iv];
+        //
         //====== invert va[iv] block
         //
         //------ normalize first row
         pivot = 1.0 / va[1][1][iv];
         va[1][2][iv] *= pivot;
-        for (l=iv;l<= nsys;l++) vm[1][l][iv] *= pivot;
+        for (l=iv;l<= nsys;l++) m1[l] *= pivot;
         vdel[1][1][iv] *= pivot;
         vdel[1][2][iv] *= pivot;
         //
         //------ eliminate lower first column in va block
         for (k=2; k<= 3; k++)
         {
+            double *mk = vm[k][iv];
             vtmp = va[k][1][iv];
             va[k][2][iv] -= vtmp*va[1][2][iv];
-            for (int l=iv; l<=nsys; l++) vm[k][l][iv] -= vtmp*vm[1][l][iv];
+            for (l=iv; l<=nsys; l++) mk[l] -= vtmp*m1[l];
             vdel[k][1][iv] -= vtmp*vdel[1][1][iv];
             vdel[k][2][iv] -= vtmp*vdel[1][2][iv];
         }
         //
         //------ normalize second row
         pivot = 1.0 / va[2][2][iv];
-        for (l=iv; l<= nsys; l++) vm[2][l][iv] *=pivot;
+        for (l=iv; l<= nsys; l++) m2[l] *=pivot;
         vdel[2][1][iv] *= pivot;
         vdel[2][2][iv] *= pivot;
         //
         //------ eliminate lower second column in va block
         k = 3;
         vtmp = va[k][2][iv];
-        for (l=iv; l<=nsys; l++) vm[k][l][iv] -= vtmp*vm[2][l][iv];
+        for (l=iv; l<=nsys; l++) m3[l] -= vtmp*m2[l];
         vdel[k][1][iv] -= vtmp*vdel[2][1][iv];
         vdel[k][2][iv] -= vtmp*vdel[2][2][iv];
 
         //------ normalize third row
-        pivot = 1.0/vm[3][iv][iv];
-        for (l=ivp; l<=nsys; l++) vm[3][l][iv] *= pivot;
+        pivot = 1.0/m3[iv];
+        for (l=ivp; l<=nsys; l++) m3[l] *= pivot;
         vdel[3][1][iv] *= pivot;
         vdel[3][2][iv] *= pivot;
         //
         //
         //------ eliminate upper third column in va block
-        vtmp1 = vm[1][iv][iv];
-        vtmp2 = vm[2][iv][iv];
+        vtmp1 = m1[iv];
+        vtmp2 = m2[iv];
         for(l=ivp;l<= nsys;l++)
         {
-            vm[1][l][iv] -= vtmp1*vm[3][l][iv];
-            vm[2][l][iv] -= vtmp2*vm[3][l][iv];
+            m1[l] -= vtmp1*m3[l];
+            m2[l] -= vtmp2*m3[l];
         }
         vdel[1][1][iv] -= vtmp1*vdel[3][1][iv];
         vdel[2][1][iv] -= vtmp2*vdel[3][1][iv];
@@ -1699,7 +1959,7 @@ bool XFoil::blsolve()
         //
         //------ eliminate upper second column in va block
         vtmp = va[1][2][iv];
-        for (l=ivp; l<=nsys;l++) vm[1][l][iv] -= vtmp*vm[2][l][iv];
+        for (l=ivp; l<=nsys;l++) m1[l] -= vtmp*m2[l];
 
         vdel[1][1][iv] -= vtmp*vdel[2][1][iv];
         vdel[1][2][iv] -= vtmp*vdel[2][2][iv];
@@ -1711,10 +1971,11 @@ bool XFoil::blsolve()
             //====== eliminate vb(iv+1) block][ rows  1 -> 3
             for (k=1; k<= 3;k++)
             {
+                double *mk = vm[k][ivp];
                 vtmp1 = vb[k][ 1][ivp];
                 vtmp2 = vb[k][ 2][ivp];
-                vtmp3 = vm[k][iv][ivp];
-                for(l=ivp; l<= nsys;l++) vm[k][l][ivp] -= (vtmp1*vm[1][l][iv]+ vtmp2*vm[2][l][iv]+vtmp3*vm[3][l][iv]);
+                vtmp3 = mk[iv];
+                for(l=ivp; l<= nsys;l++) mk[l] -= (vtmp1*m1[l]+ vtmp2*m2[l]+vtmp3*m3[l]);
                 vdel[k][1][ivp] -= (vtmp1*vdel[1][1][iv]+vtmp2*vdel[2][1][iv]+ vtmp3*vdel[3][1][iv]);
                 vdel[k][2][ivp] -= (vtmp1*vdel[1][2][iv]+vtmp2*vdel[2][2][iv]+ vtmp3*vdel[3][2][iv]);
             }
@@ -1726,11 +1987,12 @@ bool XFoil::blsolve()
                 //
                 for(k=1;k<=3;k++)
                 {
+                    double *mk = vm[k][ivz];
                     vtmp1 = vz[k][1];
                     vtmp2 = vz[k][2];
                     for (l=ivp;l<= nsys;l++)
                     {
-                        vm[k][l][ivz] -=(vtmp1*vm[1][l][iv]+ vtmp2*vm[2][l][iv]);
+                        mk[l] -=(vtmp1*m1[l]+ vtmp2*m2[l]);
                     }
                     vdel[k][1][ivz] -= (vtmp1*vdel[1][1][iv]+ vtmp2*vdel[2][1][iv]);
                     vdel[k][2][ivz] -= (vtmp1*vdel[1][2][iv]+ vtmp2*vdel[2][2][iv]);
@@ -1743,27 +2005,30 @@ bool XFoil::blsolve()
                 //====== eliminate lower vm column
                 for(kv=iv+2; kv<= nsys;kv++)
                 {
-                    vtmp1 = vm[1][iv][kv];
-                    vtmp2 = vm[2][iv][kv];
-                    vtmp3 = vm[3][iv][kv];
+                    double *mk1 = vm[1][kv];
+                    double *mk2 = vm[2][kv];
+                    double *mk3 = vm[3][kv];
+                    vtmp1 = mk1[iv];
+                    vtmp2 = mk2[iv];
+                    vtmp3 = mk3[iv];
                     //
                     if(fabs(vtmp1)>vaccel)
                     {
-                        for(l=ivp;l<= nsys;l++) vm[1][l][kv] -= vtmp1*vm[3][l][iv];
+                        for(l=ivp;l<= nsys;l++) mk1[l] -= vtmp1*m3[l];
                         vdel[1][1][kv] -= vtmp1*vdel[3][1][iv];
                         vdel[1][2][kv] -= vtmp1*vdel[3][2][iv];
                     }
                     //
                     if(fabs(vtmp2)>vaccel)
                     {
-                        for (l=ivp;l<=nsys;l++) vm[2][l][kv] -= vtmp2*vm[3][l][iv];
+                        for (l=ivp;l<=nsys;l++) mk2[l] -= vtmp2*m3[l];
                         vdel[2][1][kv] -= vtmp2*vdel[3][1][iv];
                         vdel[2][2][kv] -= vtmp2*vdel[3][2][iv];
                     }
                     //
                     if(fabs(vtmp3)>vaccel)
                     {
-                        for(l=ivp;l<=nsys;l++) vm[3][l][kv] -= vtmp3*vm[3][l][iv];
+                        for(l=ivp;l<=nsys;l++) mk3[l] -= vtmp3*m3[l];
                         vdel[3][1][kv] -= vtmp3*vdel[3][1][iv];
                         vdel[3][2][kv] -= vtmp3*vdel[3][2][iv];
                     }
@@ -1774,24 +2039,25 @@ bool XFoil::blsolve()
     }//1000
 
     //
-    for (iv=nsys; iv>=2;iv--)
+    //------ eliminate upper vm columns
+    //-      each station's unknowns are final once all the stations downstream have been substituted,
+    //-      so that the rows can be processed one at a time; the contributions are subtracted
+    //-      from the last station upwards, as in the column-wise substitution
+    for (kv=nsys-1; kv>=1; kv--)
     {
-        //------ eliminate upper vm columns
-        vtmp = vdel[3][1][iv];
-        for (kv=iv-1; kv>=1;kv--)
-        {
-            vdel[1][1][kv] -= vm[1][iv][kv]*vtmp;
-            vdel[2][1][kv] -= vm[2][iv][kv]*vtmp;
-            vdel[3][1][kv] -= vm[3][iv][kv]*vtmp;
-        }
-        vtmp = vdel[3][2][iv];
-        for (kv=iv-1; kv>=1;kv--)
+        for(k=1; k<=3; k++)
         {
-            vdel[1][2][kv] -= vm[1][iv][kv]*vtmp;
-            vdel[2][2][kv] -= vm[2][iv][kv]*vtmp;
-            vdel[3][2][kv] -= vm[3][iv][kv]*vtmp;
+            double const *mk = vm[k][kv];
+            double d1 = vdel[k][1][kv];
+            double d2 = vdel[k][2][kv];
+            for (iv=nsys; iv>kv; iv--)
+            {
+                d1 -= mk[iv]*vdel[3][1][iv];
+                d2 -= mk[iv]*vdel[3][2][iv];
+            }
+            vdel[k][1][kv] = d1;
+            vdel[k][2][kv] = d2;
         }
-        //
     }
     return true;
 }
@@ -2956,7 +3222,7 @@ bool XFoil::Gauss(int nn, double z[][6], double r[5]){
   *                                                     *
   *                              mark drela  1984       *
   ****************************************************** */
-bool XFoil::Gauss(int nn, double z[IQX][IQX], double r[IQX]){
+bool XFoil::Gauss(int nn, double **z, double r[]){
     // techwinder : only one rhs is enough ! nrhs = 1
     // dimension z(nsiz,nsiz), r(nsiz,nrhs)
 
@@ -3453,6 +3719,8 @@ bool XFoil::ggcalc()
     double bbb[IQX];
     //    double psiinf;
 
+    sizeWorkspace();
+
     cosa = cos(alfa);
     sina = sin(alfa);
 
@@ -3472,6 +3740,33 @@ bool XFoil::ggcalc()
     }
     psio = 0.0;
 
+    QVector<double> signature, data;
+    QVector<int> pivot;
+    if(s_bInfluenceCache)
+    {
+        influenceSignature(signature, false);
+        if(findInfluence(FACTOREDAIJ, signature, data, pivot))
+        {
+            //---- the system has been factored by another instance for the same geometry
+            double const *pData = data.constData();
+            for(int i=1; i<=n+1; i++)
+            {
+                memcpy(aij[i]+1, pData, size_t(n+1)*sizeof(double));
+                pData += n+1;
+                memcpy(bij[i]+1, pData, size_t(n)*sizeof(double));
+                pData += n;
+                gamu[i][1]  = *pData++;
+                gamu[i][2]  = *pData++;
+                qinvu[i][1] = gamu[i][1];
+                qinvu[i][2] = gamu[i][2];
+            }
+            memcpy(aijpiv+1, pivot.constData(), size_t(n+1)*sizeof(int));
+            lqaij = true;
+            lgamu = true;
+            return true;
+        }
+    }
+
     //---- set up matrix system for  psi = psio  on airfoil surface.
     //-    the unknowns are (dgamma)i and dpsio.
     for (int i=1; i<=n; i++)
@@ -3582,6 +3877,25 @@ bool XFoil::ggcalc()
         qinvu[i][2] = gamu[i][2];
     }
 
+    if(s_bInfluenceCache)
+    {
+        //---- keep the factored matrix, the unfactored dpsi/dm matrix and the unit vorticity distributions
+        data.resize((n+1)*(2*n+3));
+        double *pData = data.data();
+        for(int i=1; i<=n+1; i++)
+        {
+            memcpy(pData, aij[i]+1, size_t(n+1)*sizeof(double));
+            pData += n+1;
+            memcpy(pData, bij[i]+1, size_t(n)*sizeof(double));
+            pData += n;
+            *pData++ = gamu[i][1];
+            *pData++ = gamu[i][2];
+        }
+        pivot.resize(n+1);
+        memcpy(pivot.data(), aijpiv+1, size_t(n+1)*sizeof(int));
+        storeInfluence(FACTOREDAIJ, signature, data, pivot);
+    }
+
     lgamu = true;
 
     return true;
@@ -3589,7 +3903,7 @@ bool XFoil::ggcalc()
 
 
 
-bool XFoil::baksub(int n, double a[IQX][IQX], int indx[], double b[])
+bool XFoil::baksub(int n, double **a, int indx[], double b[])
 {
     double sum=0;
     int i=0, ii=0, ll=0, j=0;
@@ -3618,6 +3932,51 @@ bool XFoil::baksub(int n, double a[IQX][IQX], int indx[], double b[])
 }
 
 
+/**
+ * Solves the factored system for the columns j1 to j2 of the matrix b, in place.
+ * The rows of b are processed as a whole, so that the columns are solved together in contiguous memory
+ * rather than one at a time through a copy in a scratch array.
+ * The operations on each column are those of baksub(int, double**, int[], double[]), in the same order.
+ */
+bool XFoil::baksub(int n, double **a, int indx[], double **b, int j1, int j2)
+{
+    int nc = j2-j1+1;
+    if(nc<=0) return true;
+
+    for (int i=1; i<=n; i++)
+    {
+        int ll = indx[i];
+        double *bi = b[i]+j1;
+        if(ll!=i)
+        {
+            double *bl = b[ll]+j1;
+            for(int c=0; c<nc; c++) std::swap(bi[c], bl[c]);
+        }
+        for (int j=1; j<=i-1; j++)
+        {
+            double aij = a[i][j];
+            double const *bj = b[j]+j1;
+            for(int c=0; c<nc; c++) bi[c] -= aij*bj[c];
+        }
+    }
+
+    for (int i=n; i>=1; i--)
+    {
+        double *bi = b[i]+j1;
+        for (int j=i+1; j<=n; j++)
+        {
+            double aij = a[i][j];
+            double const *bj = b[j]+j1;
+            for(int c=0; c<nc; c++) bi[c] -= aij*bj[c];
+        }
+        double aii = a[i][i];
+        for(int c=0; c<nc; c++) bi[c] = bi[c]/aii;
+    }
+
+    return true;
+}
+
+
 bool XFoil::hct(double hk, double msq, double &hc, double &hc_hk, double &hc_msq)
 {
     //---- density shape parameter    (from whitfield)
@@ -4176,7 +4535,7 @@ bool XFoil::lefind(double &sle, double x[], double xp[], double y[], double yp[]
  *    *******************************************************
 */
 
-bool XFoil::ludcmp(int n, double a[IQX][IQX], int indx[IQX])
+bool XFoil::ludcmp(int n, double **a, int indx[])
 {
     //    bool bimaxok = false;
     int imax =0;//added techwinder
@@ -4695,7 +5054,7 @@ stop110:
 
             tran = false;
             //            qApp->processEvents();
-            if(s_bCancel) return false;
+            if(isCancelled()) return false;
         }//1000 continue
     }// 2000 continue
     return true;
@@ -6394,34 +6753,80 @@ bool XFoil::pswlin(int i, double xi, double yi, double nxi, double nyi, double &
  * ------------------------------------------------------ */
 bool XFoil::qdcalc()
 {
-    int i=0, j=0, k=0, iu=0, iw=0;
+    int i=0, j=0, k=0, iw=0;
     double psi=0, psi_n=0;
-    double bbb[IQX];
-    memset(bbb, 0, IQX*sizeof(double));
+
+    sizeWorkspace();
 
     //TRACE("calculating source influence matrix ...\n");
     QString str = "   Calculating source influence matrix ...\n";
     writeString(str);
 
+    QVector<double> signature, data;
+    QVector<int> pivot;
+
     if(!ladij)
     {
-        //----- calculate source influence matrix for airfoil surface if it doesn't exist
-        for (j=1; j<=n; j++)
+        if(s_bInfluenceCache) influenceSignature(signature, false);
+        if(s_bInfluenceCache && findInfluence(AIRFOILDIJ, signature, data, pivot))
+        {
+            //----- the matrix has been calculated by another instance for the same geometry
+            double const *pData = data.constData();
+            for (i=1; i<=n; i++)
+            {
+                memcpy(dij[i]+1, pData, size_t(n)*sizeof(double));
+                pData += n;
+            }
+        }
+        else
         {
+            //----- calculate source influence matrix for airfoil surface if it doesn't exist
             //------- multiply each dpsi/sig vector by inverse of factored dpsi/dgam matrix
-            for (iu=0; iu<IQX; iu++) bbb[iu] = bij[iu][j];//techwinder : create a dummy array
-            baksub(n+1,aij,aijpiv,bbb);
-            for (iu=0; iu<IQX; iu++) bij[iu][j] = bbb[iu];
+            baksub(n+1, aij, aijpiv, bij, 1, n);
 
             //------- store resulting dgam/dsig = dqtan/dsig vector
             for (i=1; i<=n; i++)
             {
-                dij[i][j] = bij[i][j];
+                for (j=1; j<=n; j++) dij[i][j] = bij[i][j];
+            }
+
+            if(s_bInfluenceCache)
+            {
+                data.resize(n*n);
+                double *pData = data.data();
+                for (i=1; i<=n; i++)
+                {
+                    memcpy(pData, dij[i]+1, size_t(n)*sizeof(double));
+                    pData += n;
+                }
+                storeInfluence(AIRFOILDIJ, signature, data, QVector<int>());
             }
         }
         ladij = true;
     }
 
+    if(s_bInfluenceCache)
+    {
+        influenceSignature(signature, true);
+        if(findInfluence(WAKEDIJ, signature, data, pivot))
+        {
+            //----- the wake's influence has been calculated by another instance for the same airfoil and wake geometry
+            double const *pData = data.constData();
+            for (i=1; i<=n; i++)
+            {
+                memcpy(dij[i]+n+1, pData, size_t(nw)*sizeof(double));
+                pData += nw;
+            }
+            for (i=n+1; i<=n+nw; i++)
+            {
+                memcpy(dij[i]+1, pData, size_t(n+nw)*sizeof(double));
+                pData += n+nw;
+            }
+            lwdij = true;
+            return true;
+        }
+    }
+
     //---- set up coefficient matrix of dpsi/dm on wake
     for (i=1; i<=n; i++)
     {
@@ -6441,28 +6846,8 @@ bool XFoil::qdcalc()
         for(j=n+1; j<=n+nw; j++) bij[n][j] = 0.0;
     }
 
-/*
-for(int i=1; i<=n; i++)
-{
-    QString strong;
-    for(int j=1; j<=n+nw; j++)
-    {
-        QString str;
-        str.sprintf(" %11g", bij[i][j]);
-        strong+=str;
-    }
-    qDebug(strong.toStdString().c_str());
-}*/
-
     //---- multiply by inverse of factored dpsi/dgam matrix
-    for(j=n+1; j<=n+nw;j++)
-    {
-        //        baksub(iqx,n+1,aijpiv,j);
-        for (iu=0; iu<IQX; iu++) bbb[iu] = bij[iu][j];//techwinder: create a dummy array
-
-        baksub(n+1,aij,aijpiv,bbb);
-        for (iu=0; iu<IQX; iu++) bij[iu][j] = bbb[iu];
-    }
+    baksub(n+1, aij, aijpiv, bij, n+1, n+nw);
 
     //---- set the source influence matrix for the wake sources
     for(i=1; i<=n; i++)
@@ -6473,20 +6858,6 @@ for(int i=1; i<=n; i++)
         }
     }
 
-/*
-for(int i=1; i<=n; i++)
-{
-    QString strong;
-    for(int j=1; j<=n+nw; j++)
-    {
-        QString str;
-        str.sprintf(" %11g", dij[i][j]);
-        strong+=str;
-    }
-    qDebug(strong.toStdString().c_str());
-}*/
-
-
     //**** now we need to calculate the influence of sources on the wake velocities
 
     //---- calculate dqtan/dgam and dqtan/dsig at the wake points
@@ -6513,20 +6884,21 @@ for(int i=1; i<=n; i++)
     }
 
     //---- add on effect of all sources on airfoil vorticity which effects wake qtan
+    //-    the rows of dij and bij are traversed contiguously; the sum over k is in the same order for each coefficient
     for(i=n+1; i<=n+nw; i++)
     {
-        int iw = i-n;
-
-        //------ airfoil surface source contribution first
-        for(j=1; j<=n;j++)
-        {
-            for (k=1; k<=n; k++) dij[i][j] += cij[iw][k]*dij[k][j];
-        }
+        iw = i-n;
+        double *di = dij[i];
 
-        //------ wake source contribution next
-        for(j=n+1; j<=n+nw;j++)
+        for(k=1; k<=n; k++)
         {
-            for(k=1; k<=n; k++) dij[i][j] += cij[iw][k]*bij[k][j];
+            double c = cij[iw][k];
+            //------ airfoil surface source contribution first
+            double const *dk = dij[k];
+            for(j=1; j<=n;j++) di[j] += c*dk[j];
+            //------ wake source contribution next
+            double const *bk = bij[k];
+            for(j=n+1; j<=n+nw;j++) di[j] += c*bk[j];
         }
     }
 
@@ -6536,6 +6908,22 @@ for(int i=1; i<=n; i++)
         dij[n+1][j] = dij[n][j];
     }
 
+    if(s_bInfluenceCache)
+    {
+        data.resize(n*nw + nw*(n+nw));
+        double *pData = data.data();
+        for (i=1; i<=n; i++)
+        {
+            memcpy(pData, dij[i]+n+1, size_t(nw)*sizeof(double));
+            pData += nw;
+        }
+        for (i=n+1; i<=n+nw; i++)
+        {
+            memcpy(pData, dij[i]+1, size_t(n+nw)*sizeof(double));
+            pData += n+nw;
+        }
+        storeInfluence(WAKEDIJ, signature, data, QVector<int>());
+    }
 
     lwdij = true;
     return true;
@@ -6605,6 +6993,137 @@ bool XFoil::qwcalc()
 }
 
 
+/**
+ * Saves the current boundary layer solution and the bl-to-panel pointers.
+ * @param state the snapshot to fill
+ */
+void XFoil::saveblState(blState &state) const
+{
+    state.n      = n;
+    state.ist    = ist;
+    state.nsys   = nsys;
+    state.sst    = sst;
+    state.sst_go = sst_go;
+    state.sst_gp = sst_gp;
+    memcpy(state.iblte,  iblte,  sizeof(iblte));
+    memcpy(state.nbl,    nbl,    sizeof(nbl));
+    memcpy(state.itran,  itran,  sizeof(itran));
+    memcpy(state.ipan,   ipan,   sizeof(ipan));
+    memcpy(state.xssitr, xssitr, sizeof(xssitr));
+    memcpy(state.isys,   isys,   sizeof(isys));
+    memcpy(state.xssi,   xssi,   sizeof(xssi));
+    memcpy(state.vti,    vti,    sizeof(vti));
+    memcpy(state.uinv,   uinv,   sizeof(uinv));
+    memcpy(state.uinv_a, uinv_a, sizeof(uinv_a));
+    memcpy(state.thet,   thet,   sizeof(thet));
+    memcpy(state.dstr,   dstr,   sizeof(dstr));
+    memcpy(state.ctau,   ctau,   sizeof(ctau));
+    memcpy(state.uedg,   uedg,   sizeof(uedg));
+    memcpy(state.mass,   mass,   sizeof(mass));
+    memcpy(state.tau,    tau,    sizeof(tau));
+    memcpy(state.dis,    dis,    sizeof(dis));
+    memcpy(state.ctq,    ctq,    sizeof(ctq));
+    memcpy(state.delt,   delt,   sizeof(delt));
+}
+
+
+/**
+ * Restores a boundary layer solution saved for the same paneling, so that the next viscous
+ * calculation starts from this solution. The state is typically saved at the first point of a polar,
+ * and restored before the first point of the polar of the same foil at the next Reynolds number.
+ * @param state the snapshot to restore
+ * @return false if the state was saved for a different paneling, in which case the bl is left uninitialized
+ */
+bool XFoil::restoreblState(blState const &state)
+{
+    if(state.n!=n)
+    {
+        lblini = false;
+        lipan  = false;
+        return false;
+    }
+
+    ist    = state.ist;
+    nsys   = state.nsys;
+    sst    = state.sst;
+    sst_go = state.sst_go;
+    sst_gp = state.sst_gp;
+    memcpy(iblte,  state.iblte,  sizeof(iblte));
+    memcpy(nbl,    state.nbl,    sizeof(nbl));
+    memcpy(itran,  state.itran,  sizeof(itran));
+    memcpy(ipan,   state.ipan,   sizeof(ipan));
+    memcpy(xssitr, state.xssitr, sizeof(xssitr));
+    memcpy(isys,   state.isys,   sizeof(isys));
+    memcpy(xssi,   state.xssi,   sizeof(xssi));
+    memcpy(vti,    state.vti,    sizeof(vti));
+    memcpy(uinv,   state.uinv,   sizeof(uinv));
+    memcpy(uinv_a, state.uinv_a, sizeof(uinv_a));
+    memcpy(thet,   state.thet,   sizeof(thet));
+    memcpy(dstr,   state.dstr,   sizeof(dstr));
+    memcpy(ctau,   state.ctau,   sizeof(ctau));
+    memcpy(uedg,   state.uedg,   sizeof(uedg));
+    memcpy(mass,   state.mass,   sizeof(mass));
+    memcpy(tau,    state.tau,    sizeof(tau));
+    memcpy(dis,    state.dis,    sizeof(dis));
+    memcpy(ctq,    state.ctq,    sizeof(ctq));
+    memcpy(delt,   state.delt,   sizeof(delt));
+
+    lipan  = true;
+    lblini = true;
+    return true;
+}
+
+
+/**
+ * Restores the boundary layer solution s1, extrapolated linearly from the solution s0 of the previous point,
+ * to predict the solution at the next point of a sequence.
+ * The extrapolation is only applied if both states have the same stations, i.e. the same stagnation panel;
+ * otherwise s1 is restored as is. The values which the extrapolation would make non-physical are left at their value in s1.
+ * @param s0 the solution at the point before the last
+ * @param s1 the solution at the last point
+ * @param f the ratio of the next step to the step from s0 to s1
+ * @return true if the solution has been extrapolated, false if s1 has been restored as is or could not be restored
+ */
+bool XFoil::extrapolateblState(blState const &s0, blState const &s1, double f)
+{
+    if(!restoreblState(s1)) return false;
+
+    if(s0.n!=s1.n || s0.ist!=s1.ist || s0.nsys!=s1.nsys) return false;
+    for(int is=1; is<=2; is++)
+    {
+        if(s0.nbl[is]!=s1.nbl[is] || s0.iblte[is]!=s1.iblte[is]) return false;
+        for(int ibl=1; ibl<=s1.nbl[is]; ibl++)
+        {
+            if(s0.ipan[ibl][is]!=s1.ipan[ibl][is]) return false;
+        }
+    }
+
+    for(int is=1; is<=2; is++)
+    {
+        // ctau holds the amplification ratio upstream of transition and the shear stress downstream,
+        // so it is only extrapolated where the stations were on the same side of transition in both states
+        int itr0 = std::min(s0.itran[is], s1.itran[is]);
+        int itr1 = std::max(s0.itran[is], s1.itran[is]);
+        for(int ibl=2; ibl<=nbl[is]; ibl++)
+        {
+            double th = s1.thet[ibl][is] + f*(s1.thet[ibl][is]-s0.thet[ibl][is]);
+            double ds = s1.dstr[ibl][is] + f*(s1.dstr[ibl][is]-s0.dstr[ibl][is]);
+            double ue = s1.uedg[ibl][is] + f*(s1.uedg[ibl][is]-s0.uedg[ibl][is]);
+            double ct = s1.ctau[ibl][is];
+            if(ibl<itr0 || ibl>=itr1) ct += f*(s1.ctau[ibl][is]-s0.ctau[ibl][is]);
+            if(th<=0.0 || ds<=th || ue<=0.0 || ct<0.0) continue;
+
+            thet[ibl][is] = th;
+            dstr[ibl][is] = ds;
+            uedg[ibl][is] = ue;
+            ctau[ibl][is] = ct;
+            mass[ibl][is] = ds*ue;
+        }
+    }
+    return true;
+}
+
+
 bool XFoil::restoreblData(int icom)
 {
     if (icom==1){
@@ -7019,6 +7538,8 @@ bool XFoil::setbl()
     memset(ute1_m, 0, (2*IVX+1)*sizeof(double));
     memset(ute2_m, 0, (2*IVX+1)*sizeof(double));
 
+    sizeWorkspace();
+
     double msq_clmr=0.0, mdi=0.0;
     double herat=0.0,herat_ms=0.0;
 
@@ -7301,7 +7822,7 @@ bool XFoil::setbl()
             //---- stuff bl system coefficients into main jacobian matrix
 
             for( jv=1; jv<= nsys;jv++){
-                vm[1][jv][iv] = vs1[1][3]*d1_m[jv] + vs1[1][4]*u1_m[jv]
+                vm[1][iv][jv] = vs1[1][3]*d1_m[jv] + vs1[1][4]*u1_m[jv]
                         + vs2[1][3]*d2_m[jv] + vs2[1][4]*u2_m[jv]
                         + (vs1[1][5] + vs2[1][5] + vsx[1])
                         *(xi_ule1*ule1_m[jv] + xi_ule2*ule2_m[jv]);
@@ -7328,7 +7849,7 @@ bool XFoil::setbl()
                     *(xi_ule1*dule1 + xi_ule2*dule2);
 
             for(jv=1; jv<= nsys;jv++){
-                vm[2][jv][iv] = vs1[2][3]*d1_m[jv] + vs1[2][4]*u1_m[jv]
+                vm[2][iv][jv] = vs1[2][3]*d1_m[jv] + vs1[2][4]*u1_m[jv]
                         + vs2[2][3]*d2_m[jv] + vs2[2][4]*u2_m[jv]
                         + (vs1[2][5] + vs2[2][5] + vsx[2])
                         *(xi_ule1*ule1_m[jv] + xi_ule2*ule2_m[jv]);
@@ -7356,7 +7877,7 @@ bool XFoil::setbl()
 
             //memory overlap problem
             for(jv=1; jv<= nsys;jv++){
-                vm[3][jv][iv] = vs1[3][3]*d1_m[jv] + vs1[3][4]*u1_m[jv]
+                vm[3][iv][jv] = vs1[3][3]*d1_m[jv] + vs1[3][4]*u1_m[jv]
                         + vs2[3][3]*d2_m[jv] + vs2[3][4]*u2_m[jv]
                         + (vs1[3][5] + vs2[3][5] + vsx[3])
                         *(xi_ule1*ule1_m[jv] + xi_ule2*ule2_m[jv]);
@@ -8784,7 +9305,7 @@ bool XFoil::trchek()
     //TRACE("trchek2 - n2 convergence failed\n");
     str = "trchek2 - n2 convergence failed\n";
     writeString(str, true);
-    if(s_bCancel) return false;
+    if(isCancelled()) return false;
 stop101:
 
     //---- test for free or forced transition
@@ -9239,6 +9760,8 @@ bool XFoil::trisol(double a[], double b[], double c[], double d[], int kk){
 bool XFoil::ueset()
 {
     double dui, ue_m;
+
+    sizeWorkspace();
     for (int is=1; is<= 2;is++)
     {
         for(int ibl=2; ibl<= nbl[is]; ibl++)
@@ -12032,6 +12555,8 @@ bool XFoil::mixed(int kqsp)
     //    sina = sin(alfa);
     scalc(x,y,s,n);
 
+    sizeWorkspace();
+
     //---- zero-out and set dof shape functions
     for (i=1; i<=n; i++){
         qf0[i] = 0.0;
@@ -42,11 +42,15 @@ See http://raphael.mit.edu/xfoil for more information.
 #include "xfoil-lib_global.h"
 
 #include <QTextStream>
+#include <QAtomicInt>
+#include <QVector>
 #include <math.h>
 #include <complex>
 
 #include <xfoil_params.h>
 
+#define INFLUENCECACHESIZE 256   /**< the max memory in MB of the influence matrices kept in the cache shared by the XFoil instances */
+
 
 using namespace std;
     //------ derived dimensioning limit parameters
@@ -72,6 +76,38 @@ struct blData
 };
 
 
+/**
+ * @struct XFoilWorkspace
+ * The large matrices of the panel and boundary layer systems, allocated in a single block
+ * sized from the number of panel nodes of the analysis rather than from the compile-time maxima.
+ */
+struct XFoilWorkspace
+{
+    int nq;          /**< the row and column dimension of the aij and q matrices, and the row dimension of bij */
+    int nz;          /**< the column dimension of bij, and the dimension of dij and of the vm blocks */
+    double *block;   /**< the memory block which holds all the matrices */
+    double **rows;   /**< the pointers to the rows of the matrices in the block */
+};
+
+
+/**
+ * @struct blState
+ * A snapshot of a converged boundary layer solution, used to start the analysis of a polar
+ * from the solution of a neighbouring polar of the same foil rather than from the inviscid edge velocities.
+ */
+struct blState
+{
+    int n;                     /**< the number of panel nodes of the foil for which the state was saved */
+    int ist, nsys;
+    int iblte[ISX], nbl[ISX], itran[ISX], ipan[IVX][ISX];
+    double sst, sst_go, sst_gp;
+    double xssitr[ISX];
+    double isys[IVX][ISX], xssi[IVX][ISX], vti[IVX][ISX], uinv[IVX][ISX], uinv_a[IVX][ISX];
+    double thet[IVX][ISX], dstr[IVX][ISX], ctau[IVX][ISX], uedg[IVX][ISX], mass[IVX][ISX];
+    double tau[IVX][ISX], dis[IVX][ISX], ctq[IVX][ISX], delt[IVX][ISX];
+};
+
+
 
 class XFOILLIBSHARED_EXPORT XFoil
 {
@@ -80,6 +116,9 @@ public:
     XFoil();
     virtual ~XFoil();
 
+    XFoil(XFoil const &) = delete;
+    XFoil &operator=(XFoil const &) = delete;
+
 public:
     void interpolate(double xf1[], double yf1[], int n1,
                      double xf2[], double yf2[], int n2, double mixt);
@@ -97,6 +136,9 @@ public:
     bool initXFoilGeometry(int fn, const double *fx, const double *fy, double *fnx, double *fny);
     bool initXFoilAnalysis(double Re, double alpha, double Mach, double NCrit, double XtrTop, double XtrBot,
                                   int reType, int maType, bool bViscous, QTextStream &outStream);
+    void saveblState(blState &state) const;
+    bool restoreblState(blState const &state);
+    bool extrapolateblState(blState const &s0, blState const &s1, double f);
 
     void splqsp(int kqsp);
     void qspcir();
@@ -139,12 +181,18 @@ public:
     void setClSpec(double cl) {clspec=cl;}
 
 
-    static bool isCancelled() {return s_bCancel;}
-    static void setCancel(bool bCancel) {s_bCancel=bCancel;}
+    bool isCancelled() const {return s_bCancel.loadAcquire() || m_bCancel.loadAcquire();}
+    void cancel() {m_bCancel.storeRelease(1);}
+    void resetCancel() {m_bCancel.storeRelease(0);}
+    static void setCancel(bool bCancel) {s_bCancel.storeRelease(bCancel ? 1 : 0);}
     static void setFullReport(bool bFull) {s_bFullReport=bFull;}
     static bool fullReport() {return s_bFullReport;}
-    static double VAccel() {return vaccel;}
-    static void setVAccel(double accel) {vaccel=accel;}
+    static double VAccel() {return s_VAccel;}
+    static void releaseWorkspaces();
+    static void clearInfluenceCache();
+    static void setInfluenceCache(bool bCache) {s_bInfluenceCache=bCache;}
+    static bool bInfluenceCache() {return s_bInfluenceCache;}
+    static void setVAccel(double accel) {s_VAccel=accel;}
 
 private:
 
@@ -198,7 +246,8 @@ private:
                 double acrit, double &ax,
                 double &ax_hk1, double &ax_t1, double &ax_rt1, double &ax_a1,
                 double &ax_hk2, double &ax_t2, double &ax_rt2, double &ax_a2);
-    bool baksub(int n, double a[IQX][IQX],int indx[], double b[]);
+    bool baksub(int n, double **a, int indx[], double b[]);
+    bool baksub(int n, double **a, int indx[], double **b, int j1, int j2);
     bool bldif(int ityp);
     bool blkin();
     bool blmid(int ityp);
@@ -219,7 +268,7 @@ private:
 
     bool gamqv();
     bool Gauss(int nn, double z[][6], double r[5]);
-    bool Gauss(int nn, double z[IQX][IQX], double r[IQX]);
+    bool Gauss(int nn, double **z, double r[]);
     bool geopar(double x[], double xp[], double y[], double yp[], double s[],
                int n, double t[], double &sle, double &chord,
                double &area, double &radle, double &angte,
@@ -242,7 +291,7 @@ private:
     bool iblsys();
     bool lefind(double &sle, double x[], double xp[], double y[], double yp[], double s[], int n);
     void lerscl(double *x, double *xp, double* y, double *yp, double *s, int n, double doc, double rfac, double *xnew,double *ynew);
-    bool ludcmp(int n, double a[IQX][IQX],int indx[IQX]);
+    bool ludcmp(int n, double **a, int indx[]);
     bool mhinge();
     bool mrchdu();
     bool mrchue();
@@ -258,6 +307,8 @@ private:
     bool segspld(double x[], double xs[], double s[], int n, double xs1, double xs2);
     bool setbl();
     bool setexp(double s[],double ds1,double smax,int nn);
+    bool sizeWorkspace();
+    void influenceSignature(QVector<double> &signature, bool bWake) const;
     bool sinvrt(double &si,double xi,double x[],double xs[],double s[],int n);
 
     void splina(double x[], double xs[], double s[], int n);
@@ -286,9 +337,12 @@ private:
 
 
 public:
-    static double vaccel;
-    static bool s_bCancel;
+    static double s_VAccel;       /**< the default value of vaccel for the new instances */
+    static QAtomicInt s_bCancel;  /**< non-zero if all the running instances should stop */
+    QAtomicInt m_bCancel;         /**< non-zero if this instance should stop */
+    double vaccel;
     static bool s_bFullReport;
+    static bool s_bInfluenceCache;  /**< true if the factored aij matrix and the bij and dij matrices should be shared with the instances which analyze the same paneled geometry */
 
     QTextStream *m_pOutStream;
 
@@ -444,10 +498,10 @@ private:
 //    double sigte_a,gamte_a;
     double dste,aste;
     double qinv[IZX],qinvu[IZX][3], qinv_a[IZX];
-    double q[IQX][IQX],dq[IQX],dzdg[IQX],dzdn[IQX],dzdm[IZX],dqdg[IQX];
+    double **q,dq[IQX],dzdg[IQX],dzdn[IQX],dzdm[IZX],dqdg[IQX];
     double dqdm[IZX],qtan1,qtan2,z_qinf,z_alfa,z_qdof0,z_qdof1,z_qdof2,z_qdof3;
-    double aij[IQX][IQX];
-    double bij[IQX][IZX],dij[IZX][IZX];
+    double **aij;
+    double **bij,**dij;
     double cij[IWX][IQX];
     double hopi,qopi;
 
@@ -489,7 +543,10 @@ private:
     double cfm, cfm_ms, cfm_re, cfm_u1, cfm_t1, cfm_d1, cfm_u2, cfm_t2, cfm_d2;
     double xt, xt_a1, xt_ms, xt_re, xt_xf, xt_x1, xt_t1, xt_d1, xt_u1,
           xt_x2, xt_t2, xt_d2, xt_u2;
-    double va[4][3][IZX],vb[4][3][IZX],vdel[4][3][IZX],vm[4][IZX][IZX],vz[4][3];
+    double va[4][3][IZX],vb[4][3][IZX],vdel[4][3][IZX],vz[4][3];
+    double **vm[4];   /**< vm[1] to vm[3] are the blocks of the bl system's mass influence matrix, indexed as vm[k][equation station][unknown station] */
+
+    XFoilWorkspace *m_pWorkspace;   /**< the block which holds the aij, bij, dij, q and vm matrices */
 
 //    int ncpref, napol[9], npol, ipact, nlref, icolp[9],icolr[9],imatyp[9],iretyp[9], nxypol[9],npolref, ndref[4][9];
 //    double c1sav[74], c2sav[74];
@@ -0,0 +1,486 @@
+/****************************************************************************
+
+    BatchRunner Class
+       Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QThreadPool>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+#include <QStringList>
+
+#include "batchrunner.h"
+#include "xfoiltask.h"
+#include "xfoiltaskevent.h"
+
+
+/**
+* The public constructor
+*/
+BatchRunner::BatchRunner(QObject *pParent) : QObject(pParent), m_ResultQueue(this), m_Out(stdout)
+{
+    m_nStarted = m_nDone = m_nRunning = m_nErrors = 0;
+    m_nThreads = QThread::idealThreadCount();
+
+    m_bAlpha = true;
+    m_SpMin = 0.0;
+    m_SpMax = 10.0;
+    m_SpInc = 0.5;
+    m_bInitBL = true;
+    m_bFromZero = false;
+    m_bWarmStart = false;
+
+    m_OutDir = ".";
+    m_bCSV = false;
+}
+
+
+/**
+* The destructor
+*/
+BatchRunner::~BatchRunner()
+{
+    for(int i=0; i<m_Analysis.size(); i++) delete m_Analysis.at(i).pPolar;
+    for(int i=0; i<m_Foil.size(); i++)     delete m_Foil.at(i);
+}
+
+
+/**
+ * Reads the foil coordinates from a file in the XFoil .dat format and adds the foil to the batch.
+ * The foil's name is read on the first line, or defaults to the file's name if the first line holds coordinates.
+ * @param pathName the path to the .dat file
+ * @return true if the foil has been read successfully, false otherwise
+ */
+bool BatchRunner::loadFoil(QString const &pathName)
+{
+    QFile datFile(pathName);
+    if (!datFile.open(QIODevice::ReadOnly)) return false;
+
+    QTextStream in(&datFile);
+    Foil *pFoil = new Foil();
+    QString FoilName = QFileInfo(pathName).completeBaseName();
+    double xp=-9999.0, yp=-9999.0;
+    bool bFirst = true;
+
+    while(!in.atEnd())
+    {
+        QString strong = in.readLine();
+        int pos = strong.indexOf("#");
+        // ignore everything after # (including #)
+        if(pos>=0) strong.truncate(pos);
+        strong = strong.simplified();
+        if(!strong.length()) continue;
+
+        QStringList fields = strong.split(" ");
+        bool bx=false, by=false;
+        double x=0.0, y=0.0;
+        if(fields.size()==2)
+        {
+            x = fields.at(0).toDouble(&bx);
+            y = fields.at(1).toDouble(&by);
+        }
+
+        if(!bx || !by)
+        {
+            if(bFirst)
+            {
+                FoilName = strong;
+                bFirst = false;
+                continue;
+            }
+            break; // end of the coordinates
+        }
+        bFirst = false;
+
+        //add values only if the point is not coincident with the previous one
+        if(sqrt((x-xp)*(x-xp) + (y-yp)*(y-yp))>0.000001)
+        {
+            if(pFoil->nb>=IQX)
+            {
+                delete pFoil;
+                return false;
+            }
+            pFoil->xb[pFoil->nb] = x;
+            pFoil->yb[pFoil->nb] = y;
+            pFoil->nb++;
+            xp = x;
+            yp = y;
+        }
+    }
+
+    if(pFoil->nb<3)
+    {
+        delete pFoil;
+        return false;
+    }
+
+    pFoil->setFoilName(FoilName);
+
+    // Check if the foil was written clockwise or counter-clockwise
+    double area = 0.0;
+    for (int i=0; i<pFoil->nb; i++)
+    {
+        int ip = (i==pFoil->nb-1) ? 0 : i+1;
+        area +=  0.5*(pFoil->yb[i]+pFoil->yb[ip])*(pFoil->xb[i]-pFoil->xb[ip]);
+    }
+
+    if(area < 0.0)
+    {
+        //reverse the points order
+        for (int i=0; i<pFoil->nb/2; i++)
+        {
+            std::swap(pFoil->xb[i], pFoil->xb[pFoil->nb-i-1]);
+            std::swap(pFoil->yb[i], pFoil->yb[pFoil->nb-i-1]);
+        }
+    }
+
+    memcpy(pFoil->x, pFoil->xb, sizeof(pFoil->xb));
+    memcpy(pFoil->y, pFoil->yb, sizeof(pFoil->yb));
+    pFoil->n = pFoil->nb;
+    pFoil->initFoil();
+
+    m_Foil.append(pFoil);
+    return true;
+}
+
+
+/**
+ * Creates one polar for each foil and for each combination of Reynolds number, Mach number and NCrit.
+ * The polars of a foil with the same Mach number and NCrit are added in the order of the Reynolds numbers.
+ * @param polarType the type of the polars, either FIXEDSPEEDPOLAR or FIXEDLIFTPOLAR
+ * @param ReList the Reynolds numbers
+ * @param MachList the Mach numbers
+ * @param NCritList the transition criteria
+ * @param XtrTop the forced transition location on the top surface
+ * @param XtrBot the forced transition location on the bottom surface
+ */
+void BatchRunner::addPolars(XFLR5::enumPolarType polarType, QVector<double> const &ReList, QVector<double> const &MachList,
+                            QVector<double> const &NCritList, double XtrTop, double XtrBot)
+{
+    for(int ifoil=0; ifoil<m_Foil.size(); ifoil++)
+    {
+        for(int iMa=0; iMa<MachList.size(); iMa++)
+        {
+            for(int iN=0; iN<NCritList.size(); iN++)
+            {
+                for(int iRe=0; iRe<ReList.size(); iRe++)
+                {
+                    Polar *pPolar = new Polar;
+                    pPolar->setFoilName(m_Foil.at(ifoil)->foilName());
+                    pPolar->setPolarType(polarType);
+                    pPolar->setReynolds(ReList.at(iRe));
+                    pPolar->setMach(MachList.at(iMa));
+                    pPolar->setNCrit(NCritList.at(iN));
+                    pPolar->setXtrTop(XtrTop);
+                    pPolar->setXtrBot(XtrBot);
+                    pPolar->setAutoPolarName();
+                    // the default name does not hold the NCrit
+                    pPolar->setPolarName(pPolar->polarName() + QString("_N%1").arg(NCritList.at(iN),0,'f',1));
+
+                    Analysis analysis;
+                    analysis.pFoil  = m_Foil.at(ifoil);
+                    analysis.pPolar = pPolar;
+                    analysis.bChainEnd = true;
+                    m_Analysis.append(analysis);
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * Sets the range of aoa or Cl parameters to analyze
+ * @param bAlpha true if the input parameter is a range of aoa, false if a range of lift coefficients
+ * @param SpMin the minimum value of the range to analyze
+ * @param SpMax the maximum value of the range to analyze
+ * @param SpInc the increment value for the parameter
+ */
+void BatchRunner::setSequence(bool bAlpha, double SpMin, double SpMax, double SpInc)
+{
+    m_bAlpha = bAlpha;
+    m_SpMin = SpMin;
+    m_SpMax = SpMax;
+    m_SpInc = SpInc;
+}
+
+
+/**
+ * Sets the number of analyses running concurrently, and sizes the global thread pool accordingly.
+ * @param nThreads the number of threads; a value less than 1 selects the number of cores of the machine
+ */
+void BatchRunner::setThreads(int nThreads)
+{
+    if(nThreads<1) nThreads = QThread::idealThreadCount();
+    m_nThreads = qMax(1, nThreads);
+    QThreadPool::globalInstance()->setMaxThreadCount(m_nThreads);
+}
+
+
+/**
+ * Reads a list of values separated by commas. Each item is either a single value,
+ * or a range in the form min:max:inc.
+ * @param strange the string to read
+ * @param values the array filled with the values
+ * @return true if the string has been read successfully, false otherwise
+ */
+bool BatchRunner::readRange(QString const &strange, QVector<double> &values)
+{
+    values.clear();
+    QStringList items = strange.split(",", QString::SkipEmptyParts);
+    for(int i=0; i<items.size(); i++)
+    {
+        QStringList fields = items.at(i).split(":");
+        bool bOK[] = {true, true, true};
+        if(fields.size()==1)
+        {
+            values.append(fields.at(0).toDouble(bOK));
+        }
+        else if(fields.size()==3)
+        {
+            double vMin = fields.at(0).toDouble(bOK);
+            double vMax = fields.at(1).toDouble(bOK+1);
+            double vInc = qAbs(fields.at(2).toDouble(bOK+2));
+            if(vInc<1.e-10) return false;
+            if(vMax<vMin) vInc = -vInc;
+            int total = int(qAbs((vMax*1.0001-vMin)/vInc));//*1.0001 to make sure upper limit is included
+            for(int k=0; k<=total; k++) values.append(vMin + k*vInc);
+        }
+        else return false;
+
+        if(!bOK[0] || !bOK[1] || !bOK[2]) return false;
+    }
+    return values.size()>0;
+}
+
+
+/**
+ * Starts the batch analysis. The application is exited when all the analyses are finished.
+ */
+void BatchRunner::start()
+{
+    XFoilTask::setCancel(false);
+    m_nStarted = m_nDone = m_nRunning = 0;
+
+    if(m_bWarmStart) buildChains();
+
+    m_Out << QString("Found %1 foil/polar pairs to analyze\n").arg(m_Analysis.size());
+    m_Out << QString("Starting with %1 threads\n\n").arg(m_nThreads);
+    m_Out.flush();
+
+    if(!m_Analysis.size())
+    {
+        QCoreApplication::exit(0);
+        return;
+    }
+
+    startTasks();
+}
+
+
+/**
+ * Splits the polars of each foil which differ only by their Reynolds number in chains of neighbouring Re.
+ * The number of chains is such that all the threads are kept busy when there are fewer foils than threads.
+ */
+void BatchRunner::buildChains()
+{
+    int iFirst = 0;
+    while(iFirst<m_Analysis.size())
+    {
+        // find the polars of the same foil, Mach and NCrit, which have been added in the order of the Re
+        Analysis const &first = m_Analysis.at(iFirst);
+        int iLast = iFirst;
+        while(iLast+1<m_Analysis.size())
+        {
+            Analysis const &next = m_Analysis.at(iLast+1);
+            if(next.pFoil!=first.pFoil || qAbs(next.pPolar->Mach()-first.pPolar->Mach())>1.e-6
+               || qAbs(next.pPolar->NCrit()-first.pPolar->NCrit())>1.e-6) break;
+            iLast++;
+        }
+
+        int nGroups = qMax(1, m_Analysis.size()/(iLast-iFirst+1));
+        int nChains = qMax(1, (m_nThreads+nGroups-1)/nGroups);
+        int chainLength = qMax(1, (iLast-iFirst+1+nChains-1)/nChains);
+        for(int i=iFirst; i<=iLast; i++)
+            m_Analysis[i].bChainEnd = (i==iLast) || ((i-iFirst+1)%chainLength==0);
+
+        iFirst = iLast+1;
+    }
+}
+
+
+/**
+ * Launches the next analyses until the number of running tasks is equal to the number of threads.
+ * The XFoil instance is initialized in the calling thread, as in the BatchThreadDlg class.
+ */
+void BatchRunner::startTasks()
+{
+    while(m_nRunning<m_nThreads && m_nStarted<m_Analysis.size())
+    {
+        int iFirst = m_nStarted;
+        while(!m_Analysis.at(m_nStarted).bChainEnd) m_nStarted++;
+        m_nStarted++;
+
+        Analysis const &analysis = m_Analysis.at(iFirst);
+        XFoilTask *pXFoilTask = new XFoilTask(this);
+        pXFoilTask->setResultQueue(&m_ResultQueue);
+        pXFoilTask->setSequence(m_bAlpha, m_SpMin, m_SpMax, m_SpInc);
+        if(!pXFoilTask->initializeTask(analysis.pFoil, analysis.pPolar, false, true, m_bInitBL, m_bFromZero))
+        {
+            m_Out << "   ...Failed to initialize " + analysis.pFoil->foilName() + " / " + analysis.pPolar->polarName() + "\n";
+            m_Out.flush();
+            delete pXFoilTask;
+            m_nErrors += m_nStarted-iFirst;
+            m_nDone   += m_nStarted-iFirst;
+            continue;
+        }
+
+        for(int i=iFirst; i<m_nStarted; i++)
+        {
+            if(i>iFirst) pXFoilTask->appendPolar(m_Analysis.at(i).pPolar);
+            m_Out << QString("%1/%2/%3  Starting ").arg(i+1).arg(m_nDone).arg(m_Analysis.size())
+                   + m_Analysis.at(i).pFoil->foilName() + " / " + m_Analysis.at(i).pPolar->polarName() + "\n";
+        }
+        m_Out.flush();
+        m_nRunning++;
+        QThreadPool::globalInstance()->start(pXFoilTask);
+    }
+
+    if(m_nDone>=m_Analysis.size())
+    {
+        QThreadPool::globalInstance()->waitForDone();
+        XFoil::clearInfluenceCache();
+        XFoil::releaseWorkspaces();
+        m_Out << "\n_____Analysis completed_____\n";
+        m_Out.flush();
+        QCoreApplication::exit(m_nErrors ? 1 : 0);
+    }
+}
+
+
+/**
+ * Receives the events posted by the XFoil tasks.
+ * When we get here, we've crossed the thread boundary and are now executing in the main thread.
+ */
+void BatchRunner::customEvent(QEvent *pEvent)
+{
+    if(pEvent->type() == XFOIL_END_TASK_EVENT)
+    {
+        handleTaskEvent(static_cast<XFoilTaskEvent *>(pEvent));
+    }
+    else if(pEvent->type() == XFOIL_END_OPP_EVENT)
+    {
+        XFoilOppEvent *pOppEvent = static_cast<XFoilOppEvent*>(pEvent);
+        addOpPoint(pOppEvent->polarPtr(), pOppEvent->oppPtr());
+    }
+    else if(pEvent->type() == XFOIL_RESULTS_EVENT)
+    {
+        drainResults();
+    }
+}
+
+
+/**
+ * Adds the data of an operating point to its polar, with the same rules as in Objects2d::addOpPoint(), and deletes the point.
+ */
+void BatchRunner::addOpPoint(Polar *pPolar, OpPoint *pOpPoint)
+{
+    if(pPolar->polarType()==XFLR5::FIXEDLIFTPOLAR || pPolar->polarType()==XFLR5::RUBBERCHORDPOLAR)
+    {
+        if(pOpPoint->Reynolds()<1.00e8) pPolar->addOpPointData(pOpPoint);
+    }
+    else pPolar->addOpPointData(pOpPoint);
+
+    delete pOpPoint;
+}
+
+
+/**
+ * Adds the operating points waiting in the result queue to their polars.
+ */
+void BatchRunner::drainResults()
+{
+    m_Results.clear();
+    m_ResultQueue.drain(m_Results);
+    for(int i=0; i<m_Results.size(); i++)
+        addOpPoint(m_Results.at(i).pPolar, m_Results.at(i).pOpPoint);
+}
+
+
+/**
+ * Writes the polar of a finished task to disk, releases it and launches the next analysis.
+ */
+void BatchRunner::handleTaskEvent(XFoilTaskEvent const *pEvent)
+{
+    // the task has pushed the points of the polar before posting this event
+    drainResults();
+
+    m_nDone++; //one down, more to go
+
+    Foil *pFoil = pEvent->foilPtr();
+    Polar *pPolar = pEvent->polarPtr();
+
+    // the task is finished once the last polar of its chain is done
+    for(int i=0; i<m_Analysis.size(); i++)
+    {
+        if(m_Analysis.at(i).pPolar==pPolar)
+        {
+            if(m_Analysis.at(i).bChainEnd) m_nRunning--;
+            break;
+        }
+    }
+
+    if(writePolar(pFoil, pPolar))
+        m_Out << QString("%1/%2/%3  ...Finished ").arg(m_nStarted).arg(m_nDone).arg(m_Analysis.size())
+               + pFoil->foilName() + " / " + pPolar->polarName() + "\n";
+    else
+    {
+        m_Out << "   ...Could not write the polar " + pFoil->foilName() + " / " + pPolar->polarName() + "\n";
+        m_nErrors++;
+    }
+    m_Out.flush();
+
+    // the results are on disk, no need to keep them in memory
+    pPolar->resetPolar();
+
+    startTasks();
+}
+
+
+/**
+ * Writes the polar to a file in the output directory, named after the foil and the polar.
+ * @return true if the file has been written successfully, false otherwise
+ */
+bool BatchRunner::writePolar(Foil const *pFoil, Polar *pPolar)
+{
+    QString fileName = pFoil->foilName() + "_" + pPolar->polarName();
+    fileName.replace(QRegExp("[^A-Za-z0-9_.\\-]"), "_");
+    fileName += m_bCSV ? ".csv" : ".txt";
+
+    QFile plrFile(QDir(m_OutDir).filePath(fileName));
+    if (!plrFile.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+
+    QTextStream out(&plrFile);
+    pPolar->exportPolar(out, QCoreApplication::applicationName() + " v" + QCoreApplication::applicationVersion(), m_bCSV);
+    out.flush();
+    plrFile.close();
+    return plrFile.error()==QFile::NoError;
+}
@@ -0,0 +1,120 @@
+/****************************************************************************
+
+    BatchRunner Class
+       Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+/** @file This file implements the headless management of a batch of foil polar analyses. */
+
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QObject>
+#include <QVector>
+#include <QString>
+#include <QTextStream>
+
+#include <objects/objects2d/foil.h>
+#include <objects/objects2d/polar.h>
+
+#include "xfoilresultqueue.h"
+
+class XFoilTaskEvent;
+
+/**
+*@class BatchRunner
+* Runs a batch of XFoil analyses without any graphical interface.
+*
+* Each pair of foil and polar is analyzed by an XFoilTask in the global thread pool,
+* in the same manner as in the BatchThreadDlg class. The task pushes its operating points to a result queue and
+* posts its end notification to this object, which adds the results to the polar and writes the polar to disk
+* as soon as its analysis is finished. The number of tasks in progress is limited to the number of threads,
+* so that the memory used by the XFoil instances does not depend on the size of the batch.
+*
+* In warm start mode, the polars of a foil which differ only by their Reynolds number are split in chains
+* of neighbouring Re; each chain is analyzed by a single task, each polar starting from the BL of the previous one.
+*/
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    BatchRunner(QObject *pParent = nullptr);
+    ~BatchRunner();
+
+    bool loadFoil(QString const &pathName);
+    void addPolars(XFLR5::enumPolarType polarType, QVector<double> const &ReList, QVector<double> const &MachList,
+                   QVector<double> const &NCritList, double XtrTop, double XtrBot);
+    void setSequence(bool bAlpha, double SpMin, double SpMax, double SpInc);
+    void setOutput(QString const &dirName, bool bCSV) {m_OutDir = dirName; m_bCSV = bCSV;}
+    void setThreads(int nThreads);
+    void setInitBL(bool bInitBL) {m_bInitBL = bInitBL;}
+    void setFromZero(bool bFromZero) {m_bFromZero = bFromZero;}
+    void setWarmStart(bool bWarmStart) {m_bWarmStart = bWarmStart;}
+
+    int foilCount() const {return m_Foil.size();}
+    int analysisCount() const {return m_Analysis.size();}
+
+    static bool readRange(QString const &strange, QVector<double> &values);
+
+public slots:
+    void start();
+
+protected:
+    void customEvent(QEvent *pEvent);
+
+private:
+    /** @struct a pair of foil and polar to analyze */
+    struct Analysis
+    {
+        Foil *pFoil;
+        Polar *pPolar;
+        bool bChainEnd;  /**< true if this is the last polar of the chain analyzed by a task */
+    };
+
+    void buildChains();
+    void startTasks();
+    void handleTaskEvent(XFoilTaskEvent const *pEvent);
+    void addOpPoint(Polar *pPolar, OpPoint *pOpPoint);
+    void drainResults();
+    bool writePolar(Foil const *pFoil, Polar *pPolar);
+
+    QVector<Foil*> m_Foil;            /**< the foils read from the input files */
+    QVector<Analysis> m_Analysis;     /**< the pairs of foil and polar to analyze */
+    int m_nStarted;                   /**< the number of analyses which have been launched */
+    int m_nDone;                      /**< the number of analyses which are finished */
+    int m_nRunning;                   /**< the number of tasks in progress */
+    int m_nThreads;                   /**< the maximum number of analyses running concurrently */
+    int m_nErrors;                    /**< the number of polars which could not be initialized or written */
+
+    XFoilResultQueue m_ResultQueue;   /**< the queue through which the tasks hand their operating points */
+    QVector<XFoilResult> m_Results;   /**< the operating points drained from the queue, kept to reuse the allocated memory */
+
+    bool m_bAlpha;                    /**< true if the sequence is a range of aoa, false if a range of lift coefficients */
+    double m_SpMin, m_SpMax, m_SpInc; /**< the range of the sequence */
+    bool m_bInitBL;                   /**< true if the boundary layer should be initialized at the start of each polar */
+    bool m_bFromZero;                 /**< true if the aoa sequence should start from 0 */
+    bool m_bWarmStart;                /**< true if the polars are analyzed in chains of neighbouring Re */
+
+    QString m_OutDir;                 /**< the directory in which the polar files are written */
+    bool m_bCSV;                      /**< true if the polars are written in the CSV format */
+
+    QTextStream m_Out;                /**< the console output */
+};
+
+#endif // BATCHRUNNER_H
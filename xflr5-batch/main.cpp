@@ -0,0 +1,130 @@
+/****************************************************************************
+
+    xflr5-batch Application
+       Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTimer>
+#include <QDir>
+
+#include "batchrunner.h"
+#include "xfoiltask.h"
+
+
+/**
+* Prints an error message followed by the usage, and returns the error code
+*/
+static int usageError(QCommandLineParser const &parser, QString const &message)
+{
+    QTextStream err(stderr);
+    err << message << "\n\n" << parser.helpText();
+    return 2;
+}
+
+
+/**
+* The console application's point of entry.
+*
+* Example: xflr5-batch --re 1e5:1e6:1e5 --ncrit 5,9 --alpha -5:15:0.5 --output polars naca0012.dat e387.dat
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("xflr5-batch");
+    QCoreApplication::setApplicationVersion("6.47");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs batches of foil polar analyses with XFoil, without graphical interface.\n"
+                                     "Ranges are lists of values separated by commas, each item being either a value or min:max:inc.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("foils", "The foil files in the .dat format.", "foil.dat...");
+
+    QCommandLineOption reOption("re",       "The Reynolds numbers.", "range");
+    QCommandLineOption machOption("mach",   "The Mach numbers, default 0.", "range", "0");
+    QCommandLineOption ncritOption("ncrit", "The transition criteria, default 9.", "range", "9");
+    QCommandLineOption alphaOption("alpha", "The aoa sequence in degrees, as min:max:inc.", "sequence");
+    QCommandLineOption clOption("cl",       "The lift coefficient sequence, as min:max:inc.", "sequence");
+    QCommandLineOption typeOption("type",   "The polar type: 1 for fixed speed, 2 for fixed lift, default 1.", "type", "1");
+    QCommandLineOption xtrTopOption("xtrtop", "The forced transition location on the top surface, default 1.", "x", "1.0");
+    QCommandLineOption xtrBotOption("xtrbot", "The forced transition location on the bottom surface, default 1.", "x", "1.0");
+    QCommandLineOption iterOption("iter",   "The maximum number of viscous iterations, default 100.", "n", "100");
+    QCommandLineOption threadOption("threads", "The number of threads, default is the number of cores.", "n", "0");
+    QCommandLineOption outOption("output",  "The directory in which the polars are written, default is the current directory.", "dir", ".");
+    QCommandLineOption csvOption("csv",     "Writes the polars in the CSV format.");
+    QCommandLineOption zeroOption("fromzero", "Starts the aoa sequence from 0.");
+    QCommandLineOption keepBLOption("keepbl", "Does not initialize the boundary layer at the start of each polar.");
+    QCommandLineOption warmOption("warmstart", "Analyzes the polars of each foil in chains of neighbouring Reynolds numbers,\n"
+                                               "starting each polar from the boundary layer of the previous one.");
+    QCommandLineOption adaptiveOption("adaptive", "Extrapolates the boundary layer from the previous points of the sequence,\n"
+                                                  "and bisects the step when a point does not converge.");
+
+    parser.addOptions({reOption, machOption, ncritOption, alphaOption, clOption, typeOption, xtrTopOption, xtrBotOption,
+                       iterOption, threadOption, outOption, csvOption, zeroOption, keepBLOption, warmOption,
+                       adaptiveOption});
+    parser.process(app);
+
+    QVector<double> ReList, MachList, NCritList, sequence;
+    if(!parser.isSet(reOption) || !BatchRunner::readRange(parser.value(reOption), ReList))
+        return usageError(parser, "Invalid or missing Reynolds numbers");
+    if(!BatchRunner::readRange(parser.value(machOption), MachList))   return usageError(parser, "Invalid Mach numbers");
+    if(!BatchRunner::readRange(parser.value(ncritOption), NCritList)) return usageError(parser, "Invalid NCrit values");
+
+    bool bAlpha = !parser.isSet(clOption);
+    if(parser.isSet(alphaOption) && parser.isSet(clOption)) return usageError(parser, "Select either an aoa or a Cl sequence");
+    QStringList seq = parser.value(bAlpha ? alphaOption : clOption).split(":");
+    if(seq.size()!=3) return usageError(parser, "The sequence should be specified as min:max:inc");
+    for(int i=0; i<3; i++)
+    {
+        bool bOK=false;
+        sequence.append(seq.at(i).toDouble(&bOK));
+        if(!bOK) return usageError(parser, "Invalid sequence");
+    }
+    if(qAbs(sequence.at(2))<1.e-10) return usageError(parser, "The sequence increment should be non-zero");
+
+    int type = parser.value(typeOption).toInt();
+    if(type!=1 && type!=2) return usageError(parser, "Only the polar types 1 and 2 are supported");
+    XFLR5::enumPolarType polarType = type==1 ? XFLR5::FIXEDSPEEDPOLAR : XFLR5::FIXEDLIFTPOLAR;
+
+    if(!QDir().mkpath(parser.value(outOption))) return usageError(parser, "Cannot create the output directory");
+
+    BatchRunner runner;
+    QStringList foilFiles = parser.positionalArguments();
+    for(int i=0; i<foilFiles.size(); i++)
+    {
+        if(!runner.loadFoil(foilFiles.at(i))) return usageError(parser, "Could not read the foil file "+foilFiles.at(i));
+    }
+    if(!runner.foilCount()) return usageError(parser, "No foil to analyze");
+
+    XFoilTask::s_IterLim = qMax(1, parser.value(iterOption).toInt());
+    XFoilTask::s_bAdaptiveStep = parser.isSet(adaptiveOption);
+
+    runner.addPolars(polarType, ReList, MachList, NCritList, parser.value(xtrTopOption).toDouble(), parser.value(xtrBotOption).toDouble());
+    runner.setSequence(bAlpha, sequence.at(0), sequence.at(1), sequence.at(2));
+    runner.setThreads(parser.value(threadOption).toInt());
+    runner.setOutput(parser.value(outOption), parser.isSet(csvOption));
+    runner.setInitBL(!parser.isSet(keepBLOption));
+    runner.setFromZero(parser.isSet(zeroOption));
+    runner.setWarmStart(parser.isSet(warmOption));
+
+    QTimer::singleShot(0, &runner, SLOT(start()));
+
+    return app.exec();
+}
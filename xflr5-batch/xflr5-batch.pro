@@ -0,0 +1,64 @@
+#-------------------------------------------------
+#
+# Headless console application which runs batches of foil polar
+# analyses with the XFoil-lib and xflr5-engine libraries only
+#
+#-------------------------------------------------
+
+# The following define makes your compiler emit warnings if you use
+# any feature of Qt which as been marked as deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+QT       -= gui
+QT       += concurrent
+
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = xflr5-batch
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../XFoil-lib/
+INCLUDEPATH += $$PWD/../xflr5-engine/
+INCLUDEPATH += $$PWD/../xflr5-gui/xdirect/analysis/
+
+DEPENDPATH += $$PWD/../XFoil-lib/
+DEPENDPATH += $$PWD/../xflr5-engine/
+
+SOURCES += \
+    main.cpp \
+    batchrunner.cpp \
+    ../xflr5-gui/xdirect/analysis/xfoiltask.cpp \
+    ../xflr5-gui/xdirect/analysis/xfoilresultqueue.cpp
+
+HEADERS += \
+    batchrunner.h \
+    ../xflr5-gui/xdirect/analysis/xfoiltask.h \
+    ../xflr5-gui/xdirect/analysis/xfoilresultqueue.h \
+    ../xflr5-gui/xdirect/analysis/xfoiltaskevent.h
+
+OBJECTS_DIR = ./objects
+MOC_DIR     = ./moc
+DESTDIR     = .
+
+win32 {
+#prevent qmake from making useless \debug and \release subdirs
+    CONFIG -= debug_and_release debug_and_release_target
+}
+
+
+linux-g++{
+    # VARIABLES
+    isEmpty(PREFIX):PREFIX = /usr/local
+    BINDIR = $$PREFIX/bin
+
+    # MAKE INSTALL
+    INSTALLS += target
+    target.path = $$BINDIR
+}
+
+
+LIBS += -L../xflr5-engine -lxflr5-engine
+LIBS += -L../XFoil-lib -lXFoil
@@ -20,6 +20,7 @@
 *****************************************************************************/
 
 #include <QtCore>
+#include <QtConcurrent/QtConcurrentMap>
 #include "matrix.h"
 #include <analysis3d/analysis3d_params.h>
 
@@ -134,10 +135,10 @@ void AV33(double *A, double *v, double *p)
 *@param n the size of the square matrix
 *@param B a pointer to the array of m RHS
 *@param m the number of RHS arrays to solve
-*@param pbCancel a pointer to the boolean variable which holds true if the operation should be interrupted.
+*@param pbCancel a pointer to the atomic flag which holds a non-zero value if the operation should be interrupted.
 *@return true if the problem was successfully solved.
 */
-bool Gauss(double *A, int n, double *B, int m, bool *pbCancel)
+bool Gauss(double *A, int n, double *B, int m, QAtomicInt const *pbCancel)
 {
     int row, i, j, pivot_row, k;
     double max, dum, *pa, *pA, *A_pivot_row;
@@ -146,7 +147,7 @@ bool Gauss(double *A, int n, double *B, int m, bool *pbCancel)
     pa = A;
     for (row=0; row<n-1; row++, pa+=n)
     {
-        if(*pbCancel) return false;
+        if(pbCancel->loadAcquire()) return false;
         
         //  find the pivot row
         A_pivot_row = pa;
@@ -198,7 +199,7 @@ bool Gauss(double *A, int n, double *B, int m, bool *pbCancel)
     pa = A + (n-1) * n;
     for (row = n-1; row >= 0; pa -= n, row--)
     {
-        if(*pbCancel) return false;
+        if(pbCancel->loadAcquire()) return false;
 
         if ( fabs(*(pa + row)) <PRECISION) return false;           // matrix is singular
         
@@ -414,7 +415,7 @@ complex<double> det44(complex<double> *aij)
 
 
 /**
-  int Crout_LU_Decomposition_with_Pivoting(double *A, int pivot[], int n)
+  int Crout_LU_Decomposition_with_Pivoting_Unblocked(double *A, int pivot[], int n)
 
   Unknown author http:mymathlib.webtrellis.net/index.html
 
@@ -457,8 +458,10 @@ complex<double> det44(complex<double> *aij)
      0  Success
     -1  Failure - The matrix A is singular.
 
+  This is the original scalar version of the decomposition; it is kept as a
+  reference for Crout_LU_Decomposition_with_Pivoting() and for the lu-bench benchmark.
 */
-bool Crout_LU_Decomposition_with_Pivoting(double *A, int pivot[], int n, bool *pbCancel, double TaskSize, double &Progress)
+bool Crout_LU_Decomposition_with_Pivoting_Unblocked(double *A, int pivot[], int n, QAtomicInt const *pbCancel, double TaskSize, double &Progress)
 {
     int i, j, k;
     double *p_k, *p_row, *p_col;
@@ -508,12 +511,220 @@ bool Crout_LU_Decomposition_with_Pivoting(double *A, int pivot[], int n, bool *p
 
         Progress += TaskSize/double(n);
 //        qApp->processEvents();
-        if(*pbCancel) return false;
+        if(pbCancel->loadAcquire()) return false;
     }
     return true;
 }
 
 
+#define LUBLOCKSIZE   64    /**< the number of columns of the panels in the blocked LU decomposition */
+#define LUROWTILE     32    /**< the number of rows of the trailing matrix updated in a single task */
+#define LUCOLTILE    512    /**< the number of columns of the trailing matrix updated in a single pass */
+#define LUSOLVEBLOCK   64    /**< the number of rows processed together in the blocked triangular solves */
+#define LUSOLVEROWTILE  8    /**< the number of rows of the off-diagonal product computed in a single task */
+#define LUSOLVEMTLENGTH 4096 /**< the minimal length x number of RHS of the off-diagonal products for a multithreaded evaluation */
+
+
+/**
+* Updates the rows i0 to i1-1 of the trailing sub-matrix of the blocked LU decomposition,
+* i.e. A22 = A22 - L21.U12 where L21 are the columns k0 to k1-1 and U12 the rows k0 to k1-1.
+* The columns are processed by strips of LUCOLTILE so that the strip of U12 remains in cache,
+* and four rows of U12 are combined in each pass on a row of A22 to reduce the memory traffic.
+* The innermost loops are contiguous and are left to the compiler for vectorization.
+* The single precision version processes twice as many columns per vector instruction.
+*/
+template<typename T>
+static void updateTrailingRows(T *A, int n, int k0, int k1, int i0, int i1)
+{
+    for(int j0=k1; j0<n; j0+=LUCOLTILE)
+    {
+        int j1 = qMin(j0+LUCOLTILE, n);
+        for(int i=i0; i<i1; i++)
+        {
+            T *p_row = A + i*n;
+            int k=k0;
+            for(; k+3<k1; k+=4)
+            {
+                T const l0 = p_row[k];
+                T const l1 = p_row[k+1];
+                T const l2 = p_row[k+2];
+                T const l3 = p_row[k+3];
+                T const *u0 = A + k*n;
+                T const *u1 = u0 + n;
+                T const *u2 = u1 + n;
+                T const *u3 = u2 + n;
+                for(int j=j0; j<j1; j++)
+                    p_row[j] -= l0*u0[j] + l1*u1[j] + l2*u2[j] + l3*u3[j];
+            }
+            for(; k<k1; k++)
+            {
+                T const lk = p_row[k];
+                T const *uk = A + k*n;
+                for(int j=j0; j<j1; j++) p_row[j] -= lk*uk[j];
+            }
+        }
+    }
+}
+
+
+void LU_UpdateTrailingRows(double *A, int n, int k0, int k1, int i0, int i1)
+{
+    updateTrailingRows(A, n, k0, k1, i0, i1);
+}
+
+
+void LU_UpdateTrailingRows(float *A, int n, int k0, int k1, int i0, int i1)
+{
+    updateTrailingRows(A, n, k0, k1, i0, i1);
+}
+
+
+/**
+  Blocked version of Crout's LU decomposition with partial pivoting.
+
+  The storage and the results are the same as those of the scalar version
+  Crout_LU_Decomposition_with_Pivoting_Unblocked(): the matrix A is replaced
+  by the lower triangular matrix L and by the unit upper triangular matrix U,
+  and pivot[k] is the row interchanged with row k at step k. The results may
+  be solved with Crout_LU_with_Pivoting_Solve().
+
+  The matrix is processed by panels of LUBLOCKSIZE columns:
+    - the panel is factorized with partial pivoting using the scalar method;
+      the row interchanges are applied to the full rows;
+    - the block U12 of the panel's rows on the right of the panel is computed
+      by forward substitution with the diagonal block L11;
+    - the trailing matrix is updated with A22 = A22 - L21.U12; this is where
+      most of the work is done, and the rows are distributed by tiles on the
+      threads of the global pool.
+  The progress and the cancellation flag are updated once per panel.
+
+  Arguments:
+     double *A       Pointer to the first element of the matrix A[n][n].
+     int    pivot[]  The i-th element is the pivot row interchanged with row i.
+     int     n       The number of rows or columns of the matrix A.
+     QAtomicInt *pbCancel  A pointer to the atomic flag which holds a non-zero value if the operation should be interrupted.
+     double TaskSize The amount by which Progress is incremented for the complete decomposition.
+     double &Progress The progress variable.
+
+  Return Values:
+     true  : Success
+     false : Failure - The matrix A is singular or the operation has been cancelled.
+*/
+template<typename T>
+static bool croutLUDecomposition(T *A, int pivot[], int n, QAtomicInt const *pbCancel, double TaskSize, double &Progress)
+{
+    T *p_k, *p_row, *p_col;
+    T max=0.0;
+    QVector<int> tiles;
+
+    for(int k0=0; k0<n; k0+=LUBLOCKSIZE)
+    {
+        int k1 = qMin(k0+LUBLOCKSIZE, n);
+
+        // factorize the panel of columns k0 to k1-1
+        for(int k=k0; k<k1; k++)
+        {
+            p_k = A + k*n;
+
+            // find the pivot row
+            pivot[k] = k;
+            p_col = p_k;
+            max = qAbs(p_k[k]);
+            for(int i=k+1; i<n; i++)
+            {
+                p_row = A + i*n;
+                if (max<qAbs(p_row[k]))
+                {
+                    max = qAbs(p_row[k]);
+                    pivot[k] = i;
+                    p_col = p_row;
+                }
+            }
+
+            // and if the pivot row differs from the current row, then
+            // interchange the two full rows.
+            if (pivot[k] != k)
+            {
+                for (int j=0; j<n; j++)
+                {
+                    max = p_k[j];
+                    p_k[j] = p_col[j];
+                    p_col[j] = max;
+                }
+            }
+
+            // and if the matrix is singular, return error
+            if (p_k[k] == 0.0) return false;
+
+            // otherwise find the upper triangular matrix elements for row k within the panel
+            for (int j=k+1; j<k1; j++) p_k[j] /= p_k[k];
+
+            // and update the remaining columns of the panel
+            for (int i=k+1; i<n; i++)
+            {
+                p_row = A + i*n;
+                T const lik = p_row[k];
+                for (int j=k+1; j<k1; j++) p_row[j] -= lik * p_k[j];
+            }
+        }
+
+        if(k1<n)
+        {
+            // find the block U12 of the upper triangular matrix on the right of the panel
+            for(int k=k0; k<k1; k++)
+            {
+                p_k = A + k*n;
+                for(int m=k0; m<k; m++)
+                {
+                    T const lkm = p_k[m];
+                    T const *p_m = A + m*n;
+                    for (int j=k1; j<n; j++) p_k[j] -= lkm * p_m[j];
+                }
+                for (int j=k1; j<n; j++) p_k[j] /= p_k[k];
+            }
+
+            // update the trailing matrix
+            int nTiles = (n-k1+LUROWTILE-1)/LUROWTILE;
+            if(nTiles<2)
+            {
+                updateTrailingRows(A, n, k0, k1, k1, n);
+            }
+            else
+            {
+                tiles.resize(nTiles);
+                for(int it=0; it<nTiles; it++) tiles[it] = it;
+                QtConcurrent::blockingMap(tiles, [A, n, k0, k1](int const &it)
+                {
+                    int i0 = k1 + it*LUROWTILE;
+                    updateTrailingRows(A, n, k0, k1, i0, qMin(i0+LUROWTILE, n));
+                });
+            }
+        }
+
+        Progress += TaskSize*double(k1-k0)/double(n);
+        if(pbCancel->loadAcquire()) return false;
+    }
+    return true;
+}
+
+
+bool Crout_LU_Decomposition_with_Pivoting(double *A, int pivot[], int n, QAtomicInt const *pbCancel, double TaskSize, double &Progress)
+{
+    return croutLUDecomposition(A, pivot, n, pbCancel, TaskSize, Progress);
+}
+
+
+/**
+* Single precision version of the blocked LU decomposition, for the mixed precision solution of large systems.
+* The factors require half the memory of the double precision factors, and each vector instruction of the trailing updates
+* processes twice as many coefficients; the accuracy of the solutions is recovered by the caller with iterative refinement.
+*/
+bool Crout_LU_Decomposition_with_Pivoting(float *A, int pivot[], int n, QAtomicInt const *pbCancel, double TaskSize, double &Progress)
+{
+    return croutLUDecomposition(A, pivot, n, pbCancel, TaskSize, Progress);
+}
+
+
 /**
   int Crout_LU_with_Pivoting_Solve(double *LU, double B[], int pivot[],
                                                         double x[], int n)
@@ -546,7 +757,7 @@ bool Crout_LU_Decomposition_with_Pivoting(double *A, int pivot[], int n, bool *p
      false : Failure - The matrix A is singular.
 
 */
-bool Crout_LU_with_Pivoting_Solve(double *LU, double B[], int pivot[], double x[], int Size, bool *pbCancel)
+bool Crout_LU_with_Pivoting_Solve(double *LU, double B[], int pivot[], double x[], int Size, QAtomicInt const *pbCancel)
 {
     int i, k;
     double *p_k;
@@ -565,7 +776,7 @@ bool Crout_LU_with_Pivoting_Solve(double *LU, double B[], int pivot[], double x[
         x[k] /= *(p_k+k);
 
 //        qApp->processEvents();
-        if(*pbCancel) return false;
+        if(pbCancel->loadAcquire()) return false;
     }
 
     //  Solve the linear equation Ux = y, where y is the solution
@@ -586,13 +797,380 @@ bool Crout_LU_with_Pivoting_Solve(double *LU, double B[], int pivot[], double x[
         }
 
 //        qApp->processEvents();
-        if(*pbCancel) return false;
+        if(pbCancel->loadAcquire()) return false;
+    }
+
+    return true;
+}
+
+
+
+/**
+* Subtracts from the entries i0 to i1-1 of each solution vector the products of
+* the rows i0 to i1-1 of the LU factors, restricted to the columns j0 to j1-1,
+* with the entries j0 to j1-1 of the same solution vector.
+* This is the off-diagonal part of the blocked triangular solves; the rows are independent
+* of each other, and each row of the factors is loaded once for all the RHS.
+*/
+template<typename T>
+static void solveUpdateRows(T const *LU, double *x, int n, int nRHS, int i0, int i1, int j0, int j1)
+{
+    for(int i=i0; i<i1; i++)
+    {
+        T const *p_i = LU + i*n;
+        for(int r=0; r<nRHS; r++)
+        {
+            double const *xr = x + r*n;
+            // four partial sums to break the dependency chain of the accumulation
+            double d0=0.0, d1=0.0, d2=0.0, d3=0.0;
+            int j=j0;
+            for(; j+3<j1; j+=4)
+            {
+                d0 += p_i[j]   * xr[j];
+                d1 += p_i[j+1] * xr[j+1];
+                d2 += p_i[j+2] * xr[j+2];
+                d3 += p_i[j+3] * xr[j+3];
+            }
+            for(; j<j1; j++) d0 += p_i[j] * xr[j];
+            x[r*n+i] -= (d0+d1) + (d2+d3);
+        }
+    }
+}
+
+
+void LU_SolveUpdateRows(double const *LU, double *x, int n, int nRHS, int i0, int i1, int j0, int j1)
+{
+    solveUpdateRows(LU, x, n, nRHS, i0, i1, j0, j1);
+}
+
+
+void LU_SolveUpdateRows(float const *LU, double *x, int n, int nRHS, int i0, int i1, int j0, int j1)
+{
+    solveUpdateRows(LU, x, n, nRHS, i0, i1, j0, j1);
+}
+
+
+/**
+* Solves the linear equation A.X = B for several right hand sides at once, using
+* the LU factors of A returned by Crout_LU_Decomposition_with_Pivoting().
+*
+* The RHS vectors are stored consecutively in the array B, i.e. the k-th RHS starts at B+k*n,
+* and the solutions are stored in the same way in the array x.
+* The array x may be the same as the array B, in which case the solve is performed in place.
+* The array B is modified by the row interchanges.
+*
+* The RHS block is treated as a n x nRHS matrix, and the triangular solves are blocked by
+* LUSOLVEBLOCK rows. For each block, the product of the off-diagonal part of the factors with
+* the solutions already known is computed first, with each row of the factors loaded once for
+* all the RHS; the rows of this product are independent and are distributed on the threads of
+* the global pool for large matrices. The small triangular solve on the diagonal block follows.
+* The factors are thus read once in each direction whatever the number of RHS.
+*
+*@param LU a pointer to the LU factors of the matrix
+*@param B a pointer to the array of RHS
+*@param pivot the array of row interchanges
+*@param x a pointer to the array of solutions
+*@param n the size of the matrix
+*@param nRHS the number of RHS to solve
+*@param pbCancel a pointer to the atomic flag which holds a non-zero value if the operation should be interrupted.
+*@return true if the problem was successfully solved.
+*/
+template<typename T>
+static bool croutLUSolve(T const *LU, double *B, int pivot[], double *x, int n, int nRHS, QAtomicInt const *pbCancel)
+{
+    T const *p_k;
+    double *b, *xr;
+    double dum;
+    QVector<int> tiles;
+
+    // apply the row interchanges to the RHS;
+    // the interchange at step k involves rows k and pivot[k]>=k only,
+    // so that all interchanges may be applied before the forward substitution
+    for(int r=0; r<nRHS; r++)
+    {
+        b  = B + r*n;
+        for (int k=0; k<n; k++)
+        {
+            if (pivot[k] != k)
+            {
+                dum=b[k]; b[k]=b[pivot[k]]; b[pivot[k]]=dum;
+            }
+        }
+        if(x!=B) memcpy(x+r*n, b, ulong(n)*sizeof(double));
+    }
+
+    // dispatches the off-diagonal products to the thread pool if they are large enough
+    auto updateRows = [&](int i0, int i1, int j0, int j1)
+    {
+        int nTiles = (i1-i0+LUSOLVEROWTILE-1)/LUSOLVEROWTILE;
+        if(nTiles<2 || (j1-j0)*nRHS<LUSOLVEMTLENGTH)
+        {
+            solveUpdateRows(LU, x, n, nRHS, i0, i1, j0, j1);
+            return;
+        }
+        tiles.resize(nTiles);
+        for(int it=0; it<nTiles; it++) tiles[it] = it;
+        QtConcurrent::blockingMap(tiles, [LU, x, n, nRHS, i0, i1, j0, j1](int const &it)
+        {
+            int r0 = i0 + it*LUSOLVEROWTILE;
+            solveUpdateRows(LU, x, n, nRHS, r0, qMin(r0+LUSOLVEROWTILE, i1), j0, j1);
+        });
+    };
+
+    //  Solve the linear equation Lx = B for x, where L is a lower triangular matrix.
+    for(int k0=0; k0<n; k0+=LUSOLVEBLOCK)
+    {
+        int k1 = qMin(k0+LUSOLVEBLOCK, n);
+        if(k0>0) updateRows(k0, k1, 0, k0);
+
+        for (int k=k0; k<k1; k++)
+        {
+            p_k = LU + k*n;
+            for(int r=0; r<nRHS; r++)
+            {
+                xr = x + r*n;
+                dum = xr[k];
+                for (int i=k0; i<k; i++) dum -= xr[i] * p_k[i];
+                xr[k] = dum / p_k[k];
+            }
+        }
+        if(pbCancel->loadAcquire()) return false;
+    }
+
+    //  Solve the linear equation Ux = y, where y is the solution
+    //  obtained above of Lx = B and U is an upper triangular matrix.
+    //  The diagonal part of the upper triangular part of the matrix is
+    //  assumed to be 1.0.
+    for(int k1=n; k1>0; k1-=LUSOLVEBLOCK)
+    {
+        int k0 = qMax(k1-LUSOLVEBLOCK, 0);
+        if(k1<n) updateRows(k0, k1, k1, n);
+
+        for (int k=k1-1; k>=k0; k--)
+        {
+            p_k = LU + k*n;
+            if (p_k[k]==0.0) return false;
+            for(int r=0; r<nRHS; r++)
+            {
+                xr = x + r*n;
+                dum = xr[k];
+                for (int i=k+1; i<k1; i++) dum -= xr[i] * p_k[i];
+                xr[k] = dum;
+            }
+        }
+        if(pbCancel->loadAcquire()) return false;
     }
 
     return true;
 }
 
 
+bool Crout_LU_with_Pivoting_Solve(double *LU, double *B, int pivot[], double *x, int n, int nRHS, QAtomicInt const *pbCancel)
+{
+    return croutLUSolve<double>(LU, B, pivot, x, n, nRHS, pbCancel);
+}
+
+
+/**
+* Solves the linear equation A.X = B for several right hand sides with the single precision LU factors of A
+* returned by the float version of Crout_LU_Decomposition_with_Pivoting().
+* The RHS and the solutions are in double precision, and the products are accumulated in double precision.
+*/
+bool Crout_LU_with_Pivoting_Solve(float const *LU, double *B, int pivot[], double *x, int n, int nRHS, QAtomicInt const *pbCancel)
+{
+    return croutLUSolve<float>(LU, B, pivot, x, n, nRHS, pbCancel);
+}
+
+
+/**
+* Solves the linear equation A.X = B for several right hand sides with the restarted GMRES method,
+* using right preconditioning so that the residuals which are tested are those of the original system.
+*
+* The matrix is not required: the products by the matrix and by the preconditioner are provided by the caller.
+* The Arnoldi iterations of all the RHS are performed in lockstep, so that at each iteration the product
+* by the matrix is requested once for the block of the RHS which have not converged yet;
+* this allows a matrix-free operator to compute each coefficient once for all the RHS.
+* The RHS vectors are stored consecutively, i.e. the k-th RHS starts at B+k*n, and the solutions in the same way.
+*
+*@param matVec the function which calculates the products Y=A.X for nVec vectors stored consecutively
+*@param precondition the function which replaces nVec vectors stored consecutively by their product with the inverse of the preconditioner
+*@param B a pointer to the array of RHS
+*@param X a pointer to the array of solutions, which holds the initial guess on input; must not be the same as B
+*@param n the size of the system
+*@param nRHS the number of RHS
+*@param restart the max dimension of the Krylov subspace, after which the iterations are restarted
+*@param maxIter the max number of iterations
+*@param tolerance the max ratio of the norm of the residual to the norm of the RHS
+*@param pbCancel a pointer to the atomic flag which holds a non-zero value if the operation should be interrupted.
+*@param nIter the number of iterations which have been performed
+*@param maxResidual the max ratio of the residual to the norm of the RHS at the last check
+*@return true if all the RHS have converged.
+*/
+bool GMRES_Solve(std::function<void(double const*, double*, int)> const &matVec,
+                 std::function<void(double*, int)> const &precondition,
+                 double const *B, double *X, int n, int nRHS, int restart, int maxIter, double tolerance,
+                 QAtomicInt const *pbCancel, int &nIter, double &maxResidual)
+{
+    int m = restart;
+    QVector<double> bNorm(nRHS, 0.0);
+    QVector<bool> bConverged(nRHS, false);
+    QVector<double> V(nRHS*(m+1)*n);       // the Krylov bases
+    QVector<double> H(nRHS*(m+1)*m, 0.0);  // the Hessenberg matrices, by columns
+    QVector<double> cs(nRHS*m), sn(nRHS*m), g(nRHS*(m+1));
+    QVector<int> size(nRHS, 0);            // the dimension of the subspace of each RHS in the current cycle
+    QVector<double> Z(nRHS*n), W(nRHS*n), y(m);
+    QVector<int> active, cycle;
+
+    nIter = 0;
+    maxResidual = 0.0;
+
+    for(int k=0; k<nRHS; k++)
+    {
+        double sum = 0.0;
+        for(int i=0; i<n; i++) sum += B[k*n+i]*B[k*n+i];
+        bNorm[k] = sqrt(sum);
+        if(bNorm[k]<=0.0)
+        {
+            memset(X+k*n, 0, ulong(n)*sizeof(double));
+            bConverged[k] = true;
+        }
+    }
+
+    while(true)
+    {
+        // the residuals of the current solutions
+        active.clear();
+        for(int k=0; k<nRHS; k++) if(!bConverged.at(k)) active.append(k);
+        if(active.isEmpty()) return true;
+
+        for(int a=0; a<active.size(); a++) memcpy(Z.data()+a*n, X+active.at(a)*n, ulong(n)*sizeof(double));
+        matVec(Z.constData(), W.data(), active.size());
+        if(pbCancel && pbCancel->loadAcquire()) return false;
+
+        maxResidual = 0.0;
+        cycle.clear();
+        for(int a=0; a<active.size(); a++)
+        {
+            int k = active.at(a);
+            double *v0 = V.data() + k*(m+1)*n;
+            double beta = 0.0;
+            for(int i=0; i<n; i++)
+            {
+                v0[i] = B[k*n+i] - W.at(a*n+i);
+                beta += v0[i]*v0[i];
+            }
+            beta = sqrt(beta);
+            maxResidual = qMax(maxResidual, beta/bNorm.at(k));
+            if(beta<=tolerance*bNorm.at(k))
+            {
+                bConverged[k] = true;
+                continue;
+            }
+            for(int i=0; i<n; i++) v0[i] /= beta;
+            memset(g.data()+k*(m+1), 0, ulong(m+1)*sizeof(double));
+            g[k*(m+1)] = beta;
+            size[k] = 0;
+            cycle.append(k);
+        }
+        if(cycle.isEmpty()) return true;
+        if(nIter>=maxIter) return false;
+
+        QVector<int> started = cycle;
+
+        for(int j=0; j<m && !cycle.isEmpty() && nIter<maxIter; j++)
+        {
+            // the products by the preconditioned matrix of the last vectors of the bases
+            for(int a=0; a<cycle.size(); a++)
+                memcpy(Z.data()+a*n, V.constData()+(cycle.at(a)*(m+1)+j)*n, ulong(n)*sizeof(double));
+            precondition(Z.data(), cycle.size());
+            matVec(Z.constData(), W.data(), cycle.size());
+            if(pbCancel && pbCancel->loadAcquire()) return false;
+            nIter++;
+
+            QVector<int> next;
+            for(int a=0; a<cycle.size(); a++)
+            {
+                int k = cycle.at(a);
+                double *w = W.data() + a*n;
+                double *h = H.data() + (k*m+j)*(m+1);
+                double *gk = g.data() + k*(m+1);
+                double *c = cs.data() + k*m;
+                double *s = sn.data() + k*m;
+
+                // modified Gram-Schmidt orthogonalization
+                for(int i=0; i<=j; i++)
+                {
+                    double const *vi = V.constData() + (k*(m+1)+i)*n;
+                    double dot = 0.0;
+                    for(int l=0; l<n; l++) dot += w[l]*vi[l];
+                    h[i] = dot;
+                    for(int l=0; l<n; l++) w[l] -= dot*vi[l];
+                }
+                double hnorm = 0.0;
+                for(int l=0; l<n; l++) hnorm += w[l]*w[l];
+                hnorm = sqrt(hnorm);
+                h[j+1] = hnorm;
+                if(hnorm>0.0)
+                {
+                    double *vj = V.data() + (k*(m+1)+j+1)*n;
+                    for(int l=0; l<n; l++) vj[l] = w[l]/hnorm;
+                }
+
+                // the Givens rotations which reduce the Hessenberg matrix to triangular form
+                for(int i=0; i<j; i++)
+                {
+                    double tmp = c[i]*h[i] + s[i]*h[i+1];
+                    h[i+1]     = -s[i]*h[i] + c[i]*h[i+1];
+                    h[i]       = tmp;
+                }
+                double r = sqrt(h[j]*h[j] + h[j+1]*h[j+1]);
+                if(r>0.0)
+                {
+                    c[j] = h[j]/r;
+                    s[j] = h[j+1]/r;
+                }
+                else
+                {
+                    c[j] = 1.0;
+                    s[j] = 0.0;
+                }
+                h[j]   = r;
+                h[j+1] = 0.0;
+                gk[j+1] = -s[j]*gk[j];
+                gk[j]   =  c[j]*gk[j];
+
+                size[k] = j+1;
+                if(fabs(gk[j+1])>tolerance*bNorm.at(k) && hnorm>0.0) next.append(k);
+            }
+            cycle = next;
+        }
+
+        // the update of the solutions with the minimal residual vectors of the subspaces
+        for(int a=0; a<started.size(); a++)
+        {
+            int k = started.at(a);
+            int nk = size.at(k);
+            if(nk==0) continue;
+            for(int i=nk-1; i>=0; i--)
+            {
+                double sum = g.at(k*(m+1)+i);
+                for(int l=i+1; l<nk; l++) sum -= H.at((k*m+l)*(m+1)+i)*y.at(l);
+                y[i] = sum/H.at((k*m+i)*(m+1)+i);
+            }
+            double *u = Z.data();
+            memset(u, 0, ulong(n)*sizeof(double));
+            for(int i=0; i<nk; i++)
+            {
+                double const *vi = V.constData() + (k*(m+1)+i)*n;
+                for(int l=0; l<n; l++) u[l] += y.at(i)*vi[l];
+            }
+            precondition(u, 1);
+            for(int l=0; l<n; l++) X[k*n+l] += u[l];
+        }
+    }
+}
+
+
 /**
 * Returns the coefficients of the characteristic polynomial of a 4x4 matrix of double values. Thanks Mapple.
 * The polynom can then be solved for complex roots using Bairstow's algorithm
@@ -25,6 +25,8 @@
 
 #include <objects/objects3d/vector3d.h>
 #include <complex>
+#include <functional>
+#include <QAtomicInt>
 
 using namespace std;
 
@@ -47,11 +49,23 @@ complex<double> cofactor44(complex<double> *aij, int &i, int &j);
 bool XFLR5ENGINELIBSHARED_EXPORT Invert44(complex<double> *ain, complex<double> *aout);
 
 
-bool Gauss(double *A, int n, double *B, int m, bool *pbCancel);
+bool Gauss(double *A, int n, double *B, int m, QAtomicInt const *pbCancel);
 
 
-bool Crout_LU_Decomposition_with_Pivoting(double *A, int pivot[], int n, bool *pbCancel, double TaskSize, double &Progress);
-bool Crout_LU_with_Pivoting_Solve(double *LU, double B[], int pivot[], double x[], int n, bool *pbCancel);
+bool XFLR5ENGINELIBSHARED_EXPORT Crout_LU_Decomposition_with_Pivoting(double *A, int pivot[], int n, QAtomicInt const *pbCancel, double TaskSize, double &Progress);
+bool Crout_LU_Decomposition_with_Pivoting(float *A, int pivot[], int n, QAtomicInt const *pbCancel, double TaskSize, double &Progress);
+bool XFLR5ENGINELIBSHARED_EXPORT Crout_LU_Decomposition_with_Pivoting_Unblocked(double *A, int pivot[], int n, QAtomicInt const *pbCancel, double TaskSize, double &Progress);
+void LU_UpdateTrailingRows(double *A, int n, int k0, int k1, int i0, int i1);
+void LU_UpdateTrailingRows(float *A, int n, int k0, int k1, int i0, int i1);
+bool XFLR5ENGINELIBSHARED_EXPORT Crout_LU_with_Pivoting_Solve(double *LU, double B[], int pivot[], double x[], int n, QAtomicInt const *pbCancel);
+bool XFLR5ENGINELIBSHARED_EXPORT Crout_LU_with_Pivoting_Solve(double *LU, double *B, int pivot[], double *x, int n, int nRHS, QAtomicInt const *pbCancel);
+bool Crout_LU_with_Pivoting_Solve(float const *LU, double *B, int pivot[], double *x, int n, int nRHS, QAtomicInt const *pbCancel);
+void LU_SolveUpdateRows(double const *LU, double *x, int n, int nRHS, int i0, int i1, int j0, int j1);
+void LU_SolveUpdateRows(float const *LU, double *x, int n, int nRHS, int i0, int i1, int j0, int j1);
+bool GMRES_Solve(std::function<void(double const*, double*, int)> const &matVec,
+                 std::function<void(double*, int)> const &precondition,
+                 double const *B, double *X, int n, int nRHS, int restart, int maxIter, double tolerance,
+                 QAtomicInt const *pbCancel, int &nIter, double &maxResidual);
 
 
 void TestEigen();
@@ -23,6 +23,8 @@
 #include <math.h>
 #include <QtDebug>
 #include <QString>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
 
 
 #include "lltanalysis.h"
@@ -35,6 +37,7 @@ int LLTAnalysis::s_NLLTStations = 20;
 double LLTAnalysis::s_RelaxMax = 20.0;
 double LLTAnalysis::s_CvPrec = 0.01;
 bool LLTAnalysis::s_bInitCalc = true;
+bool LLTAnalysis::s_bMultiThread = false;
 
 
 /** The public constructor */
@@ -45,6 +48,7 @@ LLTAnalysis::LLTAnalysis()
     m_pX = m_pY = nullptr;
 
     m_poaPolar = nullptr;
+    m_pMaster = nullptr;
     resetVariables();
 }
 
@@ -55,10 +59,12 @@ LLTAnalysis::LLTAnalysis()
 void LLTAnalysis::resetVariables()
 {
     m_nPoints = 1;
+    m_Progress = 0.0;
     m_bSequence = false;
     m_vMin = m_vMax = m_vDelta = 0.0;
 
-    m_bCancel    = false;
+    m_bCancel.storeRelease(0);
+    m_bInitCalc  = s_bInitCalc;
     m_bConverged = false;
     m_bWingOut   = false;
     m_bError     = false;
@@ -189,9 +195,6 @@ double LLTAnalysis::Beta(int m, int k)
  */
 void LLTAnalysis::computeWing(double QInf, double Alpha, QString &ErrorMessage)
 {
-    Foil* pFoil0 = nullptr;
-    Foil* pFoil1 = nullptr;
-
     QString strange;
     double yob=0, tau=0, c4=0, arad=0, zpos=0;
 
@@ -221,7 +224,9 @@ void LLTAnalysis::computeWing(double QInf, double Alpha, QString &ErrorMessage)
         bPointOutRe    = false;
         bPointOutAlpha = false;
         yob   = cos(double(m)*PI/double(s_NLLTStations));
-        m_pWing->getFoils(&pFoil0, &pFoil1, yob*m_pWing->m_PlanformSpan/2.0, tau);
+        Foil const *pFoil0 = m_pFoil0[m];
+        Foil const *pFoil1 = m_pFoil1[m];
+        tau = m_Tau[m];
 
         m_Cl[m]     = getCl(pFoil0, pFoil1, m_Re[m], Alpha+m_Ai[m]+m_Twist[m], tau, bOutRe, bError);
         if(bOutRe) bPointOutRe = true;
@@ -401,11 +406,9 @@ bool LLTAnalysis::setLinearSolution(double Alpha)
     memset(aij.data(), 0, ulong(s_NLLTStations*s_NLLTStations)*sizeof(double));
     memset(rhs.data(), 0, ulong(s_NLLTStations+1)*sizeof(double));
 
-    Foil *pFoil0=nullptr, *pFoil1=nullptr;
-
     int size = s_NLLTStations-1;
     double dn  = double(s_NLLTStations);
-    double di=0, dj=0, t0=0, st0=0, snt0=0, ch=0, a0=0, slope=0, tau=0, yob=0, twist=0;
+    double di=0, dj=0, t0=0, st0=0, snt0=0, ch=0, a0=0, slope=0, yob=0, twist=0;
     double cs = m_pWing->rootChord();
     double b  = m_pWing->m_PlanformSpan;
 
@@ -428,13 +431,11 @@ bool LLTAnalysis::setLinearSolution(double Alpha)
             aij[p] = snt0 + ch*PI/b/2.0* dj*snt0/st0;
         }
 
-        m_pWing->getFoils(&pFoil0, &pFoil1, yob*b/2.0, tau);
-        a0 = getZeroLiftAngle(pFoil0, pFoil1, m_Re[i], tau);
+        a0 = getZeroLiftAngle(m_pFoil0[i], m_pFoil1[i], m_Re[i], m_Tau[i]);
         rhs[i] = ch/cs * (Alpha-a0+twist)/180.0*PI;
     }
 
-    bool bCancel = false;
-    if(!Gauss(aij.data(), s_NLLTStations-1, rhs.data()+1, 1, &bCancel))
+    if(!Gauss(aij.data(), s_NLLTStations-1, rhs.data()+1, 1, &m_bCancel))
     {
         return false;
     }
@@ -452,9 +453,8 @@ bool LLTAnalysis::setLinearSolution(double Alpha)
             snt0 = sin(dj*t0);
             m_Cl[i] += rhs[j]* snt0;
         }
-        m_pWing->getFoils(&pFoil0, &pFoil1, yob*b/2.0, tau);
-        getLinearizedPolar(pFoil0, pFoil1, m_Re[i], tau, a0, slope);
-        a0 = getZeroLiftAngle(pFoil0, pFoil1, m_Re[i], tau); //better approximation ?
+        getLinearizedPolar(m_pFoil0[i], m_pFoil1[i], m_Re[i], m_Tau[i], a0, slope);
+        a0 = getZeroLiftAngle(m_pFoil0[i], m_pFoil1[i], m_Re[i], m_Tau[i]); //better approximation ?
 
         m_Cl[i] *= slope*180.0/PI*cs/m_pWing->getChord(yob);
         m_Ai[i]  = -(Alpha-a0+m_pWing->getTwist(yob)) + m_Cl[i]/slope;
@@ -467,18 +467,38 @@ bool LLTAnalysis::setLinearSolution(double Alpha)
 }
 
 
-/** 
- * Calculates the induced angle from the lift coefficient and from the Beta factor
- * @param k
+/**
+ * Stores the lift coefficients multiplied by the chord and divided by the span, split by odd and even span stations,
+ * for the calculation of the induced angles. Beta(m,k) is zero if m+k is even and different from 2k,
+ * so that the induced angle at an even station only depends on the odd stations, and conversely.
+ */
+void LLTAnalysis::setCirculation()
+{
+    int nOdd  = s_NLLTStations/2;
+    int nEven = (s_NLLTStations-1)/2;
+    for (int j=0; j<nOdd; j++)  m_Circulation[0][j] = m_Cl[2*j+1] * m_Chord[2*j+1]/m_pWing->m_PlanformSpan;
+    for (int j=0; j<nEven; j++) m_Circulation[1][j] = m_Cl[2*j+2] * m_Chord[2*j+2]/m_pWing->m_PlanformSpan;
+}
+
+
+/**
+ * Calculates the induced angle from the lift coefficient and from the Beta factor.
+ * The Beta factors are read from the matrix built in initializeGeom(), and the lift coefficients
+ * from the circulation set by setCirculation().
+ * @param k the index of the span station
  * @return the induced angle, in degrees
  */
 double LLTAnalysis::AlphaInduced(int k)
 {
-    double ai = 0.0;
+    // the non-zero factors of row k are those of the stations of opposite parity
+    int n = (k%2==0) ? s_NLLTStations/2 : (s_NLLTStations-1)/2;
+    double const *beta = m_Beta.constData() + k*m_BetaStride;
+    double const *gamma = m_Circulation[k%2==0 ? 0 : 1];
 
-    for (int m=1; m<m_pWing->m_NStation; m++)
+    double ai = m_BetaDiag[k] * m_Cl[k] * m_Chord[k]/m_pWing->m_PlanformSpan;
+    for (int j=0; j<n; j++)
     {
-        ai += Beta(m,k) * m_Cl[m] * m_Chord[m]/m_pWing->m_PlanformSpan;
+        ai += beta[j] * gamma[j];
     }
     return ai;
 }
@@ -492,17 +512,16 @@ double LLTAnalysis::AlphaInduced(int k)
 */
 int LLTAnalysis::iterate(double &QInf, double Alpha)
 {
-    Foil* pFoil0  = nullptr;
-    Foil* pFoil1  = nullptr;
-    double  yob=0, tau=0, anext=0;
+    double anext=0;
     bool bOutRe=false, bError=false;
     int iter = 0;
 
     while(iter<s_IterLim)
     {
-        if(m_bCancel) return -1;
+        if(isCancelled()) return -1;
         m_Maxa = 0.0;
 
+        setCirculation();
         for (int k=1; k<s_NLLTStations; k++)
         {
             double a = m_Ai[k];
@@ -514,9 +533,7 @@ int LLTAnalysis::iterate(double &QInf, double Alpha)
         double Lift=0.0;// required for Type 2
         for (int k=1; k<s_NLLTStations; k++)
         {
-            yob     = cos(k*PI/s_NLLTStations);
-            m_pWing->getFoils(&pFoil0, &pFoil1, yob*m_pWing->m_PlanformSpan/2.0, tau);
-            m_Cl[k] = getCl( pFoil0, pFoil1, m_Re[k], Alpha + m_Ai[k]+ m_Twist[k], tau, bOutRe, bError);
+            m_Cl[k] = getCl(m_pFoil0[k], m_pFoil1[k], m_Re[k], Alpha + m_Ai[k]+ m_Twist[k], m_Tau[k], bOutRe, bError);
             if (m_pWPolar->polarType()==XFLR5::FIXEDLIFTPOLAR)
             {
                 Lift += Eta(k) * m_Cl[k] * m_Chord[k];
@@ -533,9 +550,7 @@ int LLTAnalysis::iterate(double &QInf, double Alpha)
             for (int k=1; k<s_NLLTStations; k++)
             {
                 m_Re[k] = m_Chord[k] * QInf /m_pWPolar->m_Viscosity;
-                yob     = cos(k*PI/s_NLLTStations);
-                m_pWing->getFoils(&pFoil0, &pFoil1, yob*m_pWing->m_PlanformSpan/2.0, tau);
-                m_Cl[k] = getCl(pFoil0, pFoil1, m_Re[k], Alpha + m_Ai[k]+ m_Twist[k], tau, bOutRe, bError);
+                m_Cl[k] = getCl(m_pFoil0[k], m_pFoil1[k], m_Re[k], Alpha + m_Ai[k]+ m_Twist[k], m_Tau[k], bOutRe, bError);
             }
         }
 
@@ -586,6 +601,27 @@ void LLTAnalysis::initializeGeom()
 
         m_StripArea[j] = m_Chord[j]*dy;//m2
     }
+
+    // the foils at the span stations do not change during the analysis
+    for (int k=1; k<s_NLLTStations; k++)
+    {
+        double yob = cos(double(k)*PI/double(s_NLLTStations));
+        m_pWing->getFoils(m_pFoil0+k, m_pFoil1+k, yob*m_pWing->m_PlanformSpan/2.0, m_Tau[k]);
+    }
+
+    // store the non-zero Beta factors, i.e. those such that m+k is odd, row by row
+    m_BetaStride = s_NLLTStations/2;
+    m_Beta.resize((s_NLLTStations+1)*m_BetaStride);
+    m_Beta.fill(0.0);
+    for (int k=1; k<s_NLLTStations; k++)
+    {
+        m_BetaDiag[k] = Beta(k,k);
+        double *beta = m_Beta.data() + k*m_BetaStride;
+        for (int m=(k%2==0) ? 1 : 2, j=0; m<s_NLLTStations; m+=2, j++)
+        {
+            beta[j] = Beta(m,k);
+        }
+    }
 }
 
 
@@ -606,14 +642,14 @@ bool LLTAnalysis::loop()
 * Launches a type 1 or 2 analysis.
 * Loops over the range of specified aoa.
 * For each successful aoa, stores the data in the WPolar and Operating Point objects.
+* In multithreaded mode, the range of aoa is distributed on the threads of the global pool.
 */
 bool LLTAnalysis::alphaLoop()
 {
     QString str;
 
-    Foil *pFoil0=nullptr, *pFoil1=nullptr;
-    bool bOutRe=false, bError=false;
-    double tau = 0.0;
+    int nBlocks = qMin(QThreadPool::globalInstance()->maxThreadCount(), (m_nPoints+1)/LLTMINBLOCKSIZE);
+    if(s_bMultiThread && nBlocks>1) return alphaLoopMultiThreaded(nBlocks);
 
     for (int i=0; i<=m_nPoints; i++)
     {
@@ -621,64 +657,208 @@ bool LLTAnalysis::alphaLoop()
         if(m_pY) m_pY->clear();
 
         double Alpha = m_vMin + double(i) * m_vDelta;
-        if(m_bCancel)
+        if(isCancelled())
         {
             str = "Analysis cancelled on user request....\n";
             traceLog(str);
             break;
         }
 
-        setVelocity(m_pWPolar->m_QInfSpec);
-        if(s_bInitCalc) setLinearSolution(Alpha);
+        addPlaneOpp(alphaPoint(Alpha, m_bInitCalc));
+        m_Progress = double(i+1);
+        qApp->processEvents();
+    }
 
-        //initialize first iteration
-        for (int k=1; k<s_NLLTStations; k++)
-        {
-            double yob   = cos(double(k)*PI/double(s_NLLTStations));
-            m_pWing->getFoils(&pFoil0, &pFoil1, yob*m_pWing->m_PlanformSpan/2.0, tau);
-            m_Cl[k] = getCl(pFoil0, pFoil1, m_Re[k], Alpha + m_Ai[k] + m_Twist[k], tau, bOutRe, bError);
-        }
+    return true;
+}
 
 
-        str= QString("Calculating Alpha = %1... ").arg(Alpha,5,'f',2);
-        traceLog(str);
+/**
+* Launches a type 1 or 2 analysis on the threads of the global pool.
+* The range of aoa is split in contiguous blocks, each analyzed by a worker holding a private copy
+* of the analysis data. In each block, the points are calculated in sequence and each point starts
+* from the induced angles of the previous converged point, i.e. its closest converged neighbour.
+* Once all the blocks have been calculated, the operating points are added to the polar in the order of the sequence.
+*@param nBlocks the number of blocks in which the range of aoa is split
+*/
+bool LLTAnalysis::alphaLoopMultiThreaded(int nBlocks)
+{
+    int nPoints = m_nPoints+1;
 
-        int iter = iterate(m_pWPolar->m_QInfSpec, Alpha);
+    QVector<LLTAnalysis*> workers(nBlocks);
+    QVector<int> blocks(nBlocks);
+    QVector<int> initCalc(nBlocks);
+    for(int ib=0; ib<nBlocks; ib++)
+    {
+        workers[ib] = new LLTAnalysis;
+        workers[ib]->initializeWorker(this);
+        blocks[ib] = ib;
+        // only the first block may continue from the last calculated point
+        initCalc[ib] = (ib==0) ? m_bInitCalc : true;
+    }
 
-        if (iter==-1 && !m_bCancel)
-        {
-            str= QString("    ...negative Lift... Aborting\n");
-            m_bError = true;
-            s_bInitCalc = true;
-            traceLog(str);
-        }
-        else if (iter<s_IterLim && !m_bCancel)
-        {
-            //converged,
-            str= QString("    ...converged after %1 iterations\n").arg(iter);
-            traceLog(str);
-            computeWing(m_pWPolar->m_QInfSpec, Alpha, str);// generates wing results,
-            traceLog(str);
-            if (m_bWingOut) m_bWarning = true;
-            PlaneOpp *pPOpp = createPlaneOpp(m_pWPolar->m_QInfSpec, Alpha, m_bWingOut);// Adds WOpp point and adds result to polar
-            if(pPOpp) m_PlaneOppList.append(pPOpp);
-            s_bInitCalc = false;
-        }
-        else
-        {
-            if (m_bWingOut) m_bWarning = true;
-            m_bError = true;
-            str= QString("    ...unconverged after %1 iterations out of %2\n").arg(iter).arg(s_IterLim);
-            traceLog(str);
-            s_bInitCalc = true;
-        }
-        qApp->processEvents();
+    traceLog(QString("Distributing %1 points on %2 threads\n").arg(nPoints).arg(nBlocks));
+
+    int *pInitCalc = initCalc.data();
+    QtConcurrent::blockingMap(blocks, [workers, pInitCalc, nPoints, nBlocks](int const &ib)
+    {
+        int i0 = (ib*nPoints)/nBlocks;
+        int i1 = ((ib+1)*nPoints)/nBlocks;
+        pInitCalc[ib] = workers.at(ib)->alphaBlock(i0, i1, pInitCalc[ib]);
+    });
+
+    // merge the results in the order of the sequence
+    for(int ib=0; ib<nBlocks; ib++)
+    {
+        LLTAnalysis *pWorker = workers.at(ib);
+        traceLog(pWorker->m_Log);
+        for(int ip=0; ip<pWorker->m_PlaneOppList.size(); ip++)
+            addPlaneOpp(pWorker->m_PlaneOppList.at(ip));
+        pWorker->m_PlaneOppList.clear();
+
+        m_bError   = m_bError   || pWorker->m_bError;
+        m_bWarning = m_bWarning || pWorker->m_bWarning;
     }
 
+    // leave the state of the last point, so that the next analysis may continue from it
+    LLTAnalysis const *pLast = workers.last();
+    memcpy(m_Ai, pLast->m_Ai, sizeof(m_Ai));
+    memcpy(m_Cl, pLast->m_Cl, sizeof(m_Cl));
+    memcpy(m_Re, pLast->m_Re, sizeof(m_Re));
+    m_bInitCalc = initCalc.last();
+    m_Progress = double(nPoints);
+
+    for(int ib=0; ib<nBlocks; ib++) delete workers.at(ib);
+
+    if(isCancelled()) traceLog("Analysis cancelled on user request....\n");
+
     return true;
 }
 
 
+/**
+* Analyzes in sequence the points i0 to i1-1 of the range of aoa.
+* The operating points are stored in the array of PlaneOpp objects, and are not added to the polar.
+*@param i0 the index of the first point
+*@param i1 the index of the point past the last point of the block
+*@param bInitCalc true if the first point should start from the linear solution
+*@return true if the point following the block should start from the linear solution
+*/
+bool LLTAnalysis::alphaBlock(int i0, int i1, bool bInitCalc)
+{
+    for (int i=i0; i<i1; i++)
+    {
+        if(isCancelled()) break;
+        PlaneOpp *pPOpp = alphaPoint(m_vMin + double(i) * m_vDelta, bInitCalc);
+        if(pPOpp) m_PlaneOppList.append(pPOpp);
+    }
+    return bInitCalc;
+}
+
+
+/**
+* Analyzes one aoa of a type 1 or 2 polar.
+*@param Alpha the angle of attack, in degrees
+*@param bInitCalc true if the iterations should start from the linear solution, false if they should start
+* from the current induced angles; on output, true if the next point should start from the linear solution
+*@return a pointer to the new operating point, or nullptr if the point has not converged
+*/
+PlaneOpp *LLTAnalysis::alphaPoint(double Alpha, bool &bInitCalc)
+{
+    QString str;
+    bool bOutRe=false, bError=false;
+    PlaneOpp *pPOpp = nullptr;
+
+    setVelocity(m_pWPolar->m_QInfSpec);
+    if(bInitCalc) setLinearSolution(Alpha);
+
+    //initialize first iteration
+    for (int k=1; k<s_NLLTStations; k++)
+    {
+        m_Cl[k] = getCl(m_pFoil0[k], m_pFoil1[k], m_Re[k], Alpha + m_Ai[k] + m_Twist[k], m_Tau[k], bOutRe, bError);
+    }
+
+
+    str= QString("Calculating Alpha = %1... ").arg(Alpha,5,'f',2);
+    traceLog(str);
+
+    int iter = iterate(m_pWPolar->m_QInfSpec, Alpha);
+
+    if (iter==-1 && !isCancelled())
+    {
+        str= QString("    ...negative Lift... Aborting\n");
+        m_bError = true;
+        bInitCalc = true;
+        traceLog(str);
+    }
+    else if (iter<s_IterLim && !isCancelled())
+    {
+        //converged,
+        str= QString("    ...converged after %1 iterations\n").arg(iter);
+        traceLog(str);
+        computeWing(m_pWPolar->m_QInfSpec, Alpha, str);// generates wing results,
+        traceLog(str);
+        if (m_bWingOut) m_bWarning = true;
+        pPOpp = createPlaneOpp(m_pWPolar->m_QInfSpec, Alpha, m_bWingOut);
+        bInitCalc = false;
+    }
+    else
+    {
+        if (m_bWingOut) m_bWarning = true;
+        m_bError = true;
+        str= QString("    ...unconverged after %1 iterations out of %2\n").arg(iter).arg(s_IterLim);
+        traceLog(str);
+        bInitCalc = true;
+    }
+    return pPOpp;
+}
+
+
+/**
+* Prepares a worker of a multithreaded analysis.
+* The geometric data and the polar mesh are copied from the master, so that the worker
+* does not modify the wing and can be run concurrently with the other workers.
+* The induced angles and lift coefficients are copied as well, so that the worker's first point
+* may continue from the master's current state.
+*@param pMaster a pointer to the analysis which launches the worker, and which has been initialized
+*/
+void LLTAnalysis::initializeWorker(LLTAnalysis const *pMaster)
+{
+    m_pMaster    = pMaster;
+    m_pPlane     = pMaster->m_pPlane;
+    m_pWing      = pMaster->m_pWing;
+    m_pWPolar    = pMaster->m_pWPolar;
+    m_poaPolar   = pMaster->m_poaPolar;
+    m_PolarMesh  = pMaster->m_PolarMesh;
+
+    m_vMin       = pMaster->m_vMin;
+    m_vMax       = pMaster->m_vMax;
+    m_vDelta     = pMaster->m_vDelta;
+    m_nPoints    = pMaster->m_nPoints;
+    m_bSequence  = pMaster->m_bSequence;
+
+    m_QInf0      = pMaster->m_QInf0;
+    m_LengthUnit = pMaster->m_LengthUnit;
+    m_mtoUnit    = pMaster->m_mtoUnit;
+
+    memcpy(m_Chord,     pMaster->m_Chord,     sizeof(m_Chord));
+    memcpy(m_Offset,    pMaster->m_Offset,    sizeof(m_Offset));
+    memcpy(m_Twist,     pMaster->m_Twist,     sizeof(m_Twist));
+    memcpy(m_SpanPos,   pMaster->m_SpanPos,   sizeof(m_SpanPos));
+    memcpy(m_StripArea, pMaster->m_StripArea, sizeof(m_StripArea));
+    memcpy(m_Re,        pMaster->m_Re,        sizeof(m_Re));
+    memcpy(m_Cl,        pMaster->m_Cl,        sizeof(m_Cl));
+    memcpy(m_Ai,        pMaster->m_Ai,        sizeof(m_Ai));
+
+    memcpy(m_pFoil0,    pMaster->m_pFoil0,    sizeof(m_pFoil0));
+    memcpy(m_pFoil1,    pMaster->m_pFoil1,    sizeof(m_pFoil1));
+    memcpy(m_Tau,       pMaster->m_Tau,       sizeof(m_Tau));
+    memcpy(m_BetaDiag,  pMaster->m_BetaDiag,  sizeof(m_BetaDiag));
+    m_Beta       = pMaster->m_Beta;
+    m_BetaStride = pMaster->m_BetaStride;
+}
+
+
 
 /**
 * Launches a type 4 analysis.
@@ -688,8 +868,6 @@ bool LLTAnalysis::alphaLoop()
 bool LLTAnalysis::QInfLoop()
 {
     QString str;
-    double tau=0.0;
-    Foil *pFoil0=nullptr, *pFoil1=nullptr;
     bool bOutRe=false, bError=false;
 
     str = "Initializing analysis...\n";
@@ -701,7 +879,7 @@ bool LLTAnalysis::QInfLoop()
     for (int i=0; i<=m_nPoints; i++)
     {
         QInf = m_vMin + double(i) * m_vDelta;
-        if(m_bCancel)
+        if(isCancelled())
         {
             str = "Analysis cancelled on user request....\n";
             traceLog(str);
@@ -709,14 +887,12 @@ bool LLTAnalysis::QInfLoop()
         }
 
         setVelocity(QInf);
-        if(s_bInitCalc) setLinearSolution(m_pWPolar->m_AlphaSpec);
+        if(m_bInitCalc) setLinearSolution(m_pWPolar->m_AlphaSpec);
 
         //initialize first iteration
         for (int k=1; k<s_NLLTStations; k++)
         {
-            double yob   = cos(k*PI/s_NLLTStations);
-            m_pWing->getFoils(&pFoil0, &pFoil1, yob*m_pWing->m_PlanformSpan/2.0, tau);
-            m_Cl[k] = getCl(pFoil0, pFoil1, m_Re[k], Alpha + m_Ai[k] + m_Twist[k], tau, bOutRe, bError);
+            m_Cl[k] = getCl(m_pFoil0[k], m_pFoil1[k], m_Re[k], Alpha + m_Ai[k] + m_Twist[k], m_Tau[k], bOutRe, bError);
         }
 
         str = QString("Calculating QInf = %1... ").arg(QInf,6,'f',2);
@@ -730,9 +906,9 @@ bool LLTAnalysis::QInfLoop()
             m_bWarning = true;
             str = QString("\n");
             traceLog(str);
-            s_bInitCalc = true;
+            m_bInitCalc = true;
         }
-        else if (iter<s_IterLim  && !m_bCancel)
+        else if (iter<s_IterLim  && !isCancelled())
         {
             //converged,
             str = QString("    ...converged after %1 iterations\n").arg(iter);
@@ -740,15 +916,14 @@ bool LLTAnalysis::QInfLoop()
             computeWing(QInf, m_pWPolar->m_AlphaSpec,str);// generates wing results,
             traceLog(str);
             if (m_bWingOut) m_bWarning = true;
-            PlaneOpp *pPOpp = createPlaneOpp(QInf, m_pWPolar->m_AlphaSpec, m_bWingOut);// Adds WOpp point and adds result to polar
-            if(pPOpp) m_PlaneOppList.append(pPOpp);
+            addPlaneOpp(createPlaneOpp(QInf, m_pWPolar->m_AlphaSpec, m_bWingOut));// Adds WOpp point and adds result to polar
 
             /*            if(m_bWingOut)
             {
                 str = QString("\n");
                 traceLog(str);
             }*/
-            s_bInitCalc = false;
+            m_bInitCalc = false;
         }
         else
         {
@@ -756,8 +931,9 @@ bool LLTAnalysis::QInfLoop()
             m_bError = true;
             str = QString("    ...unconverged after %1 iterations\n").arg(iter);
             traceLog(str);
-            s_bInitCalc = true;
+            m_bInitCalc = true;
         }
+        m_Progress = double(i+1);
         qApp->processEvents();
 
         if(m_pX) m_pX->clear();
@@ -797,6 +973,8 @@ void LLTAnalysis::setLLTData(Plane *pPlane, WPolar *pWPolar)
 void LLTAnalysis::initializeAnalysis()
 {
     m_bWarning = m_bError = false;
+    m_bInitCalc = s_bInitCalc;
+    m_Progress = 0.0;
     m_PlaneOppList.clear();
 
     traceLog("\nLaunching the LLT Analysis....\n");
@@ -813,6 +991,7 @@ void LLTAnalysis::initializeAnalysis()
 
     qApp->processEvents(); */
     initializeGeom();
+    m_PolarMesh.build(m_poaPolar);
     qApp->processEvents();
 }
 
@@ -821,6 +1000,12 @@ void LLTAnalysis::initializeAnalysis()
 /** emits the analysis messages to the world */
 void LLTAnalysis::traceLog(QString str)
 {
+    // the workers do not run in the master's thread, so store the messages until the master has merged the results
+    if(m_pMaster)
+    {
+        m_Log += str;
+        return;
+    }
     emit(outputMsg(str));
     qApp->processEvents();
 }
@@ -921,11 +1106,24 @@ PlaneOpp* LLTAnalysis::createPlaneOpp(double QInf, double Alpha, bool bWingOut)
         }
     }
 
+    return pNewPOpp;
+}
+
+
+/**
+* Adds the operating point to the polar object and to the array of PlaneOpp objects.
+* In multithreaded mode, this is done by the master only, in the order of the sequence.
+*@param pPOpp a pointer to the operating point; nothing is done if the pointer is null
+*/
+void LLTAnalysis::addPlaneOpp(PlaneOpp *pPOpp)
+{
+    if(!pPOpp) return;
+
     //add the data to the polar object
-    if(PlaneOpp::s_bKeepOutOpps || !pNewPOpp->m_bOut)
-        m_pWPolar->addPlaneOpPoint(pNewPOpp);
+    if(PlaneOpp::s_bKeepOutOpps || !pPOpp->m_bOut)
+        m_pWPolar->addPlaneOpPoint(pPOpp);
 
-    return pNewPOpp;
+    m_PlaneOppList.append(pPOpp);
 }
 
 
@@ -955,14 +1153,14 @@ void LLTAnalysis::clearPOppList()
 
 void LLTAnalysis::onCancel()
 {
-    m_bCancel = true;
+    m_bCancel.storeRelease(1);
     traceLog("Cancelling the LLT analysis\n");
 }
 
 
 bool LLTAnalysis::isCancelled() const
 {
-    return m_bCancel;
+    return m_bCancel.loadAcquire() || (m_pMaster && m_pMaster->m_bCancel.loadAcquire());
 }
 
 bool LLTAnalysis::hasWarnings() const
@@ -1255,96 +1453,8 @@ double LLTAnalysis::getZeroLiftAngle(const Foil *pFoil0, const Foil *pFoil1, dou
 {
     //returns the 0-lift angle of the foil, at Reynolds=Re
     //if the polar doesn't reach to 0-lift, returns Alpha0 = 0;
-    double a01=0, a02=0;
-    double Alpha00=0, Alpha01=0;
-
-    //Find the two polars which enclose Reynolds
-    int size = 0;
-    Polar *pPolar1=nullptr, *pPolar2=nullptr;
-
-    if(!pFoil0) Alpha00 = 0.0;
-    else
-    {
-        pPolar1 = nullptr;
-        pPolar2 = nullptr;
-        for (int i=0; i<m_poaPolar->size(); i++)
-        {
-            Polar *pPolar = m_poaPolar->at(i);
-            if(pPolar->foilName() == pFoil0->foilName()) size++;
-        }
-        if(size)
-        {
-            for (int i=0; i<m_poaPolar->size(); i++)
-            {
-                Polar *pOldPolar = m_poaPolar->at(i);
-                if(pOldPolar->foilName().compare(pFoil0->foilName())==0)
-                {
-                    if(pOldPolar->m_Reynolds < Re) pPolar1=pOldPolar;
-                }
-            }
-            for (int i=0; i<m_poaPolar->size(); i++)
-            {
-                Polar *pOldPolar = m_poaPolar->at(i);
-                if(pOldPolar->foilName() == pFoil0->foilName())
-                {
-                    if(pOldPolar->m_Reynolds > Re)
-                    {
-                        pPolar2 = pOldPolar;
-                        break;
-                    }
-                }
-            }
-        }
-        if(pPolar1 && pPolar2)
-        {
-            a01 = pPolar1->getZeroLiftAngle();
-            a02 = pPolar2->getZeroLiftAngle();
-            Alpha00 = a01 + (a02-a01) * (Re-pPolar1->Reynolds())/(pPolar2->Reynolds()-pPolar1->Reynolds());
-        }
-        else Alpha00 = 0.0;
-    }
-
-    if(!pFoil1) Alpha01 = 0.0;
-    else
-    {
-        pPolar1 = nullptr;
-        pPolar2 = nullptr;
-        for (int i=0; i<m_poaPolar->size(); i++)
-        {
-            Polar *pPolar = m_poaPolar->at(i);
-            if(pPolar->foilName() == pFoil1->foilName()) size++;
-        }
-        if(size)
-        {
-            for (int i=0; i<m_poaPolar->size(); i++)
-            {
-                Polar *pPolar = m_poaPolar->at(i);
-                if(pPolar->foilName() == pFoil1->foilName())
-                {
-                    if(pPolar->Reynolds() < Re) pPolar1 = pPolar;
-                }
-            }
-            for (int i=0; i<m_poaPolar->size(); i++)
-            {
-                Polar *pPolar = m_poaPolar->at(i);
-                if(pPolar->foilName() == pFoil1->foilName())
-                {
-                    if(pPolar->Reynolds() > Re)
-                    {
-                        pPolar2 = pPolar;
-                        break;
-                    }
-                }
-            }
-        }
-        if(pPolar1 && pPolar2)
-        {
-            a01 = pPolar1->getZeroLiftAngle();
-            a02 = pPolar2->getZeroLiftAngle();
-            Alpha01 = a01 + (a02-a01) * (Re-pPolar1->Reynolds())/(pPolar2->Reynolds()-pPolar1->Reynolds());
-        }
-        else Alpha01 = 0.0;
-    }
+    double Alpha00 = m_PolarMesh.getZeroLiftAngle(pFoil0, Re);
+    double Alpha01 = m_PolarMesh.getZeroLiftAngle(pFoil1, Re);
 
     return ((1-Tau) * Alpha00 + Tau * Alpha01);
 }
@@ -1364,235 +1474,7 @@ double LLTAnalysis::getZeroLiftAngle(const Foil *pFoil0, const Foil *pFoil1, dou
 */
 double LLTAnalysis::getPlrPointFromAlpha(Foil const*pFoil, double Re, double Alpha, int PlrVar, bool &bOutRe, bool &bError)
 {
-    double amin=0, amax=0;
-    double Var1=0, Var2=0, u=0;
-
-    Polar *pPolar=nullptr;
-
-    bOutRe = false;
-    bError = false;
-
-    if(!pFoil)
-    {
-        bOutRe = true;
-        bError = true;
-        return 0.000;
-    }
-
-
-    int size = 0;
-    int n = 0;
-
-    // Are there any Type 1 polars available for this foil ?
-    for (int i=0; i<m_poaPolar->size(); i++)
-    {
-        pPolar = m_poaPolar->at(i);
-        if((pPolar->polarType()==XFLR5::FIXEDSPEEDPOLAR) && (pPolar->foilName() == pFoil->foilName()))
-        {
-            n++;
-            if(n>=2) break;
-        }
-    }
-
-    //more than one polar - interpolate between  - tough job
-
-    //First Find the two polars with Reynolds number surrounding wanted Re
-    Polar * pPolar1 = nullptr;
-    Polar * pPolar2 = nullptr;
-    int nPolars = m_poaPolar->size();
-    //Type 1 Polars are sorted by crescending Re Number
-
-    //if Re is less than that of the first polar, use this one
-    for (int i=0; i<nPolars; i++)
-    {
-        pPolar = m_poaPolar->at(i);
-        if(pPolar->isFixedSpeedPolar() && (pPolar->foilName()==pFoil->foilName()) && pPolar->m_Alpha.size()>0)
-        {
-            // we have found the first type 1 polar for this foil
-            if (Re < pPolar->Reynolds())
-            {
-                bOutRe = true;
-                //interpolate Alpha on this polar
-                QVector<double> const &pX = pPolar->getPlrVariable(PlrVar);
-                size = pPolar->m_Alpha.size();
-                if(Alpha<pPolar->m_Alpha.front())
-                {
-                    return pX.front();
-                }
-                else if(Alpha > pPolar->m_Alpha.back())
-                {
-                    return pX.back();
-                }
-                for (int i=0; i<size-1; i++)
-                {
-                    if(pPolar->m_Alpha.at(i) <= Alpha && Alpha < pPolar->m_Alpha.at(i+1))
-                    {
-                        //interpolate
-                        if(pPolar->m_Alpha.at(i+1)-pPolar->m_Alpha.at(i)<0.00001)//do not divide by zero
-                            return pX.at(i);
-                        else
-                        {
-                            u = (Alpha - pPolar->m_Alpha.at(i))
-                                    /(pPolar->m_Alpha.at(i+1)-pPolar->m_Alpha.at(i));
-                            return pX.at(i) + u * (pX.at(i+1)-pX.at(i));
-                        }
-                    }
-                }
-                break;
-            }
-            break;
-        }
-    }
-
-    // if not Find the two polars
-    for (int i=0; i<nPolars; i++)
-    {
-        pPolar = m_poaPolar->at(i);
-        if(pPolar->isFixedSpeedPolar() && (pPolar->foilName() == pFoil->foilName()) && pPolar->m_Alpha.size()>0)
-        {
-            // we have found the first type 1 polar for this foil
-            pPolar->getAlphaLimits(amin, amax);
-            if (pPolar->Reynolds() <= Re)
-            {
-                if(amin<=Alpha && Alpha<=amax)
-                {
-                    pPolar1 = pPolar;
-                }
-            }
-            else {
-                if(amin<=Alpha && Alpha<=amax)
-                {
-                    pPolar2 = pPolar;
-                    break;
-                }
-            }
-        }
-    }
-
-    if (!pPolar2)
-    {
-        //then Re is greater than that of any polar
-        // so use last polar and interpolate alphas on this polar
-        bOutRe = true;
-        if(!pPolar1)
-        {
-            bError = true;
-            return 0.000;
-        }
-        size = pPolar1->m_Alpha.size();
-        if(!size)
-        {
-            bError = true;
-            return 0.000;
-        }
-
-        QVector<double> const &pX1 = pPolar1->getPlrVariable(PlrVar);
-        if (Alpha < pPolar1->m_Alpha.front())  return pX1.front();
-        if (Alpha > pPolar1->m_Alpha.back())   return pX1.back();
-        for (int i=0; i<size-1; i++)
-        {
-            if(pPolar1->m_Alpha.at(i)<=Alpha && Alpha<pPolar1->m_Alpha.at(i+1))
-            {
-                //interpolate
-                if(pPolar1->m_Alpha.at(i+1)-pPolar1->m_Alpha.at(i) < 0.00001){//do not divide by zero
-                    return pX1.at(i);
-                }
-                else
-                {
-                    u = (Alpha - pPolar1->m_Alpha.at(i))  /(pPolar1->m_Alpha.at(i+1)-pPolar1->m_Alpha.at(i));
-                    return pX1.at(i) + u * (pX1.at(i+1)-pX1.at(i));
-                }
-            }
-        }
-        //Out in Re, out in alpha...
-        return pX1.back();
-    }
-    else
-    {
-        // Re is between that of polars 1 and 2
-        // so interpolate alphas for each
-
-        if(!pPolar1)
-        {
-            bOutRe = true;
-            bError = true;
-            return 0.000;
-        }
-        size = pPolar1->m_Alpha.size();
-        if(!size)
-        {
-            bOutRe = true;
-            bError = true;
-            return 0.000;
-        }
-
-        QVector<double> const &pX1 = pPolar1->getPlrVariable(PlrVar);
-        if(Alpha < pPolar1->m_Alpha.front())     Var1 = pX1.front();
-        else if(Alpha > pPolar1->m_Alpha.back()) Var1 = pX1.back();
-        else
-        {
-            for (int i=0; i<size-1; i++)
-            {
-                if(pPolar1->m_Alpha.at(i) <= Alpha && Alpha < pPolar1->m_Alpha.at(i+1)){
-                    //interpolate
-                    if(pPolar1->m_Alpha.at(i+1)-pPolar1->m_Alpha.at(i) < 0.00001)//do not divide by zero
-                        Var1 = pX1.at(i);
-                    else
-                    {
-                        u = (Alpha - pPolar1->m_Alpha.at(i)) / (pPolar1->m_Alpha.at(i+1)-pPolar1->m_Alpha.at(i));
-                        Var1 = pX1.at(i) + u * (pX1.at(i+1)-pX1.at(i));
-                    }
-                }
-            }
-        }
-
-        size = pPolar2->m_Alpha.size();
-        if(!size)
-        {
-            bOutRe = true;
-            bError = true;
-            return 0.000;
-        }
-        QVector<double> const &pX2 = pPolar2->getPlrVariable(PlrVar);
-        if(Alpha < pPolar2->m_Alpha.front())
-        {
-            bOutRe = true;
-            bError = true;
-            Var2 = pX2.front();
-        }
-        else if(Alpha > pPolar2->m_Alpha.back())
-        {
-            bOutRe = true;
-            bError = true;
-            Var2 = pX2.back();
-        }
-        else{
-            for (int i=0; i<size-1; i++)
-            {
-                if(pPolar2->m_Alpha.at(i)<=Alpha && Alpha<pPolar2->m_Alpha.at(i+1))
-                {
-                    //interpolate
-                    QVector<double> const &pX2 = pPolar2->getPlrVariable(PlrVar);
-                    if(pPolar2->m_Alpha.at(i+1)-pPolar2->m_Alpha.at(i) < 0.00001)//do not divide by zero
-                        Var2 =pX2.at(i);
-                    else
-                    {
-                        u = (Alpha - pPolar2->m_Alpha.at(i)) /(pPolar2->m_Alpha.at(i+1)-pPolar2->m_Alpha.at(i));
-                        Var2 = pX2.at(i) + u * (pX2.at(i+1)-pX2.at(i));
-                    }
-                }
-            }
-        }
-        // then interpolate Variable
-
-        double v = (Re - pPolar1->Reynolds()) / (pPolar2->Reynolds() - pPolar1->Reynolds());
-        double Var = Var1 + v * (Var2-Var1);
-        return Var;
-    }
-
-    //    bOutRe = true;
-    //    bError = true;
-    //    return 0.000;// we missed something somewhere...
+    return m_PolarMesh.getPlrPointFromAlpha(pFoil, Re, Alpha, PlrVar, bOutRe, bError);
 }
 
 
@@ -1609,115 +1491,9 @@ void LLTAnalysis::getLinearizedPolar(Foil *pFoil0, Foil *pFoil1, double Re, doub
 {
     double Alpha00=0, Alpha01=0;
     double Slope0=0, Slope1=0;
-    double AlphaTemp1=0, AlphaTemp2=0, SlopeTemp1=0, SlopeTemp2=0;
-
-    //Find the two polars which enclose the Reynolds number
-    int size = 0;
-    Polar *pPolar=nullptr, *pPolar1=nullptr, *pPolar2=nullptr;
 
-    if(!pFoil0)
-    {
-        Alpha00 = 0.0;
-        Slope0 = 2.0 * PI *PI/180.0;
-    }
-    else
-    {
-        pPolar1 = nullptr;
-        pPolar2 = nullptr;
-        for (int i=0; i<m_poaPolar->size(); i++)
-        {
-            pPolar = m_poaPolar->at(i);
-            if(pPolar->foilName() == pFoil0->foilName()) size++;
-        }
-        if(size)
-        {
-            for (int i=0; i<m_poaPolar->size(); i++)
-            {
-                pPolar = m_poaPolar->at(i);
-                if(pPolar->foilName() == pFoil0->foilName())
-                {
-                    if(pPolar->Reynolds() < Re) pPolar1 = pPolar;
-                }
-            }
-            for (int i=0; i<m_poaPolar->size(); i++)
-            {
-                pPolar = m_poaPolar->at(i);
-                if(pPolar->foilName() == pFoil0->foilName())
-                {
-                    if(pPolar->Reynolds() > Re)
-                    {
-                        pPolar2 = pPolar;
-                        break;
-                    }
-                }
-            }
-        }
-        if(pPolar1 && pPolar2)
-        {
-            pPolar1->getLinearizedCl(AlphaTemp1, SlopeTemp1);
-            pPolar2->getLinearizedCl(AlphaTemp2, SlopeTemp2);
-            Alpha00 = AlphaTemp1 +
-                    (AlphaTemp2-AlphaTemp1) * (Re-pPolar1->Reynolds())/(pPolar2->Reynolds()-pPolar1->Reynolds());
-            Slope0  = SlopeTemp1 +
-                    (SlopeTemp2-SlopeTemp1) * (Re-pPolar1->Reynolds())/(pPolar2->Reynolds()-pPolar1->Reynolds());
-        }
-        else
-        {
-            Alpha00 = 0.0;
-            Slope0  = 2.0 * PI *PI/180.0;
-        }
-    }
-
-    if(!pFoil1)
-    {
-        Alpha01 = 0.0;
-        Slope1 = 2.0*PI *PI/180.0;
-    }
-    else
-    {
-        pPolar1 = nullptr;
-        pPolar2 = nullptr;
-        for (int i=0; i<m_poaPolar->size(); i++)
-        {
-            pPolar = m_poaPolar->at(i);
-            if(pPolar->foilName() == pFoil1->foilName()) size++;
-        }
-        if(size)
-        {
-            for (int i=0; i<m_poaPolar->size(); i++)
-            {
-                pPolar = m_poaPolar->at(i);
-                if(pPolar->foilName() == pFoil1->foilName())
-                {
-                    if(pPolar->Reynolds() < Re) pPolar1 = pPolar;
-                }
-            }
-            for (int i=0; i<m_poaPolar->size(); i++)
-            {
-                pPolar = m_poaPolar->at(i);
-                if(pPolar->foilName() == pFoil1->foilName())
-                {
-                    if(pPolar->Reynolds() > Re)
-                    {
-                        pPolar2 = pPolar;
-                        break;
-                    }
-                }
-            }
-        }
-        if(pPolar1 && pPolar2)
-        {
-            pPolar1->getLinearizedCl(AlphaTemp1, SlopeTemp1);
-            pPolar2->getLinearizedCl(AlphaTemp2, SlopeTemp2);
-            Alpha01 = AlphaTemp1 + (AlphaTemp2-AlphaTemp1) * (Re-pPolar1->Reynolds())/(pPolar2->Reynolds()-pPolar1->Reynolds());
-            Slope1  = SlopeTemp1 + (SlopeTemp2-SlopeTemp1) * (Re-pPolar1->Reynolds())/(pPolar2->Reynolds()-pPolar1->Reynolds());
-        }
-        else
-        {
-            Alpha01 = 0.0;
-            Slope1 = 2.0*PI *PI/180.0;
-        }
-    }
+    m_PolarMesh.getLinearizedPolar(pFoil0, Re, Alpha00, Slope0);
+    m_PolarMesh.getLinearizedPolar(pFoil1, Re, Alpha01, Slope1);
 
     Alpha0 = ((1-Tau) * Alpha00 + Tau * Alpha01);
     Slope  = ((1-Tau) * Slope0  + Tau * Slope1);
@@ -36,8 +36,12 @@
 
 #include <analysis3d/analysis3d_params.h>
 #include <analysis3d/analysis3d_globals.h>
+#include <objects/objects2d/polarmesh.h>
 
 #include <QVector>
+#include <QAtomicInt>
+
+#define LLTMINBLOCKSIZE 8   /**< the minimal number of aoa points analyzed by each thread in multithreaded mode */
 
 /**
  *@class LLTAnalysis
@@ -62,6 +66,7 @@ class XFLR5ENGINELIBSHARED_EXPORT LLTAnalysis : QObject
     friend class PlaneAnalysisTask;
     friend class MainFrame;
     friend class LLTAnalysisDlg;
+    friend class PlaneBatchDlg;
     friend class XflScriptExec;
 
 public:
@@ -81,20 +86,24 @@ public:
 
     bool isCancelled() const;
     bool hasWarnings() const;
+    double progress() const {return m_Progress/double(m_nPoints+1);}
 
     static void setMaxIter(int maxIter){s_IterLim = maxIter;}
     static void setConvergencePrecision(double precision) {s_CvPrec = precision;}
     static void setNSpanStations(int nStations){s_NLLTStations=nStations;}
     static void setRelaxationFactor(double relax){s_RelaxMax = relax;}
+    static void setMultiThreaded(bool bMultiThread) {s_bMultiThread = bMultiThread;}
 
     static int maxIter(){return s_IterLim;}
     static double convergencePrecision() {return s_CvPrec;}
     static int nSpanStations(){return s_NLLTStations;}
     static double relaxationFactor(){return s_RelaxMax;}
+    static bool isMultiThreaded() {return s_bMultiThread;}
 
 
 private:
     double AlphaInduced(int k);
+    void setCirculation();
     double Beta(int m, int k);
     double Eta(int m);
     void computeWing(double QInf, double Alpha, QString &ErrorMessage);
@@ -107,8 +116,13 @@ private:
     double Sigma(int m);
 
     PlaneOpp *createPlaneOpp(double QInf, double Alpha, bool bWingOut);
+    void addPlaneOpp(PlaneOpp *pPOpp);
     bool loop();
     bool alphaLoop();
+    bool alphaLoopMultiThreaded(int nBlocks);
+    bool alphaBlock(int i0, int i1, bool bInitCalc);
+    PlaneOpp *alphaPoint(double Alpha, bool &bInitCalc);
+    void initializeWorker(LLTAnalysis const *pMaster);
     bool QInfLoop();
     void traceLog(QString str);
 
@@ -143,9 +157,10 @@ private:
 
     bool m_bError;              /**< true if the analysis couldn't converge within the max number of iterations */
     bool m_bWarning;            /**< true if one the OpPoints could not be properly interpolated */
-    bool m_bCancel;                             /**< true if the user has cancelled the analysis */
+    QAtomicInt m_bCancel;                       /**< non-zero if the user has cancelled the analysis */
     bool m_bConverged;                          /**< true if the analysis has converged  */
     bool m_bWingOut;                            /**< true if the interpolation of viscous properties falls outside the polar mesh */
+    bool m_bInitCalc;                           /**< true if the next point should be initialized with the linear solution; set from s_bInitCalc at the start of the analysis */
 
     double m_Ai[MAXSPANSTATIONS+1];                /**< Induced Angle coefficient at the span stations */
     double m_BendingMoment[MAXSPANSTATIONS+1];    /**< bending moment at the span stations */
@@ -179,9 +194,19 @@ private:
     double m_XTrTop[MAXSPANSTATIONS+1];            /**< Upper transition location at the span stations */
     double m_XTrBot[MAXSPANSTATIONS+1];            /**< Lower transition location at the span stations */
 
+    Foil *m_pFoil0[MAXSPANSTATIONS+1];          /**< the foil on the left side of the wing's section at the span stations */
+    Foil *m_pFoil1[MAXSPANSTATIONS+1];          /**< the foil on the right side of the wing's section at the span stations */
+    double m_Tau[MAXSPANSTATIONS+1];            /**< the relative position of the span stations between the two foils */
+
+    QVector<double> m_Beta;                     /**< the non-zero Beta factors, by rows of length m_BetaStride for each span station */
+    int m_BetaStride;                           /**< the row length of the Beta matrix */
+    double m_BetaDiag[MAXSPANSTATIONS+1];       /**< the Beta factors Beta(k,k) */
+    double m_Circulation[2][MAXSPANSTATIONS/2+1]; /**< the lift coefficients multiplied by the chord and divided by the span, at the odd and even span stations */
+
     Vector3d m_CP;                               /**< The position of the center of pressure */
 
     int m_nPoints;                              /**< the number of points to calculate in the sequence */
+    double m_Progress;                          /**< the number of points of the sequence calculated so far, used to provide feedback to the user */
 
     //    Curve Data
     QVarLengthArray<double, 1024> *m_pX, *m_pY;
@@ -192,9 +217,14 @@ private:
     static double s_RelaxMax;                   /**< The relaxation factor for the iterations */
     static double s_CvPrec;                     /**< Precision criterion to stop the iterations. The difference in induced angle at any span point between two iterations should be less than the criterion */
     static bool s_bInitCalc;                    /**< true if the iterations analysis should be intialized with the linear solution at each new a.o.a. calculation, false otherwise */
+    static bool s_bMultiThread;                 /**< true if the range of aoa of type 1 and 2 polars should be distributed on the threads of the global pool */
+
+    LLTAnalysis const *m_pMaster;               /**< in multithreaded mode, the analysis which has launched this worker, or nullptr if this is not a worker */
+    QString m_Log;                              /**< the messages of a worker, traced by the master once the worker has finished */
 
     QVector<PlaneOpp*> m_PlaneOppList;
     QVector<Polar*> const *m_poaPolar;
+    PolarMesh m_PolarMesh;                      /**< the index of the polars of the wing's foils, built at the start of the analysis */
 };
 
 #endif // LLTANALYSIS_H
@@ -0,0 +1,189 @@
+/****************************************************************************
+
+    MatrixCache Class
+
+    Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+
+#include <QMutexLocker>
+
+#include "matrixcache.h"
+
+
+QVector<MatrixCache::Entry*> MatrixCache::s_Entry;
+QMutex MatrixCache::s_Mutex;
+qint64 MatrixCache::s_MaxBytes = qint64(MATRIXCACHESIZE)*1024*1024;
+quint64 MatrixCache::s_UseCount = 0;
+
+
+/**
+ * Copies a cached factored matrix to the analysis arrays.
+ * @param signature the geometry and the analysis settings with which the matrix has been built
+ * @param size the size of the linear system
+ * @param LU a pointer to the array which will hold the LU factors, of size size*size
+ * @param pivot a pointer to the array which will hold the row permutations, of size size
+ * @param wakeSize the size of the wake's RHS contribution arrays
+ * @param uWake a pointer to the array which will hold the wake's contribution to the RHS for a unit x-velocity
+ * @param wWake a pointer to the array which will hold the wake's contribution to the RHS for a unit z-velocity
+ * @return true if a matrix has been found for this signature, false otherwise.
+ */
+bool MatrixCache::restore(QVector<double> const &signature, int size, double *LU, int *pivot, int wakeSize, double *uWake, double *wWake)
+{
+    quint64 key = signatureKey(signature);
+
+    QMutexLocker locker(&s_Mutex);
+
+    for(int i=0; i<s_Entry.size(); i++)
+    {
+        Entry const *pEntry = s_Entry.at(i);
+        if(!pEntry->matches(key, signature, size, wakeSize)) continue;
+
+        memcpy(LU,    pEntry->LU.constData(),    ulong(size)*ulong(size)*sizeof(double));
+        memcpy(pivot, pEntry->pivot.constData(), ulong(size)*sizeof(int));
+        memcpy(uWake, pEntry->uWake.constData(), ulong(wakeSize)*sizeof(double));
+        memcpy(wWake, pEntry->wWake.constData(), ulong(wakeSize)*sizeof(double));
+
+        s_Entry[i]->lastUse = ++s_UseCount;
+        return true;
+    }
+    return false;
+}
+
+
+/**
+ * Stores a copy of a factored matrix, replacing the least recently used entries if the memory limit is reached.
+ * The matrix is not stored if it is larger than the memory limit on its own.
+ * @param signature the geometry and the analysis settings with which the matrix has been built
+ * @param size the size of the linear system
+ * @param LU a pointer to the LU factors, of size size*size
+ * @param pivot a pointer to the row permutations, of size size
+ * @param wakeSize the size of the wake's RHS contribution arrays
+ * @param uWake a pointer to the wake's contribution to the RHS for a unit x-velocity
+ * @param wWake a pointer to the wake's contribution to the RHS for a unit z-velocity
+ */
+void MatrixCache::store(QVector<double> const &signature, int size, double const *LU, int const *pivot, int wakeSize, double const *uWake, double const *wWake)
+{
+    quint64 key = signatureKey(signature);
+    qint64 memSize = (qint64(signature.size()) + qint64(size)*qint64(size) + 2*qint64(wakeSize)) * qint64(sizeof(double)) + qint64(size)*qint64(sizeof(int));
+
+    QMutexLocker locker(&s_Mutex);
+
+    if(memSize>s_MaxBytes) return;
+
+    for(int i=0; i<s_Entry.size(); i++)
+    {
+        if(s_Entry.at(i)->matches(key, signature, size, wakeSize))
+        {
+            // may happen if two analyses of the same geometry were running concurrently
+            s_Entry[i]->lastUse = ++s_UseCount;
+            return;
+        }
+    }
+
+    trim(s_MaxBytes-memSize);
+
+    Entry *pEntry = new Entry;
+    pEntry->key  = key;
+    pEntry->signature = signature;
+    pEntry->size = size;
+    pEntry->LU.resize(size*size);
+    pEntry->pivot.resize(size);
+    pEntry->uWake.resize(wakeSize);
+    pEntry->wWake.resize(wakeSize);
+    memcpy(pEntry->LU.data(),    LU,    ulong(size)*ulong(size)*sizeof(double));
+    memcpy(pEntry->pivot.data(), pivot, ulong(size)*sizeof(int));
+    memcpy(pEntry->uWake.data(), uWake, ulong(wakeSize)*sizeof(double));
+    memcpy(pEntry->wWake.data(), wWake, ulong(wakeSize)*sizeof(double));
+    pEntry->lastUse = ++s_UseCount;
+
+    s_Entry.append(pEntry);
+}
+
+
+/**
+ * Removes all the entries from the cache.
+ */
+void MatrixCache::clear()
+{
+    QMutexLocker locker(&s_Mutex);
+    trim(0);
+}
+
+
+/**
+ * Sets the maximum memory used by the cache. A value of 0 disables the cache.
+ * @param maxBytes the memory limit, in bytes
+ */
+void MatrixCache::setMaxMemory(qint64 maxBytes)
+{
+    QMutexLocker locker(&s_Mutex);
+    s_MaxBytes = qMax(qint64(0), maxBytes);
+    trim(s_MaxBytes);
+}
+
+
+/**
+ * Removes the least recently used entries until the cache's memory is less or equal to maxBytes.
+ * The mutex must be locked by the caller.
+ */
+void MatrixCache::trim(qint64 maxBytes)
+{
+    qint64 total = 0;
+    for(int i=0; i<s_Entry.size(); i++) total += s_Entry.at(i)->memorySize();
+
+    while(s_Entry.size() && total>maxBytes)
+    {
+        int iOldest = 0;
+        for(int i=1; i<s_Entry.size(); i++)
+        {
+            if(s_Entry.at(i)->lastUse<s_Entry.at(iOldest)->lastUse) iOldest = i;
+        }
+        total -= s_Entry.at(iOldest)->memorySize();
+        delete s_Entry.at(iOldest);
+        s_Entry.removeAt(iOldest);
+    }
+}
+
+
+/**
+ * Adds the bytes of a data block to a 64-bit FNV-1a hash key.
+ * @param key the hash key to update
+ * @param data a pointer to the data block
+ * @param nBytes the size of the data block, in bytes
+ */
+void MatrixCache::hash(quint64 &key, const void *data, size_t nBytes)
+{
+    unsigned char const *bytes = static_cast<unsigned char const*>(data);
+    for(size_t i=0; i<nBytes; i++)
+    {
+        key ^= quint64(bytes[i]);
+        key *= 1099511628211ULL;
+    }
+}
+
+
+/**
+ * Returns the 64-bit FNV-1a hash key of a signature.
+ */
+quint64 MatrixCache::signatureKey(QVector<double> const &signature)
+{
+    quint64 key = 14695981039346656037ULL;
+    hash(key, signature.constData(), ulong(signature.size())*sizeof(double));
+    return key;
+}
@@ -0,0 +1,86 @@
+/****************************************************************************
+
+    MatrixCache Class
+
+    Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+
+#ifndef MATRIXCACHE_H
+#define MATRIXCACHE_H
+
+#include <QVector>
+#include <QMutex>
+
+#include <xflr5-engine_global.h>
+
+#define MATRIXCACHESIZE 256   /**< the default max memory of the cache, in MB */
+
+
+/**
+ * @class MatrixCache
+ * A process-wide cache of LU-factored influence matrices, shared by all the panel analyses.
+ *
+ * The influence matrix depends only on the panel and wake geometries and on a few analysis settings,
+ * but not on the speed, the mass or the viscous settings of the polar. Each factored matrix is stored
+ * with its pivot array and the wake's RHS contributions, under a signature which holds the geometry and
+ * the settings, so that the analysis of several polars of the same plane requires only one factorization.
+ * The entries are looked up by a hash key of the signature, and are restored only if the whole signature matches.
+ *
+ * The least recently used entries are removed when the total size exceeds the memory limit, which is set
+ * by PanelAnalysis::setMatrixCacheSize() within the limit of the analyses' memory budget.
+ */
+class XFLR5ENGINELIBSHARED_EXPORT MatrixCache
+{
+public:
+    static bool restore(QVector<double> const &signature, int size, double *LU, int *pivot, int wakeSize, double *uWake, double *wWake);
+    static void store(QVector<double> const &signature, int size, double const *LU, int const *pivot, int wakeSize, double const *uWake, double const *wWake);
+    static void clear();
+
+    static void setMaxMemory(qint64 maxBytes);
+    static qint64 maxMemory() {return s_MaxBytes;}
+
+    static void hash(quint64 &key, void const *data, size_t nBytes);
+    static quint64 signatureKey(QVector<double> const &signature);
+
+private:
+    /** @struct a factored matrix, its pivot array and the wake's RHS contributions */
+    struct Entry
+    {
+        quint64 key;              /**< the hash key of the signature */
+        QVector<double> signature;/**< the geometry and the analysis settings with which the matrix has been built */
+        int size;                 /**< the size of the linear system */
+        QVector<double> LU;       /**< the LU factors */
+        QVector<int> pivot;       /**< the row permutations */
+        QVector<double> uWake;    /**< the wake's contribution to the RHS for a unit x-velocity */
+        QVector<double> wWake;    /**< the wake's contribution to the RHS for a unit z-velocity */
+        quint64 lastUse;          /**< the value of the usage counter at the last access */
+
+        qint64 memorySize() const {return qint64(signature.size()+LU.size()+uWake.size()+wWake.size())*qint64(sizeof(double)) + qint64(pivot.size())*qint64(sizeof(int));}
+        bool matches(quint64 k, QVector<double> const &sig, int n, int nWake) const {return key==k && size==n && uWake.size()==nWake && signature==sig;}
+    };
+
+    static void trim(qint64 maxBytes);
+
+    static QVector<Entry*> s_Entry;   /**< the cached entries */
+    static QMutex s_Mutex;            /**< protects the entries against concurrent analyses */
+    static qint64 s_MaxBytes;         /**< the maximum memory used by the cache, in bytes */
+    static quint64 s_UseCount;        /**< the usage counter, used to find the least recently used entry */
+};
+
+#endif // MATRIXCACHE_H
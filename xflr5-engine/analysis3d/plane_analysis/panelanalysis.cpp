@@ -21,13 +21,20 @@
 *****************************************************************************/
 
 
+#include <algorithm>
+#include <climits>
+
 #include <QDebug>
 #include <QTime>
 #include <QThread>
+#include <QThreadPool>
+#include <QVarLengthArray>
 #include <QCoreApplication>
+#include <QtConcurrent/QtConcurrentMap>
 
 #include <matrix.h>
 #include "panelanalysis.h"
+#include "matrixcache.h"
 #include <objects/objects3d/wpolar.h>
 #include <objects/objects3d/plane.h>
 #include <objects/objects3d/body.h>
@@ -35,11 +42,19 @@
 
 
 
-bool PanelAnalysis::s_bCancel = false;
 bool PanelAnalysis::s_bWarning = false;
 bool PanelAnalysis::s_bKeepOutOpp = false;
 bool PanelAnalysis::s_bTrefftz = true;
 int PanelAnalysis::s_MaxWakeIter = 1;
+bool PanelAnalysis::s_bMultiThread = true;
+bool PanelAnalysis::s_bSymmetricSolve = true;
+double PanelAnalysis::s_TreecodeAccuracy = 0.0;
+bool PanelAnalysis::s_bIncrementalAssembly = false;
+bool PanelAnalysis::s_bLowRankUpdate = false;
+bool PanelAnalysis::s_bIterativeSolve = false;
+bool PanelAnalysis::s_bSinglePrecision = false;
+int PanelAnalysis::s_MemoryBudget = 0;
+int PanelAnalysis::s_MatrixCacheSize = MATRIXCACHESIZE;
 
 
 /**
@@ -51,6 +66,24 @@ PanelAnalysis::PanelAnalysis()
     s_MaxRHSSize = VLMMAXRHS;
     m_MaxMatSize = 0;
 
+    m_bSymmetric = false;
+    m_SymSize = 0;
+
+    m_bMatrixFactored = false;
+    m_bLowRankUpdate = false;
+    m_RefSettingsKey = 0;
+    m_LURefSettingsKey = 0;
+
+    m_bIterative = false;
+    m_nStoredRows = 0;
+
+    m_StrengthGeneration = 0;
+
+    m_bSinglePrecision = false;
+    m_bMatrixCopies = true;
+    m_MaxStoredRows = 0;
+    m_MemoryFootprint = 0;
+
 
     m_Progress = m_TotalTime = 0.0;
 
@@ -59,6 +92,7 @@ PanelAnalysis::PanelAnalysis()
     m_Vd = nullptr;
 
     m_aij = m_aijWake = nullptr;
+    m_aijSingle = nullptr;
     m_uRHS = m_vRHS = m_wRHS = m_pRHS = m_qRHS = m_rRHS = nullptr;
     m_cRHS = m_uWake = m_wWake = nullptr;
     m_uVl = m_wVl = nullptr;
@@ -111,8 +145,6 @@ PanelAnalysis::PanelAnalysis()
     m_nWakeNodes = 0;
     m_WakeSize   = 0;
 
-    phiG = 0.0;
-
     Theta0 = 0.0;
     u0     = 0.0;
 
@@ -160,25 +192,200 @@ PanelAnalysis::~PanelAnalysis()
 }
 
 
+/**
+ * Sets the memory budget of the analyses, which also limits the memory of the MatrixCache.
+ *@param budgetMB the max memory in MB which the arrays of an analysis may use, or 0 if there is no limit
+ */
+void PanelAnalysis::setMemoryBudget(int budgetMB)
+{
+    s_MemoryBudget = qMax(0, budgetMB);
+    setMatrixCacheSize(s_MatrixCacheSize);
+}
+
+
+/**
+ * Sets the memory of the MatrixCache, within the limit of the memory budget of the analyses.
+ *@param cacheMB the max memory in MB of the factored matrices kept in the cache, or 0 to disable the cache
+ */
+void PanelAnalysis::setMatrixCacheSize(int cacheMB)
+{
+    s_MatrixCacheSize = qMax(0, cacheMB);
+    qint64 maxBytes = qint64(s_MatrixCacheSize)*1024*1024;
+    if(s_MemoryBudget>0) maxBytes = qMin(maxBytes, qint64(s_MemoryBudget)*1024*1024);
+    MatrixCache::setMaxMemory(maxBytes);
+}
+
+
+/**
+ * Returns the memory in bytes which the arrays of an analysis require for a given number of panels and a given solver.
+ * The footprint includes the arrays reserved by allocateMatrix() and allocateRHS(), and the arrays reserved by the solver
+ * during the analysis: the copies of the matrix for the incremental assembly, the low-rank update and the MatrixCache,
+ * the rows kept in memory by the iterative and the mixed precision solvers, and the preconditioner and the Krylov bases
+ * of the iterative solver. The sizes are those of the full system, which are upper bounds in the symmetric case.
+ *@param matSize the number of panels
+ *@param bIterative true if the system is solved with the iterative solver
+ *@param bSinglePrecision true if the matrix is stored and factored in single precision
+ *@param bMatrixCopies true if the copies of the matrix are kept
+ *@param nStoredRows the number of rows kept in memory by the iterative or the mixed precision solver
+ *@return the footprint in bytes
+ */
+qint64 PanelAnalysis::memoryFootprint(int matSize, bool bIterative, bool bSinglePrecision, bool bMatrixCopies, int nStoredRows) const
+{
+    qint64 n    = matSize;
+    qint64 n2   = n*n;
+    qint64 nRHS = s_MaxRHSSize;
+    qint64 memsize = 0;
+
+    // the vectors of allocateMatrix() and the arrays of allocateRHS()
+    memsize += qint64(sizeof(double))   * 9 * n;
+    memsize += qint64(sizeof(Vector3d)) * 2 * n;
+    memsize += qint64(sizeof(int))      * n;
+    memsize += qint64(sizeof(double))   * (6*n*nRHS + nRHS);
+
+    if(bIterative)
+    {
+        // the blocks of the preconditioner hold at most ITERATIVEBLOCKSIZE rows each
+        memsize += qint64(sizeof(double)) * n * ITERATIVEBLOCKSIZE;
+        memsize += qint64(sizeof(int))    * 4 * n;
+        // the Krylov bases and the work vectors for the largest set of RHS, i.e. the six RHS of the stability analysis
+        memsize += qint64(sizeof(double)) * 6 * (ITERATIVERESTART+4) * n;
+    }
+    else if(bSinglePrecision)
+    {
+        memsize += qint64(sizeof(float))  * n2;
+        // the copies of the RHS and the residuals of the refinement
+        memsize += qint64(sizeof(double)) * 2 * 6 * n;
+    }
+    else
+    {
+        memsize += qint64(sizeof(double)) * 2 * n2;
+        if(bMatrixCopies)
+        {
+            if(double(n2)<=MAXREFMATRIXSIZE)
+            {
+                if(s_bIncrementalAssembly)                    memsize += qint64(sizeof(double)) * n2;
+                if(s_bIncrementalAssembly && s_bLowRankUpdate) memsize += qint64(sizeof(double)) * 2 * n2;
+            }
+            if(qint64(sizeof(double))*n2<=MatrixCache::maxMemory()) memsize += qint64(sizeof(double)) * n2;
+        }
+    }
+
+    memsize += qint64(sizeof(double)) * qint64(nStoredRows) * n;
+    return memsize;
+}
+
+
+/**
+ * Selects the storage of the influence matrix and the linear solver before the arrays are reserved, and reports the memory footprint.
+ *
+ * The solver set by the static settings is used if it fits in the memory budget. Otherwise, the settings are
+ * degraded in the order of increasing run time:
+ *   - the copies of the matrix for the incremental assembly, the low-rank update and the MatrixCache are dropped;
+ *   - the matrix is stored and factored in single precision, which halves the memory of the factors and avoids
+ *     the storage of the wake's coefficients, and the accuracy is recovered by iterative refinement;
+ *   - the system is solved with the iterative solver, which does not store the matrix.
+ * The iterative and the mixed precision solvers keep in memory as many rows of the system as the remaining budget allows,
+ * within the limit of MAXITERATIVEROWSIZE coefficients.
+ *@param matSize the number of panels
+ *@return false if the memory required by the iterative solver exceeds the budget, true otherwise.
+ */
+bool PanelAnalysis::planMemory(int matSize)
+{
+    QString strange;
+    qint64 budget = qint64(s_MemoryBudget)*1024*1024;
+    int maxRows = matSize>0 ? int(qMin(qint64(matSize), qint64(MAXITERATIVEROWSIZE)/qint64(matSize))) : 0;
+
+    m_bIterative       = s_bIterativeSolve;
+    m_bSinglePrecision = s_bSinglePrecision && !m_bIterative;
+    m_bMatrixCopies    = true;
+
+    auto footprint = [this, matSize, maxRows, budget]()
+    {
+        m_MaxStoredRows = 0;
+        if(m_bIterative || m_bSinglePrecision)
+        {
+            m_MaxStoredRows = maxRows;
+            if(budget>0)
+            {
+                qint64 spare = budget - memoryFootprint(matSize, m_bIterative, m_bSinglePrecision, m_bMatrixCopies, 0);
+                qint64 rowSize = qint64(sizeof(double)) * qMax(matSize, 1);
+                m_MaxStoredRows = int(qBound(qint64(0), spare/rowSize, qint64(maxRows)));
+            }
+        }
+        m_MemoryFootprint = memoryFootprint(matSize, m_bIterative, m_bSinglePrecision, m_bMatrixCopies, m_MaxStoredRows);
+        return budget<=0 || m_MemoryFootprint<=budget;
+    };
+
+    if(!footprint() && !m_bIterative && !m_bSinglePrecision)
+    {
+        m_bMatrixCopies = false;
+        if(!footprint()) m_bSinglePrecision = true;
+    }
+    if(!footprint() && !m_bIterative)
+    {
+        m_bSinglePrecision = false;
+        m_bIterative = true;
+    }
+    bool bFits = footprint();
+
+    QString solver;
+    if(m_bIterative)            solver = "the iterative solver";
+    else if(m_bSinglePrecision) solver = "the mixed precision LU solver";
+    else                        solver = "the double precision LU solver";
+    strange = QString("   Memory required by the analysis: %1 MB with %2").arg(double(m_MemoryFootprint)/1024./1024., 0, 'f', 1).arg(solver);
+    if(budget>0) strange += QString(", for a budget of %1 MB").arg(s_MemoryBudget);
+    traceLog(strange+"\n");
+
+    if(!m_bMatrixCopies && !m_bIterative && !m_bSinglePrecision)
+        traceLog("   The copies of the influence matrix have been disabled to fit in the memory budget\n");
+    if(m_bIterative!=s_bIterativeSolve || m_bSinglePrecision!=(s_bSinglePrecision && !s_bIterativeSolve))
+        traceLog("   The solver has been changed to fit in the memory budget\n");
+
+    if(!bFits)
+    {
+        traceLog("   The analysis exceeds the memory budget. Please reduce the model's size or increase the budget.\n");
+        return false;
+    }
+    return true;
+}
+
+
 /**
  * Reserves the memory necessary to matrix arrays.
+ * The storage of the influence matrix is selected by planMemory(): it is not allocated if the system is solved
+ * with the iterative solver, and it is allocated in single precision for the mixed precision solver.
  *@return true if the memory could be allocated, false otherwise.
  */
 bool PanelAnalysis::allocateMatrix(int matSize, int &memsize)
 {
     QString strange;
 
-    if(matSize<=m_MaxMatSize) return true;  //current analysis requires smaller size than that currently allocated
+    if(!planMemory(matSize)) return false;
+
+    //current analysis requires smaller size than that currently allocated
+    if(matSize<=m_MaxMatSize)
+    {
+        if(m_bIterative)                                  return true;
+        else if(m_bSinglePrecision && m_aijSingle)        return true;
+        else if(!m_bSinglePrecision && m_aij && m_aijWake) return true;
+    }
 
     releaseArrays();
 
     //    Trace("PanelAnalysis::Allocating matrix arrays");
 
-    int size2 = matSize * matSize;
+    qint64 size2 = m_bIterative ? 0 : qint64(matSize) * qint64(matSize);
     try
     {
-        m_aij      = new double[ulong(size2)];
-        m_aijWake  = new double[ulong(size2)];
+        if(m_bSinglePrecision)
+        {
+            m_aijSingle = new float[ulong(size2)];
+        }
+        else if(!m_bIterative)
+        {
+            m_aij      = new double[ulong(size2)];
+            m_aijWake  = new double[ulong(size2)];
+        }
 
         m_uRHS  = new double[ulong(matSize)];
         m_vRHS  = new double[ulong(matSize)];
@@ -206,16 +413,24 @@ bool PanelAnalysis::allocateMatrix(int matSize, int &memsize)
 
     m_MaxMatSize = matSize;
 
-    memsize  = sizeof(double)  * 2 * size2; //bytes
-    memsize += sizeof(double)  * 9 * matSize; //bytes
-    memsize += sizeof(Vector3d) * 3 * matSize;
-    memsize += sizeof(int)     * 1 * matSize;
+    qint64 matrixsize = m_bSinglePrecision ? qint64(sizeof(float)) * size2 : qint64(sizeof(double)) * 2 * size2; //bytes
+    matrixsize += qint64(sizeof(double))   * 9 * matSize; //bytes
+    matrixsize += qint64(sizeof(Vector3d)) * 2 * matSize;
+    matrixsize += qint64(sizeof(int))      * 1 * matSize;
+    memsize = int(qMin(matrixsize, qint64(INT_MAX)));
 
-    strange = QString("PanelAnalysis::Memory allocation for the matrix arrays is %1 MB").arg(double(memsize)/1024./1024., 7, 'f', 2);
+    strange = QString("PanelAnalysis::Memory allocation for the matrix arrays is %1 MB").arg(double(matrixsize)/1024./1024., 7, 'f', 2);
     //    Trace(strange);
 
-    memset(m_aij,     0, size2 * sizeof(double));
-    memset(m_aijWake, 0, size2 * sizeof(double));
+    if(m_bSinglePrecision)
+    {
+        memset(m_aijSingle, 0, ulong(size2) * sizeof(float));
+    }
+    else if(!m_bIterative)
+    {
+        memset(m_aij,     0, ulong(size2) * sizeof(double));
+        memset(m_aijWake, 0, ulong(size2) * sizeof(double));
+    }
 
     memset(m_uRHS,  0, ulong(matSize)*sizeof(double));
     memset(m_vRHS,  0, ulong(matSize)*sizeof(double));
@@ -299,13 +514,15 @@ bool PanelAnalysis::allocateRHS(int matSize, int &memsize)
 
 
 /**
- * Releases the memory reserved for matrix and RHS arrays
+ * Releases the memory reserved for matrix and RHS arrays, and for the copies of the influence matrix
  */
 void PanelAnalysis::releaseArrays()
 {
     if(m_aij)     delete [] m_aij;
     if(m_aijWake) delete [] m_aijWake;
     m_aij = m_aijWake = nullptr;
+    if(m_aijSingle) delete [] m_aijSingle;
+    m_aijSingle = nullptr;
 
     if(m_RHS)      delete [] m_RHS;
     if(m_RHSRef)   delete [] m_RHSRef;
@@ -336,6 +553,19 @@ void PanelAnalysis::releaseArrays()
     if(m_Index) delete [] m_Index;
     m_Index = nullptr;
 
+    // the copies of the influence matrix kept for the incremental assembly and the low-rank update
+    m_aijRef.clear();         m_aijRef.squeeze();
+    m_RefPanelKey.clear();    m_RefPanelKey.squeeze();
+    m_RefSymIndex.clear();    m_RefSymIndex.squeeze();
+    m_LURefMatrix.clear();    m_LURefMatrix.squeeze();
+    m_LURef.clear();          m_LURef.squeeze();
+    m_LURefIndex.clear();     m_LURefIndex.squeeze();
+    m_LURefPanelKey.clear();  m_LURefPanelKey.squeeze();
+    m_LURefSymIndex.clear();  m_LURefSymIndex.squeeze();
+    m_LRW.clear();            m_LRW.squeeze();
+    m_LRZ.clear();            m_LRZ.squeeze();
+    m_LRS.clear();            m_LRS.squeeze();
+
     m_MaxMatSize = 0;
 }
 
@@ -469,6 +699,9 @@ void PanelAnalysis::setArrayPointers(Panel *pPanel, Panel *pMemPanel, Panel *pWa
     m_pWakeNode     = pWakeNode;
     m_pRefWakeNode  = pRefWakeNode;
     m_pTempWakeNode = pTempWakeNode;
+
+    m_Treecode.clear();
+    m_Vortex.clear();
 }
 
 
@@ -488,7 +721,9 @@ void PanelAnalysis::setArraySize(int MatSize, int WakeSize, int nNodes, int nWak
 bool PanelAnalysis::initializeAnalysis()
 {
     if(!m_pPlane) return false;
-    s_bCancel = false;
+    m_bCancel.storeRelease(0);
+    m_Treecode.clear();
+    m_Vortex.clear();
 
     QString strange;
 
@@ -603,7 +838,7 @@ bool PanelAnalysis::initializeAnalysis()
     m_Progress = 0.0;
 
     m_bPointOut = false;
-    s_bCancel   = false;
+    m_bCancel.storeRelease(0);
     s_bWarning  = false;
 
     QString str = QString("Counted %1 panel elements\n").arg(m_MatSize,4);
@@ -623,6 +858,8 @@ bool PanelAnalysis::initializeAnalysis()
 
 bool PanelAnalysis::loop()
 {
+    m_bSymmetric = false;
+
     if(m_pWPolar->polarType()<XFLR5::FIXEDAOAPOLAR)
     {
         if(m_pWPolar->bTilted() || fabs(m_pWPolar->Beta())>PRECISION) return unitLoop();
@@ -669,18 +906,20 @@ bool PanelAnalysis::alphaLoop()
     str = QString("   Solving the problem... \n");
     traceLog(str);
 
-    buildInfluenceMatrix();
-    if (s_bCancel) return true;
+    m_bSymmetric = s_bSymmetricSolve && makeSymmetryMap();
+
+    if(!restoreFactoredMatrix()) buildInfluenceMatrix();
+    if (isCancelled()) return true;
     //display_vec(m_aij, 2*m_MatSize);
 
     createUnitRHS();
-    if (s_bCancel) return true;
+    if (isCancelled()) return true;
     //for(int i=0; i<m_MatSize; i++) displayDouble(m_uRHS[i], m_wRHS[i]);
 
     if(!m_pWPolar->bThinSurfaces())
     {
         //compute wake contribution
-        createWakeContribution();
+        if(!m_bMatrixFactored) createWakeContribution();
         //        display_vec(m_aijWake+17*m_MatSize, m_MatSize);
 
         //add wake contribution to matrix and RHS
@@ -688,14 +927,15 @@ bool PanelAnalysis::alphaLoop()
         {
             m_uRHS[p]+= m_uWake[p];
             m_wRHS[p]+= m_wWake[p];
-            for(int pp=0; pp<m_MatSize; pp++)
-            {
-                m_aij[p*m_MatSize+pp] += m_aijWake[p*m_MatSize+pp];
-            }
+        }
+        if(!m_bMatrixFactored && !m_bIterative && !m_bSinglePrecision)
+        {
+            int Size = m_bSymmetric ? m_SymSize : m_MatSize;
+            for(int p=0; p<Size*Size; p++) m_aij[p] += m_aijWake[p];
         }
     }
     //display_vec(m_aijWake, 2*m_MatSize);
-    if (s_bCancel) return true;
+    if (isCancelled()) return true;
 
     if (!solveUnitRHS())
     {
@@ -704,25 +944,25 @@ bool PanelAnalysis::alphaLoop()
     }
     //for(int i=0; i<m_MatSize; i++) displayDouble(m_uRHS[i], m_wRHS[i]);
 
-    if (s_bCancel) return true;
+    if (isCancelled()) return true;
 
     createSourceStrength(m_vMin, m_vDelta, m_nRHS);
-    if (s_bCancel) return true;
+    if (isCancelled()) return true;
 
     createDoubletStrength(m_vMin, m_vDelta, m_nRHS);
-    if (s_bCancel) return true;
+    if (isCancelled()) return true;
 
     computeFarField(1.0, m_vMin, m_vDelta, m_nRHS);
-    if (s_bCancel) return true;
+    if (isCancelled()) return true;
 
     for(int q=0; q<m_nRHS; q++)
         computeBalanceSpeeds(m_vMin+q*m_vDelta, q);
 
     scaleResultstoSpeed(m_nRHS);
-    if (s_bCancel) return true;
+    if (isCancelled()) return true;
 
     computeOnBodyCp(m_vMin, m_vDelta, m_nRHS);
-    if (s_bCancel) return true;
+    if (isCancelled()) return true;
     //for(int i=0; i<m_MatSize; i++)    displayDouble(m_Cp[i]);
 
     computeAeroCoefs(m_vMin, m_vDelta, m_nRHS);
@@ -734,1389 +974,2871 @@ bool PanelAnalysis::alphaLoop()
 
 /**
 * Builds the influence matrix, both for VLM or Panel calculations.
+*
+* The rows are assembled by tiles of PANELTILESIZE rows. In multithreaded mode, the tiles are
+* dispatched to the global thread pool in successive batches, so that the progress and the
+* cancellation flag are handled by the calling thread between two batches.
+* Each coefficient is evaluated with the same operations in both modes, so that
+* the resulting matrices are identical.
+*
+* If the system is reduced by symmetry, only the rows of the reduced system are built,
+* and their columns are folded in the leading m_SymSize x m_SymSize block of the matrix array.
+*
+* In incremental mode, a copy of the full rows is kept with a key for each panel, so that when the geometry
+* has changed only for a few panels, e.g. in a parametric sweep of a wing section,
+* only the rows and the columns of these panels are built anew.
 */
 void PanelAnalysis::buildInfluenceMatrix()
 {
-    Vector3d C, CC, V;
-    int m, mm, p, pp;
-    double phi;
-
-    int Size = m_MatSize;
-    //    if(m_b3DSymetric) Size = m_SymSize;
-
     traceLog("      Creating the influence matrix...");
     traceLog("\n");
-    m=0;
-    for(p=0; p<m_MatSize; p++)
-    {
-        if(s_bCancel) return;
-        //        if(!m_b3DSymetric || m_pPanel[p].m_bIsLeftPanel)
-        //        {
-        //for each Boundary Condition point
-        if(m_pPanel[p].m_Pos!=MIDSURFACE)
-        {
-            //Thick surfaces, 3D-panel type BC, use collocation point
-            C = m_pPanel[p].CollPt;
-        }
-        else
-        {
-            //Thin surface, VLM type BC, use control point
-            C = m_pPanel[p].CtrlPt;
-        }
-        CC.x =  C.x;//symmetric point, just in case
-        CC.y = -C.y;
-        CC.z =  C.z;
 
-        mm = 0;
-        for(pp=0; pp<m_MatSize; pp++)
-        {
-            if(s_bCancel) return;
-            //                if(!m_b3DSymetric || m_pPanel[pp].m_bIsLeftPanel)
-            //                {
-            //for each panel, get the unit doublet or vortex influence at the boundary condition pt
-            getDoubletInfluence(C, m_pPanel+pp, V, phi);
+    makeVortexArray();
 
-            /*                    if(m_b3DSymetric && m_pPanel[pp].m_iSym>=0) // add symmetric contribution
-                    {
-                        GetDoubletInfluence(CC, m_pPanel+pp, VS, phiSym);
-                        V.x += VS.x;
-                        V.y -= VS.y;
-                        V.z += VS.z;
-                        phi += phiSym;
-                    }*/
+    // the iterative solver calculates the coefficients when they are needed,
+    // and the single precision matrix is built with the wake's contribution before its decomposition
+    if(m_bIterative || m_bSinglePrecision) return;
 
-            if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE) m_aij[m*Size+mm] = V.dot(m_pPanel[p].Normal);
-            else if(m_pWPolar->bDirichlet())                              m_aij[m*Size+mm] = phi;
+    int nRows = m_bSymmetric ? m_SymSize : m_MatSize;
+    QVector<int> rows(nRows);
+    for(int i=0; i<nRows; i++) rows[i] = i;
 
-            mm++;
-            //                }
-        }
-        m++;
-        //        }
-        m_Progress += 10.0*double(Size)/400./double(Size);
+    if(!s_bIncrementalAssembly || !m_bMatrixCopies || double(nRows)*double(m_MatSize)>MAXREFMATRIXSIZE)
+    {
+        m_aijRef.clear();
+        m_RefPanelKey.clear();
+        buildInfluenceRows(rows, QVector<int>(), nullptr);
+        return;
     }
-}
 
+    QVector<quint64> panelKey(m_MatSize);
+    for(int p=0; p<m_MatSize; p++) panelKey[p] = influencePanelKey(p);
+    quint64 settingsKey = influenceSettingsKey();
 
-/**
- * Creates the source strengths for all requested RHS in a Panel analysis, using the specified boundary conditions (BC).
- * BC may be of the Neumann or Dirichlet type depending on the analysis type and on the geometry
- *
- * Uses NASA 4023 equation (20) & (22)
- *
- * The computation is performed for a unit speed. The results are scaled to speed later depending on the polar type.
- *
- *@param Alpha0 the first aoa in the sequence
- *@param AlphaDeltathe aoa increment
- *@param the total number of aoa and of source arrays to build
-*/
-void PanelAnalysis::createSourceStrength(double Alpha0, double AlphaDelta, int nval)
-{
-    int p, pp, q;
-    double alpha;
-    Vector3d WindDirection;
+    QVector<int> changed;
+    bool bUpdate = settingsKey==m_RefSettingsKey && m_RefPanelKey.size()==m_MatSize && m_aijRef.size()==nRows*m_MatSize;
+    if(bUpdate && m_bSymmetric) bUpdate = m_SymIndex==m_RefSymIndex;
+    if(bUpdate)
+    {
+        for(int p=0; p<m_MatSize; p++)
+        {
+            if(panelKey.at(p)!=m_RefPanelKey.at(p)) changed.append(p);
+        }
+        // beyond half of the panels, the update costs more than a new assembly
+        if(2*changed.size()>m_MatSize) bUpdate = false;
+    }
 
-    traceLog("      Creating source strengths...\n");
+    // the rows are invalid until they have been built completely
+    m_RefPanelKey.clear();
 
-    p=0;
-    for (q=0; q<nval;q++)
+    if(bUpdate)
     {
-        alpha = Alpha0+q*AlphaDelta;
-        WindDirection.set(cos(alpha*PI/180.0), 0.0, sin(alpha*PI/180.0));
+        QString strange = QString("      Updating the influence matrix for %1 panels out of %2\n").arg(changed.size()).arg(m_MatSize);
+        traceLog(strange);
 
-        for (pp=0; pp<m_MatSize; pp++)
+        QVector<bool> bChanged(m_MatSize, false);
+        for(int ic=0; ic<changed.size(); ic++) bChanged[changed.at(ic)] = true;
+
+        // the rows of the changed panels are built anew, and only the changed columns of the other rows
+        QVector<int> newRows, oldRows;
+        for(int i=0; i<nRows; i++)
         {
-            if(s_bCancel) return;
-            if(m_pPanel[pp].m_Pos!=MIDSURFACE) m_Sigma[p] = -1.0/4.0/PI* WindDirection.dot(m_pPanel[pp].Normal);
-            else                               m_Sigma[p] =  0.0;
-            p++;
+            int p = m_bSymmetric ? m_SymIndex.at(i) : i;
+            if(bChanged.at(p)) newRows.append(i);
+            else               oldRows.append(i);
         }
+        double *aijRef = m_aijRef.data();
+        if(!newRows.isEmpty()) buildInfluenceRows(newRows, QVector<int>(), aijRef);
+        if(!changed.isEmpty() && !oldRows.isEmpty()) buildInfluenceRows(oldRows, changed, aijRef);
+    }
+    else
+    {
+        m_aijRef.resize(nRows*m_MatSize);
+        buildInfluenceRows(rows, QVector<int>(), m_aijRef.data());
+    }
+    if(isCancelled()) return;
+
+    m_RefPanelKey    = panelKey;
+    m_RefSettingsKey = settingsKey;
+    if(m_bSymmetric) m_RefSymIndex = m_SymIndex;
+    else             m_RefSymIndex.clear();
+
+    // the matrix array is overwritten by the LU decomposition, so that the rows are copied
+    double const *aijRef = m_aijRef.constData();
+    for(int i=0; i<nRows; i++)
+    {
+        if(m_bSymmetric) foldSymmetricRow(aijRef+i*m_MatSize, m_aij+i*m_SymSize);
+        else             memcpy(m_aij+i*m_MatSize, aijRef+i*m_MatSize, ulong(m_MatSize)*sizeof(double));
     }
 }
 
 
 /**
-* Creates a RHS vector array for a given field of velocity vectors.
-* If the input pointer VField is NULL, a uniform field of freestream velocities is considered.
-* If the pointer is not NULL, it points to an array of velocity vectors on the panels. Used for evaluating the stability derivatives for the rotation dof.
-* @param RHS A pointer to the RHS to build
-* @param VField a pointer to the array of the freesteam velocity vectors on the panels.
-* @param VInf the freestream velocity vector
+* Builds a set of rows of the influence matrix by tiles of PANELTILESIZE rows.
+*@param rows the indexes of the rows to build
+*@param columns the indexes of the columns to build in each row; if the array is empty, all the columns are built
+*@param aijFull if not null, the array of full rows in which the coefficients are written; if null, the rows are written in the matrix array
 */
-void PanelAnalysis::createRHS(double *RHS, Vector3d VInf, double *VField)
+void PanelAnalysis::buildInfluenceRows(QVector<int> const &rows, QVector<int> const &columns, double *aijFull)
 {
-    int m, p, pp;
-    double  phi, sigmapp;
-    Vector3d V, C, VPanel;
+    int nRows = rows.size();
+    int nTiles = (nRows+PANELTILESIZE-1)/PANELTILESIZE;
+    double colRatio = columns.isEmpty() ? 1.0 : double(columns.size())/double(m_MatSize);
 
-    m = 0;
-
-    for (p=0; p<m_MatSize; p++)
+    if(!s_bMultiThread)
     {
-        if(s_bCancel) return;
-        if(VField)
+        for(int it=0; it<nTiles; it++)
         {
-            VPanel.x = *(VField             +p);
-            VPanel.y = *(VField+  m_MatSize +p);
-            VPanel.z = *(VField+2*m_MatSize +p);
+            if(isCancelled()) return;
+            int k0 = it*PANELTILESIZE;
+            int k1 = qMin(k0+PANELTILESIZE, nRows);
+            buildInfluenceTile(rows, k0, k1, columns, aijFull);
+            m_Progress += 10.0*double(k1-k0)*colRatio/400.0;
         }
-        else VPanel = VInf;
+        return;
+    }
 
-        //        if(!m_b3DSymetric || m_pPanel[p].m_bIsLeftPanel)
-        //        {
-        if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE)
-        {
-            // first term of RHS is -V.n
-            RHS[m] = - m_pPanel[p].Normal.dot(VPanel);
-            //                if(RHS[m]<PRECISION) RHS[m] = 0.0;
-        }
-        else if(m_pWPolar->bDirichlet()) RHS[m] = 0.0;
-        if(m_pPanel[p].m_Pos!=MIDSURFACE) C = m_pPanel[p].CollPt;
-        else                              C = m_pPanel[p].CtrlPt;
+    // a few tiles per thread in each batch to balance the load between the threads
+    int nBatch = qMax(1, 4*QThreadPool::globalInstance()->maxThreadCount());
+    QVector<int> tiles;
+    for(int it0=0; it0<nTiles; it0+=nBatch)
+    {
+        if(isCancelled()) return;
 
-        for (pp=0; pp<m_MatSize; pp++)
-        {
-            // Consider only the panels positioned on thick surfaces,
-            // since the source strength is zero on thin surfaces
-            if(m_pPanel[pp].m_Pos!=MIDSURFACE)
-            {
-                // Define the source strength on panel pp
-                sigmapp = -1.0/4.0/PI * m_pPanel[pp].Normal.dot(VPanel);
+        tiles.clear();
+        for(int it=it0; it<qMin(it0+nBatch, nTiles); it++) tiles.append(it);
 
-                // Add to RHS the source influence of panel pp on panel p
-                getSourceInfluence(C, m_pPanel+pp, V, phi);
+        QtConcurrent::blockingMap(tiles, [this, &rows, &columns, aijFull, nRows](int const &it)
+        {
+            if(isCancelled()) return;
+            buildInfluenceTile(rows, it*PANELTILESIZE, qMin((it+1)*PANELTILESIZE, nRows), columns, aijFull);
+        });
 
-                if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE)
-                {
-                    // Apply Neumann B.C.
-                    // NASA4023 eq. (22) and (23)
-                    // The RHS term is sigma[pp]*DJK = nj.Vjk
-                    RHS[m] -= V.dot(m_pPanel[p].Normal) * sigmapp;
-                }
-                else if(m_pWPolar->bDirichlet())
-                {
-                    //NASA4023 eq. (20)
-                    RHS[m] -= (phi * sigmapp);
-                }
-            }
-        }
-        m++;
-        //        }
-        m_Progress += 5.0/(double)m_MatSize;
+        int nBuilt = qMin(tiles.last()*PANELTILESIZE+PANELTILESIZE, nRows) - tiles.first()*PANELTILESIZE;
+        m_Progress += 10.0*double(nBuilt)*colRatio/400.0;
     }
 }
 
 
 /**
-*Builds the two unit RHS for freestream velocities directed along x and z
+* Builds the rows rows[k0] to rows[k1-1] of the influence matrix.
+* Only the rows of the tile are written, so that tiles may be built concurrently.
+* In the symmetric case, the full rows are built in a temporary array and then folded in the reduced matrix.
+*@param rows the indexes of the rows to build
+*@param k0 the index in the array rows of the first row of the tile
+*@param k1 the index in the array rows past the last row of the tile
+*@param columns the indexes of the columns to build; if the array is empty, all the columns are built
+*@param aijFull if not null, the array of full rows in which the coefficients are written without folding
 */
-void PanelAnalysis::createUnitRHS()
+void PanelAnalysis::buildInfluenceTile(QVector<int> const &rows, int k0, int k1, QVector<int> const &columns, double *aijFull)
 {
-    traceLog("      Creating the unit RHS vectors...\n");
+    double *row[PANELTILESIZE];
+    QVector<double> symRows;
+    int n = k1-k0;
+    bool bFold = m_bSymmetric && !aijFull;
+
+    if(bFold) symRows.resize(n*m_MatSize);
 
-    Vector3d VInf;
+    for(int k=0; k<n; k++)
+    {
+        int i = rows.at(k0+k);
+        if(aijFull)    row[k] = aijFull+i*m_MatSize;
+        else if(bFold) row[k] = symRows.data()+k*m_MatSize;
+        else           row[k] = m_aij+i*m_MatSize;
+    }
 
-    VInf.set(1.0, 0.0, 0.0);
-    createRHS(m_uRHS,  VInf);
+    computeInfluenceRows(rows.constData()+k0, n, columns, row);
+    if(isCancelled()) return;
 
-    VInf.set(0.0, 0.0, 1.0);
-    createRHS(m_wRHS, VInf);
+    if(bFold)
+    {
+        for(int k=0; k<n; k++)
+            foldSymmetricRow(row[k], m_aij+rows.at(k0+k)*m_SymSize);
+    }
 }
 
 
 /**
-* In the case of a panel analysis, adds the contribution of the wake columns to the coefficients of the influence matrix
-* Method :
-*     - follow the method described in NASA 4023 eq. (44)
-*    - add the wake's doublet contribution to the matrix
-*    - add the difference in potential at the trailing edge panels to the RHS
-* Only a flat wake is considered. Wake roll-up has been tested but did not prove robust enough for implementation.
+* Calculates the full rows of the influence matrix, i.e. the coefficients of all the panels, for at most PANELTILESIZE rows of the system.
+* The loop on the influencing panels is the outer loop, so that the data of each panel is
+* loaded once for all the boundary condition points of the tile.
+* The influence of the VLM vortices is evaluated at all the points of the tile in a single call to the vectorized kernel;
+* the ground effect images of the points are appended to the batch.
+*@param rows a pointer to the indexes of the rows of the system
+*@param n the number of rows
+*@param columns the indexes of the columns to build; if the array is empty, all the columns are built
+*@param row the array of pointers to the full rows in which the coefficients are written
 */
-void PanelAnalysis::createWakeContribution()
+void PanelAnalysis::computeInfluenceRows(int const *rows, int n, QVector<int> const &columns, double **row)
 {
-    int kw=0, lw=0, pw=0, p=0, pp=0, Size=0;
-
-    Vector3d V, C, CC, TrPt;
-    double phi=0;
-    double* PHC = new double[ulong(m_NWakeColumn)];
-    Vector3d *VHC = new Vector3d[ulong(m_NWakeColumn)];
+    Vector3d C[PANELTILESIZE], V;
+    double phi=0.0;
+    int p=0;
+    double x[2*PANELTILESIZE], y[2*PANELTILESIZE], z[2*PANELTILESIZE];
+    double vx[2*PANELTILESIZE], vy[2*PANELTILESIZE], vz[2*PANELTILESIZE];
+    bool bGround = m_pWPolar->bGround();
+    int nCols = columns.isEmpty() ? m_MatSize : columns.size();
 
-    traceLog("      Adding the wake's contribution...\n");
+    for(int k=0; k<n; k++)
+    {
+        //for each Boundary Condition point
+        p = m_bSymmetric ? m_SymIndex[rows[k]] : rows[k];
 
-    Size = m_MatSize;
-    //    if(m_b3DSymetric) Size = m_SymSize;
+        if(m_pPanel[p].m_Pos!=MIDSURFACE)
+        {
+            //Thick surfaces, 3D-panel type BC, use collocation point
+            C[k] = m_pPanel[p].CollPt;
+        }
+        else
+        {
+            //Thin surface, VLM type BC, use control point
+            C[k] = m_pPanel[p].CtrlPt;
+        }
+        x[k] = C[k].x;
+        y[k] = C[k].y;
+        z[k] = C[k].z;
+        if(bGround)
+        {
+            x[n+k] =  C[k].x;
+            y[n+k] =  C[k].y;
+            z[n+k] = -C[k].z-2.0*m_pWPolar->m_Height;
+        }
+    }
 
-    int m, mm;
-    m = mm = 0;
+    for(int jc=0; jc<nCols; jc++)
+    {
+        if(isCancelled()) return;
 
+        int pp = columns.isEmpty() ? jc : columns.at(jc);
 
-    for(p=0; p<m_MatSize; p++)
-    {
-        if(s_bCancel) return;
-        //        if(!m_b3DSymetric || m_pPanel[p].m_bIsLeftPanel)
+        if(m_pPanel[pp].m_Pos==MIDSURFACE)
         {
-            m_uWake[m] = m_wWake[m] = 0.0;
-            C    = m_pPanel[p].CollPt;
-            CC.x =  C.x;//symmetric point, just in case
-            CC.y = -C.y;
-            CC.z =  C.z;
-
-            //____________________________________________________________________________
-            //build the contributions of each wake column at point C
-            //we have m_NWakeColum to consider
-            pw=0;
-            for (kw=0; kw<m_NWakeColumn; kw++)
-            {
-                PHC[kw] = 0.0;
-                VHC[kw].set(0.0,0.0,0.0);
-                //each wake column has m_NXWakePanels
-                for(lw=0; lw<m_pWPolar->m_NXWakePanels; lw++)
-                {
-                    getDoubletInfluence(C, m_pWakePanel+pw, V, phi, true, true);
+            int nPts = bGround ? 2*n : n;
+            memset(vx, 0, ulong(nPts)*sizeof(double));
+            memset(vy, 0, ulong(nPts)*sizeof(double));
+            memset(vz, 0, ulong(nPts)*sizeof(double));
+            m_Vortex.getVelocities(pp, nPts, x, y, z, vx, vy, vz, true);
 
-                    PHC[kw] += phi;
-                    VHC[kw] += V;
+            for(int k=0; k<n; k++)
+            {
+                p = m_bSymmetric ? m_SymIndex[rows[k]] : rows[k];
 
-                    /*                    if(m_b3DSymetric && m_pPanel[p].m_bIsLeftPanel)
-                    {
-                        GetDoubletInfluence(CC,  m_pWakePanel+pw, VS, phiSym, true,true);
-                        PHC[kw]    +=  phiSym;
-                        VHC[kw].x  +=  VS.x;
-                        VHC[kw].y  -=  VS.y;
-                        VHC[kw].z  +=  VS.z;
-                    }*/
-                    pw++;
+                V.set(vx[k], vy[k], vz[k]);
+                if(bGround)
+                {
+                    V.x += vx[n+k];
+                    V.y += vy[n+k];
+                    V.z -= vz[n+k];
                 }
+
+                // the potential of a vortex is not defined, and is set to 0
+                if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE) row[k][pp] = V.dot(m_pPanel[p].Normal);
+                else if(m_pWPolar->bDirichlet())                              row[k][pp] = 0.0;
             }
+            continue;
+        }
 
-            //____________________________________________________________________________
-            //Add the contributions of the trailing panels to the matrix coefficients and to the RHS
-            mm = 0;
-            for(pp=0; pp<m_MatSize; pp++) //for each matrix column
-            {
-                //                if(!m_b3DSymetric || m_pPanel[pp].m_bIsLeftPanel)
-                //                {
-                if(s_bCancel) return;
-                m_aijWake[m*Size+mm] = 0.0;
-                // Is the panel pp shedding a wake ?
-                if(m_pPanel[pp].m_bIsTrailing)
-                {
-                    // If so, we need to add the contributions of the wake column
-                    // shedded by this panel to the RHS and to the Matrix
-                    // Get trailing point where the jup in potential is evaluated v6.02
-                    TrPt = (m_pNode[m_pPanel[pp].m_iTA] + m_pNode[m_pPanel[pp].m_iTB])/2.0;
+        for(int k=0; k<n; k++)
+        {
+            p = m_bSymmetric ? m_SymIndex[rows[k]] : rows[k];
 
-                    if(m_pPanel[pp].m_Pos==MIDSURFACE)
-                    {
-                        //The panel shedding a wake is on a thin surface
-                        if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE)
-                        {
-                            //then add the velocity contribution of the wake column to the matrix coefficient
-                            m_aijWake[m*Size+mm] += VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
-                            //we do not add the term Phi_inf_KWPUM - Phi_inf_KWPLM (eq. 44) since it is 0, thin edge
-                        }
-                        else if(m_pWPolar->bDirichlet())
-                        {
-                            //then add the potential contribution of the wake column to the matrix coefficient
-                            m_aijWake[m*Size+mm] += PHC[m_pPanel[pp].m_iWakeColumn];
-                            //we do not add the term Phi_inf_KWPUM - Phi_inf_KWPLM (eq. 44) since it is 0, thin edge
-                        }
-                    }
-                    else if(m_pPanel[pp].m_Pos==BOTSURFACE)
-                    {
-                        //the panel sedding a wake is on the bottom side, substract
-                        if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE)
-                        {
-                            //use Neumann B.C.
-                            m_aijWake[m*Size+mm] -= VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
-                            //corrected in v6.02;
-                            m_uWake[m] -= TrPt.x  * VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
-                            m_wWake[m] -= TrPt.z  * VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
-                        }
-                        else if(m_pWPolar->bDirichlet())
-                        {
-                            m_aijWake[m*Size+mm] -= PHC[m_pPanel[pp].m_iWakeColumn];
-                            m_uWake[m] +=  TrPt.x * PHC[m_pPanel[pp].m_iWakeColumn];
-                            m_wWake[m] +=  TrPt.z * PHC[m_pPanel[pp].m_iWakeColumn];
-                        }
-                    }
-                    else if(m_pPanel[pp].m_Pos==TOPSURFACE)
-                    {
-                        //the panel sedding a wake is on the top side, add
-                        if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE)
-                        {
-                            //use Neumann B.C.
-                            m_aijWake[m*Size+mm] += VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
-                            //corrected in v6.02;
-                            m_uWake[m] += TrPt.x * VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
-                            m_wWake[m] += TrPt.z * VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
-                        }
-                        else if(m_pWPolar->bDirichlet())
-                        {
-                            m_aijWake[m*Size+mm] += PHC[m_pPanel[pp].m_iWakeColumn];
-                            m_uWake[m] -= TrPt.x * PHC[m_pPanel[pp].m_iWakeColumn];
-                            m_wWake[m] -= TrPt.z * PHC[m_pPanel[pp].m_iWakeColumn];
-                        }
-                    }
-                }
-                mm++;
-                //                }
-            }
-            m++;
+            //for each panel, get the unit doublet or vortex influence at the boundary condition pt
+            getDoubletInfluence(C[k], m_pPanel+pp, V, phi);
+
+            if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE) row[k][pp] = V.dot(m_pPanel[p].Normal);
+            else if(m_pWPolar->bDirichlet())                              row[k][pp] = phi;
         }
-        m_Progress += 1.0/double(m_MatSize);
     }
-
-    delete [] PHC;
-    delete [] VHC;
 }
 
 
 /**
-* In the case of a panel analysis, adds the contribution of the wake columns to the coefficients of the influence matrix
-* Method :
-*     - follow the method described in NASA 4023 eq. (44)
-*    - add the wake's doublet contribution to the matrix
-*    - add the potential difference at the trailing edge panels to the RHS ; the potential's origin
-*     is set arbitrarily to the geometrical orgin so that phi = V.dot(WindDirectio) x point_position
-* Only a flat wake is considered. Wake roll-up has been tested but did not prove robust enough for implementation.
+* Pairs each panel with its image by the XZ symmetry plane, so that in symmetric flow conditions,
+* i.e. without sideslip nor tilted geometry, the linear system can be reduced to the panels of one half of the plane.
+*
+* The geometric pairs are identified by the position of their collocation points.
+* The sign relating the doublet strengths of the two panels of a pair depends on the orientation
+* of their normals; it is determined by comparing the influence of the two panels at mirrored points.
+* The panels which are their own image with an opposite sign, e.g. the VLM panels of a fin in the symmetry plane,
+* have a zero doublet strength and are removed from the system.
+*
+* @return true if the geometry is symmetric and the reduced system may be used, false otherwise.
 */
-void PanelAnalysis::createWakeContribution(double *pWakeContrib, Vector3d WindDirection)
+bool PanelAnalysis::makeSymmetryMap()
 {
-    int kw, lw, pw, p, pp;
-
-    Vector3d V, C, CC, TrPt;
-    double phi;
-    double* PHC = new double[m_NWakeColumn];
-    Vector3d* VHC = new Vector3d[m_NWakeColumn];
-
-    traceLog("      Adding the wake's contribution...\n");
+    if(m_pWPolar->bTilted() || fabs(m_pWPolar->Beta())>PRECISION) return false;
+    if(m_MatSize<=0) return false;
 
-    //    if(m_b3DSymetric) Size = m_SymSize;
-    //    else              Size = m_MatSize;
+    QVector<int> mirror(m_MatSize, -1);
+    m_SymRow.fill(-1, m_MatSize);
+    m_SymSign.fill(1.0, m_MatSize);
+    m_SymIndex.clear();
+    m_SymSize = 0;
 
-    int m, mm;
-    m = mm = 0;
+    // sort the panels by their x-position to accelerate the search of the image panels
+    QVector<int> sorted(m_MatSize);
+    for(int p=0; p<m_MatSize; p++) sorted[p] = p;
+    std::sort(sorted.begin(), sorted.end(), [this](int a, int b){return m_pPanel[a].CollPt.x<m_pPanel[b].CollPt.x;});
 
-    for(p=0; p<m_MatSize; p++)
+    for(int p=0; p<m_MatSize; p++)
     {
-        if(s_bCancel) return;
-        //        if(!m_b3DSymetric || m_pPanel[p].m_bIsLeftPanel)
-        //        {
-        pWakeContrib[m] = 0.0;
-        C    = m_pPanel[p].CollPt;
-        CC.x =  C.x;//symmetric point, just in case
-        CC.y = -C.y;
-        CC.z =  C.z;
+        Vector3d const &C = m_pPanel[p].CollPt;
+        double tol = 1.e-4*m_pPanel[p].Size;
 
-        //____________________________________________________________________________
-        //build the contributions of each wake column at point C
-        //we have m_NWakeColum to consider
-        pw=0;
-        for (kw=0; kw<m_NWakeColumn; kw++)
+        int l=0, r=m_MatSize;
+        while(l<r)
         {
-            PHC[kw] = 0.0;
-            VHC[kw].set(0.0,0.0,0.0);
-            //each wake column has m_NXWakePanels
-            for(lw=0; lw<m_pWPolar->m_NXWakePanels; lw++)
-            {
-                getDoubletInfluence(C, m_pWakePanel+pw, V, phi, true, true);
-
-                PHC[kw] += phi;
-                VHC[kw] += V;
-
-                /*                    if(m_b3DSymetric && m_pPanel[p].m_bIsLeftPanel)
-                    {
-                        GetDoubletInfluence(CC, m_pWakePanel+pw, VS, phiSym, true, true);
-                        PHC[kw]    +=  phiSym;
-                        VHC[kw].x  +=  VS.x;
-                        VHC[kw].y  -=  VS.y;
-                        VHC[kw].z  +=  VS.z;
-                    }*/
-                pw++;
-            }
+            int mid = (l+r)/2;
+            if(m_pPanel[sorted[mid]].CollPt.x<C.x-tol) l = mid+1;
+            else                                       r = mid;
         }
-        //____________________________________________________________________________
-        //Add the contributions to the matrix coefficients and to the RHS
-        mm = 0;
-        for(pp=0; pp<m_MatSize; pp++) //for each matrix column
+        for(int k=l; k<m_MatSize; k++)
         {
-            //                if(!m_b3DSymetric || m_pPanel[pp].m_bIsLeftPanel)
-            //                {
-            if(s_bCancel) return;
-
-            // Is the panel pp shedding a wake ?
-            if(m_pPanel[pp].m_bIsTrailing)
+            Panel const &panel = m_pPanel[sorted[k]];
+            if(panel.CollPt.x>C.x+tol) break;
+            if(fabs(panel.CollPt.y+C.y)<tol && fabs(panel.CollPt.z-C.z)<tol && panel.m_Pos==m_pPanel[p].m_Pos)
             {
-                // Get trailing point where the jump in potential is evaluated
-                TrPt = (m_pNode[m_pPanel[pp].m_iTA] + m_pNode[m_pPanel[pp].m_iTB])/2.0;
-                // If so, we need to add the contributions of the wake column
-                // shedded by this panel to the RHS and to the Matrix
-                if(m_pPanel[pp].m_Pos==MIDSURFACE)
-                {
-                    //The panel shedding a wake is on a thin surface
-                    if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE)
-                    {
-                        //then add the velocity contribution of the wake column to the matrix coefficient
-                        //we do not add the term Phi_inf_KWPUM - Phi_inf_KWPLM (eq. 44) since it is 0, thin edge
-                    }
-                    else if(m_pWPolar->bDirichlet())
-                    {
-                        //then add the potential contribution of the wake column to the matrix coefficient
-                        //we do not add the term Phi_inf_KWPUM - Phi_inf_KWPLM (eq. 44) since it is 0, thin edge
-                    }
-                }
-                else if(m_pPanel[pp].m_Pos==BOTSURFACE)//bottom side, substract
-                {
-                    //evaluate the potential on the bottom side panel pp which is shedding a wake
-                    if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE)
-                    {
-                        //use Neumann B.C.
-                        pWakeContrib[m] -= TrPt.dot(WindDirection) * VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
-                    }
-                    else if(m_pWPolar->bDirichlet())
-                    {
-                        pWakeContrib[m] += TrPt.dot(WindDirection) * PHC[m_pPanel[pp].m_iWakeColumn];
-                    }
-                }
-                else if(m_pPanel[pp].m_Pos==TOPSURFACE)  //top side, add
-                {
-                    //evaluate the potential on the top side panel pp which is shedding a wake
-                    if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE)
-                    {
-                        //use Neumann B.C.
-                        pWakeContrib[m] += TrPt.dot(WindDirection) * VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
-                    }
-                    else if(m_pWPolar->bDirichlet())
-                    {
-                        pWakeContrib[m] -= TrPt.dot(WindDirection) * PHC[m_pPanel[pp].m_iWakeColumn];
-                    }
-                }
+                mirror[p] = sorted[k];
+                break;
             }
-            mm++;
-            //                }
         }
-        m++;
-        //        }
-        m_Progress += 1.0/(double)m_MatSize;
+        if(mirror[p]<0) return false;
     }
 
-    delete [] PHC;
-    delete [] VHC;
-}
-
-
-/**
-* This method performs the computation in the far-field (Trefftz) plane.
-* For each of the wings, calculates, the resulting Force vector and induced drag, and the coefficients for each chordwise strip.
-* The calculations are made based on the source and doublet strengths or on the vortex circulations which have been previously computed.
-* The results are used a first time to calculate the balance velocities, and a second time for the calculation of aero coefficients
-* @param QInf the freestream velocity
-* @param Alpha0 the first aoa in the sequence
-* @param AlphaDelta the aoa increment
-* @param nval the number of aoa in the sequence
-*/
-void PanelAnalysis::computeFarField(double QInf, double Alpha0, double AlphaDelta, int nval)
-{
-    QString strong;
-    int q, pos;
-    double alpha, IDrag, *Mu, *Sigma;
-    double ThinSize = 0.0;
-    Vector3d WindNormal, WingForce;
-
-    traceLog("      Calculating aerodynamic coefficients in the far field plane\n");
-
-    for(int iw=0; iw<MAXWINGS; iw++)
+    // returns +1 or -1 if the field (Vq, phiq) at the image point is the image of the field (Vp, phip), 0 otherwise
+    auto imageSign = [](Vector3d const &Vp, double phip, Vector3d const &Vq, double phiq)
     {
-        if(m_pWingList[iw]) ThinSize += (double)m_pWingList[iw]->m_MatSize;
-    }
+        double scale    = Vp.VAbs() + fabs(phip);
+        double errPlus  = fabs(Vq.x-Vp.x) + fabs(Vq.y+Vp.y) + fabs(Vq.z-Vp.z) + fabs(phiq-phip);
+        double errMinus = fabs(Vq.x+Vp.x) + fabs(Vq.y-Vp.y) + fabs(Vq.z+Vp.z) + fabs(phiq+phip);
+        if(errPlus<=1.e-6*scale)  return  1.0;
+        if(errMinus<=1.e-6*scale) return -1.0;
+        return 0.0;
+    };
 
-    for (q=0; q<nval;q++)
+    Vector3d X, XS, Vp, Vq, V;
+    double phip=0.0, phiq=0.0, phi=0.0;
+    int nZero = 0;
+    for(int p=0; p<m_MatSize; p++)
     {
-        //        qDebug()<<"OpAlpha"<<m_OpAlpha<<"Alpha0"<<Alpha0;
-        if(m_pWPolar->bTilted()) alpha = m_OpAlpha;
-        else
+        int q = mirror[p];
+        if(mirror[q]!=p || m_pPanel[q].m_bIsTrailing!=m_pPanel[p].m_bIsTrailing) return false;
+        if(q<p) continue;
+
+        Vector3d const &Np = m_pPanel[p].Normal;
+        Vector3d const &Nq = m_pPanel[q].Normal;
+        if(m_pPanel[p].m_Pos!=MIDSURFACE && fabs(Nq.x-Np.x)+fabs(Nq.y+Np.y)+fabs(Nq.z-Np.z)>1.e-6)
         {
-            if(m_pWPolar->polarType()==XFLR5::FIXEDAOAPOLAR)       alpha = m_OpAlpha;
-            else if(m_pWPolar->polarType()==XFLR5::BETAPOLAR)      alpha = m_OpAlpha;
-            //            else if(m_pWPolar->polarType()==XFLR5::STABILITYPOLAR) alpha = m_OpAlpha;
-            else if(fabs(m_pWPolar->Beta())>PRECISION)             alpha = m_OpAlpha;
-            else                                                   alpha = Alpha0 + q*AlphaDelta;
+            // the source strengths on thick surfaces would not be symmetric
+            return false;
         }
-        WindNormal.set(-sin(alpha*PI/180.0), 0.0, cos(alpha*PI/180.0));
 
-        pos = 0;
-        Mu     = m_Mu    + q*m_MatSize;
-        Sigma  = m_Sigma + q*m_MatSize;
+        // compare the influence of panel p at an arbitrary point with the influence of panel q at the image point
+        double d = m_pPanel[p].Size;
+        X.set(m_pPanel[p].CollPt.x + 0.31*d, m_pPanel[p].CollPt.y + 0.17*d, m_pPanel[p].CollPt.z + 0.23*d);
+        XS.set(X.x, -X.y, X.z);
+        getDoubletInfluence(X,  m_pPanel+p, Vp, phip);
+        getDoubletInfluence(XS, m_pPanel+q, Vq, phiq);
 
-        strong = "        Calculating point " + QString("%1").arg(alpha,7,'f',2)+QString::fromUtf8("°....\n");
-        traceLog(strong);
+        double sign = imageSign(Vp, phip, Vq, phiq);
+        if(sign==0.0) return false;
 
-        for(int iw=0; iw<MAXWINGS; iw++)
+        if(!m_pWPolar->bThinSurfaces() && m_pPanel[p].m_bIsTrailing)
         {
-            if(m_pWingList[iw])
+            // the wake columns shed by the two panels must have the same symmetry
+            Vp.set(0.0,0.0,0.0);
+            Vq.set(0.0,0.0,0.0);
+            phip = phiq = 0.0;
+            for(int lw=0; lw<m_pWPolar->m_NXWakePanels; lw++)
             {
-                WingForce.set(0.0, 0.0, 0.0);
-                panelTrefftz(m_pWingList[iw], QInf, alpha, Mu, Sigma, pos, WingForce, IDrag, m_pWPolar, m_pWakePanel, m_pWakeNode);
-
-                //save the results... will save another FF calculation when computing operating point
-                m_WingForce[q*MAXWINGS+iw] = WingForce;  // N/q
-                m_WingIDrag[q*MAXWINGS+iw] = IDrag;
-
-                memcpy(m_Cl  + (q*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_Cl,  m_pWingList[iw]->m_NStation*sizeof(double));
-                memcpy(m_ICd + (q*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_ICd, m_pWingList[iw]->m_NStation*sizeof(double));
-                memcpy(m_Ai  + (q*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_Ai,  m_pWingList[iw]->m_NStation*sizeof(double));
-                memcpy(m_F   + (q*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_F,   m_pWingList[iw]->m_NStation*sizeof(Vector3d));
-                memcpy(m_Vd  + (q*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_Vd,  m_pWingList[iw]->m_NStation*sizeof(Vector3d));
-
-                pos += m_pWingList[iw]->m_MatSize;
-
-                m_Progress += 10.0 * (double)m_pWingList[iw]->m_MatSize/ThinSize *(double)m_MatSize/400.;
-                if(s_bCancel)return;
+                getDoubletInfluence(X,  m_pWakePanel + m_pPanel[p].m_iWakeColumn*m_pWPolar->m_NXWakePanels + lw, V, phi, true, true);
+                Vp += V;
+                phip += phi;
+                getDoubletInfluence(XS, m_pWakePanel + m_pPanel[q].m_iWakeColumn*m_pWPolar->m_NXWakePanels + lw, V, phi, true, true);
+                Vq += V;
+                phiq += phi;
             }
+            if(imageSign(Vp, phip, Vq, phiq)!=sign) return false;
+        }
+
+        if(q==p && sign<0.0)
+        {
+            // the strength is antisymmetric on a panel which is its own image, hence zero
+            nZero++;
+            continue;
         }
+        m_SymRow[p] = m_SymRow[q] = m_SymIndex.size();
+        m_SymSign[q] = sign;
+        m_SymIndex.append(p);
+    }
+    m_SymSize = m_SymIndex.size();
+
+    QString strange;
+    strange = QString("      Using the XZ-plane symmetry: solving for %1 unknowns instead of %2\n").arg(m_SymSize).arg(m_MatSize);
+    traceLog(strange);
+    if(nZero)
+    {
+        strange = QString("      %1 panels in the symmetry plane have zero doublet strength\n").arg(nZero);
+        traceLog(strange);
     }
+
+    return true;
 }
 
 
 /**
-* In the case of Type 2 or Type 7 polars, computes the velocity for which the lift force balances the plane's weight.
-* Assumes the lift force on each lifting wing has been calculated for a unit velocity.
-* @param Alpha the angle of attack to calculate
-* @param q the index of the aoa in the sequence
+* Folds a full row of the influence matrix into a row of the reduced system, by adding
+* the coefficients of the two panels of each symmetric pair with the sign of their doublet strengths.
+*@param row a pointer to the full row, of size m_MatSize
+*@param symRow a pointer to the reduced row, of size m_SymSize
 */
-void PanelAnalysis::computeBalanceSpeeds(double Alpha, int q)
+void PanelAnalysis::foldSymmetricRow(double const *row, double *symRow)
 {
-    QString strong;
-    Vector3d Force, WindNormal;
-    double TempCl,Lift;
-    WindNormal.set(-sin(Alpha*PI/180.0),   0.0, cos(Alpha*PI/180.0));
-
-    Force.set(0.0,0.0,0.0);
-
-    for(int iw=0; iw<MAXWINGS; iw++)
-    {
-        if(m_pWingList[iw]) Force += m_WingForce[q*MAXWINGS+iw];
-    }
-    if (m_pWPolar->isFixedSpeedPolar() || m_pWPolar->isBetaPolar())
+    memset(symRow, 0, ulong(m_SymSize)*sizeof(double));
+    for(int pp=0; pp<m_MatSize; pp++)
     {
-        m_3DQInf[q] = m_pWPolar->m_QInfSpec;
+        if(m_SymRow[pp]>=0) symRow[m_SymRow[pp]] += m_SymSign[pp]*row[pp];
     }
-    else if(m_pWPolar->isFixedLiftPolar())
+}
+
+
+/**
+* Expands the solution of the reduced system to all the panels.
+*@param symX a pointer to the solution of the reduced system, of size m_SymSize
+*@param X a pointer to the solution array for all the panels, of size m_MatSize
+*/
+void PanelAnalysis::expandSymmetricSolution(double const *symX, double *X)
+{
+    for(int p=0; p<m_MatSize; p++)
     {
-        Lift =  Force.dot(WindNormal) ;      //N/q, for 1/ms
-        TempCl = Lift/m_pWPolar->referenceArea();
-        if(Lift<=0.0)
-        {
-            strong = "           "+QString("Found a negative lift for Alpha=%1.... skipping the angle...\n").arg(Alpha, 5,'f',2);
-            traceLog(strong);
-            m_bPointOut = true;
-            s_bWarning  = true;
-            m_3DQInf[q] = -100.0;
-        }
-        else
-        {
-            m_3DQInf[q] =  sqrt(2.0* 9.81 * m_Mass/m_pWPolar->density()/TempCl/m_pWPolar->referenceArea());
-            strong = QString("           Alpha=%1   QInf=%2m/s").arg(Alpha, 5,'f',2).arg(m_3DQInf[q],5,'f',2);
-            strong+="\n";
-            traceLog(strong);
-        }
+        if(m_SymRow[p]>=0) X[p] = m_SymSign[p]*symX[m_SymRow[p]];
+        else               X[p] = 0.0;
     }
 }
 
 
 /**
-* Scales the unit results using the specified freestream velocity.
-* The velocity may have been specified directly in the case of a type 1 polar, or may have been calculated to balance the plane's weight.
-* The velocity for each aoa are provided in the member variable array m_3DQInf
-* @param nval the number of aoa in the sequence
+ * Creates the source strengths for all requested RHS in a Panel analysis, using the specified boundary conditions (BC).
+ * BC may be of the Neumann or Dirichlet type depending on the analysis type and on the geometry
+ *
+ * Uses NASA 4023 equation (20) & (22)
+ *
+ * The computation is performed for a unit speed. The results are scaled to speed later depending on the polar type.
+ *
+ *@param Alpha0 the first aoa in the sequence
+ *@param AlphaDeltathe aoa increment
+ *@param the total number of aoa and of source arrays to build
 */
-void PanelAnalysis::scaleResultstoSpeed(int nval)
+void PanelAnalysis::createSourceStrength(double Alpha0, double AlphaDelta, int nval)
 {
-    int p, q, pp;
-    //______________________________________________________________________________________
-    // Scale RHS and Sigma i.a.w. speeds (so far we have unit doublet and source strengths)
+    int p, pp, q;
+    double alpha;
+    Vector3d WindDirection;
 
-    QString strong="\n";
-    traceLog(strong);
+    traceLog("      Creating source strengths...\n");
 
-    memcpy(m_SigmaRef, m_Sigma, nval*m_MatSize*sizeof(double));
-    memcpy(m_RHSRef,   m_Mu,    nval*m_MatSize*sizeof(double));
+    p=0;
+    for (q=0; q<nval;q++)
+    {
+        alpha = Alpha0+q*AlphaDelta;
+        WindDirection.set(cos(alpha*PI/180.0), 0.0, sin(alpha*PI/180.0));
 
-    if(m_pWPolar->polarType()!=XFLR5::FIXEDAOAPOLAR)
+        for (pp=0; pp<m_MatSize; pp++)
+        {
+            if(isCancelled()) return;
+            if(m_pPanel[pp].m_Pos!=MIDSURFACE) m_Sigma[p] = -1.0/4.0/PI* WindDirection.dot(m_pPanel[pp].Normal);
+            else                               m_Sigma[p] =  0.0;
+            p++;
+        }
+    }
+}
+
+
+/**
+* Creates a RHS vector array for a given field of velocity vectors.
+* If the input pointer VField is NULL, a uniform field of freestream velocities is considered.
+* If the pointer is not NULL, it points to an array of velocity vectors on the panels. Used for evaluating the stability derivatives for the rotation dof.
+* @param RHS A pointer to the RHS to build
+* @param VField a pointer to the array of the freesteam velocity vectors on the panels.
+* @param VInf the freestream velocity vector
+*/
+void PanelAnalysis::createRHS(double *RHS, Vector3d VInf, double *VField)
+{
+    createRHS(1, &RHS, &VInf, VField ? &VField : nullptr);
+}
+
+
+/**
+* Creates several RHS vector arrays in a single pass on the panels.
+* The source influences, which are the costly part of the RHS for thick surfaces, are
+* evaluated once for all the RHS. The rows are built by tiles of PANELTILESIZE rows, which
+* are dispatched to the global thread pool in multithreaded mode as in buildInfluenceMatrix().
+* @param nRHS the number of RHS to build
+* @param RHS the array of pointers to the RHS to build
+* @param VInf the array of freestream velocity vectors, one for each RHS
+* @param VField NULL if all the velocity fields are uniform, or an array of pointers to the velocity fields on the panels, one for each RHS;
+* a NULL pointer in this array indicates a uniform field
+*/
+void PanelAnalysis::createRHS(int nRHS, double **RHS, Vector3d const *VInf, double **VField)
+{
+    int nTiles = (m_MatSize+PANELTILESIZE-1)/PANELTILESIZE;
+
+    if(!s_bMultiThread)
     {
-        p=0;
-        for (q=0; q<nval;q++)
+        for(int it=0; it<nTiles; it++)
         {
-            for(pp=0; pp<m_MatSize; pp++)
-            {
-                m_Mu[p]     *= m_3DQInf[q];
-                m_Sigma[p]  *= m_3DQInf[q];
-                p++;
-            }
+            if(isCancelled()) return;
+            int p0 = it*PANELTILESIZE;
+            int p1 = qMin(p0+PANELTILESIZE, m_MatSize);
+            createRHSTile(nRHS, RHS, VInf, VField, p0, p1);
+            m_Progress += 5.0*double(nRHS*(p1-p0))/double(m_MatSize);
         }
+        return;
     }
-    else
+
+    int nBatch = qMax(1, 4*QThreadPool::globalInstance()->maxThreadCount());
+    QVector<int> tiles;
+    for(int it0=0; it0<nTiles; it0+=nBatch)
     {
-        //type 4, we scale the first single rhs for all specified speed values
-        p=0;
-        for (q=0; q<nval;q++)
+        if(isCancelled()) return;
+
+        tiles.clear();
+        for(int it=it0; it<qMin(it0+nBatch, nTiles); it++) tiles.append(it);
+
+        QtConcurrent::blockingMap(tiles, [this, nRHS, RHS, VInf, VField](int const &it)
         {
-            for(pp=0; pp<m_MatSize; pp++)
+            if(isCancelled()) return;
+            createRHSTile(nRHS, RHS, VInf, VField, it*PANELTILESIZE, qMin((it+1)*PANELTILESIZE, m_MatSize));
+        });
+
+        int nRows = qMin(tiles.last()*PANELTILESIZE+PANELTILESIZE, m_MatSize) - tiles.first()*PANELTILESIZE;
+        m_Progress += 5.0*double(nRHS*nRows)/double(m_MatSize);
+    }
+}
+
+
+/**
+* Builds the rows p0 to p1-1 of several RHS vector arrays.
+* @param nRHS the number of RHS to build
+* @param RHS the array of pointers to the RHS to build
+* @param VInf the array of freestream velocity vectors, one for each RHS
+* @param VField NULL or an array of pointers to the velocity fields on the panels, one for each RHS
+* @param p0 the index of the first row
+* @param p1 the index of the row past the last row of the tile
+*/
+void PanelAnalysis::createRHSTile(int nRHS, double **RHS, Vector3d const *VInf, double **VField, int p0, int p1)
+{
+    double  phi, sigmapp, coef;
+    Vector3d V, C;
+    QVarLengthArray<Vector3d, 8> VPanel(nRHS);
+
+    for (int p=p0; p<p1; p++)
+    {
+        if(isCancelled()) return;
+
+        if(m_bSymmetric && !isSymmetryRow(p))
+        {
+            // the row is not part of the reduced system
+            for(int r=0; r<nRHS; r++) RHS[r][p] = 0.0;
+            continue;
+        }
+
+        bool bNeumann = !m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE;
+
+        for(int r=0; r<nRHS; r++)
+        {
+            if(VField && VField[r])
             {
-                m_Mu[p]    = m_RHSRef[pp]   * m_3DQInf[q];
-                m_Sigma[p] = m_SigmaRef[pp] * m_3DQInf[q];
-                p++;
+                VPanel[r].x = *(VField[r]             +p);
+                VPanel[r].y = *(VField[r]+  m_MatSize +p);
+                VPanel[r].z = *(VField[r]+2*m_MatSize +p);
             }
+            else VPanel[r] = VInf[r];
+
+            // first term of RHS is -V.n
+            if(bNeumann) RHS[r][p] = - m_pPanel[p].Normal.dot(VPanel[r]);
+            else         RHS[r][p] = 0.0;
         }
-    }
 
-    //scale the strip force and downwash fields
-    if(m_pWPolar->polarType()!=XFLR5::FIXEDAOAPOLAR)
-    {
-        for (q=0; q<nval;q++)
+        if(m_pPanel[p].m_Pos!=MIDSURFACE) C = m_pPanel[p].CollPt;
+        else                              C = m_pPanel[p].CtrlPt;
+
+        for (int pp=0; pp<m_MatSize; pp++)
         {
-            for(int iw=0; iw<MAXWINGS; iw++)
+            // Consider only the panels positioned on thick surfaces,
+            // since the source strength is zero on thin surfaces
+            if(m_pPanel[pp].m_Pos!=MIDSURFACE)
             {
-                if(m_pWingList[iw])
+                // Get the source influence of panel pp on panel p, once for all the RHS
+                getSourceInfluence(C, m_pPanel+pp, V, phi);
+
+                // Apply Neumann B.C., NASA4023 eq. (22) and (23): the RHS term is sigma[pp]*DJK = nj.Vjk
+                // or Dirichlet B.C., NASA4023 eq. (20)
+                if(bNeumann) coef = V.dot(m_pPanel[p].Normal);
+                else         coef = phi;
+
+                for(int r=0; r<nRHS; r++)
                 {
-                    for(int m=0; m<m_pWingList[iw]->m_NStation; m++)
-                    {
-                        m_F[ m+ (q*MAXWINGS+iw)*m_NSpanStations] *= m_3DQInf[q] * m_3DQInf[q];
-                        m_Vd[m+ (q*MAXWINGS+iw)*m_NSpanStations] *= m_3DQInf[q] ;
-                    }
+                    // Define the source strength on panel pp
+                    sigmapp = -1.0/4.0/PI * m_pPanel[pp].Normal.dot(VPanel[r]);
+                    RHS[r][p] -= coef * sigmapp;
                 }
             }
         }
     }
+}
+
+
+/**
+*Builds the two unit RHS for freestream velocities directed along x and z
+*/
+void PanelAnalysis::createUnitRHS()
+{
+    traceLog("      Creating the unit RHS vectors...\n");
+
+    Vector3d VInf[] = {Vector3d(1.0, 0.0, 0.0), Vector3d(0.0, 0.0, 1.0)};
+    double *RHS[] = {m_uRHS, m_wRHS};
+    createRHS(2, RHS, VInf);
+}
+
+
+/**
+* In the case of a panel analysis, adds the contribution of the wake columns to the coefficients of the influence matrix
+* Method :
+*     - follow the method described in NASA 4023 eq. (44)
+*    - add the wake's doublet contribution to the matrix
+*    - add the difference in potential at the trailing edge panels to the RHS
+* Only a flat wake is considered. Wake roll-up has been tested but did not prove robust enough for implementation.
+* The rows are calculated by tiles of PANELTILESIZE rows distributed on the threads of the global pool.
+*/
+void PanelAnalysis::createWakeContribution()
+{
+    traceLog("      Adding the wake's contribution...\n");
+
+    // in the symmetric case, the full rows are built in a temporary array and folded in the reduced matrix;
+    // with the iterative and the mixed precision solvers, the wake's coefficients are not stored
+    bool bStoreWake = !m_bIterative && !m_bSinglePrecision;
+
+    int nTiles = (m_MatSize+PANELTILESIZE-1)/PANELTILESIZE;
+    auto buildTile = [this, bStoreWake](int const &it)
+    {
+        QVector<double> tmpRow;
+        if(m_bSymmetric || !bStoreWake) tmpRow.resize(m_MatSize);
+
+        int p0 = it*PANELTILESIZE;
+        for(int p=p0; p<qMin(p0+PANELTILESIZE, m_MatSize); p++)
+        {
+            if(isCancelled()) return;
+            m_uWake[p] = m_wWake[p] = 0.0;
+            // the row is not part of the reduced system
+            if(m_bSymmetric && !isSymmetryRow(p)) continue;
+
+            double *aijWake = (m_bSymmetric || !bStoreWake) ? tmpRow.data() : m_aijWake+p*m_MatSize;
+            wakeContributionRow(p, aijWake, m_uWake[p], m_wWake[p]);
+
+            if(m_bSymmetric && bStoreWake) foldSymmetricRow(aijWake, m_aijWake+m_SymRow[p]*m_SymSize);
+        }
+    };
+
+    if(s_bMultiThread)
+    {
+        QVector<int> tiles(nTiles);
+        for(int it=0; it<nTiles; it++) tiles[it] = it;
+        QtConcurrent::blockingMap(tiles, buildTile);
+    }
     else
     {
-        for (q=0; q<nval;q++)
+        for(int it=0; it<nTiles; it++) buildTile(it);
+    }
+    m_Progress += 1.0;
+}
+
+
+/**
+* Calculates the contribution of the wake columns to the row of the influence matrix and to the RHS for one panel.
+*@param p the index of the panel
+*@param aijWake a pointer to the full row, of size m_MatSize, in which the wake's coefficients are written
+*@param uWake the contribution to the RHS for the unit x-velocity
+*@param wWake the contribution to the RHS for the unit z-velocity
+*/
+void PanelAnalysis::wakeContributionRow(int p, double *aijWake, double &uWake, double &wWake)
+{
+    QVarLengthArray<double, 256> PHC(m_NWakeColumn);
+    QVarLengthArray<Vector3d, 256> VHC(m_NWakeColumn);
+
+    //____________________________________________________________________________
+    //build the contributions of each wake column at point C
+    //we have m_NWakeColum to consider
+    for (int kw=0; kw<m_NWakeColumn; kw++)
+        wakeColumnInfluence(m_pPanel[p].CollPt, kw, PHC[kw], VHC[kw]);
+
+    assembleWakeRow(p, PHC.constData(), VHC.constData(), aijWake, uWake, wWake);
+}
+
+
+/**
+* Calculates the potential and the velocity induced at a point by the unit doublet strength of a wake column.
+*@param C the point where the influence is evaluated
+*@param kw the index of the wake column
+*@param phi the resulting potential
+*@param V the resulting velocity
+*/
+void PanelAnalysis::wakeColumnInfluence(Vector3d const &C, int kw, double &phi, Vector3d &V)
+{
+    Vector3d VW;
+    double phiW=0;
+
+    phi = 0.0;
+    V.set(0.0,0.0,0.0);
+
+    //each wake column has m_NXWakePanels
+    int pw = kw * m_pWPolar->m_NXWakePanels;
+    for(int lw=0; lw<m_pWPolar->m_NXWakePanels; lw++)
+    {
+        getDoubletInfluence(C, m_pWakePanel+pw, VW, phiW, true, true);
+        phi += phiW;
+        V   += VW;
+        pw++;
+    }
+}
+
+
+/**
+* Adds the contributions of the wake columns to the row of the influence matrix and to the RHS for one panel,
+* given the influence of each wake column at the panel's collocation point.
+*@param p the index of the panel
+*@param PHC the potential induced by each wake column at the panel's collocation point
+*@param VHC the velocity induced by each wake column at the panel's collocation point
+*@param aijWake a pointer to the full row, of size m_MatSize, in which the wake's coefficients are written
+*@param uWake the contribution to the RHS for the unit x-velocity
+*@param wWake the contribution to the RHS for the unit z-velocity
+*/
+void PanelAnalysis::assembleWakeRow(int p, double const *PHC, Vector3d const *VHC, double *aijWake, double &uWake, double &wWake)
+{
+    Vector3d TrPt;
+
+    uWake = wWake = 0.0;
+
+    //____________________________________________________________________________
+    //Add the contributions of the trailing panels to the matrix coefficients and to the RHS
+    for(int pp=0; pp<m_MatSize; pp++) //for each matrix column
+    {
+        if(isCancelled()) return;
+        aijWake[pp] = 0.0;
+        // Is the panel pp shedding a wake ?
+        if(m_pPanel[pp].m_bIsTrailing)
         {
-            for(int iw=0; iw<MAXWINGS; iw++)
+            // If so, we need to add the contributions of the wake column
+            // shedded by this panel to the RHS and to the Matrix
+            // Get trailing point where the jup in potential is evaluated v6.02
+            TrPt = (m_pNode[m_pPanel[pp].m_iTA] + m_pNode[m_pPanel[pp].m_iTB])/2.0;
+
+            if(m_pPanel[pp].m_Pos==MIDSURFACE)
             {
-                if(m_pWingList[iw])
+                //The panel shedding a wake is on a thin surface
+                if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE)
                 {
-                    for(int m=0; m<m_pWingList[iw]->m_NStation; m++)
-                    {
-                        m_F[ m+ (q*MAXWINGS+iw)*m_NSpanStations] = m_F[ m] * m_3DQInf[q] * m_3DQInf[q];
-                        m_Vd[m+ (q*MAXWINGS+iw)*m_NSpanStations] = m_Vd[m] * m_3DQInf[q];
-                    }
-                    m_WingForce[q*MAXWINGS+iw] = m_WingForce[iw];
-                    m_WingIDrag[q*MAXWINGS+iw] = m_WingIDrag[iw];
+                    //then add the velocity contribution of the wake column to the matrix coefficient
+                    aijWake[pp] += VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
+                    //we do not add the term Phi_inf_KWPUM - Phi_inf_KWPLM (eq. 44) since it is 0, thin edge
+                }
+                else if(m_pWPolar->bDirichlet())
+                {
+                    //then add the potential contribution of the wake column to the matrix coefficient
+                    aijWake[pp] += PHC[m_pPanel[pp].m_iWakeColumn];
+                    //we do not add the term Phi_inf_KWPUM - Phi_inf_KWPLM (eq. 44) since it is 0, thin edge
+                }
+            }
+            else if(m_pPanel[pp].m_Pos==BOTSURFACE)
+            {
+                //the panel sedding a wake is on the bottom side, substract
+                if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE)
+                {
+                    //use Neumann B.C.
+                    aijWake[pp] -= VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
+                    //corrected in v6.02;
+                    uWake -= TrPt.x  * VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
+                    wWake -= TrPt.z  * VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
+                }
+                else if(m_pWPolar->bDirichlet())
+                {
+                    aijWake[pp] -= PHC[m_pPanel[pp].m_iWakeColumn];
+                    uWake +=  TrPt.x * PHC[m_pPanel[pp].m_iWakeColumn];
+                    wWake +=  TrPt.z * PHC[m_pPanel[pp].m_iWakeColumn];
+                }
+            }
+            else if(m_pPanel[pp].m_Pos==TOPSURFACE)
+            {
+                //the panel sedding a wake is on the top side, add
+                if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE)
+                {
+                    //use Neumann B.C.
+                    aijWake[pp] += VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
+                    //corrected in v6.02;
+                    uWake += TrPt.x * VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
+                    wWake += TrPt.z * VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
+                }
+                else if(m_pWPolar->bDirichlet())
+                {
+                    aijWake[pp] += PHC[m_pPanel[pp].m_iWakeColumn];
+                    uWake -= TrPt.x * PHC[m_pPanel[pp].m_iWakeColumn];
+                    wWake -= TrPt.z * PHC[m_pPanel[pp].m_iWakeColumn];
                 }
             }
         }
     }
+}
+
+
+/**
+* In the case of a panel analysis, adds the contribution of the wake columns to the coefficients of the influence matrix
+* Method :
+*     - follow the method described in NASA 4023 eq. (44)
+*    - add the wake's doublet contribution to the matrix
+*    - add the potential difference at the trailing edge panels to the RHS ; the potential's origin
+*     is set arbitrarily to the geometrical orgin so that phi = V.dot(WindDirectio) x point_position
+* Only a flat wake is considered. Wake roll-up has been tested but did not prove robust enough for implementation.
+*/
+void PanelAnalysis::createWakeContribution(double *pWakeContrib, Vector3d WindDirection)
+{
+    int kw, lw, pw, p, pp;
+
+    Vector3d V, C, CC, TrPt;
+    double phi;
+    double* PHC = new double[m_NWakeColumn];
+    Vector3d* VHC = new Vector3d[m_NWakeColumn];
+
+    traceLog("      Adding the wake's contribution...\n");
+
+    //    if(m_b3DSymetric) Size = m_SymSize;
+    //    else              Size = m_MatSize;
+
+    int m, mm;
+    m = mm = 0;
+
+    for(p=0; p<m_MatSize; p++)
+    {
+        if(isCancelled()) return;
+        //        if(!m_b3DSymetric || m_pPanel[p].m_bIsLeftPanel)
+        //        {
+        pWakeContrib[m] = 0.0;
+        C    = m_pPanel[p].CollPt;
+        CC.x =  C.x;//symmetric point, just in case
+        CC.y = -C.y;
+        CC.z =  C.z;
+
+        //____________________________________________________________________________
+        //build the contributions of each wake column at point C
+        //we have m_NWakeColum to consider
+        pw=0;
+        for (kw=0; kw<m_NWakeColumn; kw++)
+        {
+            PHC[kw] = 0.0;
+            VHC[kw].set(0.0,0.0,0.0);
+            //each wake column has m_NXWakePanels
+            for(lw=0; lw<m_pWPolar->m_NXWakePanels; lw++)
+            {
+                getDoubletInfluence(C, m_pWakePanel+pw, V, phi, true, true);
+
+                PHC[kw] += phi;
+                VHC[kw] += V;
+
+                /*                    if(m_b3DSymetric && m_pPanel[p].m_bIsLeftPanel)
+                    {
+                        GetDoubletInfluence(CC, m_pWakePanel+pw, VS, phiSym, true, true);
+                        PHC[kw]    +=  phiSym;
+                        VHC[kw].x  +=  VS.x;
+                        VHC[kw].y  -=  VS.y;
+                        VHC[kw].z  +=  VS.z;
+                    }*/
+                pw++;
+            }
+        }
+        //____________________________________________________________________________
+        //Add the contributions to the matrix coefficients and to the RHS
+        mm = 0;
+        for(pp=0; pp<m_MatSize; pp++) //for each matrix column
+        {
+            //                if(!m_b3DSymetric || m_pPanel[pp].m_bIsLeftPanel)
+            //                {
+            if(isCancelled()) return;
+
+            // Is the panel pp shedding a wake ?
+            if(m_pPanel[pp].m_bIsTrailing)
+            {
+                // Get trailing point where the jump in potential is evaluated
+                TrPt = (m_pNode[m_pPanel[pp].m_iTA] + m_pNode[m_pPanel[pp].m_iTB])/2.0;
+                // If so, we need to add the contributions of the wake column
+                // shedded by this panel to the RHS and to the Matrix
+                if(m_pPanel[pp].m_Pos==MIDSURFACE)
+                {
+                    //The panel shedding a wake is on a thin surface
+                    if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE)
+                    {
+                        //then add the velocity contribution of the wake column to the matrix coefficient
+                        //we do not add the term Phi_inf_KWPUM - Phi_inf_KWPLM (eq. 44) since it is 0, thin edge
+                    }
+                    else if(m_pWPolar->bDirichlet())
+                    {
+                        //then add the potential contribution of the wake column to the matrix coefficient
+                        //we do not add the term Phi_inf_KWPUM - Phi_inf_KWPLM (eq. 44) since it is 0, thin edge
+                    }
+                }
+                else if(m_pPanel[pp].m_Pos==BOTSURFACE)//bottom side, substract
+                {
+                    //evaluate the potential on the bottom side panel pp which is shedding a wake
+                    if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE)
+                    {
+                        //use Neumann B.C.
+                        pWakeContrib[m] -= TrPt.dot(WindDirection) * VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
+                    }
+                    else if(m_pWPolar->bDirichlet())
+                    {
+                        pWakeContrib[m] += TrPt.dot(WindDirection) * PHC[m_pPanel[pp].m_iWakeColumn];
+                    }
+                }
+                else if(m_pPanel[pp].m_Pos==TOPSURFACE)  //top side, add
+                {
+                    //evaluate the potential on the top side panel pp which is shedding a wake
+                    if(!m_pWPolar->bDirichlet() || m_pPanel[p].m_Pos==MIDSURFACE)
+                    {
+                        //use Neumann B.C.
+                        pWakeContrib[m] += TrPt.dot(WindDirection) * VHC[m_pPanel[pp].m_iWakeColumn].dot(m_pPanel[p].Normal);
+                    }
+                    else if(m_pWPolar->bDirichlet())
+                    {
+                        pWakeContrib[m] -= TrPt.dot(WindDirection) * PHC[m_pPanel[pp].m_iWakeColumn];
+                    }
+                }
+            }
+            mm++;
+            //                }
+        }
+        m++;
+        //        }
+        m_Progress += 1.0/(double)m_MatSize;
+    }
+
+    delete [] PHC;
+    delete [] VHC;
+}
+
+
+/**
+* This method performs the computation in the far-field (Trefftz) plane.
+* For each of the wings, calculates, the resulting Force vector and induced drag, and the coefficients for each chordwise strip.
+* The calculations are made based on the source and doublet strengths or on the vortex circulations which have been previously computed.
+* The results are used a first time to calculate the balance velocities, and a second time for the calculation of aero coefficients
+* @param QInf the freestream velocity
+* @param Alpha0 the first aoa in the sequence
+* @param AlphaDelta the aoa increment
+* @param nval the number of aoa in the sequence
+*/
+void PanelAnalysis::computeFarField(double QInf, double Alpha0, double AlphaDelta, int nval)
+{
+    QString strong;
+    int q, pos;
+    double alpha, IDrag, *Mu, *Sigma;
+    double ThinSize = 0.0;
+    Vector3d WindNormal, WingForce;
+
+    traceLog("      Calculating aerodynamic coefficients in the far field plane\n");
+
+    for(int iw=0; iw<MAXWINGS; iw++)
+    {
+        if(m_pWingList[iw]) ThinSize += (double)m_pWingList[iw]->m_MatSize;
+    }
+
+    for (q=0; q<nval;q++)
+    {
+        //        qDebug()<<"OpAlpha"<<m_OpAlpha<<"Alpha0"<<Alpha0;
+        if(m_pWPolar->bTilted()) alpha = m_OpAlpha;
+        else
+        {
+            if(m_pWPolar->polarType()==XFLR5::FIXEDAOAPOLAR)       alpha = m_OpAlpha;
+            else if(m_pWPolar->polarType()==XFLR5::BETAPOLAR)      alpha = m_OpAlpha;
+            //            else if(m_pWPolar->polarType()==XFLR5::STABILITYPOLAR) alpha = m_OpAlpha;
+            else if(fabs(m_pWPolar->Beta())>PRECISION)             alpha = m_OpAlpha;
+            else                                                   alpha = Alpha0 + q*AlphaDelta;
+        }
+        WindNormal.set(-sin(alpha*PI/180.0), 0.0, cos(alpha*PI/180.0));
+
+        pos = 0;
+        Mu     = m_Mu    + q*m_MatSize;
+        Sigma  = m_Sigma + q*m_MatSize;
+
+        strong = "        Calculating point " + QString("%1").arg(alpha,7,'f',2)+QString::fromUtf8("°....\n");
+        traceLog(strong);
+
+        strengthsChanged();
+        for(int iw=0; iw<MAXWINGS; iw++)
+        {
+            if(m_pWingList[iw])
+            {
+                WingForce.set(0.0, 0.0, 0.0);
+                panelTrefftz(m_pWingList[iw], QInf, alpha, Mu, Sigma, pos, WingForce, IDrag, m_pWPolar, m_pWakePanel, m_pWakeNode);
+
+                //save the results... will save another FF calculation when computing operating point
+                m_WingForce[q*MAXWINGS+iw] = WingForce;  // N/q
+                m_WingIDrag[q*MAXWINGS+iw] = IDrag;
+
+                memcpy(m_Cl  + (q*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_Cl,  m_pWingList[iw]->m_NStation*sizeof(double));
+                memcpy(m_ICd + (q*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_ICd, m_pWingList[iw]->m_NStation*sizeof(double));
+                memcpy(m_Ai  + (q*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_Ai,  m_pWingList[iw]->m_NStation*sizeof(double));
+                memcpy(m_F   + (q*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_F,   m_pWingList[iw]->m_NStation*sizeof(Vector3d));
+                memcpy(m_Vd  + (q*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_Vd,  m_pWingList[iw]->m_NStation*sizeof(Vector3d));
+
+                pos += m_pWingList[iw]->m_MatSize;
+
+                m_Progress += 10.0 * (double)m_pWingList[iw]->m_MatSize/ThinSize *(double)m_MatSize/400.;
+                if(isCancelled())return;
+            }
+        }
+    }
+}
+
+
+/**
+* In the case of Type 2 or Type 7 polars, computes the velocity for which the lift force balances the plane's weight.
+* Assumes the lift force on each lifting wing has been calculated for a unit velocity.
+* @param Alpha the angle of attack to calculate
+* @param q the index of the aoa in the sequence
+*/
+void PanelAnalysis::computeBalanceSpeeds(double Alpha, int q)
+{
+    QString strong;
+    Vector3d Force, WindNormal;
+    double TempCl,Lift;
+    WindNormal.set(-sin(Alpha*PI/180.0),   0.0, cos(Alpha*PI/180.0));
+
+    Force.set(0.0,0.0,0.0);
+
+    for(int iw=0; iw<MAXWINGS; iw++)
+    {
+        if(m_pWingList[iw]) Force += m_WingForce[q*MAXWINGS+iw];
+    }
+    if (m_pWPolar->isFixedSpeedPolar() || m_pWPolar->isBetaPolar())
+    {
+        m_3DQInf[q] = m_pWPolar->m_QInfSpec;
+    }
+    else if(m_pWPolar->isFixedLiftPolar())
+    {
+        Lift =  Force.dot(WindNormal) ;      //N/q, for 1/ms
+        TempCl = Lift/m_pWPolar->referenceArea();
+        if(Lift<=0.0)
+        {
+            strong = "           "+QString("Found a negative lift for Alpha=%1.... skipping the angle...\n").arg(Alpha, 5,'f',2);
+            traceLog(strong);
+            m_bPointOut = true;
+            s_bWarning  = true;
+            m_3DQInf[q] = -100.0;
+        }
+        else
+        {
+            m_3DQInf[q] =  sqrt(2.0* 9.81 * m_Mass/m_pWPolar->density()/TempCl/m_pWPolar->referenceArea());
+            strong = QString("           Alpha=%1   QInf=%2m/s").arg(Alpha, 5,'f',2).arg(m_3DQInf[q],5,'f',2);
+            strong+="\n";
+            traceLog(strong);
+        }
+    }
+}
+
+
+/**
+* Scales the unit results using the specified freestream velocity.
+* The velocity may have been specified directly in the case of a type 1 polar, or may have been calculated to balance the plane's weight.
+* The velocity for each aoa are provided in the member variable array m_3DQInf
+* @param nval the number of aoa in the sequence
+*/
+void PanelAnalysis::scaleResultstoSpeed(int nval)
+{
+    int p, q, pp;
+    //______________________________________________________________________________________
+    // Scale RHS and Sigma i.a.w. speeds (so far we have unit doublet and source strengths)
+
+    QString strong="\n";
+    traceLog(strong);
+
+    memcpy(m_SigmaRef, m_Sigma, nval*m_MatSize*sizeof(double));
+    memcpy(m_RHSRef,   m_Mu,    nval*m_MatSize*sizeof(double));
+
+    if(m_pWPolar->polarType()!=XFLR5::FIXEDAOAPOLAR)
+    {
+        p=0;
+        for (q=0; q<nval;q++)
+        {
+            for(pp=0; pp<m_MatSize; pp++)
+            {
+                m_Mu[p]     *= m_3DQInf[q];
+                m_Sigma[p]  *= m_3DQInf[q];
+                p++;
+            }
+        }
+    }
+    else
+    {
+        //type 4, we scale the first single rhs for all specified speed values
+        p=0;
+        for (q=0; q<nval;q++)
+        {
+            for(pp=0; pp<m_MatSize; pp++)
+            {
+                m_Mu[p]    = m_RHSRef[pp]   * m_3DQInf[q];
+                m_Sigma[p] = m_SigmaRef[pp] * m_3DQInf[q];
+                p++;
+            }
+        }
+    }
+
+    //scale the strip force and downwash fields
+    if(m_pWPolar->polarType()!=XFLR5::FIXEDAOAPOLAR)
+    {
+        for (q=0; q<nval;q++)
+        {
+            for(int iw=0; iw<MAXWINGS; iw++)
+            {
+                if(m_pWingList[iw])
+                {
+                    for(int m=0; m<m_pWingList[iw]->m_NStation; m++)
+                    {
+                        m_F[ m+ (q*MAXWINGS+iw)*m_NSpanStations] *= m_3DQInf[q] * m_3DQInf[q];
+                        m_Vd[m+ (q*MAXWINGS+iw)*m_NSpanStations] *= m_3DQInf[q] ;
+                    }
+                }
+            }
+        }
+    }
+    else
+    {
+        for (q=0; q<nval;q++)
+        {
+            for(int iw=0; iw<MAXWINGS; iw++)
+            {
+                if(m_pWingList[iw])
+                {
+                    for(int m=0; m<m_pWingList[iw]->m_NStation; m++)
+                    {
+                        m_F[ m+ (q*MAXWINGS+iw)*m_NSpanStations] = m_F[ m] * m_3DQInf[q] * m_3DQInf[q];
+                        m_Vd[m+ (q*MAXWINGS+iw)*m_NSpanStations] = m_Vd[m] * m_3DQInf[q];
+                    }
+                    m_WingForce[q*MAXWINGS+iw] = m_WingForce[iw];
+                    m_WingIDrag[q*MAXWINGS+iw] = m_WingIDrag[iw];
+                }
+            }
+        }
+    }
+
+}
+
+
+/**
+* Computes the  viscous and inviscid aerodynamic coefficients.
+* @param V0 the initial aoa or velocity, depending on the polar type
+* @param VDelta the aoa or velocity increment, depending on the polar type
+* @param nrhs the number of points in the sequence
+*/
+void PanelAnalysis::computeAeroCoefs(double V0, double VDelta, int nrhs)
+{
+    QString str;
+
+    if(m_pWPolar->isFixedaoaPolar())
+    {
+        for (int q=0; q<nrhs; q++)
+        {
+            if(isCancelled()) return;
+            str = QString("      Computing Plane for QInf=%1m/s").arg((V0+q*VDelta),7,'f',2);
+            traceLog(str);
+            computePlane(m_OpAlpha, V0+q*VDelta, q);
+            m_Progress += 5.0*(double)nrhs /(double)nrhs;
+        }
+    }
+    else if(m_pWPolar->isBetaPolar())
+    {
+        for (int q=0; q<nrhs; q++)
+        {
+            if(isCancelled()) return;
+            str = QString("      Computing Plane for beta=%1").arg((m_OpBeta),0,'f',1);
+            str += QString::fromUtf8("°\n");
+            traceLog(str);
+            computePlane(m_OpAlpha, m_3DQInf[q], q);
+            m_Progress += 5.0*(double)nrhs /(double)nrhs;
+        }
+    }
+    else
+    {
+        for (int q=0; q<nrhs; q++)
+        {
+            if(isCancelled()) return;
+            if(m_3DQInf[q]>0.0)
+            {
+                if(!m_pWPolar->bTilted()) str = QString("      Computing Plane for alpha=%1").arg(V0+q*VDelta,7,'f',2);
+                else                      str = QString("      Computing Plane for alpha=%1").arg(m_OpAlpha,7,'f',2);
+                str += QString::fromUtf8("°\n");
+                traceLog(str);
+                computePlane(V0+q*VDelta, m_3DQInf[q], q);
+            }
+            m_Progress += 5.0*(double)nrhs/(double)nrhs;
+        }
+    }
+}
+
+
+
+/**
+ * This method calculates the all the viscous and inviscid aerodynamic coefficients for one aoa.
+ * The method calls the method in the QMiarex class which creates the operating points, updates the polar data, and updates the graphs.
+ * The method uses in input the result data stored in the member variables.
+ * @param Alpha the aoa of this calculation
+ * @param QInf the freesteam velocity of this calculation
+ * @param qrhs the index of the current right hand side calculation
+*/
+void PanelAnalysis::computePlane(double Alpha, double QInf, int qrhs)
+{
+    int pos=0;
+
+    double Lift=0, IDrag=0, VDrag=0, XCP=0, YCP=0, ZCP=0, WingVDrag=0;
+    Vector3d WindNormal, WindDirection, WindSide;
+    Vector3d Force;
+    QString OutString;
+
+    //   Define wind (stability) axis
+    double cosa = cos(Alpha*PI/180.0);
+    double sina = sin(Alpha*PI/180.0);
+
+    WindNormal.set(  -sina, 0.0, cosa);
+    WindDirection.set(cosa, 0.0, sina);
+    WindSide = WindNormal * WindDirection;
+
+    double *Mu     = m_Mu    + qrhs*m_MatSize;
+    double *Sigma  = m_Sigma + qrhs*m_MatSize;
+
+    m_QInf      = QInf;
+
+    if(m_pWPolar->bTilted() || m_pWPolar->isBetaPolar() || fabs(m_pWPolar->Beta())>PRECISION)
+        Alpha = m_OpAlpha;
+    else
+        m_OpAlpha = Alpha;
+
+    for(int iw=0; iw<MAXWINGS; iw++)
+        if(m_pWingList[iw])m_pWingList[iw]->m_bWingOut = false;
+    //    m_pWing->m_bWingOut                = false;
+
+    if(QInf >0.0)
+    {
+        traceLog("       Calculating aerodynamic coefficients...\n");
+        m_bPointOut = false;
+        Force.set(0.0, 0.0, 0.0);
+
+        Lift = IDrag = VDrag = XCP = YCP = ZCP = 0.0;
+        m_GCm = m_VCm = m_ICm = m_GRm = m_GYm = m_VYm = m_IYm = 0.0;
+
+        pos = 0;
+
+        for(int iw=0; iw<MAXWINGS; iw++)
+        {
+            if(m_pWingList[iw])
+            {
+                traceLog("         Calculating wing..." + m_pWingList[iw]->m_WingName+"\n");
+                //restore the saved FF results
+                if(m_pWPolar->polarType()!=XFLR5::FIXEDAOAPOLAR)
+                {
+                    memcpy(m_pWingList[iw]->m_Cl,  m_Cl  + (qrhs*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(double));
+                    memcpy(m_pWingList[iw]->m_ICd, m_ICd + (qrhs*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(double));
+                    memcpy(m_pWingList[iw]->m_Ai,  m_Ai  + (qrhs*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(double));
+                    memcpy(m_pWingList[iw]->m_F,   m_F   + (qrhs*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(Vector3d));
+                    memcpy(m_pWingList[iw]->m_Vd,  m_Vd  + (qrhs*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(Vector3d));
+                }
+                else
+                {
+                    memcpy(m_pWingList[iw]->m_Cl,  m_Cl +iw*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(double));
+                    memcpy(m_pWingList[iw]->m_ICd, m_ICd+iw*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(double));
+                    memcpy(m_pWingList[iw]->m_Ai,  m_Ai +iw*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(double));
+                    memcpy(m_pWingList[iw]->m_F,   m_F  +iw*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(Vector3d));
+                    memcpy(m_pWingList[iw]->m_Vd,  m_Vd +iw*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(Vector3d));
+                }
+
+                Force += m_WingForce[qrhs*MAXWINGS+iw];
+                IDrag += m_WingIDrag[qrhs*MAXWINGS+iw];
+
+                //Get viscous interpolations
+                m_pWingList[iw]->panelComputeViscous(QInf, m_pWPolar, WingVDrag, m_pWPolar->bViscous(), OutString);
+                VDrag += WingVDrag;
+
+                traceLog(OutString);
+                if(m_pWingList[iw]->m_bWingOut)  m_bPointOut = true;
+
+
+                //Compute moment coefficients
+                m_pWingList[iw]->panelComputeOnBody(QInf, Alpha, m_Cp+qrhs*m_MatSize+pos, m_Mu+qrhs*m_MatSize+pos,
+                                                    XCP, YCP, ZCP, m_GCm, m_VCm, m_ICm, m_GRm, m_GYm, m_VYm, m_IYm,
+                                                    m_pWPolar, m_CoG);
+
+
+                m_pWingList[iw]->panelComputeBending(m_pWPolar->bThinSurfaces());
+
+                pos += m_pWingList[iw]->m_MatSize;
+            }
+        }
+
+        if(m_pPlane->body() && m_pWPolar->analysisMethod()==XFLR5::PANEL4METHOD && !m_pWPolar->bIgnoreBodyPanels())
+        {
+            double ICm = 0.0;
+            traceLog("       Calculating body...\n");
+            m_pPlane->body()->computeAero(m_Cp+qrhs*m_MatSize+pos, XCP, YCP, ZCP, ICm, m_GRm, m_GYm, Alpha, m_CoG);
+            m_ICm += ICm;
+            m_GCm += ICm;
+
+            //the body does not shed any wake --> no induced lift or drag
+        }
+
+        if(!s_bTrefftz) sumPanelForces(m_Cp+qrhs*m_MatSize, Alpha, Lift, IDrag);
+
+        m_CL          =       Force.dot(WindNormal)    /m_pWPolar->referenceArea();
+        m_CX          =       Force.dot(WindDirection) /m_pWPolar->referenceArea();
+        m_CY          =       Force.dot(WindSide)      /m_pWPolar->referenceArea();
+
+        m_InducedDrag =  1.0*IDrag/m_pWPolar->referenceArea();
+        m_ViscousDrag =  1.0*VDrag/m_pWPolar->referenceArea();
+
+
+        if(fabs(Force.dot(WindNormal))>0.0)
+        {
+            m_CP.x         = XCP/Force.dot(WindNormal);
+            m_CP.y         = YCP/Force.dot(WindNormal);
+            m_CP.z         = ZCP/Force.dot(WindNormal);
+        }
+        else
+        {
+            m_CP.set(0.0,0.0,0.0);
+        }
+
+
+        m_GCm *= 1.0 / m_pWPolar->referenceArea() /m_pWPolar->referenceChordLength();
+        m_VCm *= 1.0 / m_pWPolar->referenceArea() /m_pWPolar->referenceChordLength();
+        m_ICm *= 1.0 / m_pWPolar->referenceArea() /m_pWPolar->referenceChordLength();
+
+        m_GRm *= 1.0 / m_pWPolar->referenceArea() /m_pWPolar->referenceSpanLength();
+
+        m_GYm *= 1.0 / m_pWPolar->referenceArea() /m_pWPolar->referenceSpanLength();
+        m_VYm *= 1.0 / m_pWPolar->referenceArea() /m_pWPolar->referenceSpanLength();
+        m_IYm *= 1.0 / m_pWPolar->referenceArea() /m_pWPolar->referenceSpanLength();
+
+
+        if(m_pWPolar->isStabilityPolar()) computePhillipsFormulae();
+
+        if(m_bPointOut) s_bWarning = true;
+
+        if(m_pWPolar->isStabilityPolar()) m_Alpha = m_AlphaEq; // so it is set by default at the end of the analyis
+
+        PlaneOpp *pPOpp = createPlaneOpp(m_Cp+qrhs*m_MatSize, Mu, Sigma);
+        m_PlaneOppList.append(pPOpp);
+
+        traceLog("\n");
+    }
+    else m_bPointOut = true;
+}
+
+
+/**
+* Returns the estimation of the panel's lift coeficient based on the vortex circulation.
+* @param p the index of the panel
+* @param Gamma the pointer to the array of vortex circulations
+* @param Cp a pointer to the array of resulting panel lift coefficients
+* @param VInf the freestream velocity vector
+*/
+void PanelAnalysis::getVortexCp(const int &p, double *Gamma, double *Cp, Vector3d &VInf)
+{
+    Vector3d PanelForce, Force;
+    // for each panel along the chord, add the lift coef
+    PanelForce  = VInf * m_pPanel[p].Vortex;
+    PanelForce *= Gamma[p] * m_pWPolar->density();                 //Newtons
+
+    if(!m_pWPolar->bVLM1() && !m_pPanel[p].m_bIsLeading)
+    {
+        Force       = VInf* m_pPanel[p].Vortex;
+        Force      *= Gamma[p+1] * m_pWPolar->density();           //Newtons
+        PanelForce -= Force;
+    }
+
+    Cp[p]  = -2.0 * PanelForce.dot(m_pPanel[p].Normal) /m_pPanel[p].Area/m_pWPolar->density();
+}
+
+
+/**
+* This method calculates the Cp coefficient on a panel based on the distribution of doublet strengths.
+* This calculation follows the method provided in document NASA 4023.
+* @param p the index of the panel for which the calculation is performed
+* @param Mu the array of doublet strength values
+* @param Cp a reference to the Cp variable to evaluate
+* @param VLocal a reference to the Vector3d holding the local velocity on the panel
+* @param QInf the freestream velocity
+* @param Vx the x-component of the freestream velocity vector
+* @param Vz the z-component of the freestream velocity vector
+*/
+void PanelAnalysis::getDoubletDerivative(const int &p, double *Mu, double &Cp, Vector3d &VLocal, double const &QInf, double Vx, double Vy, double Vz)
+{
+    int PL,PR, PU, PD;
+    double DELQ, DELP, mu0,mu1,mu2, x0,x1,x2, Speed2;
+    Vector3d VTot;//total local panel speed
+    Vector3d S2, Sl2;
+
+    PL = m_pPanel[p].m_iPL;
+    PR = m_pPanel[p].m_iPR;
+    PU = m_pPanel[p].m_iPU;
+    PD = m_pPanel[p].m_iPD;
+
+    if(PL>=0 && PR>=0)
+    {
+        //we have two side neighbours
+        x1  = 0.0;
+        x0  = x1 - m_pPanel[p].SMQ - m_pPanel[PL].SMQ;
+        x2  = x1 + m_pPanel[p].SMQ + m_pPanel[PR].SMQ;
+        mu0 = Mu[PL];
+        mu1 = Mu[p];
+        mu2 = Mu[PR];
+        DELQ =      mu0 *(x1-x2)       /(x0-x1)/(x0-x2)
+                + mu1 *(2.0*x1-x0-x2)/(x1-x0)/(x1-x2)
+                + mu2 *(x1-x0)       /(x2-x0)/(x2-x1);
+    }
+    else if(PL>=0 && PR<0)
+    {
+        // no right neighbour
+        // do we have two left neighbours ?
+        if(m_pPanel[PL].m_iPL>=0)
+        {
+            x2  = 0.0;
+            x1  = x2 - m_pPanel[p].SMQ  - m_pPanel[PL].SMQ;
+            x0  = x1 - m_pPanel[PL].SMQ - m_pPanel[m_pPanel[PL].m_iPL].SMQ;
+
+            mu0 = Mu[m_pPanel[PL].m_iPL];
+            mu1 = Mu[PL];
+            mu2 = Mu[p];
+            DELQ =      mu0 *(x2-x1)       /(x0-x1)/(x0-x2)
+                    + mu1 *(x2-x0)       /(x1-x0)/(x1-x2)
+                    + mu2 *(2.0*x2-x0-x1)/(x2-x0)/(x2-x1);
+        }
+        else
+        {
+            //calculate the derivative on two panels only
+            DELQ = -(Mu[PL]-Mu[p])/(m_pPanel[p].SMQ  + m_pPanel[PL].SMQ);
+        }
+    }
+    else if(PL<0 && PR>=0)
+    {
+        // no left neighbour
+        // do we have two right neighbours ?
+        if(m_pPanel[PR].m_iPR>=0){
+            x0  = 0.0;
+            x1  = x0 + m_pPanel[p].SMQ  + m_pPanel[PR].SMQ;
+            x2  = x1 + m_pPanel[PR].SMQ + m_pPanel[m_pPanel[PR].m_iPR].SMQ;
+            mu0 = Mu[p];
+            mu1 = Mu[PR];
+            mu2 = Mu[m_pPanel[PR].m_iPR];
+            DELQ =      mu0 *(2.0*x0-x1-x2)/(x0-x1)/(x0-x2)
+                    + mu1 *(x0-x2)       /(x1-x0)/(x1-x2)
+                    + mu2 *(x0-x1)       /(x2-x0)/(x2-x1);
+        }
+        else
+        {
+            //calculate the derivative on two panels only
+            DELQ = (Mu[PR]-Mu[p])/(m_pPanel[p].SMQ  + m_pPanel[PR].SMQ);
+        }
+    }
+    else
+    {
+        DELQ = 0.0;
+        //Cannot calculate a derivative on one panel only
+    }
+
+    if(PU>=0 && PD>=0)
+    {
+        //we have one upstream and one downstream neighbour
+        x1  = 0.0;
+        x0  = x1 - m_pPanel[p].SMP - m_pPanel[PU].SMP;
+        x2  = x1 + m_pPanel[p].SMP + m_pPanel[PD].SMP;
+        mu0 = Mu[PU];
+        mu1 = Mu[p];
+        mu2 = Mu[PD];
+        DELP =      mu0 *(x1-x2)       /(x0-x1)/(x0-x2)
+                + mu1 *(2.0*x1-x0-x2)/(x1-x0)/(x1-x2)
+                + mu2 *(x1-x0)       /(x2-x0)/(x2-x1);
+    }
+    else if(PU>=0 && PD<0)
+    {
+        // no downstream neighbour
+        // do we have two upstream neighbours ?
+        if(m_pPanel[PU].m_iPU>=0)
+        {
+            x2  = 0.0;
+            x1  = x2 - m_pPanel[p ].SMP  - m_pPanel[PU].SMP;
+            x0  = x1 - m_pPanel[PU].SMP  - m_pPanel[m_pPanel[PU].m_iPU].SMP;
+            mu0 = Mu[m_pPanel[PU].m_iPU];
+            mu1 = Mu[PU];
+            mu2 = Mu[p];
+            DELP =      mu0 *(x2-x1)       /(x0-x1)/(x0-x2)
+                    + mu1 *(x2-x0)       /(x1-x0)/(x1-x2)
+                    + mu2 *(2.0*x2-x0-x1)/(x2-x0)/(x2-x1);
+        }
+        else
+        {
+            //calculate the derivative on two panels only
+            DELP = -(Mu[PU]-Mu[p])/(m_pPanel[p].SMP  + m_pPanel[PU].SMP);
+        }
+    }
+    else if(PU<0 && PD>=0)
+    {
+        // no upstream neighbour
+        // do we have two downstream neighbours ?
+        if(m_pPanel[PD].m_iPD>=0)
+        {
+            x0  = 0.0;
+            x1  = x0 + m_pPanel[p].SMP  + m_pPanel[PD].SMP;
+            x2  = x1 + m_pPanel[PD].SMP + m_pPanel[m_pPanel[PD].m_iPD].SMP;
+            mu0 = Mu[p];
+            mu1 = Mu[PD];
+            mu2 = Mu[m_pPanel[PD].m_iPD];
+            DELP =      mu0 *(2.0*x0-x1-x2)/(x0-x1)/(x0-x2)
+                    + mu1 *(x0-x2)       /(x1-x0)/(x1-x2)
+                    + mu2 *(x0-x1)       /(x2-x0)/(x2-x1);
+        }
+        else
+        {
+            //calculate the derivative on two panels only
+            DELP = (Mu[PD]-Mu[p])/(m_pPanel[p].SMP  + m_pPanel[PD].SMP);
+        }
+    }
+    else
+    {
+        DELP = 0.0;
+    }
+
+    //find middle of side 2
+    S2 = (m_pNode[m_pPanel[p].m_iTA] + m_pNode[m_pPanel[p].m_iTB])/2.0 - m_pPanel[p].CollPt;
+    //convert to local coordinates
+    Sl2   = m_pPanel[p].globalToLocal(S2);
+    VTot  = m_pPanel[p].globalToLocal(Vx, Vy, Vz);
+
+    //in panel referential
+    VLocal.x = -4.0*PI*(m_pPanel[p].SMP*DELP - Sl2.y*DELQ)/Sl2.x;
+    VLocal.y = -4.0*PI*DELQ;
+    //    Vl.z =  4.0*PI*Sigma[p];
+
+    VTot +=VLocal;
+    VTot.z = 0.0;
+
+    Speed2 = VTot.x*VTot.x + VTot.y*VTot.y;
+
+    Cp  = 1.0-Speed2/QInf/QInf;
+}
+
+
+/**
+* Calculates the Cp coefficient on each panel, using hte vortex circulations or the doublet strengths, depending on the analysis method.
+* @param V0 the first value in the sequence, either aoa for type 1 & 2 polars or velocity for type 4
+* @param VDelta the increment value of the input parameter, either aoa for type 1 & 2 polars or velocity for type 4
+* @param nval the number of values in the sequence
+*/
+void PanelAnalysis::computeOnBodyCp(double V0, double VDelta, int nval)
+{
+    //following VSAERO theory manual
+    //the on-body tangential perturbation speed is the derivative of the doublet strength
+    int p, q;
+    double Alpha, *Mu, *Cp;
+    Vector3d WindDirection, VInf, VLocal;
+    double Speed2, cosa, sina;
+    //______________________________________________________________________________________
+    traceLog("      Computing On-Body Speeds...\n");
+
+    if(m_pWPolar->polarType() != XFLR5::FIXEDAOAPOLAR)
+    {
+        for (q=0; q<nval; q++)
+        {
+            //   Define wind axis
+            Alpha = V0 + (double)q * VDelta;
+            cosa = cos(Alpha*PI/180.0);
+            sina = sin(Alpha*PI/180.0);
+            WindDirection.set(cosa, 0.0, sina);
+            VInf = WindDirection * m_3DQInf[q];
+
+            Mu     = m_Mu    + q * m_MatSize;
+            //            Sigma  = m_Sigma + q * m_MatSize;
+            Cp     = m_Cp    + q * m_MatSize;
+
+            for (p=0; p<m_MatSize; p++)
+            {
+                if(m_pPanel[p].m_Pos!=MIDSURFACE)
+                {
+                    m_pPanel[p].globalToLocal(VInf, VLocal);
+                    VLocal += m_uVl[p]*cosa*m_3DQInf[q] + m_wVl[p]*sina*m_3DQInf[q];
+                    Speed2 = VLocal.x*VLocal.x + VLocal.y*VLocal.y;
+                    Cp[p]  = 1.0-Speed2/m_3DQInf[q]/m_3DQInf[q];
+                }
+                else getVortexCp(p, Mu, Cp, WindDirection);
+
+                if(isCancelled()) return;
+            }
+            if(isCancelled()) return;
+            m_Progress += 1.0 *(double)nval/(double)nval;
+        }
+    }
+    else //FIXEDAOAPOLAR
+    {
+        //   Define wind axis
+        WindDirection.set(cos(m_Alpha*PI/180.0), 0.0, sin(m_Alpha*PI/180.0));
+        for (q=0; q<nval; q++)
+        {
+            VInf = WindDirection * m_3DQInf[q];
+
+            Mu     = m_Mu    + q * m_MatSize;
+            //            Sigma  = m_Sigma + q * m_MatSize;
+            Cp     = m_Cp    + q * m_MatSize;
+
+            for (p=0; p<m_MatSize; p++)
+            {
+                if(isCancelled()) break;
+
+                if(m_pPanel[p].m_Pos!=MIDSURFACE) getDoubletDerivative(p, Mu, Cp[p], VLocal, m_3DQInf[q], VInf.x, VInf.y, VInf.z);
+                else                              getVortexCp(p, Mu, Cp, WindDirection);
+            }
+
+            m_Progress += 1.0  *(double)nval/(double)nval;
+        }
+        for (q=1; q<nval; q++)
+        {
+            if(isCancelled()) return;
+            for (p=0; p<m_MatSize; p++)
+            {
+                m_Cp[p+q*m_MatSize] = m_Cp[p];
+            }
+        }
+    }
+}
+
+
+
+/**
+* Returns the influence at point C of the panel pPanel.
+* If the panel pPanel is located on a thin surface, then its the influence of a vortex.
+* If it is on a thick surface, then its a doublet.
+*
+*@param C the point where the influence is to be evaluated
+*@param pPanel a pointer to the Panel with the doublet strength
+*@param V the perturbation velocity at point C
+*@param phi the potential at point C
+*@param bWake true if the panel is located on the wake
+*@param bAll true if the influence of the bound vortex should be evaluated, in the case of a VLM analysis.
+*/
+void PanelAnalysis::getDoubletInfluence(Vector3d const &C, Panel *pPanel, Vector3d &V, double &phi, bool bWake, bool bAll)
+{
+    if(pPanel->m_Pos!=MIDSURFACE || pPanel->m_bIsWakePanel)
+        pPanel->doubletNASA4023(C, bWake ? m_pWakeNode : m_pNode, V, phi);
+    else
+    {
+        VLMGetVortexInfluence(pPanel, C, V, bAll);
+        phi = 0.0;
+    }
+
+    if(m_pWPolar->bGround())
+    {
+        Vector3d CG(C.x, C.y, -C.z-2.0*m_pWPolar->m_Height);
+        Vector3d VG;
+        double phiG=0.0;
+
+        if(pPanel->m_Pos!=MIDSURFACE || pPanel->m_bIsWakePanel)    pPanel->doubletNASA4023(CG, bWake ? m_pWakeNode : m_pNode, VG, phiG);
+        else
+        {
+            VLMGetVortexInfluence(pPanel, CG, VG, bAll);
+            phiG = 0.0;
+        }
+        V.x += VG.x;
+        V.y += VG.y;
+        V.z -= VG.z;
+        phi += phiG;
+    }
+}
+
+
+/**
+* Returns the influence at point C of a uniform source distribution on the panel pPanel
+* The panel is necessarily located on a thick surface, else the source strength is zero
+* @param C the point where the influence is to be evaluated
+* @param pPanel a pointer to the Panel with the doublet strength
+* @param V the perturbation velocity at point C
+* @param phi the potential at point C
+*/
+void PanelAnalysis::getSourceInfluence(Vector3d const &C, Panel *pPanel, Vector3d &V, double &phi)
+{
+    pPanel->sourceNASA4023(C, m_pNode, V, phi);
+
+    if(m_pWPolar->bGround())
+    {
+        Vector3d CG(C.x, C.y, -C.z-2.0*m_pWPolar->m_Height);
+        Vector3d VG;
+        double phiG=0.0;
+        pPanel->sourceNASA4023(CG, m_pNode, VG, phiG);
+        V.x += VG.x;
+        V.y += VG.y;
+        V.z -= VG.z;
+        phi += phiG;
+    }
+}
+
+
+/**
+* Returns the perturbation velocity vector at a given point, due to the distribution of source and doublet/circulation strengths.
+*
+* If a treecode accuracy has been set, the influence of the thick panels and of their wakes is evaluated
+* with the far-field expansions of the treecode's clusters, and the exact formulas are used only in the near field.
+* The tree is re-built when the strength arrays or their generation number change, so that a series of evaluations
+* for the same strengths, e.g. for the wake roll-up or the streamlines, costs O(log N) panel evaluations per point
+* instead of O(N). The content of the arrays is not compared: strengthsChanged() must be called before a series
+* of evaluations for new strengths.
+* The VLM vortices are always evaluated exactly.
+* @param C the point where the influence is to be evaluated
+* @param Mu a pointer to the array of doublet strength or vortex circulations
+* @param sigma a pointer to the array of source strengths
+* @param VT the resulting perturbation velocity
+* @param bAll true if the influence of the bound vortex should be included, in the case of a VLM analysis
+*/
+void PanelAnalysis::getSpeedVector(Vector3d const &C, double *Mu, double *Sigma, Vector3d &VT, bool bAll)
+{
+    Vector3d V;
+    int pp, pw, lw;
+    double phi, sign;
+
+    VT.set(0.0,0.0,0.0);
+
+    if(s_TreecodeAccuracy>0.0)
+    {
+        if(isCancelled()) return;
+
+        if(!m_Treecode.isBuilt(Mu, Sigma, m_StrengthGeneration))
+            m_Treecode.build(m_pPanel, m_pNode, m_MatSize, m_pWakePanel, m_pWakeNode, m_pWPolar->m_NXWakePanels, Mu, Sigma, m_StrengthGeneration);
+
+        m_Treecode.getVelocity(C, s_TreecodeAccuracy, VT);
+
+        if(m_pWPolar->bGround())
+        {
+            Vector3d CG(C.x, C.y, -C.z-2.0*m_pWPolar->m_Height);
+            m_Treecode.getVelocity(CG, s_TreecodeAccuracy, V);
+            VT.x += V.x;
+            VT.y += V.y;
+            VT.z -= V.z;
+        }
+
+        getVortexSpeedVector(C, Mu, V, bAll);
+        VT += V;
+        return;
+    }
+
+    for (pp=0; pp<m_MatSize;pp++)
+    {
+        if(isCancelled()) return;
+
+        // the VLM vortices are evaluated together
+        if(m_pPanel[pp].m_Pos==MIDSURFACE) continue;
+
+        getSourceInfluence(C, m_pPanel+pp, V, phi);
+        VT += V * Sigma[pp] ;
+
+        getDoubletInfluence(C, m_pPanel+pp, V, phi, false, bAll);
+
+        VT += V * Mu[pp];
+
+        // Is the panel pp shedding a wake ?
+        if(m_pPanel[pp].m_bIsTrailing)
+        {
+            //If so, we need to add the contribution of the wake column shedded by this panel
+            if(m_pPanel[pp].m_Pos==BOTSURFACE) sign=-1.0; else sign=1.0;
+            pw = m_pPanel[pp].m_iWake;
+            for(lw=0; lw<m_pWPolar->m_NXWakePanels; lw++)
+            {
+                getDoubletInfluence(C, m_pWakePanel+pw+lw, V, phi, true, bAll);
+                VT += V * Mu[pp]*sign;
+            }
+        }
+    }
+
+    getVortexSpeedVector(C, Mu, V, bAll);
+    VT += V;
+}
+
+
+/**
+* Returns the perturbation velocity vector at a given point due to the vortices of the VLM panels,
+* including their ground effect images.
+* @param C the point where the influence is to be evaluated
+* @param Gamma a pointer to the array of vortex circulations
+* @param V the resulting perturbation velocity
+* @param bAll true if the influence of the bound vortex should be included
+*/
+void PanelAnalysis::getVortexSpeedVector(Vector3d const &C, double const *Gamma, Vector3d &V, bool bAll)
+{
+    if(m_Vortex.panelCount()!=m_MatSize) makeVortexArray();
+
+    m_Vortex.getVelocity(C, Gamma, bAll, V);
 
+    if(m_pWPolar->bGround())
+    {
+        Vector3d CG(C.x, C.y, -C.z-2.0*m_pWPolar->m_Height);
+        Vector3d VG;
+        m_Vortex.getVelocity(CG, Gamma, bAll, VG);
+        V.x += VG.x;
+        V.y += VG.y;
+        V.z -= VG.z;
+    }
 }
 
 
 /**
-* Computes the  viscous and inviscid aerodynamic coefficients.
-* @param V0 the initial aoa or velocity, depending on the polar type
-* @param VDelta the aoa or velocity increment, depending on the polar type
-* @param nrhs the number of points in the sequence
+* Stores the vortex segments of the VLM panels in the structure of arrays used by the vectorized kernels.
+* The segments of each panel are those evaluated by VLMGetVortexInfluence(), in the same order.
+* The array is empty for the thick panels.
 */
-void PanelAnalysis::computeAeroCoefs(double V0, double VDelta, int nrhs)
+void PanelAnalysis::makeVortexArray()
 {
-    QString str;
+    Vector3d AA1, BB1;
 
-    if(m_pWPolar->isFixedaoaPolar())
+    m_Vortex.clear();
+
+    for(int pp=0; pp<m_MatSize; pp++)
     {
-        for (int q=0; q<nrhs; q++)
+        Panel const *pPanel = m_pPanel+pp;
+        if(pPanel->m_Pos!=MIDSURFACE)
         {
-            if(s_bCancel) return;
-            str = QString("      Computing Plane for QInf=%1m/s").arg((V0+q*VDelta),7,'f',2);
-            traceLog(str);
-            computePlane(m_OpAlpha, V0+q*VDelta, q);
-            m_Progress += 5.0*(double)nrhs /(double)nrhs;
+            m_Vortex.endPanel();
+            continue;
         }
-    }
-    else if(m_pWPolar->isBetaPolar())
-    {
-        for (int q=0; q<nrhs; q++)
+
+        int p = pPanel->m_iElement;
+        if(m_pWPolar->bVLM1())
         {
-            if(s_bCancel) return;
-            str = QString("      Computing Plane for beta=%1").arg((m_OpBeta),0,'f',1);
-            str += QString::fromUtf8("°\n");
-            traceLog(str);
-            computePlane(m_OpAlpha, m_3DQInf[q], q);
-            m_Progress += 5.0*(double)nrhs /(double)nrhs;
+            m_Vortex.addHorseshoe(pPanel->VA, pPanel->VB);
         }
-    }
-    else
-    {
-        for (int q=0; q<nrhs; q++)
+        else if(!pPanel->m_bIsTrailing)
         {
-            if(s_bCancel) return;
-            if(m_3DQInf[q]>0.0)
+            m_Vortex.addRing(pPanel->VA, pPanel->VB, m_pPanel[p-1].VA, m_pPanel[p-1].VB);
+        }
+        else if(!m_pWPolar->bWakeRollUp())
+        {
+            AA1.x = m_pNode[pPanel->m_iTA].x + (m_pNode[pPanel->m_iTA].x-pPanel->VA.x)/3.0;
+            AA1.y = m_pNode[pPanel->m_iTA].y;
+            AA1.z = m_pNode[pPanel->m_iTA].z;
+            BB1.x = m_pNode[pPanel->m_iTB].x + (m_pNode[pPanel->m_iTB].x-pPanel->VB.x)/3.0;
+            BB1.y = m_pNode[pPanel->m_iTB].y;
+            BB1.z = m_pNode[pPanel->m_iTB].z;
+
+            m_Vortex.addRing(pPanel->VA, pPanel->VB, AA1, BB1);
+            m_Vortex.addHorseshoe(AA1, BB1);
+        }
+        else
+        {
+            int pw = pPanel->m_iWake;
+            m_Vortex.addRing(pPanel->VA, pPanel->VB, m_pWakePanel[pw].VA, m_pWakePanel[pw].VB);
+            for (int lw=0; lw<m_pWPolar->m_NXWakePanels-1; lw++)
             {
-                if(!m_pWPolar->bTilted()) str = QString("      Computing Plane for alpha=%1").arg(V0+q*VDelta,7,'f',2);
-                else                      str = QString("      Computing Plane for alpha=%1").arg(m_OpAlpha,7,'f',2);
-                str += QString::fromUtf8("°\n");
-                traceLog(str);
-                computePlane(V0+q*VDelta, m_3DQInf[q], q);
+                m_Vortex.addRing(m_pWakePanel[pw].VA, m_pWakePanel[pw].VB, m_pWakePanel[pw+1].VA, m_pWakePanel[pw+1].VB);
+                pw++;
             }
-            m_Progress += 5.0*(double)nrhs/(double)nrhs;
         }
+        m_Vortex.endPanel();
     }
 }
 
 
 
+
+
 /**
- * This method calculates the all the viscous and inviscid aerodynamic coefficients for one aoa.
- * The method calls the method in the QMiarex class which creates the operating points, updates the polar data, and updates the graphs.
- * The method uses in input the result data stored in the member variables.
- * @param Alpha the aoa of this calculation
- * @param QInf the freesteam velocity of this calculation
- * @param qrhs the index of the current right hand side calculation
+* Launches a calculation over the input sequence of velocity.
+* Used for type 4 analysis, without tilted geometry.
+*
+* The calculation is performed for two unit RHS, and all the Operating POints are calculated by linear combination.
+* The two unit RHS are for a unit velocity along the x-axis, and for a unit velocity along the z-axis.
+*@return true if all the aoa were computed successfully, false otherwise. Interpolation issues are not counted as unsuccessful.
 */
-void PanelAnalysis::computePlane(double Alpha, double QInf, int qrhs)
+bool PanelAnalysis::QInfLoop()
 {
-    int pos=0;
+    QString str;
+    double Alpha = 0.0;
 
-    double Lift=0, IDrag=0, VDrag=0, XCP=0, YCP=0, ZCP=0, WingVDrag=0;
-    Vector3d WindNormal, WindDirection, WindSide;
-    Vector3d Force;
-    QString OutString;
+    setInertia(0.0, 0.0, 0.0);
 
-    //   Define wind (stability) axis
-    double cosa = cos(Alpha*PI/180.0);
-    double sina = sin(Alpha*PI/180.0);
+    m_QInf = m_vMin;
 
-    WindNormal.set(  -sina, 0.0, cosa);
-    WindDirection.set(cosa, 0.0, sina);
-    WindSide = WindNormal * WindDirection;
+    if(!m_pWPolar->bThinSurfaces()) m_TotalTime +=1.0; //for wake contribution
 
-    double *Mu     = m_Mu    + qrhs*m_MatSize;
-    double *Sigma  = m_Sigma + qrhs*m_MatSize;
+    m_Progress = 0.0;
 
-    m_QInf      = QInf;
+    if(m_pWPolar->bTilted())
+    {
+        //reset the initial geometry before a new angle is processed
+        memcpy(m_pPanel,     m_pMemPanel,     m_MatSize * sizeof(Panel));
+        memcpy(m_pNode,      m_pMemNode,      m_nNodes  * sizeof(Vector3d));
+        memcpy(m_pWakePanel, m_pRefWakePanel, m_WakeSize * sizeof(Panel));
+        memcpy(m_pWakeNode,  m_pRefWakeNode,  m_nWakeNodes * sizeof(Vector3d));
+        memcpy(m_pTempWakeNode,  m_pRefWakeNode,  m_nWakeNodes * sizeof(Vector3d));
 
-    if(m_pWPolar->bTilted() || m_pWPolar->isBetaPolar() || fabs(m_pWPolar->Beta())>PRECISION)
-        Alpha = m_OpAlpha;
+        // Rotate the wing panels and translate the wake to the new T.E. position
+        Vector3d O;
+        rotateGeomY(m_pWPolar->m_AlphaSpec, O, m_pWPolar->m_NXWakePanels);
+
+        m_OpAlpha = m_pWPolar->m_AlphaSpec;
+        Alpha = 0.0;
+    }
     else
-        m_OpAlpha = Alpha;
+    {
+        Alpha = m_Alpha;
+        m_OpAlpha = m_Alpha;
+    }
 
-    for(int iw=0; iw<MAXWINGS; iw++)
-        if(m_pWingList[iw])m_pWingList[iw]->m_bWingOut = false;
-    //    m_pWing->m_bWingOut                = false;
+    str = QString("   Solving the problem... \n");
+    traceLog("\n"+str);
 
-    if(QInf >0.0)
-    {
-        traceLog("       Calculating aerodynamic coefficients...\n");
-        m_bPointOut = false;
-        Force.set(0.0, 0.0, 0.0);
+    m_bSymmetric = s_bSymmetricSolve && makeSymmetryMap();
 
-        Lift = IDrag = VDrag = XCP = YCP = ZCP = 0.0;
-        m_GCm = m_VCm = m_ICm = m_GRm = m_GYm = m_VYm = m_IYm = 0.0;
+    if(!restoreFactoredMatrix()) buildInfluenceMatrix();
+    if (isCancelled()) return true;
 
-        pos = 0;
+    createUnitRHS();
+    if (isCancelled()) return true;
 
-        for(int iw=0; iw<MAXWINGS; iw++)
+    createSourceStrength(m_Alpha, 0.0, 1);
+    if (isCancelled()) return true;
+
+    if(!m_pWPolar->bThinSurfaces())
+    {
+        //compute wake contribution
+        if(!m_bMatrixFactored) createWakeContribution();
+
+        //add wake contribution to matrix and RHS
+        for(int p=0; p<m_MatSize; p++)
         {
-            if(m_pWingList[iw])
-            {
-                traceLog("         Calculating wing..." + m_pWingList[iw]->m_WingName+"\n");
-                //restore the saved FF results
-                if(m_pWPolar->polarType()!=XFLR5::FIXEDAOAPOLAR)
-                {
-                    memcpy(m_pWingList[iw]->m_Cl,  m_Cl  + (qrhs*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(double));
-                    memcpy(m_pWingList[iw]->m_ICd, m_ICd + (qrhs*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(double));
-                    memcpy(m_pWingList[iw]->m_Ai,  m_Ai  + (qrhs*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(double));
-                    memcpy(m_pWingList[iw]->m_F,   m_F   + (qrhs*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(Vector3d));
-                    memcpy(m_pWingList[iw]->m_Vd,  m_Vd  + (qrhs*MAXWINGS+iw)*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(Vector3d));
-                }
-                else
-                {
-                    memcpy(m_pWingList[iw]->m_Cl,  m_Cl +iw*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(double));
-                    memcpy(m_pWingList[iw]->m_ICd, m_ICd+iw*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(double));
-                    memcpy(m_pWingList[iw]->m_Ai,  m_Ai +iw*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(double));
-                    memcpy(m_pWingList[iw]->m_F,   m_F  +iw*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(Vector3d));
-                    memcpy(m_pWingList[iw]->m_Vd,  m_Vd +iw*m_NSpanStations, m_pWingList[iw]->m_NStation*sizeof(Vector3d));
-                }
+            m_uRHS[p]+= m_uWake[p];
+            m_wRHS[p]+= m_wWake[p];
+        }
+        if(!m_bMatrixFactored && !m_bIterative && !m_bSinglePrecision)
+        {
+            int Size = m_bSymmetric ? m_SymSize : m_MatSize;
+            for(int p=0; p<Size*Size; p++) m_aij[p] += m_aijWake[p];
+        }
+    }
+    if (isCancelled()) return true;
 
-                Force += m_WingForce[qrhs*MAXWINGS+iw];
-                IDrag += m_WingIDrag[qrhs*MAXWINGS+iw];
+    if (!solveUnitRHS())
+    {
+        s_bWarning = true;
+        return true;
+    }
+    if (isCancelled()) return true;
 
-                //Get viscous interpolations
-                m_pWingList[iw]->panelComputeViscous(QInf, m_pWPolar, WingVDrag, m_pWPolar->bViscous(), OutString);
-                VDrag += WingVDrag;
+    createDoubletStrength(Alpha, m_vDelta, 1);
+    if (isCancelled()) return true;
 
-                traceLog(OutString);
-                if(m_pWingList[iw]->m_bWingOut)  m_bPointOut = true;
 
+    computeFarField(1.0, m_OpAlpha, 0.0, 1);
+    if (isCancelled()) return true;
 
-                //Compute moment coefficients
-                m_pWingList[iw]->panelComputeOnBody(QInf, Alpha, m_Cp+qrhs*m_MatSize+pos, m_Mu+qrhs*m_MatSize+pos,
-                                                    XCP, YCP, ZCP, m_GCm, m_VCm, m_ICm, m_GRm, m_GYm, m_VYm, m_IYm,
-                                                    m_pWPolar, m_CoG);
 
+    for(int q=0; q<m_nRHS; q++)
+        m_3DQInf[q] = m_QInf+q*m_vDelta;
 
-                m_pWingList[iw]->panelComputeBending(m_pWPolar->bThinSurfaces());
+    scaleResultstoSpeed(m_nRHS);
+    if (isCancelled()) return true;
 
-                pos += m_pWingList[iw]->m_MatSize;
-            }
-        }
 
-        if(m_pPlane->body() && m_pWPolar->analysisMethod()==XFLR5::PANEL4METHOD && !m_pWPolar->bIgnoreBodyPanels())
-        {
-            double ICm = 0.0;
-            traceLog("       Calculating body...\n");
-            m_pPlane->body()->computeAero(m_Cp+qrhs*m_MatSize+pos, XCP, YCP, ZCP, ICm, m_GRm, m_GYm, Alpha, m_CoG);
-            m_ICm += ICm;
-            m_GCm += ICm;
+    computeOnBodyCp(m_QInf, m_vDelta, m_nRHS);
+    if (isCancelled()) return true;
 
-            //the body does not shed any wake --> no induced lift or drag
-        }
+    computeAeroCoefs(m_QInf, m_vDelta, m_nRHS);
+    if (isCancelled()) return true;
 
-        if(!s_bTrefftz) sumPanelForces(m_Cp+qrhs*m_MatSize, Alpha, Lift, IDrag);
+    return true;
+}
 
-        m_CL          =       Force.dot(WindNormal)    /m_pWPolar->referenceArea();
-        m_CX          =       Force.dot(WindDirection) /m_pWPolar->referenceArea();
-        m_CY          =       Force.dot(WindSide)      /m_pWPolar->referenceArea();
 
-        m_InducedDrag =  1.0*IDrag/m_pWPolar->referenceArea();
-        m_ViscousDrag =  1.0*VDrag/m_pWPolar->referenceArea();
+
+/**
+* Appends to the signature the analysis settings on which the coefficients of the influence matrix depend,
+* excluding the wake's contribution.
+*/
+void PanelAnalysis::influenceSettingsSignature(QVector<double> &signature)
+{
+    signature << m_MatSize << m_pWPolar->m_NXWakePanels
+              << m_pWPolar->bThinSurfaces() << m_pWPolar->bVLM1() << m_pWPolar->bDirichlet() << m_pWPolar->bWakeRollUp()
+              << m_pWPolar->bGround() << m_bSymmetric << m_SymSize
+              << m_pWPolar->groundHeight() << Panel::coreSize();
+}
 
 
-        if(fabs(Force.dot(WindNormal))>0.0)
+/**
+* Appends to the signature the geometry of a panel, i.e. the data on which the coefficients
+* of the panel's row and of the panel's column of the influence matrix depend.
+* For the VLM panels, the signature includes the vortices which are shed downstream of the panel.
+*@param p the index of the panel
+*/
+void PanelAnalysis::influencePanelSignature(int p, QVector<double> &signature)
+{
+    Panel const &panel = m_pPanel[p];
+    signature << panel.m_Pos << panel.m_bIsTrailing << panel.m_iWake << panel.m_iWakeColumn << panel.m_iElement;
+    Vector3d const *pt[] = {m_pNode+panel.m_iLA, m_pNode+panel.m_iLB, m_pNode+panel.m_iTA, m_pNode+panel.m_iTB,
+                            &panel.CollPt, &panel.CtrlPt, &panel.Normal, &panel.VA, &panel.VB};
+    for(int i=0; i<9; i++) signature << pt[i]->x << pt[i]->y << pt[i]->z;
+
+    if(panel.m_Pos==MIDSURFACE && !m_pWPolar->bVLM1())
+    {
+        // the rings are closed by the vortex of the panel downstream, or by the wake, as in makeVortexArray()
+        if(!panel.m_bIsTrailing && panel.m_iElement>0)
         {
-            m_CP.x         = XCP/Force.dot(WindNormal);
-            m_CP.y         = YCP/Force.dot(WindNormal);
-            m_CP.z         = ZCP/Force.dot(WindNormal);
+            Panel const &down = m_pPanel[panel.m_iElement-1];
+            signature << down.VA.x << down.VA.y << down.VA.z << down.VB.x << down.VB.y << down.VB.z;
         }
-        else
+        else if(panel.m_bIsTrailing && m_pWPolar->bWakeRollUp() && m_pWakePanel)
         {
-            m_CP.set(0.0,0.0,0.0);
+            for(int pw=panel.m_iWake; pw>=0 && pw<panel.m_iWake+m_pWPolar->m_NXWakePanels && pw<m_WakeSize; pw++)
+            {
+                Panel const &wake = m_pWakePanel[pw];
+                signature << wake.VA.x << wake.VA.y << wake.VA.z << wake.VB.x << wake.VB.y << wake.VB.z;
+            }
         }
+    }
+}
 
 
-        m_GCm *= 1.0 / m_pWPolar->referenceArea() /m_pWPolar->referenceChordLength();
-        m_VCm *= 1.0 / m_pWPolar->referenceArea() /m_pWPolar->referenceChordLength();
-        m_ICm *= 1.0 / m_pWPolar->referenceArea() /m_pWPolar->referenceChordLength();
+/**
+* Returns a key which identifies the analysis settings on which the coefficients of the influence matrix depend,
+* excluding the wake's contribution.
+*/
+quint64 PanelAnalysis::influenceSettingsKey()
+{
+    QVector<double> signature;
+    influenceSettingsSignature(signature);
+    return MatrixCache::signatureKey(signature);
+}
 
-        m_GRm *= 1.0 / m_pWPolar->referenceArea() /m_pWPolar->referenceSpanLength();
 
-        m_GYm *= 1.0 / m_pWPolar->referenceArea() /m_pWPolar->referenceSpanLength();
-        m_VYm *= 1.0 / m_pWPolar->referenceArea() /m_pWPolar->referenceSpanLength();
-        m_IYm *= 1.0 / m_pWPolar->referenceArea() /m_pWPolar->referenceSpanLength();
+/**
+* Returns a key which identifies the geometry of a panel, used to find the rows and columns of the
+* influence matrix which need to be updated when the geometry changes.
+*@param p the index of the panel
+*/
+quint64 PanelAnalysis::influencePanelKey(int p)
+{
+    QVector<double> signature;
+    influencePanelSignature(p, signature);
+    return MatrixCache::signatureKey(signature);
+}
 
 
-        if(m_pWPolar->isStabilityPolar()) computePhillipsFormulae();
+/**
+* Builds the signature of the current influence matrix, i.e. the panel and wake geometries
+* and the analysis settings on which the matrix coefficients and the wake's RHS contributions depend.
+* The speed, the mass and the viscous settings of the polar are not part of the signature.
+*@param signature the array which holds the signature on output
+*/
+void PanelAnalysis::influenceMatrixSignature(QVector<double> &signature)
+{
+    signature.clear();
+    influenceSettingsSignature(signature);
+    signature << m_WakeSize << m_NWakeColumn;
 
-        if(m_bPointOut) s_bWarning = true;
+    for(int p=0; p<m_MatSize; p++) influencePanelSignature(p, signature);
 
-        if(m_pWPolar->isStabilityPolar()) m_Alpha = m_AlphaEq; // so it is set by default at the end of the analyis
+    for(int pw=0; pw<m_WakeSize; pw++)
+    {
+        Panel const &panel = m_pWakePanel[pw];
+        Vector3d const *pt[] = {m_pWakeNode+panel.m_iLA, m_pWakeNode+panel.m_iLB, m_pWakeNode+panel.m_iTA, m_pWakeNode+panel.m_iTB};
+        for(int i=0; i<4; i++) signature << pt[i]->x << pt[i]->y << pt[i]->z;
+    }
+    if(m_bSymmetric)
+    {
+        for(int i=0; i<m_SymSize; i++) signature << m_SymIndex.at(i);
+        signature << m_SymSign;
+    }
+}
+
+
+/**
+* Looks up the MatrixCache for the LU factors of the current influence matrix.
+* If they are found, they are copied in m_aij and m_Index with the wake's RHS contributions,
+* so that the assembly and the decomposition of the matrix can be skipped.
+*@return true if the factored matrix has been restored, false if it needs to be built.
+*/
+bool PanelAnalysis::restoreFactoredMatrix()
+{
+    m_bMatrixFactored = false;
+    m_bLowRankUpdate = false;
+    if(m_bIterative || m_bSinglePrecision || !m_bMatrixCopies) return false;
+    influenceMatrixSignature(m_MatrixSignature);
+
+    int Size = m_bSymmetric ? m_SymSize : m_MatSize;
+    if(!MatrixCache::restore(m_MatrixSignature, Size, m_aij, m_Index, m_MatSize, m_uWake, m_wWake)) return false;
+
+    traceLog("      Restoring the influence matrix from the cache...\n");
+    m_Progress += 10.0*double(Size)/400.0;
+    m_bMatrixFactored = true;
+    return true;
+}
 
-        PlaneOpp *pPOpp = createPlaneOpp(m_Cp+qrhs*m_MatSize, Mu, Sigma);
-        m_PlaneOppList.append(pPOpp);
 
-        traceLog("\n");
-    }
-    else m_bPointOut = true;
+/**
+* Stores the LU factors of the current influence matrix and the wake's RHS contributions in the MatrixCache.
+*/
+void PanelAnalysis::storeFactoredMatrix()
+{
+    int Size = m_bSymmetric ? m_SymSize : m_MatSize;
+    MatrixCache::store(m_MatrixSignature, Size, m_aij, m_Index, m_MatSize, m_uWake, m_wWake);
 }
 
 
 /**
-* Returns the estimation of the panel's lift coeficient based on the vortex circulation.
-* @param p the index of the panel
-* @param Gamma the pointer to the array of vortex circulations
-* @param Cp a pointer to the array of resulting panel lift coefficients
-* @param VInf the freestream velocity vector
+* Performs the LU decomposition of the matrix m_aij, and stores the factors in the MatrixCache.
+* If the low-rank update is enabled, the matrix and its factors are also kept as the reference
+* for the low-rank updates of the next analyses.
+*@param Size the size of the linear system
+*@param TaskSize the estimated time of the decomposition, used to update the progress
+*@return true if the matrix has been factored, false if it is singular or if the analysis has been cancelled.
 */
-void PanelAnalysis::getVortexCp(const int &p, double *Gamma, double *Cp, Vector3d &VInf)
+bool PanelAnalysis::factorizeMatrix(int Size, double TaskSize)
 {
-    Vector3d PanelForce, Force;
-    // for each panel along the chord, add the lift coef
-    PanelForce  = VInf * m_pPanel[p].Vortex;
-    PanelForce *= Gamma[p] * m_pWPolar->density();                 //Newtons
+    bool bReference = s_bLowRankUpdate && m_bMatrixCopies && double(Size)*double(Size)<=MAXREFMATRIXSIZE && m_RefPanelKey.size()==m_MatSize;
 
-    if(!m_pWPolar->bVLM1() && !m_pPanel[p].m_bIsLeading)
+    m_LURefPanelKey.clear();
+    if(bReference)
     {
-        Force       = VInf* m_pPanel[p].Vortex;
-        Force      *= Gamma[p+1] * m_pWPolar->density();           //Newtons
-        PanelForce -= Force;
+        m_LURefMatrix.resize(Size*Size);
+        memcpy(m_LURefMatrix.data(), m_aij, ulong(Size*Size)*sizeof(double));
+    }
+    else
+    {
+        m_LURefMatrix.clear();
+        m_LURef.clear();
+        m_LURefIndex.clear();
     }
 
-    Cp[p]  = -2.0 * PanelForce.dot(m_pPanel[p].Normal) /m_pPanel[p].Area/m_pWPolar->density();
+    traceLog("      Performing LU Matrix decomposition...\n");
+
+    if(!Crout_LU_Decomposition_with_Pivoting(m_aij, m_Index, Size, &m_bCancel, TaskSize, m_Progress))
+    {
+        traceLog("      Singular Matrix.... Aborting calculation...\n");
+        return false;
+    }
+    if(isCancelled()) return false;
+
+    m_bMatrixFactored = true;
+    m_bLowRankUpdate = false;
+    if(m_bMatrixCopies) storeFactoredMatrix();
+
+    if(bReference)
+    {
+        m_LURef.resize(Size*Size);
+        memcpy(m_LURef.data(), m_aij, ulong(Size*Size)*sizeof(double));
+        m_LURefIndex.resize(Size);
+        memcpy(m_LURefIndex.data(), m_Index, ulong(Size)*sizeof(int));
+        m_LURefPanelKey    = m_RefPanelKey;
+        m_LURefSettingsKey = m_RefSettingsKey;
+        if(m_bSymmetric) m_LURefSymIndex = m_SymIndex;
+        else             m_LURefSymIndex.clear();
+    }
+    return true;
 }
 
 
 /**
-* This method calculates the Cp coefficient on a panel based on the distribution of doublet strengths.
-* This calculation follows the method provided in document NASA 4023.
-* @param p the index of the panel for which the calculation is performed
-* @param Mu the array of doublet strength values
-* @param Cp a reference to the Cp variable to evaluate
-* @param VLocal a reference to the Vector3d holding the local velocity on the panel
-* @param QInf the freestream velocity
-* @param Vx the x-component of the freestream velocity vector
-* @param Vz the z-component of the freestream velocity vector
+* Prepares the solution of the current system as a low-rank update of the reference LU factors.
+*
+* If the panels have changed only in a small part of the plane, e.g. the incidence of the elevator
+* or the geometry of a wing section in a parametric study, the matrix A differs from the reference
+* matrix A0 only in the rows and columns of these panels. The difference is written as U.V^T,
+* where the k columns of U are the changed columns of A-A0 and the unit vectors of the changed rows,
+* and the solution of A.x=b is given by the Sherman-Morrison-Woodbury formula:
+*     x = y - Z.(I+V^T.Z)^-1.V^T.y,    with y=A0^-1.b and Z=A0^-1.U.
+* The k solutions Z are computed with the reference factors, and the k x k capacitance matrix I+V^T.Z
+* is factored once; each solve then costs one solve with the reference factors and O(k.n) operations,
+* instead of the O(n^3) operations of a new decomposition.
+*
+* The changed panels are identified with the keys of the incremental assembly.
+* The coefficients outside the changed rows and columns are checked to be identical to those of the
+* reference matrix, so that any change which is not captured by the keys leads to a full decomposition.
+*
+*@param Size the size of the linear system
+*@return true if the low-rank update has been set up, false if the matrix needs to be factored.
 */
-void PanelAnalysis::getDoubletDerivative(const int &p, double *Mu, double &Cp, Vector3d &VLocal, double const &QInf, double Vx, double Vy, double Vz)
+bool PanelAnalysis::setupLowRankUpdate(int Size)
 {
-    int PL,PR, PU, PD;
-    double DELQ, DELP, mu0,mu1,mu2, x0,x1,x2, Speed2;
-    Vector3d VTot;//total local panel speed
-    Vector3d S2, Sl2;
+    m_bLowRankUpdate = false;
+    m_LRColumn.clear();
+    m_LRRow.clear();
 
-    PL = m_pPanel[p].m_iPL;
-    PR = m_pPanel[p].m_iPR;
-    PU = m_pPanel[p].m_iPU;
-    PD = m_pPanel[p].m_iPD;
+    if(!s_bLowRankUpdate) return false;
+    if(m_LURefPanelKey.size()!=m_MatSize || m_RefPanelKey.size()!=m_MatSize) return false;
+    if(m_LURef.size()!=Size*Size || m_LURefMatrix.size()!=Size*Size) return false;
+    if(m_LURefSettingsKey!=m_RefSettingsKey) return false;
+    if(m_bSymmetric && m_LURefSymIndex!=m_SymIndex) return false;
+    if(!m_bSymmetric && !m_LURefSymIndex.isEmpty()) return false;
 
-    if(PL>=0 && PR>=0)
+    // the rows and columns of the changed panels
+    QVector<bool> bChanged(Size, false);
+    for(int p=0; p<m_MatSize; p++)
     {
-        //we have two side neighbours
-        x1  = 0.0;
-        x0  = x1 - m_pPanel[p].SMQ - m_pPanel[PL].SMQ;
-        x2  = x1 + m_pPanel[p].SMQ + m_pPanel[PR].SMQ;
-        mu0 = Mu[PL];
-        mu1 = Mu[p];
-        mu2 = Mu[PR];
-        DELQ =      mu0 *(x1-x2)       /(x0-x1)/(x0-x2)
-                + mu1 *(2.0*x1-x0-x2)/(x1-x0)/(x1-x2)
-                + mu2 *(x1-x0)       /(x2-x0)/(x2-x1);
+        if(m_RefPanelKey.at(p)==m_LURefPanelKey.at(p)) continue;
+        int i = m_bSymmetric ? m_SymRow.at(p) : p;
+        if(i>=0) bChanged[i] = true;
     }
-    else if(PL>=0 && PR<0)
+    for(int i=0; i<Size; i++)
     {
-        // no right neighbour
-        // do we have two left neighbours ?
-        if(m_pPanel[PL].m_iPL>=0)
-        {
-            x2  = 0.0;
-            x1  = x2 - m_pPanel[p].SMQ  - m_pPanel[PL].SMQ;
-            x0  = x1 - m_pPanel[PL].SMQ - m_pPanel[m_pPanel[PL].m_iPL].SMQ;
-
-            mu0 = Mu[m_pPanel[PL].m_iPL];
-            mu1 = Mu[PL];
-            mu2 = Mu[p];
-            DELQ =      mu0 *(x2-x1)       /(x0-x1)/(x0-x2)
-                    + mu1 *(x2-x0)       /(x1-x0)/(x1-x2)
-                    + mu2 *(2.0*x2-x0-x1)/(x2-x0)/(x2-x1);
-        }
-        else
+        if(bChanged.at(i))
         {
-            //calculate the derivative on two panels only
-            DELQ = -(Mu[PL]-Mu[p])/(m_pPanel[p].SMQ  + m_pPanel[PL].SMQ);
+            m_LRColumn.append(i);
+            m_LRRow.append(i);
         }
     }
-    else if(PL<0 && PR>=0)
+    int nc = m_LRColumn.size();
+    int nr = m_LRRow.size();
+    int k = nc + nr;
+    if(k*LOWRANKRATIO>Size) return false;
+
+    // the change must be limited to the rows and columns of the changed panels
+    double const *A0 = m_LURefMatrix.constData();
+    for(int i=0; i<Size; i++)
     {
-        // no left neighbour
-        // do we have two right neighbours ?
-        if(m_pPanel[PR].m_iPR>=0){
-            x0  = 0.0;
-            x1  = x0 + m_pPanel[p].SMQ  + m_pPanel[PR].SMQ;
-            x2  = x1 + m_pPanel[PR].SMQ + m_pPanel[m_pPanel[PR].m_iPR].SMQ;
-            mu0 = Mu[p];
-            mu1 = Mu[PR];
-            mu2 = Mu[m_pPanel[PR].m_iPR];
-            DELQ =      mu0 *(2.0*x0-x1-x2)/(x0-x1)/(x0-x2)
-                    + mu1 *(x0-x2)       /(x1-x0)/(x1-x2)
-                    + mu2 *(x0-x1)       /(x2-x0)/(x2-x1);
-        }
-        else
+        if(bChanged.at(i)) continue;
+        for(int j=0; j<Size; j++)
         {
-            //calculate the derivative on two panels only
-            DELQ = (Mu[PR]-Mu[p])/(m_pPanel[p].SMQ  + m_pPanel[PR].SMQ);
+            if(!bChanged.at(j) && m_aij[i*Size+j]!=A0[i*Size+j]) return false;
         }
     }
-    else
-    {
-        DELQ = 0.0;
-        //Cannot calculate a derivative on one panel only
-    }
 
-    if(PU>=0 && PD>=0)
+    QString strange = QString("      Updating the LU decomposition for a change of rank %1\n").arg(k);
+    traceLog(strange);
+
+    // the columns of U
+    m_LRZ.fill(0.0, k*Size);
+    double *Z = m_LRZ.data();
+    for(int b=0; b<nc; b++)
     {
-        //we have one upstream and one downstream neighbour
-        x1  = 0.0;
-        x0  = x1 - m_pPanel[p].SMP - m_pPanel[PU].SMP;
-        x2  = x1 + m_pPanel[p].SMP + m_pPanel[PD].SMP;
-        mu0 = Mu[PU];
-        mu1 = Mu[p];
-        mu2 = Mu[PD];
-        DELP =      mu0 *(x1-x2)       /(x0-x1)/(x0-x2)
-                + mu1 *(2.0*x1-x0-x2)/(x1-x0)/(x1-x2)
-                + mu2 *(x1-x0)       /(x2-x0)/(x2-x1);
+        int c = m_LRColumn.at(b);
+        for(int i=0; i<Size; i++) Z[b*Size+i] = m_aij[i*Size+c] - A0[i*Size+c];
     }
-    else if(PU>=0 && PD<0)
+    for(int b=0; b<nr; b++) Z[(nc+b)*Size+m_LRRow.at(b)] = 1.0;
+
+    // the changed rows of V^T
+    m_LRW.fill(0.0, nr*Size);
+    for(int a=0; a<nr; a++)
     {
-        // no downstream neighbour
-        // do we have two upstream neighbours ?
-        if(m_pPanel[PU].m_iPU>=0)
-        {
-            x2  = 0.0;
-            x1  = x2 - m_pPanel[p ].SMP  - m_pPanel[PU].SMP;
-            x0  = x1 - m_pPanel[PU].SMP  - m_pPanel[m_pPanel[PU].m_iPU].SMP;
-            mu0 = Mu[m_pPanel[PU].m_iPU];
-            mu1 = Mu[PU];
-            mu2 = Mu[p];
-            DELP =      mu0 *(x2-x1)       /(x0-x1)/(x0-x2)
-                    + mu1 *(x2-x0)       /(x1-x0)/(x1-x2)
-                    + mu2 *(2.0*x2-x0-x1)/(x2-x0)/(x2-x1);
-        }
-        else
+        int r = m_LRRow.at(a);
+        double *w = m_LRW.data() + a*Size;
+        for(int j=0; j<Size; j++)
         {
-            //calculate the derivative on two panels only
-            DELP = -(Mu[PU]-Mu[p])/(m_pPanel[p].SMP  + m_pPanel[PU].SMP);
+            if(!bChanged.at(j)) w[j] = m_aij[r*Size+j] - A0[r*Size+j];
         }
     }
-    else if(PU<0 && PD>=0)
+
+    if(k>0)
     {
-        // no upstream neighbour
-        // do we have two downstream neighbours ?
-        if(m_pPanel[PD].m_iPD>=0)
-        {
-            x0  = 0.0;
-            x1  = x0 + m_pPanel[p].SMP  + m_pPanel[PD].SMP;
-            x2  = x1 + m_pPanel[PD].SMP + m_pPanel[m_pPanel[PD].m_iPD].SMP;
-            mu0 = Mu[p];
-            mu1 = Mu[PD];
-            mu2 = Mu[m_pPanel[PD].m_iPD];
-            DELP =      mu0 *(2.0*x0-x1-x2)/(x0-x1)/(x0-x2)
-                    + mu1 *(x0-x2)       /(x1-x0)/(x1-x2)
-                    + mu2 *(x0-x1)       /(x2-x0)/(x2-x1);
-        }
-        else
+        Crout_LU_with_Pivoting_Solve(m_LURef.data(), Z, m_LURefIndex.data(), Z, Size, k, &m_bCancel);
+        if(isCancelled()) return false;
+    }
+
+    // the capacitance matrix I+V^T.Z
+    m_LRS.fill(0.0, k*k);
+    QVector<int> rows(k);
+    for(int a=0; a<k; a++) rows[a] = a;
+    auto capacitanceRow = [this, Z, nc, k, Size](int const &a)
+    {
+        double *s = m_LRS.data() + a*k;
+        for(int b=0; b<k; b++)
         {
-            //calculate the derivative on two panels only
-            DELP = (Mu[PD]-Mu[p])/(m_pPanel[p].SMP  + m_pPanel[PD].SMP);
+            double const *z = Z + b*Size;
+            double sum = 0.0;
+            if(a<nc) sum = z[m_LRColumn.at(a)];
+            else
+            {
+                double const *w = m_LRW.constData() + (a-nc)*Size;
+                for(int j=0; j<Size; j++) sum += w[j]*z[j];
+            }
+            s[b] = sum + (a==b ? 1.0 : 0.0);
         }
-    }
-    else
+    };
+    if(s_bMultiThread && k>PANELTILESIZE) QtConcurrent::blockingMap(rows, capacitanceRow);
+    else                                  for(int a=0; a<k; a++) capacitanceRow(a);
+
+    m_LRSIndex.resize(k);
+    double progress = 0.0;
+    if(k>0 && !Crout_LU_Decomposition_with_Pivoting(m_LRS.data(), m_LRSIndex.data(), k, &m_bCancel, 0.0, progress))
     {
-        DELP = 0.0;
+        traceLog("      Singular low-rank update, performing the full LU decomposition...\n");
+        return false;
     }
+    if(isCancelled()) return false;
 
-    //find middle of side 2
-    S2 = (m_pNode[m_pPanel[p].m_iTA] + m_pNode[m_pPanel[p].m_iTB])/2.0 - m_pPanel[p].CollPt;
-    //convert to local coordinates
-    Sl2   = m_pPanel[p].globalToLocal(S2);
-    VTot  = m_pPanel[p].globalToLocal(Vx, Vy, Vz);
-
-    //in panel referential
-    VLocal.x = -4.0*PI*(m_pPanel[p].SMP*DELP - Sl2.y*DELQ)/Sl2.x;
-    VLocal.y = -4.0*PI*DELQ;
-    //    Vl.z =  4.0*PI*Sigma[p];
-
-    VTot +=VLocal;
-    VTot.z = 0.0;
-
-    Speed2 = VTot.x*VTot.x + VTot.y*VTot.y;
-
-    Cp  = 1.0-Speed2/QInf/QInf;
+    m_bMatrixFactored = true;
+    m_bLowRankUpdate = true;
+    return true;
 }
 
 
 /**
-* Calculates the Cp coefficient on each panel, using hte vortex circulations or the doublet strengths, depending on the analysis method.
-* @param V0 the first value in the sequence, either aoa for type 1 & 2 polars or velocity for type 4
-* @param VDelta the increment value of the input parameter, either aoa for type 1 & 2 polars or velocity for type 4
-* @param nval the number of values in the sequence
+* Solves the current linear system for several RHS, either with the LU factors in m_aij,
+* with the reference factors and the low-rank update, with the single precision factors and iterative refinement,
+* or with the iterative solver.
+* The arrays follow the conventions of Crout_LU_with_Pivoting_Solve().
+*@param B a pointer to the array of RHS; the array is modified by the row interchanges
+*@param X a pointer to the array of solutions, which may be the same as B
+*@param Size the size of the linear system
+*@param nRHS the number of RHS to solve
+*@return false if the iterations of the iterative or of the mixed precision solver have not converged, true otherwise.
 */
-void PanelAnalysis::computeOnBodyCp(double V0, double VDelta, int nval)
+bool PanelAnalysis::solveLinearSystem(double *B, double *X, int Size, int nRHS)
 {
-    //following VSAERO theory manual
-    //the on-body tangential perturbation speed is the derivative of the doublet strength
-    int p, q;
-    double Alpha, *Mu, *Cp;
-    Vector3d WindDirection, VInf, VLocal;
-    double Speed2, cosa, sina;
-    //______________________________________________________________________________________
-    traceLog("      Computing On-Body Speeds...\n");
-
-    if(m_pWPolar->polarType() != XFLR5::FIXEDAOAPOLAR)
+    if(m_bSinglePrecision)
     {
-        for (q=0; q<nval; q++)
-        {
-            //   Define wind axis
-            Alpha = V0 + (double)q * VDelta;
-            cosa = cos(Alpha*PI/180.0);
-            sina = sin(Alpha*PI/180.0);
-            WindDirection.set(cosa, 0.0, sina);
-            VInf = WindDirection * m_3DQInf[q];
+        QVector<double> RHS(Size*nRHS);
+        memcpy(RHS.data(), B, ulong(Size*nRHS)*sizeof(double));
+        Crout_LU_with_Pivoting_Solve(m_aijSingle, B, m_Index, X, Size, nRHS, &m_bCancel);
+        return refineSinglePrecisionSolution(RHS.constData(), X, Size, nRHS);
+    }
 
-            Mu     = m_Mu    + q * m_MatSize;
-            //            Sigma  = m_Sigma + q * m_MatSize;
-            Cp     = m_Cp    + q * m_MatSize;
+    if(m_bIterative)
+    {
+        QVector<double> RHS(Size*nRHS);
+        memcpy(RHS.data(), B, ulong(Size*nRHS)*sizeof(double));
+        memset(X, 0, ulong(Size*nRHS)*sizeof(double));
 
-            for (p=0; p<m_MatSize; p++)
-            {
-                if(m_pPanel[p].m_Pos!=MIDSURFACE)
-                {
-                    m_pPanel[p].globalToLocal(VInf, VLocal);
-                    VLocal += m_uVl[p]*cosa*m_3DQInf[q] + m_wVl[p]*sina*m_3DQInf[q];
-                    Speed2 = VLocal.x*VLocal.x + VLocal.y*VLocal.y;
-                    Cp[p]  = 1.0-Speed2/m_3DQInf[q]/m_3DQInf[q];
-                }
-                else getVortexCp(p, Mu, Cp, WindDirection);
+        int nIter = 0;
+        double residual = 0.0;
+        bool bConverged = GMRES_Solve([this, Size](double const *x, double *y, int nVec) {multiplySystemMatrix(x, y, Size, nVec);},
+                                      [this, Size](double *x, int nVec) {preconditionSystem(x, Size, nVec);},
+                                      RHS.constData(), X, Size, nRHS, ITERATIVERESTART, ITERATIVEMAXITER, ITERATIVETOLERANCE,
+                                      &m_bCancel, nIter, residual);
+        if(isCancelled()) return false;
 
-                if(s_bCancel) return;
-            }
-            if(s_bCancel) return;
-            m_Progress += 1.0 *(double)nval/(double)nval;
-        }
+        QString strange;
+        if(bConverged) strange = QString("      GMRES converged in %1 iterations\n").arg(nIter);
+        else           strange = QString("      GMRES did not converge in %1 iterations, residual=%2\n").arg(nIter).arg(residual, 0, 'g', 3);
+        traceLog(strange);
+        return bConverged;
     }
-    else //FIXEDAOAPOLAR
+
+    if(!m_bLowRankUpdate)
     {
-        //   Define wind axis
-        WindDirection.set(cos(m_Alpha*PI/180.0), 0.0, sin(m_Alpha*PI/180.0));
-        for (q=0; q<nval; q++)
-        {
-            VInf = WindDirection * m_3DQInf[q];
+        Crout_LU_with_Pivoting_Solve(m_aij, B, m_Index, X, Size, nRHS, &m_bCancel);
+        return true;
+    }
 
-            Mu     = m_Mu    + q * m_MatSize;
-            //            Sigma  = m_Sigma + q * m_MatSize;
-            Cp     = m_Cp    + q * m_MatSize;
+    Crout_LU_with_Pivoting_Solve(m_LURef.data(), B, m_LURefIndex.data(), X, Size, nRHS, &m_bCancel);
 
-            for (p=0; p<m_MatSize; p++)
+    int nc = m_LRColumn.size();
+    int k  = nc + m_LRRow.size();
+    if(k==0) return true;
+
+    QVector<double> t(k);
+    for(int r=0; r<nRHS; r++)
+    {
+        double *x = X + r*Size;
+        for(int a=0; a<k; a++)
+        {
+            if(a<nc) t[a] = x[m_LRColumn.at(a)];
+            else
             {
-                if(s_bCancel) break;
+                double const *w = m_LRW.constData() + (a-nc)*Size;
+                double sum = 0.0;
+                for(int j=0; j<Size; j++) sum += w[j]*x[j];
+                t[a] = sum;
+            }
+        }
+        Crout_LU_with_Pivoting_Solve(m_LRS.data(), t.data(), m_LRSIndex.data(), t.data(), k, &m_bCancel);
+        for(int b=0; b<k; b++)
+        {
+            double const *z = m_LRZ.constData() + b*Size;
+            for(int i=0; i<Size; i++) x[i] -= t.at(b)*z[i];
+        }
+    }
+    return true;
+}
+
 
-                if(m_pPanel[p].m_Pos!=MIDSURFACE) getDoubletDerivative(p, Mu, Cp[p], VLocal, m_3DQInf[q], VInf.x, VInf.y, VInf.z);
-                else                              getVortexCp(p, Mu, Cp, WindDirection);
-            }
+/**
+* Improves the solutions obtained with the low-rank update by one step of iterative refinement,
+* and checks their residuals with the matrix m_aij.
+*@param B a pointer to the array of the original RHS
+*@param X a pointer to the array of solutions
+*@param Size the size of the linear system
+*@param nRHS the number of RHS
+*@return true if the relative residuals are less than LOWRANKTOLERANCE.
+*/
+bool PanelAnalysis::refineLowRankSolution(double const *B, double *X, int Size, int nRHS)
+{
+    QVector<double> R(Size*nRHS);
 
-            m_Progress += 1.0  *(double)nval/(double)nval;
-        }
-        for (q=1; q<nval; q++)
+    auto residual = [this, B, X, Size, nRHS, &R]()
+    {
+        double maxRatio = 0.0;
+        for(int r=0; r<nRHS; r++)
         {
-            if(s_bCancel) return;
-            for (p=0; p<m_MatSize; p++)
+            double const *b = B + r*Size;
+            double const *x = X + r*Size;
+            double *res = R.data() + r*Size;
+            double bMax=0.0, rMax=0.0;
+            for(int i=0; i<Size; i++)
             {
-                m_Cp[p+q*m_MatSize] = m_Cp[p];
+                double const *a = m_aij + i*Size;
+                double sum = 0.0;
+                for(int j=0; j<Size; j++) sum += a[j]*x[j];
+                res[i] = b[i] - sum;
+                bMax = std::max(bMax, fabs(b[i]));
+                rMax = std::max(rMax, fabs(res[i]));
             }
+            if(bMax>0.0) maxRatio = std::max(maxRatio, rMax/bMax);
         }
-    }
-}
+        return maxRatio;
+    };
 
+    residual();
+    solveLinearSystem(R.data(), R.data(), Size, nRHS);
+    for(int i=0; i<Size*nRHS; i++) X[i] += R.at(i);
+
+    return residual()<LOWRANKTOLERANCE;
+}
 
 
 /**
-* Returns the influence at point C of the panel pPanel.
-* If the panel pPanel is located on a thin surface, then its the influence of a vortex.
-* If it is on a thick surface, then its a doublet.
-*
-*@param C the point where the influence is to be evaluated
-*@param pPanel a pointer to the Panel with the doublet strength
-*@param V the perturbation velocity at point C
-*@param phi the potential at point C
-*@param bWake true if the panel is located on the wake
-*@param bAll true if the influence of the bound vortex should be evaluated, in the case of a VLM analysis.
+* Calculates the full rows of the system for the rows i0 to i1-1, with at most PANELTILESIZE rows,
+* including the wake's contribution in the case of thick surfaces.
+* In the symmetric case, the rows are not folded.
+*@param i0 the index of the first row of the system
+*@param i1 the index past the last row
+*@param rows a pointer to the array in which the rows are stored consecutively
 */
-void PanelAnalysis::getDoubletInfluence(Vector3d const &C, Panel *pPanel, Vector3d &V, double &phi, bool bWake, bool bAll)
+void PanelAnalysis::computeSystemRows(int i0, int i1, double *rows)
 {
-    if(pPanel->m_Pos!=MIDSURFACE || pPanel->m_bIsWakePanel)
-        pPanel->doubletNASA4023(C, V, phi, bWake);
-    else
+    int n = i1-i0;
+    int index[PANELTILESIZE];
+    double *row[PANELTILESIZE];
+    for(int k=0; k<n; k++)
     {
-        VLMGetVortexInfluence(pPanel, C, V, bAll);
-        phi = 0.0;
+        index[k] = i0+k;
+        row[k] = rows + k*m_MatSize;
     }
 
-    if(m_pWPolar->bGround())
-    {
-        CG.set(C.x, C.y, -C.z-2.0*m_pWPolar->m_Height);
+    computeInfluenceRows(index, n, QVector<int>(), row);
 
-        if(pPanel->m_Pos!=MIDSURFACE || pPanel->m_bIsWakePanel)    pPanel->doubletNASA4023(CG, VG, phiG, bWake);
-        else
+    if(!m_pWPolar->bThinSurfaces())
+    {
+        QVector<double> aijWake(m_MatSize);
+        double uWake=0.0, wWake=0.0;
+        for(int k=0; k<n; k++)
         {
-            VLMGetVortexInfluence(pPanel, CG, VG, bAll);
-            phiG = 0.0;
+            int p = m_bSymmetric ? m_SymIndex.at(i0+k) : i0+k;
+            wakeContributionRow(p, aijWake.data(), uWake, wWake);
+            for(int pp=0; pp<m_MatSize; pp++) row[k][pp] += aijWake.at(pp);
         }
-        V.x += VG.x;
-        V.y += VG.y;
-        V.z -= VG.z;
-        phi += phiG;
     }
 }
 
 
 /**
-* Returns the influence at point C of a uniform source distribution on the panel pPanel
-* The panel is necessarily located on a thick surface, else the source strength is zero
-* @param C the point where the influence is to be evaluated
-* @param pPanel a pointer to the Panel with the doublet strength
-* @param V the perturbation velocity at point C
-* @param phi the potential at point C
+* Groups the rows of the system in the diagonal blocks of the block-Jacobi preconditioner.
+*
+* The strips are found from the upstream and downstream neighbours of the panels, so that the blocks do not
+* depend on the order in which the panels are numbered. The strips are taken in the order of their first row,
+* and the consecutive strips are gathered in blocks of at most ITERATIVEBLOCKSIZE rows; a strip which is longer
+* than ITERATIVEBLOCKSIZE is split. Each block thus holds the near-field interactions of whole neighbouring strips.
+*@param Size the size of the linear system
 */
-void PanelAnalysis::getSourceInfluence(Vector3d const &C, Panel *pPanel, Vector3d &V, double &phi)
+void PanelAnalysis::makeJacobiBlocks(int Size)
 {
-    pPanel->sourceNASA4023(C, V, phi);
+    // the strip of each row, as the first row of the strip, found by following the links to the upstream panels
+    QVector<int> strip(Size);
+    for(int i=0; i<Size; i++) strip[i] = i;
 
-    if(m_pWPolar->bGround())
+    auto rowOf = [this](int p) {return m_bSymmetric ? m_SymRow.at(p) : p;};
+    auto findStrip = [&strip](int i)
     {
-        CG.set(C.x, C.y, -C.z-2.0*m_pWPolar->m_Height);
-        pPanel->sourceNASA4023(CG, VG, phiG);
-        V.x += VG.x;
-        V.y += VG.y;
-        V.z -= VG.z;
-        phi += phiG;
+        while(strip.at(i)!=i)
+        {
+            strip[i] = strip.at(strip.at(i));
+            i = strip.at(i);
+        }
+        return i;
+    };
+
+    for(int i=0; i<Size; i++)
+    {
+        int p = m_bSymmetric ? m_SymIndex.at(i) : i;
+        int neighbour[] = {m_pPanel[p].m_iPU, m_pPanel[p].m_iPD};
+        for(int k=0; k<2; k++)
+        {
+            if(neighbour[k]<0 || neighbour[k]>=m_MatSize) continue;
+            int j = rowOf(neighbour[k]);
+            if(j<0 || j>=Size) continue;
+            int si = findStrip(i);
+            int sj = findStrip(j);
+            if(si<sj)      strip[sj] = si;
+            else if(sj<si) strip[si] = sj;
+        }
+    }
+
+    // the rows of each strip, the strips being sorted by their first row
+    for(int i=0; i<Size; i++) strip[i] = findStrip(i);
+    QVector<int> stripSize(Size, 0), stripStart(Size, 0), stripPos(Size, 0);
+    for(int i=0; i<Size; i++) stripSize[strip.at(i)]++;
+    int pos = 0;
+    for(int i=0; i<Size; i++)
+    {
+        if(strip.at(i)!=i) continue;
+        stripStart[i] = stripPos[i] = pos;
+        pos += stripSize.at(i);
+    }
+    m_JacobiRows.resize(Size);
+    for(int i=0; i<Size; i++) m_JacobiRows[stripPos[strip.at(i)]++] = i;
+
+    // the blocks, which do not cut the strips unless a strip is longer than a block
+    m_JacobiStart.clear();
+    int blockSize = 0;
+    for(int i=0; i<Size; i++)
+    {
+        if(strip.at(i)!=i) continue;
+        int n = stripSize.at(i);
+        if(blockSize>0 && blockSize+n>ITERATIVEBLOCKSIZE) blockSize = 0;
+        if(blockSize==0) m_JacobiStart.append(stripStart.at(i));
+        blockSize += n;
+        while(blockSize>ITERATIVEBLOCKSIZE)
+        {
+            m_JacobiStart.append(m_JacobiStart.last()+ITERATIVEBLOCKSIZE);
+            blockSize -= ITERATIVEBLOCKSIZE;
+        }
     }
+    m_JacobiStart.append(Size);
 }
 
 
 /**
-* Returns the perturbation velocity vector at a given point, due to the distribution of source and doublet/circulation strengths.
-* @param C the point where the influence is to be evaluated
-* @param Mu a pointer to the array of doublet strength or vortex circulations
-* @param sigma a pointer to the array of source strengths
-* @param VT the resulting perturbation velocity
-* @param bAll true if the influence of the bound vortex should be included, in the case of a VLM analysis
+* Prepares the iterative solution of the system.
+*
+* The influence matrix is not stored; its coefficients are calculated again at each product by the matrix,
+* except for the leading rows which fit in MAXITERATIVEROWSIZE coefficients and which are kept in memory.
+* The memory in use is thus bounded whatever the size of the mesh.
+* The rows are calculated once here, to keep the leading rows and to build the preconditioner.
+*
+* The preconditioner is block-Jacobi: the diagonal blocks of the rows grouped by makeJacobiBlocks() are factored.
+*
+*@param Size the size of the linear system
+*@return true if the preconditioner has been built, false if the analysis has been cancelled or a block is singular.
 */
-void PanelAnalysis::getSpeedVector(Vector3d const &C, double *Mu, double *Sigma, Vector3d &VT, bool bAll)
+bool PanelAnalysis::setupIterativeSolver(int Size)
 {
-    Vector3d V;
-    int pp, pw, lw;
-    double phi, sign;
+    traceLog("      Building the preconditioner of the iterative solver...\n");
 
-    VT.set(0.0,0.0,0.0);
+    m_nStoredRows = qMin(Size, m_MaxStoredRows);
+    m_StoredRows.resize(m_nStoredRows*m_MatSize);
 
-    for (pp=0; pp<m_MatSize;pp++)
-    {
-        if(s_bCancel) return;
+    makeJacobiBlocks(Size);
+    int nBlocks = m_JacobiStart.size()-1;
 
-        if(m_pPanel[pp].m_Pos!=MIDSURFACE) //otherwise Sigma[pp] =0.0, so contribution is zero also
+    // the block of each row, its position in the block, and the position of each block in the array of the LU factors
+    QVector<int> rowBlock(Size), rowPos(Size), blockOffset(nBlocks+1);
+    blockOffset[0] = 0;
+    for(int ib=0; ib<nBlocks; ib++)
+    {
+        int n = m_JacobiStart.at(ib+1)-m_JacobiStart.at(ib);
+        for(int k=0; k<n; k++)
         {
-            getSourceInfluence(C, m_pPanel+pp, V, phi);
-            VT += V * Sigma[pp] ;
+            rowBlock[m_JacobiRows.at(m_JacobiStart.at(ib)+k)] = ib;
+            rowPos[m_JacobiRows.at(m_JacobiStart.at(ib)+k)] = k;
         }
-        getDoubletInfluence(C, m_pPanel+pp, V, phi, false, bAll);
+        blockOffset[ib+1] = blockOffset.at(ib) + n*n;
+    }
+    m_JacobiLU.resize(blockOffset.at(nBlocks));
+    m_JacobiIndex.resize(Size);
 
-        VT += V * Mu[pp];
+    // the rows are calculated by tiles, and each row is copied to the row of its block
+    int nTiles = (Size+PANELTILESIZE-1)/PANELTILESIZE;
+    auto buildTile = [this, Size, &rowBlock, &rowPos, &blockOffset](int const &it)
+    {
+        if(isCancelled()) return;
+        QVector<double> rows(PANELTILESIZE*m_MatSize), symRow(Size);
+        int r0 = it*PANELTILESIZE;
+        int r1 = qMin(r0+PANELTILESIZE, Size);
+        computeSystemRows(r0, r1, rows.data());
 
-        // Is the panel pp shedding a wake ?
-        if(m_pPanel[pp].m_bIsTrailing && m_pPanel[pp].m_Pos!=MIDSURFACE)
+        for(int i=r0; i<r1; i++)
         {
-            //If so, we need to add the contribution of the wake column shedded by this panel
-            if(m_pPanel[pp].m_Pos==BOTSURFACE) sign=-1.0; else sign=1.0;
-            pw = m_pPanel[pp].m_iWake;
-            for(lw=0; lw<m_pWPolar->m_NXWakePanels; lw++)
+            double const *row = rows.constData() + (i-r0)*m_MatSize;
+            if(i<m_nStoredRows) memcpy(m_StoredRows.data()+i*m_MatSize, row, ulong(m_MatSize)*sizeof(double));
+            if(m_bSymmetric)
             {
-                getDoubletInfluence(C, m_pWakePanel+pw+lw, V, phi, true, bAll);
-                VT += V * Mu[pp]*sign;
+                foldSymmetricRow(row, symRow.data());
+                row = symRow.constData();
             }
+            int ib = rowBlock.at(i);
+            int j0 = m_JacobiStart.at(ib);
+            int n = m_JacobiStart.at(ib+1)-j0;
+            double *blockRow = m_JacobiLU.data() + blockOffset.at(ib) + rowPos.at(i)*n;
+            for(int k=0; k<n; k++) blockRow[k] = row[m_JacobiRows.at(j0+k)];
         }
+    };
+
+    QAtomicInt bSingular(0);
+    auto factorBlock = [this, &blockOffset, &bSingular](int const &ib)
+    {
+        if(isCancelled()) return;
+        int j0 = m_JacobiStart.at(ib);
+        int n = m_JacobiStart.at(ib+1)-j0;
+        double progress = 0.0;
+        if(!Crout_LU_Decomposition_with_Pivoting(m_JacobiLU.data()+blockOffset.at(ib), m_JacobiIndex.data()+j0, n, &m_bCancel, 0.0, progress))
+            bSingular.storeRelease(1);
+    };
+
+    if(s_bMultiThread)
+    {
+        QVector<int> tiles(nTiles);
+        for(int it=0; it<nTiles; it++) tiles[it] = it;
+        QtConcurrent::blockingMap(tiles, buildTile);
+        QVector<int> blocks(nBlocks);
+        for(int ib=0; ib<nBlocks; ib++) blocks[ib] = ib;
+        QtConcurrent::blockingMap(blocks, factorBlock);
     }
-}
+    else
+    {
+        for(int it=0; it<nTiles; it++) buildTile(it);
+        for(int ib=0; ib<nBlocks; ib++) factorBlock(ib);
+    }
+    m_Progress += double(m_MatSize);
 
+    if(isCancelled()) return false;
+    if(bSingular.loadAcquire())
+    {
+        traceLog("      Singular preconditioner.... Aborting calculation...\n");
+        return false;
+    }
 
+    QString strange = QString("      Keeping %1 rows out of %2 in memory, %3 blocks in the preconditioner\n").arg(m_nStoredRows).arg(Size).arg(nBlocks);
+    traceLog(strange);
 
+    m_bMatrixFactored = true;
+    return true;
+}
 
 
 /**
-* Launches a calculation over the input sequence of velocity.
-* Used for type 4 analysis, without tilted geometry.
-*
-* The calculation is performed for two unit RHS, and all the Operating POints are calculated by linear combination.
-* The two unit RHS are for a unit velocity along the x-axis, and for a unit velocity along the z-axis.
-*@return true if all the aoa were computed successfully, false otherwise. Interpolation issues are not counted as unsuccessful.
+* Calculates the products of the system's matrix by a set of vectors.
+* The rows which have not been kept in memory are calculated again tile by tile, and each of them is applied to all the vectors.
+*@param X a pointer to the vectors, stored consecutively
+*@param Y a pointer to the array of the products, stored consecutively
+*@param Size the size of the linear system
+*@param nVec the number of vectors
 */
-bool PanelAnalysis::QInfLoop()
+void PanelAnalysis::multiplySystemMatrix(double const *X, double *Y, int Size, int nVec)
 {
-    QString str;
-    double Alpha = 0.0;
-
-    setInertia(0.0, 0.0, 0.0);
-
-    m_QInf = m_vMin;
-
-    if(!m_pWPolar->bThinSurfaces()) m_TotalTime +=1.0; //for wake contribution
-
-    m_Progress = 0.0;
-
-    if(m_pWPolar->bTilted())
+    // in the symmetric case, the vectors are expanded to all the panels so that the full rows may be used
+    QVector<double> XFull;
+    double const *x = X;
+    if(m_bSymmetric)
     {
-        //reset the initial geometry before a new angle is processed
-        memcpy(m_pPanel,     m_pMemPanel,     m_MatSize * sizeof(Panel));
-        memcpy(m_pNode,      m_pMemNode,      m_nNodes  * sizeof(Vector3d));
-        memcpy(m_pWakePanel, m_pRefWakePanel, m_WakeSize * sizeof(Panel));
-        memcpy(m_pWakeNode,  m_pRefWakeNode,  m_nWakeNodes * sizeof(Vector3d));
-        memcpy(m_pTempWakeNode,  m_pRefWakeNode,  m_nWakeNodes * sizeof(Vector3d));
+        XFull.resize(nVec*m_MatSize);
+        for(int r=0; r<nVec; r++) expandSymmetricSolution(X+r*Size, XFull.data()+r*m_MatSize);
+        x = XFull.constData();
+    }
 
-        // Rotate the wing panels and translate the wake to the new T.E. position
-        Vector3d O;
-        rotateGeomY(m_pWPolar->m_AlphaSpec, O, m_pWPolar->m_NXWakePanels);
+    int nTiles = (Size+PANELTILESIZE-1)/PANELTILESIZE;
+    auto multiplyTile = [this, x, Y, Size, nVec](int const &it)
+    {
+        if(isCancelled()) return;
+        int i0 = it*PANELTILESIZE;
+        int i1 = qMin(i0+PANELTILESIZE, Size);
+        QVector<double> rows;
+        double const *pRows = nullptr;
+        if(i1<=m_nStoredRows) pRows = m_StoredRows.constData() + i0*m_MatSize;
+        else
+        {
+            rows.resize(PANELTILESIZE*m_MatSize);
+            computeSystemRows(i0, i1, rows.data());
+            pRows = rows.constData();
+        }
+        for(int i=i0; i<i1; i++)
+        {
+            double const *a = pRows + (i-i0)*m_MatSize;
+            for(int r=0; r<nVec; r++)
+            {
+                double const *xr = x + r*m_MatSize;
+                double sum = 0.0;
+                for(int pp=0; pp<m_MatSize; pp++) sum += a[pp]*xr[pp];
+                Y[r*Size+i] = sum;
+            }
+        }
+    };
 
-        m_OpAlpha = m_pWPolar->m_AlphaSpec;
-        Alpha = 0.0;
+    if(s_bMultiThread)
+    {
+        QVector<int> tiles(nTiles);
+        for(int it=0; it<nTiles; it++) tiles[it] = it;
+        QtConcurrent::blockingMap(tiles, multiplyTile);
     }
     else
     {
-        Alpha = m_Alpha;
-        m_OpAlpha = m_Alpha;
+        for(int it=0; it<nTiles; it++) multiplyTile(it);
     }
+}
 
-    str = QString("   Solving the problem... \n");
-    traceLog("\n"+str);
 
-    buildInfluenceMatrix();
-    if (s_bCancel) return true;
+/**
+* Applies the inverse of the block-Jacobi preconditioner to a set of vectors.
+*@param X a pointer to the vectors, stored consecutively, which are replaced by the results
+*@param Size the size of the linear system
+*@param nVec the number of vectors
+*/
+void PanelAnalysis::preconditionSystem(double *X, int Size, int nVec)
+{
+    int nBlocks = m_JacobiStart.size()-1;
+    double xb[ITERATIVEBLOCKSIZE];
+    for(int r=0; r<nVec; r++)
+    {
+        double *x = X + r*Size;
+        double *LU = m_JacobiLU.data();
+        for(int ib=0; ib<nBlocks; ib++)
+        {
+            int j0 = m_JacobiStart.at(ib);
+            int n = m_JacobiStart.at(ib+1)-j0;
+            for(int k=0; k<n; k++) xb[k] = x[m_JacobiRows.at(j0+k)];
+            Crout_LU_with_Pivoting_Solve(LU, xb, m_JacobiIndex.data()+j0, xb, n, &m_bCancel);
+            for(int k=0; k<n; k++) x[m_JacobiRows.at(j0+k)] = xb[k];
+            LU += n*n;
+        }
+    }
+}
+
 
-    createUnitRHS();
-    if (s_bCancel) return true;
+/**
+* Builds the influence matrix in single precision and performs its LU decomposition.
+*
+* The rows of the system, including the wake's contribution, are calculated in double precision by tiles
+* of PANELTILESIZE rows, folded in the symmetric case, and rounded to single precision in m_aijSingle.
+* The leading rows which fit in the memory budget are kept in double precision, so that the residuals of
+* the iterative refinement are evaluated without calculating these rows again.
+*@param Size the size of the linear system
+*@param TaskSize the estimated time of the decomposition, used to update the progress
+*@return true if the matrix has been factored, false if it is singular or if the analysis has been cancelled.
+*/
+bool PanelAnalysis::setupSinglePrecision(int Size, double TaskSize)
+{
+    traceLog("      Creating the single precision influence matrix...\n");
 
-    createSourceStrength(m_Alpha, 0.0, 1);
-    if (s_bCancel) return true;
+    m_nStoredRows = qMin(Size, m_MaxStoredRows);
+    m_StoredRows.resize(m_nStoredRows*m_MatSize);
 
-    if(!m_pWPolar->bThinSurfaces())
+    int nTiles = (Size+PANELTILESIZE-1)/PANELTILESIZE;
+    auto buildTile = [this, Size](int const &it)
     {
-        //compute wake contribution
-        createWakeContribution();
+        if(isCancelled()) return;
+        QVector<double> rows(PANELTILESIZE*m_MatSize), symRow(Size);
+        int i0 = it*PANELTILESIZE;
+        int i1 = qMin(i0+PANELTILESIZE, Size);
+        computeSystemRows(i0, i1, rows.data());
 
-        //add wake contribution to matrix and RHS
-        for(int p=0; p<m_MatSize; p++)
+        for(int i=i0; i<i1; i++)
         {
-            m_uRHS[p]+= m_uWake[p];
-            m_wRHS[p]+= m_wWake[p];
-            for(int pp=0; pp<m_MatSize; pp++)
+            double const *row = rows.constData() + (i-i0)*m_MatSize;
+            if(i<m_nStoredRows) memcpy(m_StoredRows.data()+i*m_MatSize, row, ulong(m_MatSize)*sizeof(double));
+            if(m_bSymmetric)
             {
-                m_aij[p*m_MatSize+pp] += m_aijWake[p*m_MatSize+pp];
+                foldSymmetricRow(row, symRow.data());
+                row = symRow.constData();
             }
+            float *aij = m_aijSingle + i*Size;
+            for(int j=0; j<Size; j++) aij[j] = float(row[j]);
         }
-    }
-    if (s_bCancel) return true;
+    };
 
-    if (!solveUnitRHS())
+    if(s_bMultiThread)
     {
-        s_bWarning = true;
-        return true;
+        QVector<int> tiles(nTiles);
+        for(int it=0; it<nTiles; it++) tiles[it] = it;
+        QtConcurrent::blockingMap(tiles, buildTile);
     }
-    if (s_bCancel) return true;
-
-    createDoubletStrength(Alpha, m_vDelta, 1);
-    if (s_bCancel) return true;
-
+    else
+    {
+        for(int it=0; it<nTiles; it++) buildTile(it);
+    }
+    m_Progress += 10.0*double(Size)/400.0;
+    if(isCancelled()) return false;
 
-    computeFarField(1.0, m_OpAlpha, 0.0, 1);
-    if (s_bCancel) return true;
+    traceLog("      Performing the single precision LU decomposition...\n");
+    if(!Crout_LU_Decomposition_with_Pivoting(m_aijSingle, m_Index, Size, &m_bCancel, TaskSize, m_Progress))
+    {
+        traceLog("      Singular Matrix.... Aborting calculation...\n");
+        return false;
+    }
+    if(isCancelled()) return false;
 
+    m_bMatrixFactored = true;
+    return true;
+}
 
-    for(int q=0; q<m_nRHS; q++)
-        m_3DQInf[q] = m_QInf+q*m_vDelta;
 
-    scaleResultstoSpeed(m_nRHS);
-    if (s_bCancel) return true;
+/**
+* Refines the solutions obtained with the single precision LU factors.
+* At each step, the residuals are evaluated in double precision with the rows of the system, which are
+* either kept in memory or calculated again, and the corrections are solved with the single precision factors.
+* Each step gains about as many digits as the single precision factors hold, less the log of the condition number
+* of the matrix, so that a few steps recover the accuracy of a double precision solve for the well-conditioned panel systems.
+* The iterations are stopped if the residuals do not decrease, which indicates an ill-conditioned matrix.
+*@param B a pointer to the array of the original RHS
+*@param X a pointer to the array of solutions, which are refined in place
+*@param Size the size of the linear system
+*@param nRHS the number of RHS
+*@return true if the relative residuals are less than MIXEDTOLERANCE.
+*/
+bool PanelAnalysis::refineSinglePrecisionSolution(double const *B, double *X, int Size, int nRHS)
+{
+    QVector<double> R(Size*nRHS);
 
+    auto residual = [this, B, X, Size, nRHS, &R]()
+    {
+        multiplySystemMatrix(X, R.data(), Size, nRHS);
+        double maxRatio = 0.0;
+        for(int r=0; r<nRHS; r++)
+        {
+            double const *b = B + r*Size;
+            double *res = R.data() + r*Size;
+            double bMax=0.0, rMax=0.0;
+            for(int i=0; i<Size; i++)
+            {
+                res[i] = b[i] - res[i];
+                bMax = std::max(bMax, fabs(b[i]));
+                rMax = std::max(rMax, fabs(res[i]));
+            }
+            if(bMax>0.0) maxRatio = std::max(maxRatio, rMax/bMax);
+        }
+        return maxRatio;
+    };
 
-    computeOnBodyCp(m_QInf, m_vDelta, m_nRHS);
-    if (s_bCancel) return true;
+    int nSteps = 0;
+    double maxRatio = residual();
+    while(maxRatio>=MIXEDTOLERANCE && nSteps<MIXEDMAXREFINEMENT)
+    {
+        if(isCancelled()) return false;
+        Crout_LU_with_Pivoting_Solve(m_aijSingle, R.data(), m_Index, R.data(), Size, nRHS, &m_bCancel);
+        for(int i=0; i<Size*nRHS; i++) X[i] += R.at(i);
+        nSteps++;
 
-    computeAeroCoefs(m_QInf, m_vDelta, m_nRHS);
-    if (s_bCancel) return true;
+        double lastRatio = maxRatio;
+        maxRatio = residual();
+        if(maxRatio>0.5*lastRatio) break;
+    }
+    if(isCancelled()) return false;
 
-    return true;
+    QString strange;
+    if(maxRatio<MIXEDTOLERANCE) strange = QString("      Mixed precision solution refined in %1 steps\n").arg(nSteps);
+    else                        strange = QString("      Mixed precision refinement did not converge in %1 steps, residual=%2\n").arg(nSteps).arg(maxRatio, 0, 'g', 3);
+    traceLog(strange);
+    return maxRatio<MIXEDTOLERANCE;
 }
 
 
-
 /**
 * Solves the linear system for the two unit RHS, using LU decomposition.
+* If the system has been reduced by symmetry, the reduced system is solved and the solution is expanded to all the panels.
 * Calculates the local velocities on each panel for the two unit RHS
 */
 bool PanelAnalysis::solveUnitRHS()
@@ -2127,28 +3849,84 @@ bool PanelAnalysis::solveUnitRHS()
     QTime t;
     t.start();
 
-    memcpy(m_RHS,      m_uRHS, Size * sizeof(double));
-    memcpy(m_RHS+Size, m_wRHS, Size * sizeof(double));
-
-    traceLog("      Performing LU Matrix decomposition...\n");
+    if(m_bSymmetric)
+    {
+        Size = m_SymSize;
+        for(int i=0; i<Size; i++)
+        {
+            m_RHS[i]      = m_uRHS[m_SymIndex[i]];
+            m_RHS[Size+i] = m_wRHS[m_SymIndex[i]];
+        }
+    }
+    else
+    {
+        memcpy(m_RHS,      m_uRHS, Size * sizeof(double));
+        memcpy(m_RHS+Size, m_wRHS, Size * sizeof(double));
+    }
 
-    if(!Crout_LU_Decomposition_with_Pivoting(m_aij, m_Index, Size, &s_bCancel, taskTime*(double)m_MatSize/400.0, m_Progress))
+    if(!m_bMatrixFactored)
     {
-        traceLog("      Singular Matrix.... Aborting calculation...\n");
-        return false;
+        if(m_bIterative)
+        {
+            if(!setupIterativeSolver(Size)) return false;
+        }
+        else if(m_bSinglePrecision)
+        {
+            if(!setupSinglePrecision(Size, taskTime*(double)m_MatSize/400.0)) return false;
+        }
+        else if(!setupLowRankUpdate(Size))
+        {
+            if(isCancelled()) return false;
+            if(!factorizeMatrix(Size, taskTime*(double)m_MatSize/400.0)) return false;
+        }
+        else m_Progress += taskTime*(double)m_MatSize/400.0;
+    }
+    else if(!m_bIterative && !m_bSinglePrecision)
+    {
+        traceLog("      Using the cached LU decomposition of the influence matrix...\n");
+        m_Progress += taskTime*(double)m_MatSize/400.0;
     }
 
-    traceLog("      Solving the LU system...\n");
-    Crout_LU_with_Pivoting_Solve(m_aij, m_uRHS, m_Index, m_RHS,      Size, &s_bCancel);
-    Crout_LU_with_Pivoting_Solve(m_aij, m_wRHS, m_Index, m_RHS+Size, Size, &s_bCancel);
+    if(m_bIterative || m_bSinglePrecision)
+    {
+        if(!solveLinearSystem(m_RHS, m_RHS, Size, 2)) return false;
+    }
+    else if(!m_bLowRankUpdate)
+    {
+        traceLog("      Solving the LU system...\n");
+        solveLinearSystem(m_RHS, m_RHS, Size, 2);
+    }
+    else
+    {
+        traceLog("      Solving the LU system...\n");
+        // the RHS array is modified by the solve, so that a copy is needed to check the residuals
+        QVector<double> B(2*Size);
+        memcpy(B.data(), m_RHS, ulong(2*Size)*sizeof(double));
+        solveLinearSystem(m_RHS, m_RHS, Size, 2);
+        if(!refineLowRankSolution(B.constData(), m_RHS, Size, 2))
+        {
+            traceLog("      Inaccurate low-rank update, performing the full LU decomposition...\n");
+            memcpy(m_RHS, B.constData(), ulong(2*Size)*sizeof(double));
+            if(!factorizeMatrix(Size, taskTime*(double)m_MatSize/400.0)) return false;
+            solveLinearSystem(m_RHS, m_RHS, Size, 2);
+        }
+    }
 
     QString strange;
     strange.sprintf("      Time for linear system solve: %.3f s\n", double(t.elapsed())/1000.0);
     //    qDebug(strange.toStdString().c_str());
     traceLog(strange);
 
-    memcpy(m_uRHS, m_RHS,           m_MatSize*sizeof(double));
-    memcpy(m_wRHS, m_RHS+m_MatSize, m_MatSize*sizeof(double));
+    if(m_bSymmetric)
+    {
+        expandSymmetricSolution(m_RHS,      m_uRHS);
+        expandSymmetricSolution(m_RHS+Size, m_wRHS);
+    }
+    else
+    {
+        memcpy(m_uRHS, m_RHS,           m_MatSize*sizeof(double));
+        memcpy(m_wRHS, m_RHS+m_MatSize, m_MatSize*sizeof(double));
+    }
 
     //   Define unit local velocity vector, necessary for moment calculations in stability analysis of 3D panels
     Vector3d u(1.0, 0.0, 0.0);
@@ -2164,7 +3942,7 @@ bool PanelAnalysis::solveUnitRHS()
             getDoubletDerivative(p, m_uRHS, Cp, m_uVl[p], 1.0, u.x, u.y, u.z);
             getDoubletDerivative(p, m_wRHS, Cp, m_wVl[p], 1.0, w.x, w.y, w.z);
         }
-        if(s_bCancel) return false;
+        if(isCancelled()) return false;
     }
 
     //for(int p=0; p<m_MatSize; p++) displayDouble('local', m_uVl[p].x, m_uVl[p].y, m_uVl[p].z, m_wVl[p].x, m_wVl[p].y, m_wVl[p].z);
@@ -2308,15 +4086,15 @@ bool PanelAnalysis::unitLoop()
             rotateGeomZ(m_OpBeta, O, m_pWPolar->m_NXWakePanels);
         }
 
-        buildInfluenceMatrix();
-        if (s_bCancel) return true;
+        if(!restoreFactoredMatrix()) buildInfluenceMatrix();
+        if (isCancelled()) return true;
 
         createUnitRHS();
-        if (s_bCancel) return true;
+        if (isCancelled()) return true;
 
 
         createSourceStrength(0.0, m_vDelta, 1);
-        if (s_bCancel) return true;
+        if (isCancelled()) return true;
 
         for (nWakeIter = 0; nWakeIter<MaxWakeIter; nWakeIter++)
         {
@@ -2326,48 +4104,50 @@ bool PanelAnalysis::unitLoop()
                 traceLog(str);
             }
 
-            if (s_bCancel) return true;
+            if (isCancelled()) return true;
 
             /** @todo : check... may not be quite correct */
             if(!m_pWPolar->bThinSurfaces())
             {
                 //compute wake contribution
-                createWakeContribution();
+                if(!m_bMatrixFactored) createWakeContribution();
+                if (isCancelled()) return true;
                 //add wake contribution to matrix and RHS
                 for(int p=0; p<m_MatSize; p++)
                 {
                     m_uRHS[p]+= m_uWake[p];
                     m_wRHS[p]+= m_wWake[p];
-                    for(int pp=0; pp<m_MatSize; pp++)
-                    {
-                        m_aij[p*m_MatSize+pp] += m_aijWake[p*m_MatSize+pp];
-                    }
+                }
+                if(!m_bMatrixFactored && !m_bIterative && !m_bSinglePrecision)
+                {
+                    int Size = m_bSymmetric ? m_SymSize : m_MatSize;
+                    for(int p=0; p<Size*Size; p++) m_aij[p] += m_aijWake[p];
                 }
             }
 
-            if (s_bCancel) return true;
+            if (isCancelled()) return true;
 
             if (!solveUnitRHS())
             {
                 s_bWarning = true;
                 return true;
             }
-            if (s_bCancel) return true;
+            if (isCancelled()) return true;
 
             createDoubletStrength(0.0, m_vDelta, 1);
-            if (s_bCancel) return true;
+            if (isCancelled()) return true;
 
             computeFarField(1.0, 0.0, m_vDelta, 1);
-            if (s_bCancel) return true;
+            if (isCancelled()) return true;
 
             computeBalanceSpeeds(0.0, 0);
-            if (s_bCancel) return true;
+            if (isCancelled()) return true;
 
             scaleResultstoSpeed(1);
-            if (s_bCancel) return true;
+            if (isCancelled()) return true;
 
             computeOnBodyCp(0.0, m_vDelta, 1);
-            if (s_bCancel) return true;
+            if (isCancelled()) return true;
 
 //            if(MaxWakeIter>0 && m_pWPolar->bWakeRollUp()) relaxWake();
         }
@@ -2618,12 +4398,12 @@ bool PanelAnalysis::controlLoop()
         setControlPositions(m_Ctrl, m_NCtrls, outString, true);
 
         traceLog(outString);
-        if(s_bCancel) break;
+        if(isCancelled()) break;
 
         // next find the balanced and trimmed conditions
         if(!computeTrimmedConditions())
         {
-            if(s_bCancel) break;
+            if(isCancelled()) break;
             //no zero moment alpha
             str = QString("      Unsuccessful attempt to trim the model for control position=%1 - skipping.\n\n\n").arg(m_Ctrl,5,'f',2);
             traceLog(str);
@@ -2634,15 +4414,15 @@ bool PanelAnalysis::controlLoop()
             m_3DQInf[i] = u0;
             m_QInf      = u0;
 
-            if (s_bCancel) return true;
+            if (isCancelled()) return true;
 
             //Build the rotation matrix from body axes to stability axes
             buildRotationMatrix();
-            if(s_bCancel) break;
+            if(isCancelled()) break;
 
             // Compute inertia in stability axes
             computeStabilityInertia();
-            if(s_bCancel) break;
+            if(isCancelled()) break;
 
             str = "\n      ___Inertia - Stability Axis - CoG Origin____\n";
             traceLog(str);
@@ -2658,10 +4438,10 @@ bool PanelAnalysis::controlLoop()
             // Compute stability and control derivatives in stability axes
             // viscous or not viscous ?
             computeStabilityDerivatives();
-            if(s_bCancel) break;
+            if(isCancelled()) break;
 
             computeControlDerivatives(); //single derivative, wrt the polar's control variable
-            if(s_bCancel) break;
+            if(isCancelled()) break;
 
             computeNDStabDerivatives();
 
@@ -2679,10 +4459,10 @@ bool PanelAnalysis::controlLoop()
             {
                 // Compute aero coefficients for trimmed conditions
                 computeFarField(m_QInf, m_AlphaEq, 0.0, 1);
-                if (s_bCancel) return true;
+                if (isCancelled()) return true;
 
                 computeOnBodyCp(m_AlphaEq, 0.0, 1);
-                if (s_bCancel) return true;
+                if (isCancelled()) return true;
 
 
                 str = QString("      Computing Plane for alpha=%1").arg(m_AlphaEq,7,'f',2);
@@ -2690,12 +4470,12 @@ bool PanelAnalysis::controlLoop()
                 traceLog(str);
                 computePlane(m_AlphaEq, u0, 0);
 
-                if (s_bCancel) return true;
+                if (isCancelled()) return true;
             }
             str = QString("\n     ______Finished operating point calculation for control position %1________\n\n\n\n\n").arg(m_Ctrl, 5,'f',2);
             traceLog(str);
         }
-        if(s_bCancel) break;
+        if(isCancelled()) break;
     }
     return true;
 }
@@ -2978,6 +4758,8 @@ void PanelAnalysis::forces(double *Mu, double *Sigma, double alpha, Vector3d Vin
 
     bOut = bOutCl = bError = false;
 
+    strengthsChanged();
+
     int coef = 2;
     if (m_pWPolar->bThinSurfaces()) coef = 1;
 
@@ -3188,9 +4970,9 @@ bool PanelAnalysis::getZeroMomentAngle()
         Cm0 = computeCm(a0*180.0/PI);
         Cm1 = computeCm(a1*180.0/PI);
         iter++;
-        if(s_bCancel) break;
+        if(isCancelled()) break;
     }
-    if(iter>=100 || s_bCancel) return false;
+    if(iter>=100 || isCancelled()) return false;
 
     iter = 0;
 
@@ -3220,10 +5002,10 @@ bool PanelAnalysis::getZeroMomentAngle()
             Cm0 = Cm;
         }
         iter++;
-        if(s_bCancel) break;
+        if(isCancelled()) break;
     }
 
-    if(iter>=CM_ITER_MAX || s_bCancel) return false;
+    if(iter>=CM_ITER_MAX || isCancelled()) return false;
 
     m_AlphaEq = a*180.0/PI;
     //    Cm = computeCm(m_AlphaEq);// for information only, should be zero
@@ -3419,25 +5201,26 @@ bool PanelAnalysis::computeTrimmedConditions()
 
     //Build the unit RHS vectors along x and z in Body Axis
     createUnitRHS();
-    if (s_bCancel) return false;
+    if (isCancelled()) return false;
 
     // build the influence matrix in Body Axis
-    buildInfluenceMatrix();
-    if (s_bCancel) return false;
+    if(!restoreFactoredMatrix()) buildInfluenceMatrix();
+    if (isCancelled()) return false;
 
     if(!m_pWPolar->bThinSurfaces())
     {
         //compute wake contribution
-        createWakeContribution();
+        if(!m_bMatrixFactored) createWakeContribution();
         //add wake contribution to matrix and RHS
         for(int p=0; p<m_MatSize; p++)
         {
             m_uRHS[p]+= m_uWake[p];
             m_wRHS[p]+= m_wWake[p];
-            for(int pp=0; pp<m_MatSize; pp++)
-            {
-                m_aij[p*m_MatSize+pp] += m_aijWake[p*m_MatSize+pp];
-            }
+        }
+        if(!m_bMatrixFactored && !m_bIterative && !m_bSinglePrecision)
+        {
+            int Size = m_bSymmetric ? m_SymSize : m_MatSize;
+            for(int p=0; p<Size*Size; p++) m_aij[p] += m_aijWake[p];
         }
     }
 
@@ -3460,11 +5243,11 @@ bool PanelAnalysis::computeTrimmedConditions()
     traceLog(strong);
 
     createSourceStrength(m_AlphaEq, 0.0, 1);
-    if (s_bCancel) return true;
+    if (isCancelled()) return true;
 
     //reconstruct doublet strengths from unit cosine and sine vectors
     createDoubletStrength(m_AlphaEq, 0.0, 1.0);
-    if(s_bCancel) return false;
+    if(isCancelled()) return false;
 
     //______________________________________________________________________________________
     // Calculate the trimmed conditions for this control setting and calculated Alpha_eq
@@ -3635,9 +5418,9 @@ void PanelAnalysis::computeStabilityDerivativesOld()
         m_Sigma[p+2*m_MatSize] = -1.0/4.0/PI* (m_RHS[56*m_MatSize+p] *m_pPanel[p].Normal.x + m_RHS[57*m_MatSize+p] *m_pPanel[p].Normal.y + m_RHS[58*m_MatSize+p] *m_pPanel[p].Normal.z);
     }
 
-    createRHS(m_uRHS, Vi);
-    createRHS(m_vRHS, Vj);
-    createRHS(m_wRHS, Vk);
+    Vector3d VTrans[] = {Vi, Vj, Vk};
+    double *RHSTrans[] = {m_uRHS, m_vRHS, m_wRHS};
+    createRHS(3, RHSTrans, VTrans);
 
     //______________________________________________________________________________
     // RHS for unit rotation vectors around Stability axis
@@ -3671,9 +5454,10 @@ void PanelAnalysis::computeStabilityDerivativesOld()
         m_Sigma[p+5*m_MatSize] = -1.0/4.0/PI* (m_RHS[65*m_MatSize+p]*m_pPanel[p].Normal.x + m_RHS[66*m_MatSize+p]*m_pPanel[p].Normal.y + m_RHS[67*m_MatSize+p]*m_pPanel[p].Normal.z);
     }
 
-    createRHS(m_pRHS, WindDirection, m_RHS+59*m_MatSize);
-    createRHS(m_qRHS, WindDirection, m_RHS+62*m_MatSize);
-    createRHS(m_rRHS, WindDirection, m_RHS+65*m_MatSize);
+    Vector3d VRot[] = {WindDirection, WindDirection, WindDirection};
+    double *RHSRot[] = {m_pRHS, m_qRHS, m_rRHS};
+    double *VFieldRot[] = {m_RHS+59*m_MatSize, m_RHS+62*m_MatSize, m_RHS+65*m_MatSize};
+    createRHS(3, RHSRot, VRot, VFieldRot);
 
     if(!m_pWPolar->bThinSurfaces())
     {
@@ -3699,12 +5483,13 @@ void PanelAnalysis::computeStabilityDerivativesOld()
     strong = "         LU solving for RHS\n";
     traceLog(strong);
 
-    Crout_LU_with_Pivoting_Solve(m_aij, m_uRHS, m_Index, m_RHS,             Size, &s_bCancel);
-    Crout_LU_with_Pivoting_Solve(m_aij, m_vRHS, m_Index, m_RHS+  m_MatSize, Size, &s_bCancel);
-    Crout_LU_with_Pivoting_Solve(m_aij, m_wRHS, m_Index, m_RHS+2*m_MatSize, Size, &s_bCancel);
-    Crout_LU_with_Pivoting_Solve(m_aij, m_pRHS, m_Index, m_RHS+3*m_MatSize, Size, &s_bCancel);
-    Crout_LU_with_Pivoting_Solve(m_aij, m_qRHS, m_Index, m_RHS+4*m_MatSize, Size, &s_bCancel);
-    Crout_LU_with_Pivoting_Solve(m_aij, m_rRHS, m_Index, m_RHS+5*m_MatSize, Size, &s_bCancel);
+    memcpy(m_RHS+0*m_MatSize, m_uRHS, m_MatSize*sizeof(double));
+    memcpy(m_RHS+1*m_MatSize, m_vRHS, m_MatSize*sizeof(double));
+    memcpy(m_RHS+2*m_MatSize, m_wRHS, m_MatSize*sizeof(double));
+    memcpy(m_RHS+3*m_MatSize, m_pRHS, m_MatSize*sizeof(double));
+    memcpy(m_RHS+4*m_MatSize, m_qRHS, m_MatSize*sizeof(double));
+    memcpy(m_RHS+5*m_MatSize, m_rRHS, m_MatSize*sizeof(double));
+    solveLinearSystem(m_RHS, m_RHS, Size, 6);
 
     memcpy(m_uRHS, m_RHS,             m_MatSize*sizeof(double));
     memcpy(m_vRHS, m_RHS+  m_MatSize, m_MatSize*sizeof(double));
@@ -3887,12 +5672,9 @@ void PanelAnalysis::computeStabilityDerivatives()
         }
     }
 
-    createRHS(m_uRHS, Vip);
-    createRHS(m_vRHS, Vjp);
-    createRHS(m_wRHS, Vkp);
-    createRHS(m_pRHS, Vim);
-    createRHS(m_qRHS, Vjm);
-    createRHS(m_rRHS, Vkm);
+    Vector3d VTrans[] = {Vip, Vjp, Vkp, Vim, Vjm, Vkm};
+    double *RHSTrans[] = {m_uRHS, m_vRHS, m_wRHS, m_pRHS, m_qRHS, m_rRHS};
+    createRHS(6, RHSTrans, VTrans);
 
     if(!m_pWPolar->bThinSurfaces())
     {
@@ -3918,12 +5700,13 @@ void PanelAnalysis::computeStabilityDerivatives()
     strong = "         LU solving for RHS - longitudinal\n";
     traceLog(strong);
 
-    Crout_LU_with_Pivoting_Solve(m_aij, m_uRHS, m_Index, m_RHS+0*m_MatSize, Size, &s_bCancel);
-    Crout_LU_with_Pivoting_Solve(m_aij, m_vRHS, m_Index, m_RHS+1*m_MatSize, Size, &s_bCancel);
-    Crout_LU_with_Pivoting_Solve(m_aij, m_wRHS, m_Index, m_RHS+2*m_MatSize, Size, &s_bCancel);
-    Crout_LU_with_Pivoting_Solve(m_aij, m_pRHS, m_Index, m_RHS+3*m_MatSize, Size, &s_bCancel);
-    Crout_LU_with_Pivoting_Solve(m_aij, m_qRHS, m_Index, m_RHS+4*m_MatSize, Size, &s_bCancel);
-    Crout_LU_with_Pivoting_Solve(m_aij, m_rRHS, m_Index, m_RHS+5*m_MatSize, Size, &s_bCancel);
+    memcpy(m_RHS+0*m_MatSize, m_uRHS, m_MatSize*sizeof(double));
+    memcpy(m_RHS+1*m_MatSize, m_vRHS, m_MatSize*sizeof(double));
+    memcpy(m_RHS+2*m_MatSize, m_wRHS, m_MatSize*sizeof(double));
+    memcpy(m_RHS+3*m_MatSize, m_pRHS, m_MatSize*sizeof(double));
+    memcpy(m_RHS+4*m_MatSize, m_qRHS, m_MatSize*sizeof(double));
+    memcpy(m_RHS+5*m_MatSize, m_rRHS, m_MatSize*sizeof(double));
+    solveLinearSystem(m_RHS, m_RHS, Size, 6);
 
     memcpy(m_uRHS, m_RHS+0*m_MatSize, m_MatSize*sizeof(double));
     memcpy(m_vRHS, m_RHS+1*m_MatSize, m_MatSize*sizeof(double));
@@ -4033,13 +5816,11 @@ void PanelAnalysis::computeStabilityDerivatives()
         }
     }
 
-    createRHS(m_uRHS, WindDirection, m_RHS+50*m_MatSize);
-    createRHS(m_vRHS, WindDirection, m_RHS+53*m_MatSize);
-    createRHS(m_wRHS, WindDirection, m_RHS+56*m_MatSize);
-
-    createRHS(m_pRHS, WindDirection, m_RHS+60*m_MatSize);
-    createRHS(m_qRHS, WindDirection, m_RHS+63*m_MatSize);
-    createRHS(m_rRHS, WindDirection, m_RHS+66*m_MatSize);
+    Vector3d VRot[] = {WindDirection, WindDirection, WindDirection, WindDirection, WindDirection, WindDirection};
+    double *RHSRot[] = {m_uRHS, m_vRHS, m_wRHS, m_pRHS, m_qRHS, m_rRHS};
+    double *VFieldRot[] = {m_RHS+50*m_MatSize, m_RHS+53*m_MatSize, m_RHS+56*m_MatSize,
+                           m_RHS+60*m_MatSize, m_RHS+63*m_MatSize, m_RHS+66*m_MatSize};
+    createRHS(6, RHSRot, VRot, VFieldRot);
 
     if(!m_pWPolar->bThinSurfaces())
     {
@@ -4066,12 +5847,13 @@ void PanelAnalysis::computeStabilityDerivatives()
     strong = "         LU solving for RHS - lateral\n";
     traceLog(strong);
 
-    Crout_LU_with_Pivoting_Solve(m_aij, m_uRHS, m_Index, m_RHS+0*m_MatSize, Size, &s_bCancel);
-    Crout_LU_with_Pivoting_Solve(m_aij, m_vRHS, m_Index, m_RHS+1*m_MatSize, Size, &s_bCancel);
-    Crout_LU_with_Pivoting_Solve(m_aij, m_wRHS, m_Index, m_RHS+2*m_MatSize, Size, &s_bCancel);
-    Crout_LU_with_Pivoting_Solve(m_aij, m_pRHS, m_Index, m_RHS+3*m_MatSize, Size, &s_bCancel);
-    Crout_LU_with_Pivoting_Solve(m_aij, m_qRHS, m_Index, m_RHS+4*m_MatSize, Size, &s_bCancel);
-    Crout_LU_with_Pivoting_Solve(m_aij, m_rRHS, m_Index, m_RHS+5*m_MatSize, Size, &s_bCancel);
+    memcpy(m_RHS+0*m_MatSize, m_uRHS, m_MatSize*sizeof(double));
+    memcpy(m_RHS+1*m_MatSize, m_vRHS, m_MatSize*sizeof(double));
+    memcpy(m_RHS+2*m_MatSize, m_wRHS, m_MatSize*sizeof(double));
+    memcpy(m_RHS+3*m_MatSize, m_pRHS, m_MatSize*sizeof(double));
+    memcpy(m_RHS+4*m_MatSize, m_qRHS, m_MatSize*sizeof(double));
+    memcpy(m_RHS+5*m_MatSize, m_rRHS, m_MatSize*sizeof(double));
+    solveLinearSystem(m_RHS, m_RHS, Size, 6);
 
     memcpy(m_uRHS, m_RHS+0*m_MatSize, m_MatSize*sizeof(double));
     memcpy(m_vRHS, m_RHS+1*m_MatSize, m_MatSize*sizeof(double));
@@ -4337,7 +6119,7 @@ void PanelAnalysis::computeControlDerivatives()
     QString strong = "      Calculating the control derivatives\n\n";
     traceLog(strong);
 
-    Crout_LU_with_Pivoting_Solve(m_aij, m_cRHS, m_Index, m_RHS, m_MatSize, &s_bCancel);
+    solveLinearSystem(m_cRHS, m_RHS, m_MatSize, 1);
     memcpy(m_cRHS, m_RHS, m_MatSize*sizeof(double));
 
     forces(m_cRHS, m_Sigma, m_AlphaEq, V0, m_RHS+50*m_MatSize, Force, Moment);
@@ -4428,6 +6210,8 @@ void PanelAnalysis::restorePanels()
         memcpy(m_pWakeNode,  m_pRefWakeNode,  m_nWakeNodes * sizeof(Vector3d));
         memcpy(m_pTempWakeNode,  m_pRefWakeNode,  m_nWakeNodes * sizeof(Vector3d));
     }
+    m_Treecode.clear();
+    m_Vortex.clear();
 }
 
 
@@ -4763,6 +6547,9 @@ void PanelAnalysis::rotateGeomY(double const &Alpha, Vector3d const &P, int NXWa
     int iLA, iLB, iTA, iTB;
     Vector3d LATB, TALB, Pt, Trans;
 
+    m_Treecode.clear();
+    m_Vortex.clear();
+
     for (n=0; n<m_nNodes; n++)
         m_pNode[n].rotateY(P, Alpha);
 
@@ -4844,6 +6631,9 @@ void PanelAnalysis::rotateGeomZ(double const &Beta, Vector3d const &P, int NXWak
     int iLA, iLB, iTA, iTB;
     Vector3d Pt, Trans;
 
+    m_Treecode.clear();
+    m_Vortex.clear();
+
     for (n=0; n<m_nNodes; n++)    m_pNode[n].rotateZ(P, Beta);
 
     for (p=0; p<m_MatSize; p++)
@@ -4929,6 +6719,9 @@ void PanelAnalysis::setControlPositions(double t, int &NCtrls, QString &out, boo
     Vector3d YVector(0.0, 1.0, 0.0);
     Vector3d W;
 
+    m_Treecode.clear();
+    m_Vortex.clear();
+
     // update the variables & geometry
     // if plane : WingTilt, elevator Tilt
     // if flaps : wing flaps, elevator flaps
@@ -4981,7 +6774,7 @@ void PanelAnalysis::setControlPositions(double t, int &NCtrls, QString &out, boo
                 }
                 for(int p=0; p<m_MatSize; p++)
                 {
-                    if(m_pPlane->wing()->isWingPanel(p)) m_pPanel[p].setPanelFrame();
+                    if(m_pPlane->wing()->isWingPanel(p)) m_pPanel[p].setPanelFrame(m_pNode);
                 }
             }
         }
@@ -5015,7 +6808,7 @@ void PanelAnalysis::setControlPositions(double t, int &NCtrls, QString &out, boo
                     }
                     for(int p=0; p<m_MatSize; p++)
                     {
-                        if(pWingList[2]->isWingPanel(p)) m_pPanel[p].setPanelFrame();
+                        if(pWingList[2]->isWingPanel(p)) m_pPanel[p].setPanelFrame(m_pNode);
                     }
                 }
                 else
@@ -5074,7 +6867,7 @@ void PanelAnalysis::setControlPositions(double t, int &NCtrls, QString &out, boo
                             {
                                 for(int n=0; n<m_nNodes; n++)
                                 {
-                                    if(pWing->m_Surface.at(j)->isFlapNode(n))
+                                    if(pWing->m_Surface.at(j)->isFlapNode(m_pPanel, n))
                                     {
                                         m_pNode[n].copy(m_pMemNode[n]);
                                         W = m_pNode[n] - pWing->m_Surface.at(j)->m_HingePoint;
@@ -5084,7 +6877,7 @@ void PanelAnalysis::setControlPositions(double t, int &NCtrls, QString &out, boo
                                 }
                                 for(int p=0; p<m_MatSize; p++)
                                 {
-                                    if(pWing->m_Surface.at(j)->isFlapPanel(p)) m_pPanel[p].setPanelFrame();
+                                    if(pWing->m_Surface.at(j)->isFlapPanel(p)) m_pPanel[p].setPanelFrame(m_pNode);
                                 }
                             }
                         }
@@ -5380,7 +7173,7 @@ void PanelAnalysis::clearPOppList()
 
 void PanelAnalysis::onCancel()
 {
-    s_bCancel = true;
+    m_bCancel.storeRelease(1);
     traceLog("Cancelling the panel analysis\n");
 }
 
@@ -5578,10 +7371,10 @@ void PanelAnalysis::relaxWake()
 
     for (int lw=0; lw<m_pWPolar->m_NXWakePanels; lw++)
     {
-        if(s_bCancel) break;
+        if(isCancelled()) break;
         for (int kw=0; kw<m_NWakeColumn; kw++)
         {
-            if(s_bCancel) break;
+            if(isCancelled()) break;
 
             mw = kw * m_pWPolar->m_NXWakePanels + lw;
             //left point
@@ -5630,12 +7423,14 @@ void PanelAnalysis::relaxWake()
 
     // Paste the new wake nodes back into the wake node array
     memcpy(m_pWakeNode, m_pTempWakeNode, m_nWakeNodes * sizeof(Vector3d));
+    // the treecode is built again with the relaxed wake
+    strengthsChanged();
 
     // Re-create the wake panels
     mw=0;
     for (int mw=0; mw<m_WakeSize; mw++)
     {
-        if(s_bCancel) break;
+        if(isCancelled()) break;
 
         WLA.copy(m_pWakeNode[m_pWakePanel[mw].m_iLA]);
         WLB.copy(m_pWakeNode[m_pWakePanel[mw].m_iLB]);
@@ -5653,6 +7448,8 @@ void PanelAnalysis::relaxWake()
         m_pWakePanel[mw].Normal.normalize();
         m_pWakePanel[mw].setPanelFrame(WLA, WLB, WTA, WTB);
     }
+    m_Treecode.clear();
+    m_Vortex.clear();
 }
 
 
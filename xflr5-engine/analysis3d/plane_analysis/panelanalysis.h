@@ -29,12 +29,26 @@
 
 #include <QObject>
 #include <QVector>
+#include <QAtomicInt>
 
 #include <objects/objects3d/vector3d.h>
 #include <objects/objects3d/panel.h>
+#include "paneltreecode.h"
+#include "vortexarray.h"
 
 
 #define VLMMAXRHS 100
+#define PANELTILESIZE 16   /**< the number of matrix rows assembled together in a single task */
+#define MAXREFMATRIXSIZE 16000000   /**< the max number of coefficients of the copy of the influence matrix kept for the incremental assembly */
+#define LOWRANKRATIO 8              /**< the LU factors are updated rather than computed anew if the rank of the change of the matrix is less than its size divided by this ratio */
+#define LOWRANKTOLERANCE 1.e-9      /**< the max relative residual of a solution obtained with the low-rank update of the LU factors */
+#define ITERATIVEBLOCKSIZE 64       /**< the max size of the diagonal blocks of the block-Jacobi preconditioner of the iterative solver */
+#define ITERATIVERESTART 40         /**< the max dimension of the Krylov subspace of the GMRES iterations before restart */
+#define ITERATIVEMAXITER 1000       /**< the max number of GMRES iterations */
+#define ITERATIVETOLERANCE 1.e-8    /**< the max ratio of the residual to the norm of the RHS for the GMRES iterations to be converged */
+#define MAXITERATIVEROWSIZE 32000000 /**< the max number of coefficients of the influence matrix which the iterative solver keeps in memory */
+#define MIXEDMAXREFINEMENT 10       /**< the max number of iterative refinement steps of the mixed precision solver */
+#define MIXEDTOLERANCE 1.e-10       /**< the max relative residual of a solution refined by the mixed precision solver */
 
 class Plane;
 class WPolar;
@@ -53,6 +67,7 @@ class XFLR5ENGINELIBSHARED_EXPORT PanelAnalysis : QObject
     friend class Objects3D;
     friend class Miarex;
     friend class PlaneAnalysisTask;
+    friend class PlaneBatchDlg;
     friend class XflScriptExec;
 
 public:
@@ -72,6 +87,33 @@ public:
     bool getZeroMomentAngle();
 
     void buildInfluenceMatrix();
+    void buildInfluenceRows(QVector<int> const &rows, QVector<int> const &columns, double *aijFull);
+    void buildInfluenceTile(QVector<int> const &rows, int k0, int k1, QVector<int> const &columns, double *aijFull);
+    void computeInfluenceRows(int const *rows, int n, QVector<int> const &columns, double **row);
+
+    bool makeSymmetryMap();
+    void foldSymmetricRow(double const *row, double *symRow);
+    void expandSymmetricSolution(double const *symX, double *X);
+    bool isSymmetryRow(int p) const {return m_SymRow[p]>=0 && m_SymIndex[m_SymRow[p]]==p;}
+
+    void influenceSettingsSignature(QVector<double> &signature);
+    void influencePanelSignature(int p, QVector<double> &signature);
+    void influenceMatrixSignature(QVector<double> &signature);
+    quint64 influenceSettingsKey();
+    quint64 influencePanelKey(int p);
+    bool restoreFactoredMatrix();
+    void storeFactoredMatrix();
+    bool factorizeMatrix(int Size, double TaskSize);
+    bool setupLowRankUpdate(int Size);
+    bool solveLinearSystem(double *B, double *X, int Size, int nRHS);
+    bool refineLowRankSolution(double const *B, double *X, int Size, int nRHS);
+    void computeSystemRows(int i0, int i1, double *rows);
+    void makeJacobiBlocks(int Size);
+    bool setupIterativeSolver(int Size);
+    void multiplySystemMatrix(double const *X, double *Y, int Size, int nVec);
+    void preconditionSystem(double *X, int Size, int nVec);
+    bool setupSinglePrecision(int Size, double TaskSize);
+    bool refineSinglePrecisionSolution(double const *B, double *X, int Size, int nRHS);
 
     void computeAeroCoefs(double V0, double VDelta, int nrhs);
     void computeOnBodyCp(double V0, double VDelta, int nval);
@@ -81,14 +123,18 @@ public:
     void createDoubletStrength(double Alpha0, double AlphaDelta, int nval);
     void createSourceStrength(double Alpha0, double AlphaDelta, int nval);
     void createRHS(double *RHS, Vector3d VInf, double *VField=nullptr);
+    void createRHS(int nRHS, double **RHS, Vector3d const *VInf, double **VField=nullptr);
+    void createRHSTile(int nRHS, double **RHS, Vector3d const *VInf, double **VField, int p0, int p1);
     void createUnitRHS();
     void createWakeContribution();
+    void wakeContributionRow(int p, double *aijWake, double &uWake, double &wWake);
+    void wakeColumnInfluence(Vector3d const &C, int kw, double &phi, Vector3d &V);
+    void assembleWakeRow(int p, double const *PHC, Vector3d const *VHC, double *aijWake, double &uWake, double &wWake);
     void createWakeContribution(double *pWakeContrib, Vector3d WindDirection);
     void getDoubletInfluence(Vector3d const &C, Panel *pPanel, Vector3d &V, double &phi, bool bWake=false, bool bAll=true);
     void getSourceInfluence(Vector3d const &C, Panel *pPanel, Vector3d &V, double &phi);
     void scaleResultstoSpeed(int nval);
     void sumPanelForces(double *Cp, double Alpha, double &Lift, double &Drag);
-    void VLMGetVortexInfluence(Panel *pPanel, Vector3d const &C, Vector3d &V, bool bAll);
     void VLMCmn(Vector3d const &A, Vector3d const &B, Vector3d const &C, Vector3d &V, bool const &bAll);
     void VLMQmn(Vector3d &LA, Vector3d &LB, Vector3d &TA, Vector3d &TB, Vector3d const &C, Vector3d &V);
 
@@ -111,6 +157,8 @@ public:
     void forces(double *Mu, double *Sigma, double alpha, Vector3d Vinc, double *VInf, Vector3d &Force, Vector3d &Moment);
     double computeCm(double Alpha);
 
+    qint64 memoryFootprint(int matSize, bool bIterative, bool bSinglePrecision, bool bMatrixCopies, int nStoredRows) const;
+    bool planMemory(int matSize);
     bool allocateMatrix(int matSize, int &memsize);
     bool allocateRHS(int matSize, int &memsize);
     void releaseArrays();
@@ -127,17 +175,42 @@ public:
     void setInertia(double ctrl, double alpha, double beta);
     void setObjectPointers(Plane *pPlane, void *pSurfaceList);
     void setRange(double vMin, double VMax, double vDelta, bool bSequence);
-    void setWPolar(WPolar*pWPolar){m_pWPolar = pWPolar;}
+    void setWPolar(WPolar*pWPolar){m_pWPolar = pWPolar; m_Treecode.clear(); m_Vortex.clear();}
     PlaneOpp* createPlaneOpp(double *Cp, double *Gamma, double *Sigma);
 
     void getSpeedVector(Vector3d const &C, double *Mu, double *Sigma, Vector3d &VT, bool bAll=true);
+    void strengthsChanged() {m_StrengthGeneration++;}
+    void getVortexSpeedVector(Vector3d const &C, double const *Gamma, Vector3d &V, bool bAll=true);
+    void VLMGetVortexInfluence(Panel *pPanel, Vector3d const &C, Vector3d &V, bool bAll);
+    void makeVortexArray();
+    VortexArray const &vortexArray() const {return m_Vortex;}
     void computePhillipsFormulae();
 
     void clearPOppList();
+    double progress() const {return m_TotalTime>0 ? m_Progress/double(m_TotalTime) : 0.0;}
+    qint64 plannedMemory() const {return m_MemoryFootprint;}
+    bool isCancelled() const {return m_bCancel.loadAcquire();}
 
-    static bool s_bCancel;      /**< true if the user has cancelled the analysis */
     static bool s_bWarning;     /**< true if one the OpPoints could not be properly interpolated */
     static void setMaxWakeIter(int nMaxWakeIter) {s_MaxWakeIter = nMaxWakeIter;}
+    static void setMultiThreaded(bool bMultiThread) {s_bMultiThread = bMultiThread;}
+    static bool isMultiThreaded() {return s_bMultiThread;}
+    static void setSymmetricSolve(bool bSymmetric) {s_bSymmetricSolve = bSymmetric;}
+    static bool isSymmetricSolve() {return s_bSymmetricSolve;}
+    static void setIncrementalAssembly(bool bIncremental) {s_bIncrementalAssembly = bIncremental;}
+    static bool isIncrementalAssembly() {return s_bIncrementalAssembly;}
+    static void setLowRankUpdate(bool bLowRank) {s_bLowRankUpdate = bLowRank;}
+    static bool isLowRankUpdate() {return s_bLowRankUpdate;}
+    static void setIterativeSolve(bool bIterative) {s_bIterativeSolve = bIterative;}
+    static bool isIterativeSolve() {return s_bIterativeSolve;}
+    static void setSinglePrecision(bool bSingle) {s_bSinglePrecision = bSingle;}
+    static bool isSinglePrecision() {return s_bSinglePrecision;}
+    static void setMemoryBudget(int budgetMB);
+    static int memoryBudget() {return s_MemoryBudget;}
+    static void setMatrixCacheSize(int cacheMB);
+    static int matrixCacheSize() {return s_MatrixCacheSize;}
+    static void setTreecodeAccuracy(double theta) {s_TreecodeAccuracy = theta;}
+    static double treecodeAccuracy() {return s_TreecodeAccuracy;}
 
 signals:
     void outputMsg(QString msg);
@@ -153,10 +226,20 @@ private:
     int m_MaxMatSize;    /**< the size currently allocated for the influence matrix >*/
 
     static int s_MaxWakeIter;                 /**< wake roll-up iteration limit */
+    static bool s_bMultiThread;               /**< true if the matrix assembly should be distributed on the threads of the global pool */
+    static bool s_bSymmetricSolve;            /**< true if the symmetry of the geometry should be used to reduce the size of the linear system in symmetric flow conditions */
+    static bool s_bIncrementalAssembly;       /**< true if a copy of the influence matrix should be kept, so that only the rows and columns of the panels which have changed are built in the next analysis; off by default, since the copy doubles the memory of the matrix */
+    static bool s_bLowRankUpdate;             /**< true if the LU factors of a reference matrix should be kept, so that a system which differs by the rows and columns of a few panels is solved by a low-rank update; requires the incremental assembly, and is off by default, since the reference matrix and its factors double the memory of the LU solver */
+    static bool s_bIterativeSolve;            /**< true if the linear system should be solved with preconditioned GMRES iterations and a matrix-free operator rather than with the dense LU decomposition */
+    static bool s_bSinglePrecision;           /**< true if the influence matrix should be stored and factored in single precision, with the accuracy recovered by iterative refinement */
+    static int s_MemoryBudget;                /**< the max memory in MB which the arrays of an analysis may use, or 0 if there is no limit */
+    static int s_MatrixCacheSize;             /**< the max memory in MB of the MatrixCache, which is also limited by the memory budget; 0 disables the cache */
+    static double s_TreecodeAccuracy;         /**< the max ratio of a cluster's radius to its distance for the treecode's far-field expansion to be used in the velocity evaluations; 0 for exact evaluations */
 
     double m_Progress;   /**< A measure of the progress of the analysis, used to provide feedback to the user */
     int m_TotalTime;     /**< the esimated total time of the analysis, used to set the progress bar. No specific unit. */
 
+    QAtomicInt m_bCancel;       /**< non-zero if this analysis has been cancelled; set from the GUI thread, read by the analysis thread */
     bool m_bPointOut;           /**< true if an interpolation was outside the min or max Cl */
     bool m_bSequence;           /**< true if the calculation is should be performed for a range of aoa */
 
@@ -167,6 +250,52 @@ private:
     int m_WakeSize;                /**< the number of wake elements */
     int m_NWakeColumn;          /**< the number of wake columns, which is also the number of panels in the spanwise direction */
 
+    bool m_bSymmetric;          /**< true if the current linear system is reduced to the panels of one half of the plane */
+    int m_SymSize;              /**< the size of the reduced linear system */
+    QVector<int> m_SymIndex;    /**< the index of the panel associated to each row of the reduced system */
+    QVector<int> m_SymRow;      /**< for each panel, the row of the reduced system which holds its doublet strength, or -1 if the strength is zero */
+    QVector<double> m_SymSign;  /**< for each panel, the sign of its doublet strength relative to the strength of the reduced system's row */
+
+    bool m_bMatrixFactored;     /**< true if the current influence matrix, including the wake's contribution, has been factored, either in m_aij or as a low-rank update of the reference factors */
+    bool m_bLowRankUpdate;      /**< true if the current system is solved with a low-rank update of the reference factors, in which case m_aij holds the matrix itself */
+    QVector<double> m_MatrixSignature; /**< the signature identifying the current influence matrix in the MatrixCache */
+
+    QVector<double> m_aijRef;       /**< the full rows of the last influence matrix which has been built, without the wake's contribution */
+    QVector<quint64> m_RefPanelKey; /**< the keys of the panels of the rows in m_aijRef, or an empty array if the rows are not valid */
+    QVector<int> m_RefSymIndex;     /**< the index of the panel associated to each row of m_aijRef, in the symmetric case */
+    quint64 m_RefSettingsKey;       /**< the key of the analysis settings with which the rows of m_aijRef have been built */
+
+    QVector<double> m_LURefMatrix;      /**< the reference matrix, including the wake's contribution, before its LU decomposition */
+    QVector<double> m_LURef;            /**< the LU factors of the reference matrix */
+    QVector<int> m_LURefIndex;          /**< the row interchanges of the LU factors of the reference matrix */
+    QVector<quint64> m_LURefPanelKey;   /**< the keys of the panels of the reference matrix, or an empty array if there is no valid reference */
+    QVector<int> m_LURefSymIndex;       /**< the index of the panel associated to each row of the reference matrix in the symmetric case, empty otherwise */
+    quint64 m_LURefSettingsKey;         /**< the key of the analysis settings with which the reference matrix has been built */
+
+    QVector<int> m_LRColumn;    /**< the columns of the system which differ from those of the reference matrix */
+    QVector<int> m_LRRow;       /**< the rows of the system which differ from those of the reference matrix outside of the changed columns */
+    QVector<double> m_LRW;      /**< the difference with the reference matrix of each changed row, with zeros in the changed columns */
+    QVector<double> m_LRZ;      /**< the solutions of the reference system for each column of the low-rank change */
+    QVector<double> m_LRS;      /**< the LU factors of the capacitance matrix of the low-rank update */
+    QVector<int> m_LRSIndex;    /**< the row interchanges of the LU factors of the capacitance matrix */
+
+    bool m_bIterative;              /**< true if the arrays have been allocated for the iterative solver, in which case the influence matrix is not stored */
+    int m_nStoredRows;              /**< the number of leading rows of the system which the iterative and the mixed precision solvers keep in memory */
+    QVector<double> m_StoredRows;   /**< the full rows of the system, including the wake's contribution, kept in memory by the iterative and the mixed precision solvers */
+    QVector<double> m_JacobiLU;     /**< the LU factors of the diagonal blocks of the block-Jacobi preconditioner, stored consecutively */
+    QVector<int> m_JacobiIndex;     /**< the row interchanges of the LU factors of the diagonal blocks, in the order of m_JacobiRows */
+    QVector<int> m_JacobiRows;      /**< the rows of the system sorted by blocks of the preconditioner, the rows of a strip being in the same block */
+    QVector<int> m_JacobiStart;     /**< the position in m_JacobiRows of the first row of each block, followed by the size of the system */
+
+    bool m_bSinglePrecision;        /**< true if the influence matrix is stored and factored in single precision in m_aijSingle, in which case m_aij is not allocated */
+    bool m_bMatrixCopies;           /**< true if the copies of the matrix for the incremental assembly, the low-rank update and the MatrixCache fit in the memory budget */
+    int m_MaxStoredRows;            /**< the max number of rows which the iterative and the mixed precision solvers may keep in memory */
+    qint64 m_MemoryFootprint;       /**< the memory in bytes planned for the arrays of the analysis */
+
+    PanelTreecode m_Treecode;   /**< the treecode used to evaluate the velocities induced by the thick panels and their wakes */
+    uint m_StrengthGeneration;  /**< incremented each time the strengths passed to getSpeedVector() may have changed, so that the treecode is re-built */
+    VortexArray m_Vortex;       /**< the vortex segments of the VLM panels, used by the vectorized velocity kernels */
+
 
     double m_vMin;              /**< The minimum value of the analysis parameter*/
     double m_vMax;              /**< The max value of the analysis parameter*/
@@ -211,6 +340,7 @@ private:
 
     double *m_aij;           /**< coefficient matrix for the panel analysis. Is declared as a common member variable to save memory allocation times*/
     double *m_aijWake;       /**< coefficient matrix. Is declared as a common member variable to save memory allocation times*/
+    float *m_aijSingle;      /**< the single precision influence matrix, including the wake's contribution, and then its LU factors */
     double *m_uRHS, *m_vRHS, *m_wRHS;
     double *m_pRHS, *m_qRHS, *m_rRHS;
     double *m_cRHS;
@@ -239,8 +369,6 @@ private:
 
     //temp data
     int m_NSpanStations;
-    Vector3d VG, CG;
-    double phiG;
     //    Vector3d h, r0, r1, r2, Psi, t, Far;
     //    double r1v,r2v,ftmp, Omega;
     //    Vector3d *m_pR[5];
@@ -0,0 +1,271 @@
+/****************************************************************************
+
+    PanelTreecode Class
+
+    Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+
+#include <algorithm>
+
+#include <QVarLengthArray>
+
+#include "paneltreecode.h"
+#include <objects/objects3d/panel.h>
+
+
+PanelTreecode::PanelTreecode()
+{
+    m_pMu = m_pSigma = nullptr;
+    m_Generation = 0;
+}
+
+
+/**
+ * Removes the elements and the clusters, so that the tree will be re-built at the next evaluation.
+ * Must be called each time the geometry of the panels or of the wake is modified.
+ */
+void PanelTreecode::clear()
+{
+    m_Element.clear();
+    m_Cluster.clear();
+    m_pMu = m_pSigma = nullptr;
+}
+
+
+/**
+ * Checks if the tree has been built with the input strengths.
+ * The values of the strengths are not compared, since this check is made for each evaluation point;
+ * the owner of the arrays increments the generation number each time it modifies their content.
+ * @param Mu a pointer to the array of doublet strengths
+ * @param Sigma a pointer to the array of source strengths, or a null pointer if there are no sources
+ * @param generation the generation number of the content of the arrays
+ * @return true if the expansions are up to date, false otherwise.
+ */
+bool PanelTreecode::isBuilt(double const *Mu, double const *Sigma, uint generation) const
+{
+    return m_pMu && m_pMu==Mu && m_pSigma==Sigma && m_Generation==generation;
+}
+
+
+/**
+ * Builds the tree of the thick panels and of their wake panels, and the multipole expansions
+ * of the clusters for the input strengths.
+ * The thin surface panels are not included, since their vortices are not located on the panels.
+ * @param pPanel a pointer to the array of surface panels
+ * @param pNode a pointer to the array of nodes of the surface panels
+ * @param nPanels the number of surface panels
+ * @param pWakePanel a pointer to the array of wake panels
+ * @param pWakeNode a pointer to the array of nodes of the wake panels
+ * @param NXWakePanels the number of wake panels in each wake column
+ * @param Mu a pointer to the array of doublet strengths
+ * @param Sigma a pointer to the array of source strengths, or a null pointer if there are no sources
+ * @param generation the generation number of the content of the arrays
+ */
+void PanelTreecode::build(Panel *pPanel, Vector3d const *pNode, int nPanels, Panel *pWakePanel, Vector3d const *pWakeNode, int NXWakePanels,
+                          double const *Mu, double const *Sigma, uint generation)
+{
+    Element elem;
+
+    clear();
+
+    m_pMu        = Mu;
+    m_pSigma     = Sigma;
+    m_Generation = generation;
+
+    for(int pp=0; pp<nPanels; pp++)
+    {
+        if(pPanel[pp].m_Pos==MIDSURFACE) continue;
+
+        elem.pPanel = pPanel+pp;
+        elem.pNode  = pNode;
+        elem.mu     = Mu[pp];
+        elem.sigma  = Sigma ? Sigma[pp] : 0.0;
+        m_Element.append(elem);
+
+        if(pPanel[pp].m_bIsTrailing)
+        {
+            // the wake column shed by this panel has the same doublet strength
+            double sign = pPanel[pp].m_Pos==BOTSURFACE ? -1.0 : 1.0;
+            for(int lw=0; lw<NXWakePanels; lw++)
+            {
+                elem.pPanel = pWakePanel + pPanel[pp].m_iWake + lw;
+                elem.pNode  = pWakeNode;
+                elem.mu     = Mu[pp]*sign;
+                elem.sigma  = 0.0;
+                m_Element.append(elem);
+            }
+        }
+    }
+
+    if(m_Element.size()) makeCluster(0, m_Element.size());
+}
+
+
+/**
+ * Creates the cluster of the elements e0 to e1-1 and its multipole expansion,
+ * and then recursively splits it in two sub-clusters at the median of its longest dimension.
+ * @param e0 the index of the first element of the cluster
+ * @param e1 the index of the element past the last element of the cluster
+ * @return the index of the new cluster.
+ */
+int PanelTreecode::makeCluster(int e0, int e1)
+{
+    Cluster cl;
+    cl.e0 = e0;
+    cl.e1 = e1;
+    cl.child[0] = cl.child[1] = -1;
+
+    // the expansion centre is the area-weighted centroid of the collocation points
+    Vector3d Min(m_Element.at(e0).pPanel->CollPt), Max(Min);
+    double area = 0.0;
+    cl.centre.set(0.0, 0.0, 0.0);
+    for(int e=e0; e<e1; e++)
+    {
+        Panel const *pPanel = m_Element.at(e).pPanel;
+        Vector3d const &P = pPanel->CollPt;
+        cl.centre += P * pPanel->Area;
+        area += pPanel->Area;
+        Min.set(qMin(Min.x, P.x), qMin(Min.y, P.y), qMin(Min.z, P.z));
+        Max.set(qMax(Max.x, P.x), qMax(Max.y, P.y), qMax(Max.z, P.z));
+    }
+    if(area>0.0) cl.centre *= 1.0/area;
+    else         cl.centre = (Min+Max)*0.5;
+
+    cl.radius = 0.0;
+    cl.Q = 0.0;
+    cl.P.set(0.0, 0.0, 0.0);
+    memset(cl.S, 0, 6*sizeof(double));
+    for(int e=e0; e<e1; e++)
+    {
+        Element const &elem = m_Element.at(e);
+        Vector3d d = elem.pPanel->CollPt - cl.centre;
+        cl.radius = qMax(cl.radius, d.VAbs() + elem.pPanel->Size);
+
+        double q = elem.sigma * elem.pPanel->Area;
+        Vector3d m = elem.pPanel->Normal * (elem.mu * elem.pPanel->Area);
+
+        // source at an offset d: q.G(r-d) = q.G - q.d.grad(G) + 1/2 q.dd:grad(grad(G))
+        // doublet at an offset d: -m.grad(G(r-d)) = -m.grad(G) + md:grad(grad(G))
+        cl.Q += q;
+        cl.P += d*q + m;
+        cl.S[0] += m.x*d.x + 0.5*q*d.x*d.x;
+        cl.S[1] += m.y*d.y + 0.5*q*d.y*d.y;
+        cl.S[2] += m.z*d.z + 0.5*q*d.z*d.z;
+        cl.S[3] += 0.5*(m.x*d.y + m.y*d.x) + 0.5*q*d.x*d.y;
+        cl.S[4] += 0.5*(m.x*d.z + m.z*d.x) + 0.5*q*d.x*d.z;
+        cl.S[5] += 0.5*(m.y*d.z + m.z*d.y) + 0.5*q*d.y*d.z;
+    }
+
+    int index = m_Cluster.size();
+    m_Cluster.append(cl);
+
+    if(e1-e0<=TREECODELEAFSIZE) return index;
+
+    // split along the longest dimension
+    int iAxis = 0;
+    Vector3d Ext = Max - Min;
+    if(Ext.y>Ext.x && Ext.y>=Ext.z) iAxis = 1;
+    else if(Ext.z>Ext.x && Ext.z>Ext.y) iAxis = 2;
+
+    int mid = (e0+e1)/2;
+    std::nth_element(m_Element.begin()+e0, m_Element.begin()+mid, m_Element.begin()+e1,
+                     [iAxis](Element const &a, Element const &b)
+    {
+        Vector3d const &A = a.pPanel->CollPt;
+        Vector3d const &B = b.pPanel->CollPt;
+        if(iAxis==0) return A.x<B.x;
+        if(iAxis==1) return A.y<B.y;
+        return A.z<B.z;
+    });
+
+    int c0 = makeCluster(e0, mid);
+    int c1 = makeCluster(mid, e1);
+    m_Cluster[index].child[0] = c0;
+    m_Cluster[index].child[1] = c1;
+
+    return index;
+}
+
+
+/**
+ * Returns the perturbation velocity induced at a point by the elements of the tree.
+ * @param C the point where the velocity is to be evaluated
+ * @param theta the max ratio of a cluster's radius to its distance to the point for the multipole expansion to be used
+ * @param V the resulting perturbation velocity
+ */
+void PanelTreecode::getVelocity(Vector3d const &C, double theta, Vector3d &V) const
+{
+    Vector3d VP;
+    double phi=0.0;
+
+    V.set(0.0, 0.0, 0.0);
+    if(!m_Cluster.size()) return;
+
+    QVarLengthArray<int, 128> stack;
+    stack.append(0);
+
+    while(stack.size())
+    {
+        Cluster const &cl = m_Cluster.at(stack.last());
+        stack.removeLast();
+
+        Vector3d r = C - cl.centre;
+        double r2 = r.x*r.x + r.y*r.y + r.z*r.z;
+
+        if(cl.radius*cl.radius < theta*theta*r2)
+        {
+            // far cluster, use the expansion
+            double r1 = sqrt(r2);
+            double r3 = r2*r1;
+            double r5 = r3*r2;
+            double r7 = r5*r2;
+
+            double Pr = cl.P.dot(r);
+            Vector3d Sr(cl.S[0]*r.x + cl.S[3]*r.y + cl.S[4]*r.z,
+                        cl.S[3]*r.x + cl.S[1]*r.y + cl.S[5]*r.z,
+                        cl.S[4]*r.x + cl.S[5]*r.y + cl.S[2]*r.z);
+            double rSr = Sr.dot(r);
+            double trS = cl.S[0] + cl.S[1] + cl.S[2];
+
+            V += r * (cl.Q/r3 + 3.0*Pr/r5 + 15.0*rSr/r7 - 3.0*trS/r5);
+            V -= cl.P * (1.0/r3);
+            V -= Sr * (6.0/r5);
+        }
+        else if(cl.child[0]<0)
+        {
+            // near leaf, use the exact formulas
+            for(int e=cl.e0; e<cl.e1; e++)
+            {
+                Element const &elem = m_Element.at(e);
+                if(fabs(elem.sigma)>0.0)
+                {
+                    elem.pPanel->sourceNASA4023(C, elem.pNode, VP, phi);
+                    V += VP * elem.sigma;
+                }
+                elem.pPanel->doubletNASA4023(C, elem.pNode, VP, phi);
+                V += VP * elem.mu;
+            }
+        }
+        else
+        {
+            stack.append(cl.child[0]);
+            stack.append(cl.child[1]);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/****************************************************************************
+
+    PanelTreecode Class
+
+    Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+
+#ifndef PANELTREECODE_H
+#define PANELTREECODE_H
+
+#include <QVector>
+
+#include <objects/objects3d/vector3d.h>
+
+#define TREECODELEAFSIZE 8   /**< the max number of elements in a leaf cluster */
+
+class Panel;
+
+/**
+ * @class PanelTreecode
+ * A Barnes-Hut treecode which evaluates the perturbation velocity induced by the uniform source
+ * and doublet distributions of the thick surface panels and of their wake panels.
+ *
+ * The elements are sorted in a binary tree of clusters, by successive bisections of the clusters along
+ * their longest dimension. For each cluster, the source and doublet strengths are aggregated in a
+ * multipole expansion at the cluster's centre: source monopole, dipole and quadrupole moments,
+ * and doublet dipole and first order quadrupole moments.
+ *
+ * The velocity at a point is evaluated by walking the tree: the expansion of a cluster is used
+ * if the ratio of the cluster's radius to the distance is less than the accuracy parameter,
+ * otherwise the cluster is opened. The elements of the leaf clusters which are too close
+ * to the point are evaluated with the exact NASA 4023 formulas.
+ *
+ * The velocities are returned without the 1/4.PI factor, consistently with the Panel methods.
+ */
+class PanelTreecode
+{
+public:
+    PanelTreecode();
+
+    void clear();
+    bool isBuilt(double const *Mu, double const *Sigma, uint generation) const;
+    void build(Panel *pPanel, Vector3d const *pNode, int nPanels, Panel *pWakePanel, Vector3d const *pWakeNode, int NXWakePanels,
+               double const *Mu, double const *Sigma, uint generation);
+    void getVelocity(Vector3d const &C, double theta, Vector3d &V) const;
+
+    int elementCount() const {return m_Element.size();}
+
+private:
+    /** @struct a source and doublet panel of the tree */
+    struct Element
+    {
+        Panel *pPanel;     /**< a pointer to the panel */
+        Vector3d const *pNode; /**< a pointer to the array of nodes of the panel, i.e. the wake nodes for a wake panel */
+        double mu;         /**< the doublet strength */
+        double sigma;      /**< the source strength */
+    };
+
+    /** @struct a cluster of elements and its multipole expansion */
+    struct Cluster
+    {
+        int e0, e1;        /**< the range of the cluster's elements in the element array */
+        int child[2];      /**< the indexes of the two sub-clusters, or -1 if the cluster is a leaf */
+        Vector3d centre;   /**< the centre of the expansion */
+        double radius;     /**< the radius of the sphere centered on the expansion centre which contains all the elements */
+        double Q;          /**< the monopole moment */
+        Vector3d P;        /**< the dipole moment */
+        double S[6];       /**< the symmetric quadrupole moment, xx, yy, zz, xy, xz, yz */
+    };
+
+    int makeCluster(int e0, int e1);
+
+    QVector<Element> m_Element;    /**< the elements, ordered by cluster */
+    QVector<Cluster> m_Cluster;    /**< the clusters; the root cluster is the first one */
+    double const *m_pMu;           /**< a pointer to the doublet strengths used to build the expansions */
+    double const *m_pSigma;        /**< a pointer to the source strengths used to build the expansions */
+    uint m_Generation;             /**< the generation of the strengths used to build the expansions */
+};
+
+#endif // PANELTREECODE_H
@@ -22,15 +22,17 @@
 
 
 #include <QDebug>
+#include <QCoreApplication>
 
 
 #include "planeanalysistask.h"
+#include "planetaskevent.h"
 #include <objects/objects3d/plane.h>
 #include <objects/objects3d/wpolar.h>
 #include <objects/objects3d/surface.h>
 
 
-bool PlaneAnalysisTask::s_bCancel = false;
+QAtomicInt PlaneAnalysisTask::s_bCancel(0);
 
 PlaneAnalysisTask::PlaneAnalysisTask()
 {
@@ -45,6 +47,7 @@ PlaneAnalysisTask::PlaneAnalysisTask()
     m_MaxPanelSize = 0;
     m_bSequence = true;
     m_bIsFinished = false;
+    m_bCancel.storeRelease(0);
 
     m_WakeSize = 0;
     m_MatSize = 0;
@@ -54,7 +57,8 @@ PlaneAnalysisTask::PlaneAnalysisTask()
 }
 
 /**
- * @param pParent a pointer to the parent widget which will receive the analysis event messages
+ * @param pParent a pointer to the parent widget which will receive the analysis event messages.
+ * If set, a PlaneTaskEvent is posted to the parent at the end of the task.
  */
 void PlaneAnalysisTask::setParent(void *pParent)
 {
@@ -77,6 +81,7 @@ void PlaneAnalysisTask::initializeTask(Plane *pPlane, WPolar *pWPolar, double vM
     m_vMax = vMax;
     m_vInc = VInc;
     m_bSequence = bSequence;
+    m_bCancel.storeRelease(0);
 }
 
 
@@ -89,27 +94,40 @@ void PlaneAnalysisTask::initializeTask(PlaneAnalysis *pAnalysis)
     m_vMax = pAnalysis->vMax;
     m_vInc = pAnalysis->vInc;
     m_bSequence = true;
+    m_bCancel.storeRelease(0);
 }
 
 
 void PlaneAnalysisTask::run()
 {
-    if(s_bCancel || !m_pPlane || !m_pWPolar)
+    if(!isCancelled() && m_pPlane && m_pWPolar)
     {
-        m_bIsFinished = true;
-        return;
-    }
-
-    if(m_pWPolar->isLLTMethod())
-    {
-        LLTAnalyze();
-    }
-    else if(m_pWPolar->isQuadMethod())
-    {
-        PanelAnalyze();
+        if(m_pWPolar->isLLTMethod())
+        {
+            LLTAnalyze();
+        }
+        else if(m_pWPolar->isQuadMethod())
+        {
+            PanelAnalyze();
+        }
     }
 
     m_bIsFinished = true;
+
+    //post an event to notify the parent widget that the task is done
+    if(m_pParent) qApp->postEvent((QObject*)m_pParent, new PlaneTaskEvent(m_pPlane, m_pWPolar));
+}
+
+
+/**
+ * Cancels this task only, in a thread-safe manner.
+ * The other running tasks are not affected.
+ */
+void PlaneAnalysisTask::cancel()
+{
+    m_bCancel.storeRelease(1);
+    if(isLLTTask() && m_ptheLLTAnalysis)            m_ptheLLTAnalysis->onCancel();
+    else if(isPanelTask() && m_pthePanelAnalysis)   m_pthePanelAnalysis->onCancel();
 }
 
 
@@ -273,21 +291,50 @@ WPolar* PlaneAnalysisTask::setWPolarObject(Plane *pCurPlane, WPolar *pCurWPolar)
 
 
 
+    setAutoInertia();
+
+    return m_pWPolar;
+}
+
+
+/**
+ * Sets the plane and the polar of an LLT analysis.
+ * Unlike setWPolarObject(), does not build the panels, and so leaves the static
+ * panel and node pointers untouched for the panel analysis which may be running concurrently.
+ * @param pPlane a pointer to the plane to analyze
+ * @param pWPolar a pointer to the polar to analyze
+ * @return a pointer to the polar, or nullptr if the polar is not an LLT polar
+ */
+WPolar* PlaneAnalysisTask::setLLTObjects(Plane *pPlane, WPolar *pWPolar)
+{
+    m_pPlane  = pPlane;
+    m_pWPolar = pWPolar;
+    if(!m_pPlane || !m_pWPolar || !m_pWPolar->isLLTMethod()) return nullptr;
+
+    m_ptheLLTAnalysis->setWPolar(m_pWPolar);
+    m_ptheLLTAnalysis->setPlane(m_pPlane);
+
+    setAutoInertia();
+
+    return m_pWPolar;
+}
+
+
+/**
+ * Copies the plane's inertia to the polar, if the polar is set to use the plane's inertia.
+ */
+void PlaneAnalysisTask::setAutoInertia()
+{
     /** @todo need to cancel results too if we modify the inertia */
-    if(m_pWPolar->m_bAutoInertia)
+    if(m_pWPolar && m_pWPolar->m_bAutoInertia && m_pPlane)
     {
-        if(pCurPlane)
-        {
-            m_pWPolar->setMass(pCurPlane->totalMass());
-            m_pWPolar->setCoG(pCurPlane->CoG());
-            m_pWPolar->setCoGIxx(pCurPlane->CoGIxx());
-            m_pWPolar->setCoGIyy(pCurPlane->CoGIyy());
-            m_pWPolar->setCoGIzz(pCurPlane->CoGIzz());
-            m_pWPolar->setCoGIxz(pCurPlane->CoGIxz());
-        }
+        m_pWPolar->setMass(m_pPlane->totalMass());
+        m_pWPolar->setCoG(m_pPlane->CoG());
+        m_pWPolar->setCoGIxx(m_pPlane->CoGIxx());
+        m_pWPolar->setCoGIyy(m_pPlane->CoGIyy());
+        m_pWPolar->setCoGIzz(m_pPlane->CoGIzz());
+        m_pWPolar->setCoGIxz(m_pPlane->CoGIxz());
     }
-
-    return m_pWPolar;
 }
 
 
@@ -310,6 +357,8 @@ bool PlaneAnalysisTask::initializePanels()
     if(!m_pPlane) return false;
     int Nel=0;
 
+    if(refreshPanels()) return true;
+
     // first check that the total number of panels that will be created does not exceed
     // the currently allocated memory size for the influence atrix.
 
@@ -430,10 +479,154 @@ bool PlaneAnalysisTask::initializePanels()
     memcpy(m_RefWakePanel, m_WakePanel, m_WakeSize* sizeof(Panel));
     memcpy(m_RefWakeNode,  m_WakeNode,  m_nWakeNodes * sizeof(Vector3d));
 
+    //keep a copy of the surfaces, so that only the surfaces which change are panelled next time
+    m_MeshSurface.clear();
+    m_MeshSettings.clear();
+    if(!bBodyEl)
+    {
+        for(int iw=0; iw<MAXWINGS; iw++)
+        {
+            if(!pWingList[iw]) continue;
+            for(int jSurf=0; jSurf<pWingList[iw]->m_Surface.size(); jSurf++)
+                m_MeshSurface.append(*pWingList[iw]->m_Surface.at(jSurf));
+        }
+        meshSettings(m_MeshSettings);
+    }
+
     return true;
 }
 
 
+/**
+ * Updates the panels in place if the surfaces have the same topology as those on which the panels were last built,
+ * i.e. if only the shape of the wings has changed, e.g. in a parametric sweep of the wing's chords or sweep.
+ *
+ * The Surface objects are created anew each time the plane is modified, so that the surfaces which have
+ * changed are identified by comparison with the copies kept in m_MeshSurface. Only the panels of these surfaces are
+ * calculated; the nodes and the panel connections are kept, so that the search for the nodes shared by adjacent panels,
+ * which is the costly part of the panel creation, is skipped.
+ * The wake columns are calculated anew, since their length depends on the plane's mean aerodynamic chord.
+ *
+ * No dirty flag is kept on the wing sections or on the surfaces: the surfaces are rebuilt from the sections each time
+ * the plane is modified, by the dialogs, the scripts or the batch analyses alike, so that a flag would need to be set
+ * on each of these paths. The comparison of the side points costs O(NX) per surface, which is negligible
+ * compared to the calculation of the panels and of the influence matrix.
+ *
+ * If a node shared by a changed surface and another surface does not match, e.g. at a junction whose position
+ * is calculated differently on either side, the update is abandoned and the panels are built anew.
+ *
+ * The planes with body panels are not updated in place.
+ *@return true if the panels have been updated, false if they need to be built anew.
+ */
+bool PlaneAnalysisTask::refreshPanels()
+{
+    if(!m_pPlane || !m_Panel || m_MatSize<=0 || m_MeshSurface.isEmpty()) return false;
+
+    if(m_pPlane->body())
+    {
+        if(!m_pWPolar) return false;
+        if(m_pWPolar->analysisMethod()==XFLR5::PANEL4METHOD && !m_pWPolar->bIgnoreBodyPanels()) return false;
+    }
+
+    QVector<int> settings;
+    meshSettings(settings);
+    if(settings!=m_MeshSettings) return false;
+
+    Wing *pWingList[MAXWINGS];
+    pWingList[0] = m_pPlane->wing();
+    pWingList[1] = m_pPlane->wing2();
+    pWingList[2] = m_pPlane->stab();
+    pWingList[3] = m_pPlane->fin();
+
+    int js=0;
+    for(int iw=0; iw<MAXWINGS; iw++)
+    {
+        if(!pWingList[iw]) continue;
+        for(int jSurf=0; jSurf<pWingList[iw]->m_Surface.size(); jSurf++)
+        {
+            if(js>=m_MeshSurface.size()) return false;
+            if(!pWingList[iw]->m_Surface.at(jSurf)->hasSameTopology(m_MeshSurface.at(js))) return false;
+            js++;
+        }
+    }
+    if(js!=m_MeshSurface.size()) return false;
+
+    if(m_pWPolar)
+    {
+        int MatrixSize=0;
+        if(!m_pthePanelAnalysis->allocateMatrix(m_MaxPanelSize, MatrixSize)) return false;
+    }
+
+    //start from the panels as they were built, in case they have been rotated by the last analysis
+    memcpy(m_Panel, m_MemPanel, m_MatSize* sizeof(Panel));
+    memcpy(m_Node,  m_MemNode,  m_nNodes * sizeof(Vector3d));
+    memcpy(m_WakePanel, m_RefWakePanel, m_WakeSize* sizeof(Panel));
+    memcpy(m_WakeNode,  m_RefWakeNode,  m_nWakeNodes * sizeof(Vector3d));
+
+    QVector<bool> bNodeSet(m_nNodes, false);
+    int p=0;
+    js = 0;
+    for(int iw=0; iw<MAXWINGS; iw++)
+    {
+        if(!pWingList[iw]) continue;
+
+        pWingList[iw]->m_MatSize = 0;
+        pWingList[iw]->m_pWingPanel = m_Panel+p;
+        for(int jSurf=0; jSurf<pWingList[iw]->m_Surface.size(); jSurf++)
+        {
+            Surface *pSurface = pWingList[iw]->m_Surface.at(jSurf);
+            bool bChanged = !pSurface->hasSamePanels(m_MeshSurface.at(js));
+            pSurface->resetFlap();
+            int Nel = refreshSurfaceElements(pSurface, p, bChanged, bNodeSet);
+            if(Nel<0) return false;
+            if(bChanged) m_MeshSurface[js] = *pSurface;
+            pWingList[iw]->m_MatSize += Nel;
+            p += Nel;
+            js++;
+        }
+    }
+
+    if(m_pWPolar && m_pWPolar->analysisMethod()==XFLR5::PANEL4METHOD)
+    {
+        QVector<bool> bWakeNodeSet(m_nWakeNodes, false);
+        for(int pp=0; pp<m_MatSize; pp++)
+        {
+            //the columns are shed by the mid panels of thin surfaces and by the top panels of thick surfaces
+            Panel const &panel = m_Panel[pp];
+            if(panel.m_bIsTrailing && (panel.m_Pos==MIDSURFACE || panel.m_Pos==TOPSURFACE))
+                createWakeElems(pp, m_pPlane, m_pWPolar, &bWakeNodeSet);
+        }
+    }
+
+    //back-up the current geometry
+    memcpy(m_MemPanel, m_Panel, m_MatSize* sizeof(Panel));
+    memcpy(m_MemNode,  m_Node,  m_nNodes * sizeof(Vector3d));
+    memcpy(m_RefWakePanel, m_WakePanel, m_WakeSize* sizeof(Panel));
+    memcpy(m_RefWakeNode,  m_WakeNode,  m_nWakeNodes * sizeof(Vector3d));
+
+    return true;
+}
+
+
+/**
+ * Returns the settings of the polar and of the plane which define the number and the order of the panels,
+ * in addition to the topology of the surfaces.
+ *@param settings the array of settings
+ */
+void PlaneAnalysisTask::meshSettings(QVector<int> &settings)
+{
+    settings.clear();
+    settings.append(m_pPlane->isWing() ? 1 : 0);
+    if(m_pWPolar)
+    {
+        settings.append(m_pWPolar->analysisMethod());
+        settings.append(m_pWPolar->bThinSurfaces() ? 1 : 0);
+        settings.append(m_pWPolar->m_NXWakePanels);
+    }
+    else settings.append(-1);
+}
+
+
 
 
 
@@ -1183,17 +1376,153 @@ int PlaneAnalysisTask::createSurfaceElements(Plane *pPlane, WPolar *pWPolar, Sur
 }
 
 
+/**
+* Updates in place the panels of a surface which have been created by createSurfaceElements().
+* The panels are visited in the order in which they have been created, and keep their nodes and their connections;
+* only the positions of the nodes and the panels' frames are calculated anew.
+* A node shared by several panels is set by the first panel which uses it, as in createSurfaceElements().
+* The other panels which share the node, e.g. at the junction of two surfaces, must place it at the same position
+* within the tolerance with which createSurfaceElements() merges the nodes; the nodes of an unchanged surface
+* keep their previous positions, and are checked in the same way against those of the changed surfaces.
+*
+*@param pSurface a pointer to the surface for which the panels will be updated
+*@param PanelIndex the index of the surface's first panel
+*@param bGeometry true if the surface has changed and the geometry of its panels needs to be calculated,
+* false if only the surface's flap panels and number of elements need to be set
+*@param bNodeSet the flags of the nodes which have already been set
+*@return the number of panels of the surface, or -1 if a shared node does not match the one set by another surface
+*/
+int PlaneAnalysisTask::refreshSurfaceElements(Surface *pSurface, int PanelIndex, bool bGeometry, QVector<bool> &bNodeSet)
+{
+    Vector3d LA, LB, TA, TB;
+    int p = PanelIndex;
+
+    bool bThickSurfaces = true;
+    if(!m_pPlane->isWing()) bThickSurfaces= false;
+    if(m_pWPolar)
+    {
+        if(m_pWPolar->analysisMethod() == XFLR5::LLTMETHOD) bThickSurfaces = false;
+        if(m_pWPolar->analysisMethod() == XFLR5::VLMMETHOD) bThickSurfaces = false;
+        if(m_pWPolar->bThinSurfaces()) bThickSurfaces = false;
+    }
+
+    bool bMatch = true;
+    auto setNode = [this, &bNodeSet, &bMatch](int n, Vector3d const &Pt)
+    {
+        if(bNodeSet.at(n))
+        {
+            if(!m_Node[n].isSame(Pt)) bMatch = false;
+            return;
+        }
+        m_Node[n].copy(Pt);
+        bNodeSet[n] = true;
+    };
+    auto setPanelNodes = [this, &setNode](int p, Vector3d const &LA, Vector3d const &LB, Vector3d const &TA, Vector3d const &TB)
+    {
+        setNode(m_Panel[p].m_iLA, LA);
+        setNode(m_Panel[p].m_iTA, TA);
+        setNode(m_Panel[p].m_iLB, LB);
+        setNode(m_Panel[p].m_iTB, TB);
+    };
+    auto keepPanelNodes = [this, &setPanelNodes](int p)
+    {
+        Panel const &panel = m_Panel[p];
+        setPanelNodes(p, m_MemNode[panel.m_iLA], m_MemNode[panel.m_iLB], m_MemNode[panel.m_iTA], m_MemNode[panel.m_iTB]);
+    };
+
+    if (bThickSurfaces && m_pWPolar && pSurface->isTipLeft())
+    {
+        for (int l=0; l<pSurface->NXPanels(); l++)
+        {
+            if(bGeometry)
+            {
+                pSurface->getPanel(0, l, BOTSURFACE);
+                LA.copy(pSurface->LA);
+                TA.copy(pSurface->TA);
+                pSurface->getPanel(0, l, TOPSURFACE);
+                LB.copy(pSurface->LA);
+                TB.copy(pSurface->TA);
+                setPanelNodes(p, LA, LB, TA, TB);
+                m_Panel[p].setPanelFrame(LA, LB, TA, TB);
+            }
+            else keepPanelNodes(p);
+            p++;
+        }
+    }
+
+    for (int k=0; k<pSurface->NYPanels(); k++)
+    {
+        enumPanelPosition side = bThickSurfaces ? BOTSURFACE : MIDSURFACE;
+        for (int l=0; l<pSurface->NXPanels(); l++)
+        {
+            if(bGeometry)
+            {
+                pSurface->getPanel(k,l,side);
+                setPanelNodes(p, pSurface->LA, pSurface->LB, pSurface->TA, pSurface->TB);
+                if(side==MIDSURFACE) m_Panel[p].setPanelFrame(pSurface->LA, pSurface->LB, pSurface->TA, pSurface->TB);
+                else                 m_Panel[p].setPanelFrame(pSurface->LB, pSurface->LA, pSurface->TB, pSurface->TA);
+            }
+            else keepPanelNodes(p);
+            if(l<pSurface->NXFlap()) pSurface->addFlapPanel(m_Panel+p);
+            p++;
+        }
+
+        if (bThickSurfaces)
+        {
+            for (int l=pSurface->NXPanels()-1;l>=0; l--)
+            {
+                if(bGeometry)
+                {
+                    pSurface->getPanel(k,l,TOPSURFACE);
+                    setPanelNodes(p, pSurface->LA, pSurface->LB, pSurface->TA, pSurface->TB);
+                    m_Panel[p].setPanelFrame(pSurface->LA, pSurface->LB, pSurface->TA, pSurface->TB);
+                }
+                else keepPanelNodes(p);
+                if(l<pSurface->NXFlap()) pSurface->addFlapPanel(m_Panel+p);
+                p++;
+            }
+        }
+    }
+
+    if (bThickSurfaces && m_pWPolar && pSurface->isTipRight())
+    {
+        int k = pSurface->NYPanels()-1;
+        for (int l=0; l< pSurface->NXPanels(); l++)
+        {
+            if(bGeometry)
+            {
+                pSurface->getPanel(k,l,TOPSURFACE);
+                LA.copy(pSurface->LB);
+                TA.copy(pSurface->TB);
+                pSurface->getPanel(k,l,BOTSURFACE);
+                LB.copy(pSurface->LB);
+                TB.copy(pSurface->TB);
+                setPanelNodes(p, LA, LB, TA, TB);
+                m_Panel[p].setPanelFrame(LA, LB, TA, TB);
+            }
+            else keepPanelNodes(p);
+            p++;
+        }
+    }
+
+    pSurface->setNElements(p-PanelIndex);
+    return bMatch ? pSurface->NElements() : -1;
+}
+
+
 /**
 * Creates a column of wake elements shed from a panel at the trailing edge of the wing's surface
 * @param PanelIndex the index of the panel on the trailing edge of the surface which will shed the column of wake panels
+* @param pbWakeNodeSet if not null, the column has already been created and is updated in place;
+* the array holds the flags of the wake nodes which have already been set by the previous columns
 */
-bool PlaneAnalysisTask::createWakeElems(int PanelIndex, Plane *pPlane, WPolar* pWPolar)
+bool PlaneAnalysisTask::createWakeElems(int PanelIndex, Plane *pPlane, WPolar* pWPolar, QVector<bool> *pbWakeNodeSet)
 {
     if(!pWPolar) return false;
     if(!m_Panel[PanelIndex].m_bIsTrailing) return false;
 
     int n0=0, n1=0, n2=0, n3=0;
-    int mw = m_WakeSize;// number of wake panels
+    int mw = pbWakeNodeSet ? m_Panel[PanelIndex].m_iWake : m_WakeSize;// number of wake panels
     Vector3d LATB, TALB;
     Vector3d LA, LB, TA,TB;//wake panel's corner points
 
@@ -1232,45 +1561,59 @@ bool PlaneAnalysisTask::createWakeElems(int PanelIndex, Plane *pPlane, WPolar* p
         dxA *= WakePanelFactor;
         dxB *= WakePanelFactor;
 
-        n0 = isWakeNode(LA);
-        n1 = isWakeNode(TA);
-        n2 = isWakeNode(LB);
-        n3 = isWakeNode(TB);
-
-        if(n0>=0) {
-            m_WakePanel[mw].m_iLA = n0;
-        }
-        else {
-            m_WakePanel[mw].m_iLA = m_nWakeNodes;
-            m_WakeNode[m_nWakeNodes].copy(LA);
-            m_nWakeNodes++;
+        if(pbWakeNodeSet)
+        {
+            int node[] = {m_WakePanel[mw].m_iLA, m_WakePanel[mw].m_iTA, m_WakePanel[mw].m_iLB, m_WakePanel[mw].m_iTB};
+            Vector3d const *pt[] = {&LA, &TA, &LB, &TB};
+            for(int i=0; i<4; i++)
+            {
+                if(pbWakeNodeSet->at(node[i])) continue;
+                m_WakeNode[node[i]].copy(*pt[i]);
+                (*pbWakeNodeSet)[node[i]] = true;
+            }
         }
+        else
+        {
+            n0 = isWakeNode(LA);
+            n1 = isWakeNode(TA);
+            n2 = isWakeNode(LB);
+            n3 = isWakeNode(TB);
 
-        if(n1>=0) {
-            m_WakePanel[mw].m_iTA = n1;
-        }
-        else {
-            m_WakePanel[mw].m_iTA = m_nWakeNodes;
-            m_WakeNode[m_nWakeNodes].copy(TA);
-            m_nWakeNodes++;
-        }
+            if(n0>=0) {
+                m_WakePanel[mw].m_iLA = n0;
+            }
+            else {
+                m_WakePanel[mw].m_iLA = m_nWakeNodes;
+                m_WakeNode[m_nWakeNodes].copy(LA);
+                m_nWakeNodes++;
+            }
 
-        if(n2>=0) {
-            m_WakePanel[mw].m_iLB = n2;
-        }
-        else {
-            m_WakePanel[mw].m_iLB = m_nWakeNodes;
-            m_WakeNode[m_nWakeNodes].copy(LB);
-            m_nWakeNodes++;
-        }
+            if(n1>=0) {
+                m_WakePanel[mw].m_iTA = n1;
+            }
+            else {
+                m_WakePanel[mw].m_iTA = m_nWakeNodes;
+                m_WakeNode[m_nWakeNodes].copy(TA);
+                m_nWakeNodes++;
+            }
 
-        if(n3 >=0) {
-            m_WakePanel[mw].m_iTB = n3;
-        }
-        else {
-            m_WakePanel[mw].m_iTB = m_nWakeNodes;
-            m_WakeNode[m_nWakeNodes].copy(TB);
-            m_nWakeNodes++;
+            if(n2>=0) {
+                m_WakePanel[mw].m_iLB = n2;
+            }
+            else {
+                m_WakePanel[mw].m_iLB = m_nWakeNodes;
+                m_WakeNode[m_nWakeNodes].copy(LB);
+                m_nWakeNodes++;
+            }
+
+            if(n3 >=0) {
+                m_WakePanel[mw].m_iTB = n3;
+            }
+            else {
+                m_WakePanel[mw].m_iTB = m_nWakeNodes;
+                m_WakeNode[m_nWakeNodes].copy(TB);
+                m_nWakeNodes++;
+            }
         }
 
         LATB = TB - LA;
@@ -1295,7 +1638,7 @@ bool PlaneAnalysisTask::createWakeElems(int PanelIndex, Plane *pPlane, WPolar* p
         mw++;
     }
 
-    m_WakeSize = mw;
+    if(!pbWakeNodeSet) m_WakeSize = mw;
 
     return true;
 }
@@ -1374,6 +1717,7 @@ void PlaneAnalysisTask::releasePanelMemory()
 
     m_MatSize = 0;
     m_nNodes = 0;
+    m_MeshSurface.clear();
 }
 
 
@@ -1486,14 +1830,6 @@ bool PlaneAnalysisTask::allocatePanelArrays(int &memsize)
 
 //    Trace(QString("Objects3D::   ...Allocated %1MB for the panel and node arrays").arg((double)memsize/1024./1024.));
 
-    Panel::s_pNode = m_Node;
-    Panel::s_pWakeNode = m_WakeNode;
-
-    Surface::setPanelPointers(m_Panel, m_Node);
-
-//    QMiarex::s_pPanel = m_Panel;
-//    QMiarex::s_pNode = m_Node;
-
     return true;
 }
 
@@ -25,15 +25,16 @@
 
 
 #include <QEvent>
+#include <QAtomicInt>
 #include <QTextStream>
 
 #include <analysis3d/plane_analysis/lltanalysis.h>
 #include <analysis3d/plane_analysis/panelanalysis.h>
+#include <objects/objects3d/surface.h>
 
 class Plane;
 class WPolar;
 class PlaneOpp;
-class Surface;
 class Panel;
 class Vector3d;
 
@@ -68,9 +69,11 @@ public:
     bool   allocatePanelArrays(int &memsize);
     int    calculateMatSize();
     int    createBodyElements(Plane *pCurPlane);
-    bool   createWakeElems(int PanelIndex, Plane *pPlane, WPolar *pWPolar);
+    bool   createWakeElems(int PanelIndex, Plane *pPlane, WPolar *pWPolar, QVector<bool> *pbWakeNodeSet=nullptr);
     int    createSurfaceElements(Plane *pPlane, WPolar *pWPolar, Surface *pSurface);
+    int    refreshSurfaceElements(Surface *pSurface, int PanelIndex, bool bGeometry, QVector<bool> &bNodeSet);
     bool   initializePanels();
+    bool   refreshPanels();
     void   insertPOpp(PlaneOpp *pPOpp);
     int    isNode(Vector3d &Pt);
     int    isWakeNode(Vector3d &Pt);
@@ -83,22 +86,30 @@ public:
     void   setPanelAnalysis(PanelAnalysis &panelAnalysis) {m_pthePanelAnalysis = &panelAnalysis;}
 
     bool isFinished(){return m_bIsFinished;}
+    int matSize() const {return m_MatSize;}
+    Panel *panel(int p) const {return m_Panel+p;}
 
     WPolar *  setWPolarObject(Plane *pCurPlane, WPolar *pCurWPolar);
+    WPolar *  setLLTObjects(Plane *pPlane, WPolar *pWPolar);
     Plane *   setPlaneObject(Plane *pPlane);
 
     void LLTAnalyze();
     void PanelAnalyze();
     void run();
-    static void cancelTask(){s_bCancel=true;}
+    void cancel();
+    static void cancelTask(){s_bCancel.storeRelease(1);}
 
     PanelAnalysis *m_pthePanelAnalysis;
     LLTAnalysis *m_ptheLLTAnalysis;
 
     bool isLLTTask() const;
     bool isPanelTask() const;
+    bool isCancelled() const {return s_bCancel.loadAcquire() || m_bCancel.loadAcquire();}
 
 private:
+    void setAutoInertia();
+    void meshSettings(QVector<int> &settings);
+
     void *m_pParent;
 
     Plane *m_pPlane;
@@ -126,11 +137,14 @@ private:
     int m_MaxPanelSize;                  /**< the maximum matrix size consistent <ith the current memory allocation */
 
     QVector<Surface *> m_SurfaceList;        /**< An array holding the pointers to the wings Surface objects */
+    QVector<Surface> m_MeshSurface;          /**< copies of the Surface objects on which the current panels have been built, used to identify the surfaces which have changed */
+    QVector<int> m_MeshSettings;             /**< the polar and plane settings with which the current panels have been built */
 
     double m_vMin, m_vMax, m_vInc;
     bool m_bSequence;
     bool m_bIsFinished;       /**< true if the calculation is over */
-    static bool s_bCancel;    /**< true if all analysis should be cancelled */
+    QAtomicInt m_bCancel;           /**< non-zero if this analysis should be cancelled */
+    static QAtomicInt s_bCancel;    /**< non-zero if all analysis should be cancelled */
 
 };
 
@@ -0,0 +1,469 @@
+/****************************************************************************
+
+    VortexArray Class
+
+    Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+
+#include <math.h>
+
+#include "vortexarray.h"
+#include <objects/objects3d/panel.h>
+#include <analysis3d/analysis3d_params.h>
+
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define VORTEX_AVX2
+    #include <immintrin.h>
+#endif
+
+
+bool VortexArray::s_bVectorized = true;
+
+
+/**
+ * @struct the pointers to the arrays of a VortexArray, passed to the kernels
+ */
+struct SegmentArrays
+{
+    int const *owner;
+    char const *bBound;
+    double const *P0x, *P0y, *P0z;
+    double const *P1x, *P1y, *P1z;
+    double const *Qx, *Qy, *Qz;
+    double const *Wx, *Wy, *Wz;
+};
+
+
+/**
+ * Evaluates the velocity induced at one point by a straight vortex segment of unit circulation,
+ * with the same operations as PanelAnalysis::VLMCmn() and PanelAnalysis::VLMQmn().
+ * The velocity is zero if the point's distance to the line (Q, W) is less than the core size.
+ */
+static inline void segmentVelocity(double P0x, double P0y, double P0z, double P1x, double P1y, double P1z,
+                                   double Qx, double Qy, double Qz, double Wx, double Wy, double Wz,
+                                   double Cx, double Cy, double Cz, double CoreSize2,
+                                   double &Vx, double &Vy, double &Vz)
+{
+    double r0_x = P1x - P0x;
+    double r0_y = P1y - P0y;
+    double r0_z = P1z - P0z;
+    double r1_x = Cx - P0x;
+    double r1_y = Cy - P0y;
+    double r1_z = Cz - P0z;
+    double r2_x = Cx - P1x;
+    double r2_y = Cy - P1y;
+    double r2_z = Cz - P1z;
+
+    double Psi_x = r1_y*r2_z - r1_z*r2_y;
+    double Psi_y =-r1_x*r2_z + r1_z*r2_x;
+    double Psi_z = r1_x*r2_y - r1_y*r2_x;
+
+    double ftmp = Psi_x*Psi_x + Psi_y*Psi_y + Psi_z*Psi_z;
+
+    //get the distance of the TestPoint to the core line
+    double h_x = Cx - Qx;
+    double h_y = Cy - Qy;
+    double h_z = Cz - Qz;
+    double t_x =  h_y*Wz - h_z*Wy;
+    double t_y = -h_x*Wz + h_z*Wx;
+    double t_z =  h_x*Wy - h_y*Wx;
+
+    Vx = Vy = Vz = 0.0;
+    if ((t_x*t_x+t_y*t_y+t_z*t_z)/(Wx*Wx+Wy*Wy+Wz*Wz) > CoreSize2)
+    {
+        Psi_x /= ftmp;
+        Psi_y /= ftmp;
+        Psi_z /= ftmp;
+
+        double Omega = (r0_x*r1_x + r0_y*r1_y + r0_z*r1_z)/sqrt(r1_x*r1_x + r1_y*r1_y + r1_z*r1_z)
+                      -(r0_x*r2_x + r0_y*r2_y + r0_z*r2_z)/sqrt(r2_x*r2_x + r2_y*r2_y + r2_z*r2_z);
+
+        Vx = Psi_x * Omega/4.0/PI;
+        Vy = Psi_y * Omega/4.0/PI;
+        Vz = Psi_z * Omega/4.0/PI;
+    }
+}
+
+
+/**
+ * Adds the velocities induced by the segments s0 to s1-1 at n points; scalar version.
+ */
+static void segmentsAtPoints(SegmentArrays const &sg, int s0, int s1, bool bAll,
+                             int n, double const *x, double const *y, double const *z,
+                             double *vx, double *vy, double *vz, double CoreSize2)
+{
+    double Vx=0.0, Vy=0.0, Vz=0.0;
+    for(int s=s0; s<s1; s++)
+    {
+        if(!bAll && sg.bBound[s]) continue;
+
+        double P0x = sg.P0x[s], P0y = sg.P0y[s], P0z = sg.P0z[s];
+        double P1x = sg.P1x[s], P1y = sg.P1y[s], P1z = sg.P1z[s];
+        double Qx  = sg.Qx[s],  Qy  = sg.Qy[s],  Qz  = sg.Qz[s];
+        double Wx  = sg.Wx[s],  Wy  = sg.Wy[s],  Wz  = sg.Wz[s];
+        for(int i=0; i<n; i++)
+        {
+            segmentVelocity(P0x, P0y, P0z, P1x, P1y, P1z, Qx, Qy, Qz, Wx, Wy, Wz, x[i], y[i], z[i], CoreSize2, Vx, Vy, Vz);
+            vx[i] += Vx;
+            vy[i] += Vy;
+            vz[i] += Vz;
+        }
+    }
+}
+
+
+/**
+ * Returns the sum of the velocities induced at one point by the segments s0 to s1-1 with circulations Gamma[owner[s]];
+ * scalar version.
+ */
+static void pointFromSegments(SegmentArrays const &sg, int s0, int s1, bool bAll, double const *Gamma,
+                              double Cx, double Cy, double Cz, double CoreSize2,
+                              double &vx, double &vy, double &vz)
+{
+    double Vx=0.0, Vy=0.0, Vz=0.0;
+    for(int s=s0; s<s1; s++)
+    {
+        if(!bAll && sg.bBound[s]) continue;
+        segmentVelocity(sg.P0x[s], sg.P0y[s], sg.P0z[s], sg.P1x[s], sg.P1y[s], sg.P1z[s],
+                        sg.Qx[s], sg.Qy[s], sg.Qz[s], sg.Wx[s], sg.Wy[s], sg.Wz[s],
+                        Cx, Cy, Cz, CoreSize2, Vx, Vy, Vz);
+        double g = Gamma[sg.owner[s]];
+        vx += Vx*g;
+        vy += Vy*g;
+        vz += Vz*g;
+    }
+}
+
+
+#ifdef VORTEX_AVX2
+
+/**
+ * The AVX2 version of segmentVelocity(), for 4 segment and point pairs.
+ * The operations are the same as in the scalar version; FMA contractions are not enabled, so that
+ * the results are identical.
+ */
+__attribute__((target("avx2")))
+static inline void segmentVelocity4(__m256d P0x, __m256d P0y, __m256d P0z, __m256d P1x, __m256d P1y, __m256d P1z,
+                                    __m256d Qx, __m256d Qy, __m256d Qz, __m256d Wx, __m256d Wy, __m256d Wz,
+                                    __m256d Cx, __m256d Cy, __m256d Cz, __m256d CoreSize2,
+                                    __m256d &Vx, __m256d &Vy, __m256d &Vz)
+{
+    __m256d r0_x = _mm256_sub_pd(P1x, P0x);
+    __m256d r0_y = _mm256_sub_pd(P1y, P0y);
+    __m256d r0_z = _mm256_sub_pd(P1z, P0z);
+    __m256d r1_x = _mm256_sub_pd(Cx, P0x);
+    __m256d r1_y = _mm256_sub_pd(Cy, P0y);
+    __m256d r1_z = _mm256_sub_pd(Cz, P0z);
+    __m256d r2_x = _mm256_sub_pd(Cx, P1x);
+    __m256d r2_y = _mm256_sub_pd(Cy, P1y);
+    __m256d r2_z = _mm256_sub_pd(Cz, P1z);
+
+    __m256d Psi_x = _mm256_sub_pd(_mm256_mul_pd(r1_y, r2_z), _mm256_mul_pd(r1_z, r2_y));
+    __m256d Psi_y = _mm256_sub_pd(_mm256_mul_pd(r1_z, r2_x), _mm256_mul_pd(r1_x, r2_z));
+    __m256d Psi_z = _mm256_sub_pd(_mm256_mul_pd(r1_x, r2_y), _mm256_mul_pd(r1_y, r2_x));
+
+    __m256d ftmp = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(Psi_x, Psi_x), _mm256_mul_pd(Psi_y, Psi_y)), _mm256_mul_pd(Psi_z, Psi_z));
+
+    __m256d h_x = _mm256_sub_pd(Cx, Qx);
+    __m256d h_y = _mm256_sub_pd(Cy, Qy);
+    __m256d h_z = _mm256_sub_pd(Cz, Qz);
+    __m256d t_x = _mm256_sub_pd(_mm256_mul_pd(h_y, Wz), _mm256_mul_pd(h_z, Wy));
+    __m256d t_y = _mm256_sub_pd(_mm256_mul_pd(h_z, Wx), _mm256_mul_pd(h_x, Wz));
+    __m256d t_z = _mm256_sub_pd(_mm256_mul_pd(h_x, Wy), _mm256_mul_pd(h_y, Wx));
+
+    __m256d t2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(t_x, t_x), _mm256_mul_pd(t_y, t_y)), _mm256_mul_pd(t_z, t_z));
+    __m256d W2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(Wx, Wx), _mm256_mul_pd(Wy, Wy)), _mm256_mul_pd(Wz, Wz));
+    __m256d bOut = _mm256_cmp_pd(_mm256_div_pd(t2, W2), CoreSize2, _CMP_GT_OQ);
+
+    // avoid the division by zero for the points inside the core; the result is discarded anyway
+    ftmp = _mm256_blendv_pd(_mm256_set1_pd(1.0), ftmp, bOut);
+    Psi_x = _mm256_div_pd(Psi_x, ftmp);
+    Psi_y = _mm256_div_pd(Psi_y, ftmp);
+    Psi_z = _mm256_div_pd(Psi_z, ftmp);
+
+    __m256d r1v = _mm256_sqrt_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(r1_x, r1_x), _mm256_mul_pd(r1_y, r1_y)), _mm256_mul_pd(r1_z, r1_z)));
+    __m256d r2v = _mm256_sqrt_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(r2_x, r2_x), _mm256_mul_pd(r2_y, r2_y)), _mm256_mul_pd(r2_z, r2_z)));
+    __m256d d1 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(r0_x, r1_x), _mm256_mul_pd(r0_y, r1_y)), _mm256_mul_pd(r0_z, r1_z));
+    __m256d d2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(r0_x, r2_x), _mm256_mul_pd(r0_y, r2_y)), _mm256_mul_pd(r0_z, r2_z));
+    __m256d Omega = _mm256_sub_pd(_mm256_div_pd(d1, r1v), _mm256_div_pd(d2, r2v));
+
+    __m256d four = _mm256_set1_pd(4.0);
+    __m256d pi   = _mm256_set1_pd(PI);
+    Vx = _mm256_and_pd(_mm256_div_pd(_mm256_div_pd(_mm256_mul_pd(Psi_x, Omega), four), pi), bOut);
+    Vy = _mm256_and_pd(_mm256_div_pd(_mm256_div_pd(_mm256_mul_pd(Psi_y, Omega), four), pi), bOut);
+    Vz = _mm256_and_pd(_mm256_div_pd(_mm256_div_pd(_mm256_mul_pd(Psi_z, Omega), four), pi), bOut);
+}
+
+
+/**
+ * The AVX2 version of segmentsAtPoints(): each segment is evaluated at 4 points at a time.
+ */
+__attribute__((target("avx2")))
+static void segmentsAtPointsAVX2(SegmentArrays const &sg, int s0, int s1, bool bAll,
+                                 int n, double const *x, double const *y, double const *z,
+                                 double *vx, double *vy, double *vz, double CoreSize2)
+{
+    __m256d Vx, Vy, Vz;
+    __m256d core2 = _mm256_set1_pd(CoreSize2);
+    int n4 = n - n%4;
+
+    for(int s=s0; s<s1; s++)
+    {
+        if(!bAll && sg.bBound[s]) continue;
+
+        __m256d P0x = _mm256_set1_pd(sg.P0x[s]), P0y = _mm256_set1_pd(sg.P0y[s]), P0z = _mm256_set1_pd(sg.P0z[s]);
+        __m256d P1x = _mm256_set1_pd(sg.P1x[s]), P1y = _mm256_set1_pd(sg.P1y[s]), P1z = _mm256_set1_pd(sg.P1z[s]);
+        __m256d Qx  = _mm256_set1_pd(sg.Qx[s]),  Qy  = _mm256_set1_pd(sg.Qy[s]),  Qz  = _mm256_set1_pd(sg.Qz[s]);
+        __m256d Wx  = _mm256_set1_pd(sg.Wx[s]),  Wy  = _mm256_set1_pd(sg.Wy[s]),  Wz  = _mm256_set1_pd(sg.Wz[s]);
+
+        for(int i=0; i<n4; i+=4)
+        {
+            segmentVelocity4(P0x, P0y, P0z, P1x, P1y, P1z, Qx, Qy, Qz, Wx, Wy, Wz,
+                             _mm256_loadu_pd(x+i), _mm256_loadu_pd(y+i), _mm256_loadu_pd(z+i), core2, Vx, Vy, Vz);
+            _mm256_storeu_pd(vx+i, _mm256_add_pd(_mm256_loadu_pd(vx+i), Vx));
+            _mm256_storeu_pd(vy+i, _mm256_add_pd(_mm256_loadu_pd(vy+i), Vy));
+            _mm256_storeu_pd(vz+i, _mm256_add_pd(_mm256_loadu_pd(vz+i), Vz));
+        }
+        if(n4<n) segmentsAtPoints(sg, s, s+1, true, n-n4, x+n4, y+n4, z+n4, vx+n4, vy+n4, vz+n4, CoreSize2);
+    }
+}
+
+
+/**
+ * The AVX2 version of pointFromSegments(): the point is evaluated against 4 segments at a time.
+ */
+__attribute__((target("avx2")))
+static void pointFromSegmentsAVX2(SegmentArrays const &sg, int s0, int s1, bool bAll, double const *Gamma,
+                                  double Cx, double Cy, double Cz, double CoreSize2,
+                                  double &vx, double &vy, double &vz)
+{
+    __m256d Vx, Vy, Vz;
+    __m256d core2 = _mm256_set1_pd(CoreSize2);
+    __m256d Cx4 = _mm256_set1_pd(Cx), Cy4 = _mm256_set1_pd(Cy), Cz4 = _mm256_set1_pd(Cz);
+    __m256d sx = _mm256_setzero_pd(), sy = _mm256_setzero_pd(), sz = _mm256_setzero_pd();
+    double lane[4];
+    int s4 = s0 + (s1-s0) - (s1-s0)%4;
+
+    for(int s=s0; s<s4; s+=4)
+    {
+        segmentVelocity4(_mm256_loadu_pd(sg.P0x+s), _mm256_loadu_pd(sg.P0y+s), _mm256_loadu_pd(sg.P0z+s),
+                         _mm256_loadu_pd(sg.P1x+s), _mm256_loadu_pd(sg.P1y+s), _mm256_loadu_pd(sg.P1z+s),
+                         _mm256_loadu_pd(sg.Qx+s),  _mm256_loadu_pd(sg.Qy+s),  _mm256_loadu_pd(sg.Qz+s),
+                         _mm256_loadu_pd(sg.Wx+s),  _mm256_loadu_pd(sg.Wy+s),  _mm256_loadu_pd(sg.Wz+s),
+                         Cx4, Cy4, Cz4, core2, Vx, Vy, Vz);
+
+        __m256d g = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), Gamma, _mm_loadu_si128(reinterpret_cast<__m128i const*>(sg.owner+s)),
+                                             _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8);
+        if(!bAll)
+        {
+            g = _mm256_mul_pd(g, _mm256_set_pd(sg.bBound[s+3] ? 0.0 : 1.0, sg.bBound[s+2] ? 0.0 : 1.0,
+                                               sg.bBound[s+1] ? 0.0 : 1.0, sg.bBound[s]   ? 0.0 : 1.0));
+        }
+        sx = _mm256_add_pd(sx, _mm256_mul_pd(Vx, g));
+        sy = _mm256_add_pd(sy, _mm256_mul_pd(Vy, g));
+        sz = _mm256_add_pd(sz, _mm256_mul_pd(Vz, g));
+    }
+
+    _mm256_storeu_pd(lane, sx);
+    vx += lane[0] + lane[1] + lane[2] + lane[3];
+    _mm256_storeu_pd(lane, sy);
+    vy += lane[0] + lane[1] + lane[2] + lane[3];
+    _mm256_storeu_pd(lane, sz);
+    vz += lane[0] + lane[1] + lane[2] + lane[3];
+
+    pointFromSegments(sg, s4, s1, bAll, Gamma, Cx, Cy, Cz, CoreSize2, vx, vy, vz);
+}
+
+
+/**
+ * @return true if the processor supports the AVX2 instructions
+ */
+static bool hasAVX2()
+{
+    static bool bAVX2 = __builtin_cpu_supports("avx2");
+    return bAVX2;
+}
+
+#endif
+
+
+
+VortexArray::VortexArray()
+{
+    clear();
+}
+
+
+/**
+ * Removes all the segments.
+ */
+void VortexArray::clear()
+{
+    m_First.clear();
+    m_First.append(0);
+    m_Owner.clear();
+    m_bBound.clear();
+    m_P0x.clear();  m_P0y.clear();  m_P0z.clear();
+    m_P1x.clear();  m_P1y.clear();  m_P1z.clear();
+    m_Qx.clear();   m_Qy.clear();   m_Qz.clear();
+    m_Wx.clear();   m_Wy.clear();   m_Wz.clear();
+}
+
+
+/**
+ * Closes the list of segments of the current panel. Must be called once for each panel, including those without vortices.
+ */
+void VortexArray::endPanel()
+{
+    m_First.append(m_P0x.size());
+}
+
+
+void VortexArray::addSegment(Vector3d const &P0, Vector3d const &P1, Vector3d const &Q, Vector3d const &W, bool bBound)
+{
+    m_Owner.append(m_First.size()-1);
+    m_bBound.append(bBound ? 1 : 0);
+    m_P0x.append(P0.x);  m_P0y.append(P0.y);  m_P0z.append(P0.z);
+    m_P1x.append(P1.x);  m_P1y.append(P1.y);  m_P1z.append(P1.z);
+    m_Qx.append(Q.x);    m_Qy.append(Q.y);    m_Qz.append(Q.z);
+    m_Wx.append(W.x);    m_Wy.append(W.y);    m_Wz.append(W.z);
+}
+
+
+/**
+ * Adds the segments of a horseshoe vortex to the current panel.
+ * The trailing legs extend to x=+infinity, as in PanelAnalysis::VLMCmn().
+ * @param A the left point of the bound vortex
+ * @param B the right point of the bound vortex
+ */
+void VortexArray::addHorseshoe(Vector3d const &A, Vector3d const &B)
+{
+    Vector3d XAxis(1.0, 0.0, 0.0);
+
+    addSegment(A, B, A, B-A, true);
+
+    // the left leg comes from infinity, the right leg goes to infinity
+    Vector3d FarA(A.x + 1.0e10, A.y, A.z);
+    Vector3d FarB(B.x + 1.0e10, B.y, B.z);
+    addSegment(FarA, A, A, XAxis, false);
+    addSegment(B, FarB, B, XAxis, false);
+}
+
+
+/**
+ * Adds the four sides of a ring vortex to the current panel, in the order of PanelAnalysis::VLMQmn().
+ * @param LA the leading left point of the quad vortex
+ * @param LB the leading right point of the quad vortex
+ * @param TA the trailing left point of the quad vortex
+ * @param TB the trailing right point of the quad vortex
+ */
+void VortexArray::addRing(Vector3d const &LA, Vector3d const &LB, Vector3d const &TA, Vector3d const &TB)
+{
+    addSegment(LB, TB, LB, TB-LB, true);
+    addSegment(TB, TA, TB, TA-TB, true);
+    addSegment(TA, LA, TA, LA-TA, true);
+    addSegment(LA, LB, LA, LB-LA, true);
+}
+
+
+/**
+ * Returns the pointers to the arrays, for the kernels.
+ */
+SegmentArrays VortexArray::arrays() const
+{
+    SegmentArrays sg;
+    sg.owner  = m_Owner.constData();
+    sg.bBound = m_bBound.constData();
+    sg.P0x = m_P0x.constData();  sg.P0y = m_P0y.constData();  sg.P0z = m_P0z.constData();
+    sg.P1x = m_P1x.constData();  sg.P1y = m_P1y.constData();  sg.P1z = m_P1z.constData();
+    sg.Qx  = m_Qx.constData();   sg.Qy  = m_Qy.constData();   sg.Qz  = m_Qz.constData();
+    sg.Wx  = m_Wx.constData();   sg.Wy  = m_Wy.constData();   sg.Wz  = m_Wz.constData();
+    return sg;
+}
+
+
+/**
+ * @return the square of the vortex core size
+ */
+double VortexArray::coreSize2()
+{
+    //we use a default core size, unless the user has specified one
+    double CoreSize = 0.0001;
+    if(fabs(Panel::coreSize())>PRECISION) CoreSize = Panel::coreSize();
+    return CoreSize*CoreSize;
+}
+
+
+/**
+ * Adds the velocities induced at n points by the vortices of a panel with unit circulation.
+ * @param p the index of the panel
+ * @param n the number of points
+ * @param x, y, z the arrays of the points' coordinates
+ * @param vx, vy, vz the arrays of the velocities, to which the panel's velocities are added
+ * @param bAll true if the influence of the bound vortices should be included
+ */
+void VortexArray::getVelocities(int p, int n, double const *x, double const *y, double const *z, double *vx, double *vy, double *vz, bool bAll) const
+{
+    if(p+1>=m_First.size()) return;
+
+#ifdef VORTEX_AVX2
+    if(s_bVectorized && hasAVX2())
+    {
+        segmentsAtPointsAVX2(arrays(), m_First.at(p), m_First.at(p+1), bAll, n, x, y, z, vx, vy, vz, coreSize2());
+        return;
+    }
+#endif
+    segmentsAtPoints(arrays(), m_First.at(p), m_First.at(p+1), bAll, n, x, y, z, vx, vy, vz, coreSize2());
+}
+
+
+/**
+ * @return true if the AVX2 kernels have been compiled and the processor supports them
+ */
+bool VortexArray::hasVectorKernels()
+{
+#ifdef VORTEX_AVX2
+    return hasAVX2();
+#else
+    return false;
+#endif
+}
+
+
+/**
+ * Returns the velocity induced at one point by the vortices of all the panels.
+ * @param C the point where the velocity is calculated
+ * @param Gamma the array of the panels' circulations
+ * @param bAll true if the influence of the bound vortices should be included
+ * @param V the resulting velocity
+ */
+void VortexArray::getVelocity(Vector3d const &C, double const *Gamma, bool bAll, Vector3d &V) const
+{
+    V.set(0.0, 0.0, 0.0);
+
+#ifdef VORTEX_AVX2
+    if(s_bVectorized && hasAVX2())
+    {
+        pointFromSegmentsAVX2(arrays(), 0, m_P0x.size(), bAll, Gamma, C.x, C.y, C.z, coreSize2(), V.x, V.y, V.z);
+        return;
+    }
+#endif
+    pointFromSegments(arrays(), 0, m_P0x.size(), bAll, Gamma, C.x, C.y, C.z, coreSize2(), V.x, V.y, V.z);
+}
@@ -0,0 +1,85 @@
+/****************************************************************************
+
+    VortexArray Class
+
+    Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+
+#ifndef VORTEXARRAY_H
+#define VORTEXARRAY_H
+
+#include <QVector>
+
+#include <objects/objects3d/vector3d.h>
+
+struct SegmentArrays;
+
+/**
+ * @class VortexArray
+ * The straight vortex segments of the VLM panels, stored as a structure of arrays.
+ *
+ * Each horseshoe vortex is stored as its bound segment and its two semi-infinite trailing legs,
+ * and each ring vortex as its four sides. The segments of a panel are stored contiguously,
+ * in the order in which PanelAnalysis::VLMGetVortexInfluence() evaluates them.
+ *
+ * The velocities are evaluated by batches, either of one panel's segments at a set of points,
+ * or of all the segments at one point. With GCC or Clang on x86 processors, the batches are
+ * evaluated four at a time with AVX2 instructions if the processor supports them;
+ * the scalar kernels are used otherwise.
+ *
+ * The results are those of PanelAnalysis::VLMCmn() and PanelAnalysis::VLMQmn(),
+ * which remain the reference scalar implementation.
+ */
+class XFLR5ENGINELIBSHARED_EXPORT VortexArray
+{
+public:
+    VortexArray();
+
+    void clear();
+    int panelCount() const {return m_First.size()-1;}
+    int segmentCount() const {return m_P0x.size();}
+
+    void addHorseshoe(Vector3d const &A, Vector3d const &B);
+    void addRing(Vector3d const &LA, Vector3d const &LB, Vector3d const &TA, Vector3d const &TB);
+    void endPanel();
+
+    void getVelocities(int p, int n, double const *x, double const *y, double const *z, double *vx, double *vy, double *vz, bool bAll) const;
+    void getVelocity(Vector3d const &C, double const *Gamma, bool bAll, Vector3d &V) const;
+
+    static void setVectorized(bool bVectorized) {s_bVectorized = bVectorized;}
+    static bool isVectorized() {return s_bVectorized;}
+    static bool hasVectorKernels();
+
+private:
+    void addSegment(Vector3d const &P0, Vector3d const &P1, Vector3d const &Q, Vector3d const &W, bool bBound);
+    SegmentArrays arrays() const;
+    static double coreSize2();
+
+    static bool s_bVectorized;    /**< true if the AVX2 kernels should be used when the processor supports them */
+
+    QVector<int> m_First;         /**< the index of the first segment of each panel; the last value is the number of segments */
+    QVector<int> m_Owner;         /**< the index of the panel of each segment */
+    QVector<char> m_bBound;       /**< 1 if the segment is a bound vortex, 0 if it is a semi-infinite trailing leg */
+    QVector<double> m_P0x, m_P0y, m_P0z;    /**< the start points of the segments */
+    QVector<double> m_P1x, m_P1y, m_P1z;    /**< the end points of the segments */
+    QVector<double> m_Qx, m_Qy, m_Qz;       /**< a point of the line used to test if a point is in the vortex core */
+    QVector<double> m_Wx, m_Wy, m_Wz;       /**< the direction of the line used to test if a point is in the vortex core */
+};
+
+#endif // VORTEXARRAY_H
@@ -23,6 +23,8 @@
 #include "foil.h"
 #include "polar.h"
 
+#include <algorithm>
+
 #define PI 3.141592654
 
 /**
@@ -211,57 +213,31 @@ void Polar::addOpPointData(OpPoint *pOpPoint)
 {
     if(!pOpPoint->m_bViscResults) return;
 
-    bool bInserted = false;
-    int i;
+    // the arrays are kept sorted by this method, so that the index is found by bisection
     int size = m_Alpha.size();
-
-    if(size)
+    int i = size;
+    if(m_PolarType<XFLR5::FIXEDAOAPOLAR)
     {
-        for (i=0; i<size; i++)
+        i = int(std::upper_bound(m_Alpha.constBegin(), m_Alpha.constEnd(), pOpPoint->aoa()-0.001) - m_Alpha.constBegin());
+        if(i<size && qAbs(pOpPoint->aoa()-m_Alpha[i]) < 0.001)
         {
-            if(m_PolarType<XFLR5::FIXEDAOAPOLAR)
-            {
-                if (qAbs(pOpPoint->aoa()-m_Alpha[i]) < 0.001)
-                {
-                    replaceOppDataAt(i, pOpPoint);
-                    bInserted = true;
-                    break;
-                }
-                else if (pOpPoint->aoa() < m_Alpha[i])
-                {
-                    insertOppDataAt(i, pOpPoint);
-                    bInserted = true;
-                    break;
-                }
-            }
-            else if(m_PolarType==XFLR5::FIXEDAOAPOLAR)
-            {
-                // type 4, sort by speed
-                if (qAbs(pOpPoint->Reynolds() - m_Re[i]) < 0.1)
-                {
-                    // then erase former result
-                    replaceOppDataAt(i, pOpPoint);
-                    bInserted = true;
-                    break;
-                }
-                else if (pOpPoint->Reynolds() < m_Re[i])
-                {
-                    // sort by crescending speed
-                    insertOppDataAt(i, pOpPoint);
-                    bInserted = true;
-                    break;
-                }
-            }
-
+            replaceOppDataAt(i, pOpPoint);
+            return;
         }
     }
-
-    if(!bInserted)
+    else if(m_PolarType==XFLR5::FIXEDAOAPOLAR)
     {
-        // data is appended at the end
-        int size = m_Alpha.size();
-        insertOppDataAt(size, pOpPoint);
+        // type 4, sort by crescending speed
+        i = int(std::upper_bound(m_Re.constBegin(), m_Re.constEnd(), pOpPoint->Reynolds()-0.1) - m_Re.constBegin());
+        if(i<size && qAbs(pOpPoint->Reynolds() - m_Re[i]) < 0.1)
+        {
+            // then erase former result
+            replaceOppDataAt(i, pOpPoint);
+            return;
+        }
     }
+
+    insertOppDataAt(i, pOpPoint);
 }
 
 
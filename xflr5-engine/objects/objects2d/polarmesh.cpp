@@ -0,0 +1,268 @@
+/****************************************************************************
+
+    PolarMesh Class
+    Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+#include <algorithm>
+
+#include "polarmesh.h"
+#include <analysis3d/analysis3d_params.h>
+#include "foil.h"
+#include "polar.h"
+
+
+/**
+* Interpolates a variable in an array sorted by crescending values.
+*@param x the sorted array in which the value is searched
+*@param var the array of the variable to interpolate
+*@param value the value to search for
+*@param result the interpolated variable
+*@return true if an interval such that x[i]<=value<x[i+1] has been found, false otherwise
+*/
+static bool interpolateSorted(QVector<double> const &x, QVector<double> const &var, double value, double &result)
+{
+    // the first point strictly greater than the value
+    int j = int(std::upper_bound(x.constBegin(), x.constEnd(), value) - x.constBegin());
+    if(j<=0 || j>=x.size()) return false;
+
+    int i = j-1;
+    if(x.at(i+1)-x.at(i)<0.00001)//do not divide by zero
+        result = var.at(i);
+    else
+    {
+        double u = (value - x.at(i)) / (x.at(i+1)-x.at(i));
+        result = var.at(i) + u * (var.at(i+1)-var.at(i));
+    }
+    return true;
+}
+
+
+/**
+* Builds the index of the polar mesh from the array of polars.
+*@param poaPolar a pointer to the array of polars
+*/
+void PolarMesh::build(QVector<Polar*> const *poaPolar)
+{
+    m_FoilMesh.clear();
+    if(!poaPolar) return;
+
+    for (int i=0; i<poaPolar->size(); i++)
+    {
+        Polar *pPolar = poaPolar->at(i);
+
+        MeshPolar meshPolar;
+        meshPolar.pPolar = pPolar;
+        meshPolar.Re = pPolar->Reynolds();
+        pPolar->getAlphaLimits(meshPolar.aMin, meshPolar.aMax);
+        meshPolar.ZeroLiftAngle = pPolar->getZeroLiftAngle();
+        pPolar->getLinearizedCl(meshPolar.Alpha0, meshPolar.Slope);
+
+        FoilMesh &foilMesh = m_FoilMesh[pPolar->foilName()];
+        foilMesh.allPolars.append(meshPolar);
+        if(pPolar->isFixedSpeedPolar() && pPolar->m_Alpha.size()>0)
+            foilMesh.type1Polars.append(meshPolar);
+    }
+
+    // the array of polars is normally sorted by Re already, but the binary search requires it
+    for(QHash<QString, FoilMesh>::iterator it=m_FoilMesh.begin(); it!=m_FoilMesh.end(); ++it)
+    {
+        std::stable_sort(it.value().type1Polars.begin(), it.value().type1Polars.end(),
+                         [](MeshPolar const &p1, MeshPolar const &p2) {return p1.Re<p2.Re;});
+    }
+}
+
+
+/**
+* Returns the polars of a foil, or a null pointer if the foil has no polars.
+*/
+PolarMesh::FoilMesh const *PolarMesh::foilMesh(Foil const *pFoil) const
+{
+    if(!pFoil) return nullptr;
+    QHash<QString, FoilMesh>::const_iterator it = m_FoilMesh.constFind(pFoil->foilName());
+    if(it==m_FoilMesh.constEnd()) return nullptr;
+    return &it.value();
+}
+
+
+/**
+* Returns the value of an aero coefficient, interpolated on a polar mesh, and based on the value of the Reynolds Number and of the aoa.
+* Proceeds by identifiying the two type 1 polars surrounding Re, then interpolating both with the value of Alpha,
+* last by interpolating the requested variable between the values measured on the two polars.
+*@param pFoil the pointer to the foil
+*@param Re the Reynolds number .
+*@param Alpha the angle of attack.
+*@param PlrVar the index of the variable to interpolate.
+*@param bOutRe true if Cl is outside the min or max Cl of the polar mesh.
+*@param bError if Re is outside the min or max Reynolds number of the polar mesh.
+*@return the interpolated value.
+*/
+double PolarMesh::getPlrPointFromAlpha(Foil const *pFoil, double Re, double Alpha, int PlrVar, bool &bOutRe, bool &bError) const
+{
+    double Var=0, Var1=0, Var2=0;
+
+    bOutRe = false;
+    bError = false;
+
+    FoilMesh const *pFoilMesh = foilMesh(pFoil);
+    if(!pFoilMesh)
+    {
+        bOutRe = true;
+        bError = true;
+        return 0.000;
+    }
+    QVector<MeshPolar> const &polars = pFoilMesh->type1Polars;
+
+    //if Re is less than that of the first polar, use this one
+    if(polars.size() && Re<polars.front().Re)
+    {
+        bOutRe = true;
+        Polar *pPolar = polars.front().pPolar;
+        QVector<double> const &pX = pPolar->getPlrVariable(PlrVar);
+        if(Alpha<pPolar->m_Alpha.front())     return pX.front();
+        else if(Alpha>pPolar->m_Alpha.back()) return pX.back();
+        if(interpolateSorted(pPolar->m_Alpha, pX, Alpha, Var)) return Var;
+    }
+
+    // if not find the two polars with Reynolds number surrounding Re, and which enclose Alpha
+    Polar * pPolar1 = nullptr;
+    Polar * pPolar2 = nullptr;
+    int k = int(std::upper_bound(polars.constBegin(), polars.constEnd(), Re,
+                                 [](double value, MeshPolar const &p) {return value<p.Re;}) - polars.constBegin());
+    for(int i=k-1; i>=0; i--)
+    {
+        if(polars.at(i).aMin<=Alpha && Alpha<=polars.at(i).aMax)
+        {
+            pPolar1 = polars.at(i).pPolar;
+            break;
+        }
+    }
+    for(int i=k; i<polars.size(); i++)
+    {
+        if(polars.at(i).aMin<=Alpha && Alpha<=polars.at(i).aMax)
+        {
+            pPolar2 = polars.at(i).pPolar;
+            break;
+        }
+    }
+
+    if (!pPolar2)
+    {
+        //then Re is greater than that of any polar
+        // so use last polar and interpolate alphas on this polar
+        bOutRe = true;
+        if(!pPolar1)
+        {
+            bError = true;
+            return 0.000;
+        }
+
+        QVector<double> const &pX1 = pPolar1->getPlrVariable(PlrVar);
+        if(interpolateSorted(pPolar1->m_Alpha, pX1, Alpha, Var)) return Var;
+        //Out in Re, out in alpha...
+        return pX1.back();
+    }
+
+    if(!pPolar1)
+    {
+        bOutRe = true;
+        bError = true;
+        return 0.000;
+    }
+
+    // Re is between that of polars 1 and 2, which both enclose Alpha
+    // so interpolate alphas for each
+    interpolateSorted(pPolar1->m_Alpha, pPolar1->getPlrVariable(PlrVar), Alpha, Var1);
+    interpolateSorted(pPolar2->m_Alpha, pPolar2->getPlrVariable(PlrVar), Alpha, Var2);
+
+    // then interpolate Variable
+    double v = (Re - pPolar1->Reynolds()) / (pPolar2->Reynolds() - pPolar1->Reynolds());
+    return Var1 + v * (Var2-Var1);
+}
+
+
+/**
+* Returns the zero-lift angle of the foil, interpolated between the two polars which enclose the Reynolds number.
+*@param pFoil the pointer to the foil
+*@param Re the Reynolds number
+*@return the interpolated zero-lift angle, or 0 if the Reynolds number is outside the polar mesh.
+*/
+double PolarMesh::getZeroLiftAngle(Foil const *pFoil, double Re) const
+{
+    FoilMesh const *pFoilMesh = foilMesh(pFoil);
+    if(!pFoilMesh) return 0.0;
+
+    MeshPolar const *pPolar1 = nullptr;
+    MeshPolar const *pPolar2 = nullptr;
+    QVector<MeshPolar> const &polars = pFoilMesh->allPolars;
+    for (int i=0; i<polars.size(); i++)
+    {
+        if(polars.at(i).Re < Re) pPolar1 = &polars.at(i);
+    }
+    for (int i=0; i<polars.size(); i++)
+    {
+        if(polars.at(i).Re > Re)
+        {
+            pPolar2 = &polars.at(i);
+            break;
+        }
+    }
+    if(!pPolar1 || !pPolar2) return 0.0;
+
+    double a01 = pPolar1->ZeroLiftAngle;
+    double a02 = pPolar2->ZeroLiftAngle;
+    return a01 + (a02-a01) * (Re-pPolar1->Re)/(pPolar2->Re-pPolar1->Re);
+}
+
+
+/**
+* Returns the coefficients of the linearized curve Cl=f(aoa) of the foil,
+* interpolated between the two polars which enclose the Reynolds number.
+*@param pFoil the pointer to the foil
+*@param Re the Reynolds number
+*@param Alpha0 the zero-lift angle; if the interpolation fails, returns Alpha0 = 0
+*@param Slope the slope of the lift curve; if the interpolation fails, returns Slope = 2 PI
+*/
+void PolarMesh::getLinearizedPolar(Foil const *pFoil, double Re, double &Alpha0, double &Slope) const
+{
+    Alpha0 = 0.0;
+    Slope  = 2.0 * PI *PI/180.0;
+
+    FoilMesh const *pFoilMesh = foilMesh(pFoil);
+    if(!pFoilMesh) return;
+
+    MeshPolar const *pPolar1 = nullptr;
+    MeshPolar const *pPolar2 = nullptr;
+    QVector<MeshPolar> const &polars = pFoilMesh->allPolars;
+    for (int i=0; i<polars.size(); i++)
+    {
+        if(polars.at(i).Re < Re) pPolar1 = &polars.at(i);
+    }
+    for (int i=0; i<polars.size(); i++)
+    {
+        if(polars.at(i).Re > Re)
+        {
+            pPolar2 = &polars.at(i);
+            break;
+        }
+    }
+    if(!pPolar1 || !pPolar2) return;
+
+    Alpha0 = pPolar1->Alpha0 + (pPolar2->Alpha0-pPolar1->Alpha0) * (Re-pPolar1->Re)/(pPolar2->Re-pPolar1->Re);
+    Slope  = pPolar1->Slope  + (pPolar2->Slope -pPolar1->Slope)  * (Re-pPolar1->Re)/(pPolar2->Re-pPolar1->Re);
+}
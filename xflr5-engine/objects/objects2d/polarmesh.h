@@ -0,0 +1,89 @@
+/****************************************************************************
+
+    PolarMesh Class
+    Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+/**
+ * @file
+ * This file implements the index of the polar mesh used to interpolate the viscous properties of the foils
+ *
+ */
+
+
+#ifndef POLARMESH_H
+#define POLARMESH_H
+
+#include <QVector>
+#include <QHash>
+#include <QString>
+
+#include <xflr5-engine_global.h>
+
+class Foil;
+class Polar;
+
+/**
+*@brief
+* An index of the polars of each foil, built once at the start of an analysis.
+*
+    The interpolation of the foils' properties on the polar mesh is requested for each span station
+    at each iteration of the LLT. Without the index, each request scans the whole array of polars
+    and compares the foil names. With the index, the polars of a foil are found with a single hash lookup.
+    The type 1 polars are sorted by Reynolds number and the two polars which enclose a Reynolds number
+    are found by binary search; the aoa interval is also found by binary search in the polar's data arrays,
+    which are contiguous and sorted by aoa.
+    The values which depend only on the polar, i.e. the range of aoa, the zero-lift angle and the linearized
+    lift curve, are calculated once when the index is built.
+
+    The index holds pointers to the polars, which should not be modified or deleted while the index is in use.
+*/
+class XFLR5ENGINELIBSHARED_EXPORT PolarMesh
+{
+public:
+    void build(QVector<Polar*> const *poaPolar);
+    void clear() {m_FoilMesh.clear();}
+
+    double getPlrPointFromAlpha(Foil const *pFoil, double Re, double Alpha, int PlrVar, bool &bOutRe, bool &bError) const;
+    double getZeroLiftAngle(Foil const *pFoil, double Re) const;
+    void getLinearizedPolar(Foil const *pFoil, double Re, double &Alpha0, double &Slope) const;
+
+private:
+    /** @struct the data of a polar which does not change during the analysis */
+    struct MeshPolar
+    {
+        Polar *pPolar;
+        double Re;              /**< the polar's Reynolds number */
+        double aMin, aMax;      /**< the range of aoa stored in the polar */
+        double ZeroLiftAngle;   /**< the aoa such that Cl=0, or 0 if the polar does not cross Cl=0 */
+        double Alpha0, Slope;   /**< the least-squares linearization of the curve Cl=f(aoa) */
+    };
+
+    /** @struct the polars of a foil */
+    struct FoilMesh
+    {
+        QVector<MeshPolar> allPolars;   /**< all the polars of the foil, in the order of the array of polars */
+        QVector<MeshPolar> type1Polars; /**< the type 1 polars holding at least one point, sorted by crescending Re */
+    };
+
+    FoilMesh const *foilMesh(Foil const *pFoil) const;
+
+    QHash<QString, FoilMesh> m_FoilMesh; /**< the polars, indexed by the name of their foil */
+};
+
+#endif // POLARMESH_H
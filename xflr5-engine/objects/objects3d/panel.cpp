@@ -29,7 +29,6 @@ double Panel::s_CoreSize = 0.000001;
 double Panel::s_VortexPos = 0.25;
 double Panel::s_CtrlPos   = 0.75;
 
-Vector3d *Panel::s_pNode, *Panel::s_pWakeNode;
 
 //temporary variables
 
@@ -81,11 +80,12 @@ void Panel::reset()
 
 /**
 * Defines the vortex and panel geometrical properties necessary for the VLM and panel calculations.
+*@param pNode a pointer to the array of nodes in which the panel's corners are indexed
 */
-void Panel::setPanelFrame()
+void Panel::setPanelFrame(Vector3d const *pNode)
 {
     //set the boundary conditions from existing nodes
-    setPanelFrame(s_pNode[m_iLA], s_pNode[m_iLB], s_pNode[m_iTA], s_pNode[m_iTB]);
+    setPanelFrame(pNode[m_iLA], pNode[m_iLB], pNode[m_iTA], pNode[m_iTB]);
 }
 
 
@@ -329,22 +329,23 @@ Vector3d Panel::localToGlobal(Vector3d const &V)
 /**
 * Finds the intersection point of a ray with the panel. 
 * The ray is defined by a point and a direction vector.
+*@param pNode a pointer to the array of nodes in which the panel's corners are indexed
 *@param A the ray's origin
 *@param U the ray's direction
 *@param I the intersection point
 *@param dist the distance of A to the panel in the direction of the panel's normal
 */
-bool Panel::intersect(Vector3d const &A, Vector3d const &U, Vector3d &I, double &dist)
+bool Panel::intersect(Vector3d const *pNode, Vector3d const &A, Vector3d const &U, Vector3d &I, double &dist)
 {
     Vector3d ILA, ILB, ITA, ITB;
     Vector3d T, V, W, P;
     bool b1, b2, b3, b4;
     double r,s;
 
-    ILA.copy(s_pNode[m_iLA]);
-    ITA.copy(s_pNode[m_iTA]);
-    ILB.copy(s_pNode[m_iLB]);
-    ITB.copy(s_pNode[m_iTB]);
+    ILA.copy(pNode[m_iLA]);
+    ITA.copy(pNode[m_iTA]);
+    ILB.copy(pNode[m_iLB]);
+    ITB.copy(pNode[m_iTB]);
 
     r = (CollPt.x-A.x)*Normal.x + (CollPt.y-A.y)*Normal.y + (CollPt.z-A.z)*Normal.z ;
     s = U.x*Normal.x + U.y*Normal.y + U.z*Normal.z;
@@ -418,11 +419,12 @@ bool Panel::intersect(Vector3d const &A, Vector3d const &U, Vector3d &I, double
 
 /**
 *Returns the panel's width, measured at the leading edge 
+*@param pNode a pointer to the array of nodes in which the panel's corners are indexed
 */
-double Panel::width()
+double Panel::width(Vector3d const *pNode)
 {
-    return sqrt( (s_pNode[m_iLB].y - s_pNode[m_iLA].y)*(s_pNode[m_iLB].y - s_pNode[m_iLA].y)
-                 +(s_pNode[m_iLB].z - s_pNode[m_iLA].z)*(s_pNode[m_iLB].z - s_pNode[m_iLA].z));
+    return sqrt( (pNode[m_iLB].y - pNode[m_iLA].y)*(pNode[m_iLB].y - pNode[m_iLA].y)
+                 +(pNode[m_iLB].z - pNode[m_iLA].z)*(pNode[m_iLB].z - pNode[m_iLA].z));
 }
 
 
@@ -492,18 +494,18 @@ void Panel::rotateBC(Vector3d const &HA, Quaternion &Qt)
 * Vectorial operations are written inline to save computing times -->longer code, but 4x more efficient.
 *
 *@param C the point where the influence is to be evaluated
-*@param pPanel a pointer to the Panel with the doublet strength
+*@param pNode a pointer to the array of nodes in which the panel's corners are indexed
 *@param V the perturbation velocity at point C
 *@param phi the potential at point C
 */
-void Panel::sourceNASA4023(Vector3d const &C,  Vector3d &V, double &phi)
+void Panel::sourceNASA4023(Vector3d const &C, Vector3d const *pNode, Vector3d &V, double &phi)
 {
     int i;
     double RNUM, DNOM, pjk, CJKi;
     double PN, A, B, PA, PB, SM, SL, AM, AL, Al;
     double side, sign, S, GL;
     Vector3d PJK, a, b, s, T1, T2, h;
-    Vector3d *m_pR[5];
+    Vector3d const *m_pR[5];
     //we use a default core size, unless the user has specified one
     double CoreSize = 0.00000;
     if(qAbs(s_CoreSize)>PRECISION) CoreSize = s_CoreSize;
@@ -530,19 +532,19 @@ void Panel::sourceNASA4023(Vector3d const &C,  Vector3d &V, double &phi)
 
     if(m_Pos>=MIDSURFACE)
     {
-        m_pR[0] = s_pNode + m_iLA;
-        m_pR[1] = s_pNode + m_iTA;
-        m_pR[2] = s_pNode + m_iTB;
-        m_pR[3] = s_pNode + m_iLB;
-        m_pR[4] = s_pNode + m_iLA;
+        m_pR[0] = pNode + m_iLA;
+        m_pR[1] = pNode + m_iTA;
+        m_pR[2] = pNode + m_iTB;
+        m_pR[3] = pNode + m_iLB;
+        m_pR[4] = pNode + m_iLA;
     }
     else
     {
-        m_pR[0] = s_pNode + m_iLB;
-        m_pR[1] = s_pNode + m_iTB;
-        m_pR[2] = s_pNode + m_iTA;
-        m_pR[3] = s_pNode + m_iLA;
-        m_pR[4] = s_pNode + m_iLB;
+        m_pR[0] = pNode + m_iLB;
+        m_pR[1] = pNode + m_iTB;
+        m_pR[2] = pNode + m_iTA;
+        m_pR[3] = pNode + m_iLA;
+        m_pR[4] = pNode + m_iLB;
     }
 
     for (i=0; i<4; i++)
@@ -644,15 +646,14 @@ void Panel::sourceNASA4023(Vector3d const &C,  Vector3d &V, double &phi)
  * Vectorial operations are written inline to save computing times -->longer code, but 4x more efficient.
  *
  * @param C the point where the influence is to be evaluated
- * @param pPanel a pointer to the Panel with the doublet strength
+ * @param pNode a pointer to the array of nodes in which the panel's corners are indexed, i.e. the wake nodes for a wake panel
  * @param V the perturbation velocity at point C
  * @param phi the potential at point C
- * @param bWake true if the panel is a wake panel, false if it is a surface panel
  */
-void Panel::doubletNASA4023(Vector3d const &C, Vector3d &V, double &phi, bool bWake)
+void Panel::doubletNASA4023(Vector3d const &C, Vector3d const *pNode, Vector3d &V, double &phi)
 {
     int i;
-    Vector3d *m_pR[5];
+    Vector3d const *m_pR[5];
     Vector3d PJK, a, b, s, T1, h;
     double RNUM, DNOM, pjk, CJKi;
     double PN, A, B, PA, PB, SM, SL, AM, AL, Al;
@@ -663,10 +664,6 @@ void Panel::doubletNASA4023(Vector3d const &C, Vector3d &V, double &phi, bool bW
     double CoreSize = 0.00000;
     if(qAbs(s_CoreSize)>PRECISION) CoreSize = s_CoreSize;
 
-    Vector3d *pNode;
-    if(!bWake) pNode = s_pNode;
-    else       pNode = s_pWakeNode;
-
     phi = 0.0;
 
     V.x=0.0; V.y=0.0; V.z=0.0;
@@ -795,8 +792,10 @@ void Panel::doubletNASA4023(Vector3d const &C, Vector3d &V, double &phi, bool bW
     }
 }
 
-/** output the panel's properties - debug only */
-void Panel::printPanel()
+/** output the panel's properties - debug only
+*@param pNode a pointer to the array of nodes in which the panel's corners are indexed
+*/
+void Panel::printPanel(Vector3d const *pNode)
 {
     qDebug("Panel %d:", m_iElement);
     qDebug("  neighbour panels:  PU=%3d    PD=%3d   PL=%3d   PR=%3d", m_iPU, m_iPD, m_iPL, m_iPR);
@@ -804,11 +803,11 @@ void Panel::printPanel()
     qDebug("  isLeading=%1d    isTrailing=%1d", m_bIsLeading, m_bIsTrailing);
     qDebug("  isInSymPlane=%1d    isLeftWingPanel=%d    isWakePanel=%d", m_bIsInSymPlane, m_bIsLeftPanel, m_bIsWakePanel);
     qDebug("  Area=%13.5g  Size=%13.5g", Area, Size);
-    setPanelFrame(s_pNode[m_iLA], s_pNode[m_iLB], s_pNode[m_iTA], s_pNode[m_iTB]);
-    s_pNode[m_iLA].displayCoords("  LA");
-    s_pNode[m_iLB].displayCoords("  LB");
-    s_pNode[m_iTA].displayCoords("  TA");
-    s_pNode[m_iTB].displayCoords("  TB");
+    setPanelFrame(pNode[m_iLA], pNode[m_iLB], pNode[m_iTA], pNode[m_iTB]);
+    pNode[m_iLA].displayCoords("  LA");
+    pNode[m_iLB].displayCoords("  LB");
+    pNode[m_iTA].displayCoords("  TA");
+    pNode[m_iTB].displayCoords("  TB");
     qDebug("  Normal: %13.7f  %13.7f  %13.7f", Normal.x, Normal.y, Normal.z);
     qDebug("  CollPt: %13.7f  %13.7f  %13.7f", CollPt.x, CollPt.y, CollPt.z);
     qDebug("  CtrlPt: %13.7f  %13.7f  %13.7f", CtrlPt.x, CtrlPt.y, CtrlPt.z);
@@ -67,6 +67,7 @@ class XFLR5ENGINELIBSHARED_EXPORT Panel
     friend class Body;
     friend class PlaneAnalysisTask;
     friend class PanelAnalysis;
+    friend class PanelTreecode;
     friend class PanelAnalysisDlg;
     friend class GL3dBodyDlg;
     friend class GL3dWingDlg;
@@ -76,21 +77,21 @@ public:
     Panel();
 
     void VLMCmn(Vector3d const &C, Vector3d &VTest, bool const &bAll);
-    void doubletNASA4023(Vector3d const &C, Vector3d &VTest, double &phi, bool bWake);
-    void sourceNASA4023(Vector3d const &C, Vector3d &VTest, double &phi);
+    void doubletNASA4023(Vector3d const &C, Vector3d const *pNode, Vector3d &VTest, double &phi);
+    void sourceNASA4023(Vector3d const &C, Vector3d const *pNode, Vector3d &VTest, double &phi);
 
     void rotateBC(Vector3d const &HA, Quaternion & Qt);
     void reset();
-    void setPanelFrame();
+    void setPanelFrame(Vector3d const *pNode);
     void setPanelFrame(Vector3d const &LA, Vector3d const &LB, Vector3d const &TA, Vector3d const &TB);
-    bool intersect(Vector3d const &A, Vector3d const &U, Vector3d &I, double &dist);
+    bool intersect(Vector3d const *pNode, Vector3d const &A, Vector3d const &U, Vector3d &I, double &dist);
     bool invert33(double *l);
     void globalToLocal(Vector3d const &V, Vector3d &VLocal);
     Vector3d globalToLocal(Vector3d const &VTest);
     Vector3d globalToLocal(double const &Vx, double const &Vy, double const &Vz);
     Vector3d localToGlobal(Vector3d const &VTest);
 
-    double width();
+    double width(Vector3d const *pNode);
     double area() const {return Area;}
     Vector3d ctrlPt() const {return CtrlPt;}
     Vector3d collPt() const {return CollPt;}
@@ -102,7 +103,7 @@ public:
     bool isSideSurface() const {return m_Pos==SIDESURFACE;}
     bool isBodySurface() const {return m_Pos==BODYSURFACE;}
 
-    void printPanel();
+    void printPanel(Vector3d const *pNode);
 
     static void setCoreSize(double CoreSize) { s_CoreSize=CoreSize;    }
     static double coreSize() { return s_CoreSize; }
@@ -138,9 +139,6 @@ protected:
                                   the evaluation of the source and doublet influent at a distant point */
     double lij[9];           /**< The 3x3 matrix used to transform local coordinates in absolute coordinates */
 
-    static Vector3d *s_pNode;       /**< A static pointer to the global array of panel nodes */
-    static Vector3d *s_pWakeNode;   /**< A static pointer to the global array of wake panel nodes */
-
     static double s_VortexPos; /**< Defines the relative position of the bound vortex in the streamwise direction. Usually the vortex is positioned at the panel's quarter chord i.e. s_VortexPos=0.25 */
     static double s_CtrlPos;   /**< Defines the relative position of the panel's control point in VLM. Usually the control point is positioned at the panel's 3/4 chord : s_VortexPos=0.75 */
 
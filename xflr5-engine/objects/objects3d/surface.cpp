@@ -28,9 +28,6 @@
 #include <objects/objects3d/vector3d.h>
 #include "wingsection.h"
 
-Vector3d *Surface::s_pNode;
-Panel *Surface::s_pPanel;
-
 
 /**
  * The public constructor
@@ -225,6 +222,55 @@ void Surface::copy(Surface *pSurface)
 }
 
 
+/**
+ * Returns true if the panels built on this Surface and on the other Surface have the same number, order and connections,
+ * i.e. if the panels of one can be built in place of the panels of the other.
+ * @param surface the Surface to compare with
+ */
+bool Surface::hasSameTopology(Surface const &surface) const
+{
+    return m_NXPanels      == surface.m_NXPanels      &&
+           m_NYPanels      == surface.m_NYPanels      &&
+           m_NXFlap        == surface.m_NXFlap        &&
+           m_bIsTipLeft    == surface.m_bIsTipLeft    &&
+           m_bIsTipRight   == surface.m_bIsTipRight   &&
+           m_bIsLeftSurf   == surface.m_bIsLeftSurf   &&
+           m_bIsInSymPlane == surface.m_bIsInSymPlane &&
+           m_bJoinRight    == surface.m_bJoinRight    &&
+           SideA.size()    == surface.SideA.size()    &&
+           SideA_T.size()  == surface.SideA_T.size();
+}
+
+
+/**
+ * Returns true if the panels built on this Surface and on the other Surface are identical.
+ * The panels' corner points are interpolated by getPanel() between the side points, so that the comparison
+ * is made on the side points and on the spanwise distribution, rather than on the wing's sections.
+ * The side points should have been set on both Surfaces.
+ * @param surface the Surface to compare with
+ */
+bool Surface::hasSamePanels(Surface const &surface) const
+{
+    if(!hasSameTopology(surface)) return false;
+    if(m_YDistType!=surface.m_YDistType) return false;
+
+    // exact comparisons, since any change of the geometry should lead to new panels
+    auto isSameArray = [](QVector<Vector3d> const &a1, QVector<Vector3d> const &a2)
+    {
+        if(a1.size()!=a2.size()) return false;
+        for(int i=0; i<a1.size(); i++)
+        {
+            if(a1.at(i).x!=a2.at(i).x || a1.at(i).y!=a2.at(i).y || a1.at(i).z!=a2.at(i).z) return false;
+        }
+        return true;
+    };
+
+    return isSameArray(SideA,   surface.SideA)   && isSameArray(SideB,   surface.SideB)   &&
+           isSameArray(SideA_T, surface.SideA_T) && isSameArray(SideB_T, surface.SideB_T) &&
+           isSameArray(SideA_B, surface.SideA_B) && isSameArray(SideB_B, surface.SideB_B);
+}
+
+
 /**
  * Returns the quarter-chord point of a specified strip
  * @param k the 0-based index of the strip for which the quarter-chord point shall be returned.
@@ -828,18 +874,19 @@ bool Surface::isFlapPanel(Panel *pPanel) const
 
 /**
  * Returns true if the specified node is located on the T.E. flap
+ * @param pPanel a pointer to the array of panels in which the flap panels are indexed
  * @param nNode the index of the node
  * @return true if the node is located on the T.E. flap
  */
-bool Surface::isFlapNode(int nNode) const
+bool Surface::isFlapNode(Panel const *pPanel, int nNode) const
 {
     int pp;
     for(pp=0; pp<m_nFlapPanels; pp++)
     {
-        if(nNode==s_pPanel[m_FlapPanel[pp]].m_iLA) return true;
-        if(nNode==s_pPanel[m_FlapPanel[pp]].m_iLB) return true;
-        if(nNode==s_pPanel[m_FlapPanel[pp]].m_iTA) return true;
-        if(nNode==s_pPanel[m_FlapPanel[pp]].m_iTB) return true;
+        if(nNode==pPanel[m_FlapPanel[pp]].m_iLA) return true;
+        if(nNode==pPanel[m_FlapPanel[pp]].m_iLB) return true;
+        if(nNode==pPanel[m_FlapPanel[pp]].m_iTA) return true;
+        if(nNode==pPanel[m_FlapPanel[pp]].m_iTB) return true;
     }
     return false;
 }
@@ -863,9 +910,11 @@ void Surface::resetFlap()
 /**
  * Rotates a flap panels around its hinge axis.
  * @param Angle the rotation angle in degrees
+ * @param pPanel a pointer to the array of panels in which the flap panels are indexed
+ * @param pNode a pointer to the array of nodes in which the flap nodes are indexed
  * @return false if the left and right Foil objects do not have an identical default flap angle, true otherwise.
  */
-bool Surface::rotateFlap(double Angle)
+bool Surface::rotateFlap(double Angle, Panel *pPanel, Vector3d *pNode)
 {
     //The average angle between the two tip foil is cancelled
     //Instead, the Panels are rotated by Angle around the hinge point and hinge vector
@@ -893,34 +942,34 @@ bool Surface::rotateFlap(double Angle)
 
         for (k=0; k<m_nFlapNodes; k++)
         {
-            R.x = s_pNode[m_FlapNode[k]].x - m_HingePoint.x;
-            R.y = s_pNode[m_FlapNode[k]].y - m_HingePoint.y;
-            R.z = s_pNode[m_FlapNode[k]].z - m_HingePoint.z;
+            R.x = pNode[m_FlapNode[k]].x - m_HingePoint.x;
+            R.y = pNode[m_FlapNode[k]].y - m_HingePoint.y;
+            R.z = pNode[m_FlapNode[k]].z - m_HingePoint.z;
             Quat.Conjugate(R,S);
 
-            s_pNode[m_FlapNode[k]].x = S.x + m_HingePoint.x;
-            s_pNode[m_FlapNode[k]].y = S.y + m_HingePoint.y;
-            s_pNode[m_FlapNode[k]].z = S.z + m_HingePoint.z;
+            pNode[m_FlapNode[k]].x = S.x + m_HingePoint.x;
+            pNode[m_FlapNode[k]].y = S.y + m_HingePoint.y;
+            pNode[m_FlapNode[k]].z = S.z + m_HingePoint.z;
         }
 
         for(l=0; l<m_nFlapPanels; l++)
         {
             k = m_FlapPanel[l];
-            if(s_pPanel[k].m_Pos==BOTSURFACE)
+            if(pPanel[k].m_Pos==BOTSURFACE)
             {
-                s_pPanel[k].setPanelFrame(
-                            s_pNode[s_pPanel[k].m_iLB],
-                        s_pNode[s_pPanel[k].m_iLA],
-                        s_pNode[s_pPanel[k].m_iTB],
-                        s_pNode[s_pPanel[k].m_iTA]);
+                pPanel[k].setPanelFrame(
+                            pNode[pPanel[k].m_iLB],
+                        pNode[pPanel[k].m_iLA],
+                        pNode[pPanel[k].m_iTB],
+                        pNode[pPanel[k].m_iTA]);
             }
             else
             {
-                s_pPanel[k].setPanelFrame(
-                            s_pNode[s_pPanel[k].m_iLA],
-                        s_pNode[s_pPanel[k].m_iLB],
-                        s_pNode[s_pPanel[k].m_iTA],
-                        s_pNode[s_pPanel[k].m_iTB]);
+                pPanel[k].setPanelFrame(
+                            pNode[pPanel[k].m_iLA],
+                        pNode[pPanel[k].m_iLB],
+                        pNode[pPanel[k].m_iTA],
+                        pNode[pPanel[k].m_iTB]);
             }
         }
     }
@@ -1358,13 +1407,6 @@ double Surface::spanLength() const
 }
 
 
-void Surface::setPanelPointers(Panel *pPanel, Vector3d *pNode)
-{
-    s_pPanel = pPanel;
-    s_pNode = pNode;
-}
-
-
 
 
 
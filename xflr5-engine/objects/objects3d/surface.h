@@ -147,10 +147,13 @@ public:
     bool isTipRight()   const {return m_bIsTipRight;}
     bool isInSymPlane() const {return m_bIsInSymPlane;}
 
+    bool hasSameTopology(Surface const &surface) const;
+    bool hasSamePanels(Surface const &surface) const;
+
     bool isFlapPanel(Panel *pPanel) const;
     bool isFlapPanel(int p) const;
-    bool isFlapNode(int nNode) const;
-    bool rotateFlap(double Angle);
+    bool isFlapNode(Panel const *pPanel, int nNode) const;
+    bool rotateFlap(double Angle, Panel *pPanel, Vector3d *pNode);
 
     double twist(int k) const;
     double chord(int k) const;
@@ -175,8 +178,6 @@ public:
     Foil *foilA() {return m_pFoilA;}
     Foil *foilB() {return m_pFoilB;}
 
-    static void setPanelPointers(Panel *pPanel, Vector3d *pNode);
-
     QVector<Vector3d> SideA;      /**< the array of panel points on the left foil's mid-line*/
     QVector<Vector3d> SideB;      /**< the array of panel points on the right foil's mid-line*/
 
@@ -196,8 +197,6 @@ private :
     QVector<Vector3d> SideA_B;    /**< the array of panel points on the left foil's bottom-line*/
     QVector<Vector3d> SideB_B;    /**< the array of panel points on the right foil's bottom-line*/
     Vector3d VTemp;
-    static Panel *s_pPanel;    /**< a pointer to the array of this Surface's panels, This array is a sub-array of the total array.*/
-    static Vector3d *s_pNode;   /**< a pointer to the array of this panel nodes.*/
 
     bool m_bIsInSymPlane;      /**< true if the Surface is positioned in the symetry xz plane defined by y=0. Case of a single fin. */
     bool m_bTEFlap;            /**< true if the Surface has a flap on the trailing edge */
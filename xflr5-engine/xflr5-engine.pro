@@ -16,6 +16,7 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 QT       -= gui
+QT       += concurrent
 
 TARGET = xflr5-engine
 TEMPLATE = lib
@@ -28,12 +29,16 @@ SOURCES += \
     analysis3d/analysis3d_globals.cpp \
     analysis3d/matrix.cpp \
     analysis3d/plane_analysis/lltanalysis.cpp \
+    analysis3d/plane_analysis/matrixcache.cpp \
     analysis3d/plane_analysis/panelanalysis.cpp \
+    analysis3d/plane_analysis/paneltreecode.cpp \
     analysis3d/plane_analysis/planeanalysistask.cpp \
+    analysis3d/plane_analysis/vortexarray.cpp \
     objects/objects2d/blxfoil.cpp \
     objects/objects2d/foil.cpp \
     objects/objects2d/opppoint.cpp \
     objects/objects2d/polar.cpp \
+    objects/objects2d/polarmesh.cpp \
     objects/objects2d/spline.cpp \
     objects/objects3d/body.cpp \
     objects/objects3d/frame.cpp \
@@ -56,14 +61,18 @@ HEADERS += \
     analysis3d/analysis3d_params.h \
     analysis3d/matrix.h \
     analysis3d/plane_analysis/lltanalysis.h \
+    analysis3d/plane_analysis/matrixcache.h \
     analysis3d/plane_analysis/panelanalysis.h \
+    analysis3d/plane_analysis/paneltreecode.h \
     analysis3d/plane_analysis/planeanalysistask.h \
     analysis3d/plane_analysis/planetaskevent.h \
+    analysis3d/plane_analysis/vortexarray.h \
     objects/objectcolor.h \
     objects/objects2d/blxfoil.h \
     objects/objects2d/foil.h \
     objects/objects2d/oppoint.h \
     objects/objects2d/polar.h \
+    objects/objects2d/polarmesh.h \
     objects/objects2d/spline.h \
     objects/objects3d/body.h \
     objects/objects3d/frame.h \
@@ -1524,6 +1524,10 @@ void MainFrame::createMiarexActions()
     m_pAadvancedSettings->setStatusTip(tr("Define the settings for LLT, VLM and Panel analysis"));
     connect(m_pAadvancedSettings, SIGNAL(triggered()), m_pMiarex, SLOT(onAdvancedSettings()));
 
+    m_pBatchPlaneAnalysisAct = new QAction(tr("Multi-threaded Batch Analysis"), this);
+    m_pBatchPlaneAnalysisAct->setStatusTip(tr("Analyzes several polars concurrently using the available computer CPU cores"));
+    connect(m_pBatchPlaneAnalysisAct, SIGNAL(triggered()), m_pMiarex, SLOT(onBatchAnalysis()));
+
     m_pShowPolarProps = new QAction(tr("Properties"), this);
     m_pShowPolarProps->setStatusTip(tr("Show the properties of the currently selected polar"));
     m_pShowPolarProps->setShortcut(QKeySequence(Qt::ALT + Qt::Key_Return));
@@ -1675,6 +1679,8 @@ void MainFrame::createMiarexMenus()
         m_pMiarexAnalysisMenu->addAction(m_pDefineStabPolar);
         m_pMiarexAnalysisMenu->addAction(m_pImportAnalysisFromXml);
         m_pMiarexAnalysisMenu->addSeparator();
+        m_pMiarexAnalysisMenu->addAction(m_pBatchPlaneAnalysisAct);
+        m_pMiarexAnalysisMenu->addSeparator();
         m_pMiarexAnalysisMenu->addAction(m_pViewLogFile);
         m_pMiarexAnalysisMenu->addAction(m_pAadvancedSettings);
     }
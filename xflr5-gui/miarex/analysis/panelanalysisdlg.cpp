@@ -105,10 +105,9 @@ void PanelAnalysisDlg::keyPressEvent(QKeyEvent *event)
 /** The user has requested to cancel the on-going analysis*/
 void PanelAnalysisDlg::onCancelAnalysis()
 {
-    PanelAnalysis::s_bCancel = true;
+    if(m_pTheTask) m_pTheTask->cancel();
     if(m_bIsFinished)
     {
-        PanelAnalysis::s_bCancel = false;
         //        QThreadPool::globalInstance()->waitForDone();
         done(1);
     }
@@ -284,7 +283,7 @@ void PanelAnalysisDlg::cleanUp()
 
     m_bIsFinished = true;
 
-    if (!PanelAnalysis::s_bCancel && !PanelAnalysis::s_bWarning)
+    if (!m_pTheTask->m_pthePanelAnalysis->isCancelled() && !PanelAnalysis::s_bWarning)
         strong = "\n"+tr("Panel Analysis completed successfully")+"\n";
     else if (PanelAnalysis::s_bWarning)
         strong = "\n"+tr("Panel Analysis completed ... Errors encountered")+"\n";
@@ -0,0 +1,698 @@
+/****************************************************************************
+
+    PlaneBatchDlg Class
+    Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QGroupBox>
+#include <QLabel>
+#include <QKeyEvent>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtDebug>
+
+#include "planebatchdlg.h"
+#include <analysis3d/plane_analysis/lltanalysis.h>
+#include <analysis3d/plane_analysis/panelanalysis.h>
+#include <analysis3d/plane_analysis/planetaskevent.h>
+#include <miarex/miarex.h>
+#include <miarex/objects3d.h>
+#include <misc/options/settings.h>
+#include <misc/text/intedit.h>
+#include <objects/objects3d/plane.h>
+#include <objects/objects3d/planeopp.h>
+#include <objects/objects3d/wing.h>
+#include <objects/objects3d/wpolar.h>
+#include <xdirect/objects2d.h>
+
+
+Miarex *PlaneBatchDlg::s_pMiarex = nullptr;
+bool PlaneBatchDlg::s_bCurrentPlane = true;
+QPoint PlaneBatchDlg::s_Position;
+int PlaneBatchDlg::s_nThreads = 1;
+
+
+/**
+ * The public contructor
+ */
+PlaneBatchDlg::PlaneBatchDlg(QWidget *pParent) : QDialog(pParent)
+{
+    setWindowTitle(tr("Multi-threaded batch analysis of the plane polars"));
+
+    m_pCurPlane = nullptr;
+
+    m_nJobStarted = m_nJobDone = m_nRunning = 0;
+
+    m_bCancel    = false;
+    m_bIsRunning = false;
+
+    setupLayout();
+
+    connect(m_pctrlClose,     SIGNAL(clicked()), this, SLOT(onClose()));
+    connect(m_pctrlAnalyze,   SIGNAL(clicked()), this, SLOT(onAnalyze()));
+    connect(m_pctrlCancelJob, SIGNAL(clicked()), this, SLOT(onCancelJob()));
+    connect(&m_Timer,         SIGNAL(timeout()), this, SLOT(onProgress()));
+}
+
+
+/**
+ * The jobs are either finished or cancelled when the dialog is destroyed, since the dialog cannot be closed while running.
+ */
+PlaneBatchDlg::~PlaneBatchDlg()
+{
+    m_Job.clear();
+}
+
+
+/**
+ * Sets up the GUI
+ */
+void PlaneBatchDlg::setupLayout()
+{
+    QVBoxLayout *pLeftSide = new QVBoxLayout;
+    {
+        QGroupBox *pPlaneBox = new QGroupBox(tr("Polar selection"));
+        {
+            QVBoxLayout *pPlaneLayout = new QVBoxLayout;
+            {
+                m_prbCurPlane  = new QRadioButton(tr("Polars of the current plane"));
+                m_prbAllPlanes = new QRadioButton(tr("Polars of all the planes"));
+                QLabel *pRangeLabel = new QLabel(tr("The analysis range of each polar is the one\n"
+                                                    "defined in the analysis settings for its type."));
+                pPlaneLayout->addWidget(m_prbCurPlane);
+                pPlaneLayout->addWidget(m_prbAllPlanes);
+                pPlaneLayout->addWidget(pRangeLabel);
+            }
+            pPlaneBox->setLayout(pPlaneLayout);
+        }
+
+        QHBoxLayout *pnThreadLayout = new QHBoxLayout;
+        {
+            QLabel *label1 = new QLabel(tr("Max. polars to analyze at a time:"));
+            int maxThreads = QThread::idealThreadCount();
+            m_pctrlMaxThreads = new IntEdit(std::min(s_nThreads, maxThreads));
+            QLabel *label2= new QLabel(QString("/%1").arg(maxThreads));
+            pnThreadLayout->addWidget(label1);
+            pnThreadLayout->addWidget(m_pctrlMaxThreads);
+            pnThreadLayout->addWidget(label2);
+            pnThreadLayout->addStretch();
+        }
+
+        QHBoxLayout *pCommandButtons = new QHBoxLayout;
+        {
+            m_pctrlClose     = new QPushButton(tr("Close"));
+            m_pctrlAnalyze   = new QPushButton(tr("Analyze"));
+            m_pctrlAnalyze->setAutoDefault(true);
+
+            pCommandButtons->addStretch(1);
+            pCommandButtons->addWidget(m_pctrlAnalyze);
+            pCommandButtons->addStretch(1);
+            pCommandButtons->addWidget(m_pctrlClose);
+            pCommandButtons->addStretch(1);
+        }
+        pLeftSide->addWidget(pPlaneBox);
+        pLeftSide->addLayout(pnThreadLayout);
+        pLeftSide->addStretch(1);
+        pLeftSide->addSpacing(20);
+        pLeftSide->addLayout(pCommandButtons);
+    }
+
+    QVBoxLayout *pRightSide = new QVBoxLayout;
+    {
+        m_pctrlJobList = new QListWidget;
+        m_pctrlJobList->setFont(Settings::s_TableFont);
+        QFontMetrics fm(Settings::s_TableFont);
+        m_pctrlJobList->setMinimumWidth(67*fm.averageCharWidth());
+
+        m_pctrlTextOutput = new QTextEdit;
+        m_pctrlTextOutput->setReadOnly(true);
+        m_pctrlTextOutput->setLineWrapMode(QTextEdit::NoWrap);
+        m_pctrlTextOutput->setWordWrapMode(QTextOption::NoWrap);
+        m_pctrlTextOutput->setFont(Settings::s_TableFont);
+
+        QHBoxLayout *pJobLayout = new QHBoxLayout;
+        {
+            m_pctrlCancelJob = new QPushButton(tr("Cancel the selected analysis"));
+            QPushButton *pClearBtn = new QPushButton(tr("Clear Output"));
+            connect(pClearBtn, SIGNAL(clicked()), m_pctrlTextOutput, SLOT(clear()));
+            pJobLayout->addWidget(m_pctrlCancelJob);
+            pJobLayout->addStretch(1);
+            pJobLayout->addWidget(pClearBtn);
+        }
+
+        pRightSide->addWidget(m_pctrlJobList,1);
+        pRightSide->addLayout(pJobLayout);
+        pRightSide->addWidget(m_pctrlTextOutput,1);
+    }
+
+    QHBoxLayout *pBoxesLayout = new QHBoxLayout;
+    {
+        pBoxesLayout->addLayout(pLeftSide);
+        pBoxesLayout->addLayout(pRightSide);
+    }
+
+    setLayout(pBoxesLayout);
+}
+
+
+/**
+ * Initializes the dialog's controls
+ * @param pCurPlane a pointer to the current plane
+ */
+void PlaneBatchDlg::initDialog(Plane *pCurPlane)
+{
+    m_pCurPlane = pCurPlane;
+
+    m_pctrlTextOutput->clear();
+    m_pctrlJobList->clear();
+
+    m_prbCurPlane->setEnabled(m_pCurPlane!=nullptr);
+    m_prbCurPlane->setChecked(s_bCurrentPlane && m_pCurPlane);
+    m_prbAllPlanes->setChecked(!s_bCurrentPlane || !m_pCurPlane);
+
+    m_pctrlCancelJob->setEnabled(false);
+    m_pctrlAnalyze->setFocus();
+}
+
+
+/**
+ * Overrides the keyPressEvent sent by Qt
+ */
+void PlaneBatchDlg::keyPressEvent(QKeyEvent *event)
+{
+    // Prevent Return Key from closing App
+    switch (event->key())
+    {
+        case Qt::Key_Return:
+        case Qt::Key_Enter:
+        {
+            if(m_pctrlClose->hasFocus())         onClose();
+            else if(m_pctrlAnalyze->hasFocus())  onAnalyze();
+            else                                 m_pctrlAnalyze->setFocus();
+            break;
+        }
+        case Qt::Key_Escape:
+        {
+            if(m_bIsRunning) cancelAll();
+            else             onClose(); // will close the dialog box
+            break;
+        }
+        default:
+            event->ignore();
+    }
+    event->accept();
+}
+
+
+/**
+ * Overrides the base class showEvent method. Moves the window to its former location.
+ * @param event the showEvent.
+ */
+void PlaneBatchDlg::showEvent(QShowEvent *event)
+{
+    move(s_Position);
+    event->accept();
+}
+
+
+/**
+ * Overrides the base class hideEvent method. Stores the window's current position.
+ * @param event the hideEvent.
+ */
+void PlaneBatchDlg::hideEvent(QHideEvent *event)
+{
+    s_Position = pos();
+    event->accept();
+}
+
+
+/**
+ * Overrides the base class reject() method, to prevent window closure when an analysis is running.
+ * If the analysis is running, cancels it and returns.
+ * If not, closes the window.
+ */
+void PlaneBatchDlg::reject()
+{
+    if(m_bIsRunning) cancelAll();
+    else             QDialog::reject();
+}
+
+
+/**
+ * The user has requested to quit the dialog box
+ */
+void PlaneBatchDlg::onClose()
+{
+    if(m_bIsRunning) return;
+    s_bCurrentPlane = m_prbCurPlane->isChecked();
+    s_nThreads = qMax(1, m_pctrlMaxThreads->value());
+    accept();
+}
+
+
+/**
+ * The user has clicked the Analyze button: launches the batch, or cancels it if it is running
+ */
+void PlaneBatchDlg::onAnalyze()
+{
+    if(m_bIsRunning)
+    {
+        cancelAll();
+        return;
+    }
+
+    s_bCurrentPlane = m_prbCurPlane->isChecked();
+    s_nThreads = qMax(1, m_pctrlMaxThreads->value());
+
+    createJobs();
+    if(!m_Job.size())
+    {
+        updateOutput(tr("No polar to analyze\n"));
+        return;
+    }
+
+    m_bCancel    = false;
+    m_bIsRunning = true;
+    m_nJobStarted = m_nJobDone = m_nRunning = 0;
+
+    m_pctrlClose->setEnabled(false);
+    m_pctrlCancelJob->setEnabled(true);
+    m_pctrlAnalyze->setText(tr("Cancel"));
+
+    startJobs();
+    m_Timer.start(200);
+
+    if(!m_nRunning) cleanUp(); // all the jobs have been skipped
+}
+
+
+/**
+ * Builds the queue of the jobs from the polars of the selected planes.
+ * The ranges are those of the analysis settings of Miarex.
+ */
+void PlaneBatchDlg::createJobs()
+{
+    QString strong;
+    m_Job.clear();
+    m_pctrlJobList->clear();
+
+    for(int ip=0; ip<Objects3d::planeCount(); ip++)
+    {
+        Plane *pPlane = Objects3d::planeAt(ip);
+        if(s_bCurrentPlane && pPlane!=m_pCurPlane) continue;
+
+        QString foilMessage;
+        bool bFoilsOK = checkFoils(pPlane, foilMessage);
+
+        for(int iw=0; iw<Objects3d::polarCount(); iw++)
+        {
+            WPolar *pWPolar = Objects3d::polarAt(iw);
+            if(pWPolar->planeName()!=pPlane->planeName()) continue;
+
+            PlaneAnalysisJob job;
+            job.analysis.pPlane  = pPlane;
+            job.analysis.pWPolar = pWPolar;
+            s_pMiarex->analysisRange(pWPolar, job.analysis.vMin, job.analysis.vMax, job.analysis.vInc);
+            job.pTask = nullptr;
+            job.status = PENDINGJOB;
+
+            if(!bFoilsOK)
+            {
+                job.status = SKIPPEDJOB;
+                updateOutput(pPlane->planeName()+" / "+pWPolar->polarName()+": "+foilMessage+"\n");
+            }
+            else if(!pWPolar->isLLTMethod() && !pWPolar->isQuadMethod())
+            {
+                job.status = SKIPPEDJOB;
+            }
+
+            m_Job.append(job);
+            m_pctrlJobList->addItem(pPlane->planeName()+" / "+pWPolar->polarName());
+            updateJobItem(m_Job.size()-1);
+        }
+    }
+
+    strong.sprintf("%d polars to analyze\n", m_Job.size());
+    updateOutput(strong);
+}
+
+
+/**
+ * Checks that the foils of the plane's wings are in the database
+ * @param pPlane a pointer to the plane to check
+ * @param strong the error message if a foil is missing
+ * @return true if all the foils have been found
+ */
+bool PlaneBatchDlg::checkFoils(Plane *pPlane, QString &strong)
+{
+    for(int iw=0; iw<MAXWINGS; iw++)
+    {
+        Wing *pWing = pPlane->wing(iw);
+        if(!pWing) continue;
+        for (int l=0; l<pWing->NWingSection(); l++)
+        {
+            if (!Objects2d::foil(pWing->rightFoil(l)) || !Objects2d::foil(pWing->leftFoil(l)))
+            {
+                strong = pWing->wingName() + ": "+tr("Could not find the wing's foils... skipping");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @return true if a job is running for this plane
+ */
+bool PlaneBatchDlg::isPlaneBusy(Plane const *pPlane) const
+{
+    for(int ij=0; ij<m_Job.size(); ij++)
+    {
+        if(m_Job.at(ij).status==RUNNINGJOB && m_Job.at(ij).analysis.pPlane==pPlane) return true;
+    }
+    return false;
+}
+
+
+/**
+ * Starts the pending jobs, in the order of the queue, until the max number of running jobs is reached.
+ * A job is held if its plane is being analyzed.
+ */
+void PlaneBatchDlg::startJobs()
+{
+    if(m_bCancel) return;
+
+    for(int ij=0; ij<m_Job.size() && m_nRunning<s_nThreads; ij++)
+    {
+        PlaneAnalysisJob const &job = m_Job.at(ij);
+        if(job.status!=PENDINGJOB) continue;
+        if(isPlaneBusy(job.analysis.pPlane)) continue;
+
+        if(!startJob(ij))
+        {
+            m_Job[ij].status = SKIPPEDJOB;
+            updateJobItem(ij);
+        }
+    }
+}
+
+
+/**
+ * Creates the task and the analysis objects of a job, and launches the task on the global thread pool.
+ * The geometry is prepared in the main thread, since it modifies the plane's wings.
+ * @param iJob the index of the job in the queue
+ * @return true if the job has been started
+ */
+bool PlaneBatchDlg::startJob(int iJob)
+{
+    PlaneAnalysisJob &job = m_Job[iJob];
+    Plane *pPlane   = job.analysis.pPlane;
+    WPolar *pWPolar = job.analysis.pWPolar;
+
+    LLTAnalysis *pLLTAnalysis = new LLTAnalysis;
+    pLLTAnalysis->m_poaPolar = Objects2d::pOAPolar();
+    PanelAnalysis *pPanelAnalysis = new PanelAnalysis;
+
+    PlaneAnalysisTask *pTask = new PlaneAnalysisTask;
+    pTask->setLLTAnalysis(*pLLTAnalysis);
+    pTask->setPanelAnalysis(*pPanelAnalysis);
+    pTask->setParent(this);
+
+    WPolar *pTaskWPolar = nullptr;
+    if(pWPolar->isLLTMethod())
+    {
+        pTaskWPolar = pTask->setLLTObjects(pPlane, pWPolar);
+    }
+    else
+    {
+        pTask->setPlaneObject(pPlane);
+        pTaskWPolar = pTask->setWPolarObject(pPlane, pWPolar);
+    }
+
+    if(!pTaskWPolar)
+    {
+        updateOutput(tr("Could not initialize ")+pPlane->planeName()+" / "+pWPolar->polarName()+"\n");
+        delete pTask;
+        delete pLLTAnalysis;
+        delete pPanelAnalysis;
+        return false;
+    }
+
+    pTask->initializeTask(pPlane, pWPolar, job.analysis.vMin, job.analysis.vMax, job.analysis.vInc, true);
+
+    job.pTask  = pTask;
+    job.status = RUNNINGJOB;
+    m_nRunning++;
+    m_nJobStarted++;
+    updateOutput(tr("Starting ")+pPlane->planeName()+" / "+pWPolar->polarName()+"\n");
+    updateJobItem(iJob);
+
+    QtConcurrent::run(pTask, &PlaneAnalysisTask::run);
+
+    return true;
+}
+
+
+void PlaneBatchDlg::customEvent(QEvent * event)
+{
+    // When we get here, we've crossed the thread boundary and are now
+    // executing in this widget's thread
+
+    if(event->type() == PLANE_END_TASK_EVENT)
+    {
+        handlePlaneTaskEvent(static_cast<PlaneTaskEvent *>(event));
+    }
+}
+
+
+/**
+ * A task has finished: stores its results, releases its memory and starts the next jobs.
+ */
+void PlaneBatchDlg::handlePlaneTaskEvent(const PlaneTaskEvent *event)
+{
+    // each polar is analyzed by a single job
+    int iJob = -1;
+    for(int ij=0; ij<m_Job.size(); ij++)
+    {
+        if(m_Job.at(ij).status==RUNNINGJOB && m_Job.at(ij).analysis.pWPolar==event->wPolarPtr())
+        {
+            iJob = ij;
+            break;
+        }
+    }
+    if(iJob<0) return;
+
+    PlaneAnalysisJob &job = m_Job[iJob];
+    PlaneAnalysisTask *pTask = job.pTask;
+
+    storeResults(job);
+
+    job.status = pTask->isCancelled() ? CANCELLEDJOB : FINISHEDJOB;
+    job.pTask = nullptr;
+    delete pTask->m_ptheLLTAnalysis;
+    delete pTask->m_pthePanelAnalysis;
+    delete pTask;
+
+    m_nRunning--;
+    m_nJobDone++;
+    updateJobItem(iJob);
+
+    startJobs();
+
+    if(m_nRunning<=0) cleanUp();
+}
+
+
+/**
+ * Adds the operating points calculated by the task of a job to the array of Objects3d.
+ * @param job the job which has finished
+ */
+void PlaneBatchDlg::storeResults(PlaneAnalysisJob &job)
+{
+    PlaneAnalysisTask *pTask = job.pTask;
+    WPolar *pWPolar = job.analysis.pWPolar;
+    QString strong;
+    bool bWarning=false, bError=false;
+
+    QVector<PlaneOpp*> *pPOppList = nullptr;
+    if(pTask->isLLTTask())
+    {
+        pPOppList = &pTask->m_ptheLLTAnalysis->m_PlaneOppList;
+        bWarning = pTask->m_ptheLLTAnalysis->m_bWarning;
+        bError   = pTask->m_ptheLLTAnalysis->m_bError;
+    }
+    else
+    {
+        pPOppList = &pTask->m_pthePanelAnalysis->m_PlaneOppList;
+        bWarning = PanelAnalysis::s_bWarning;
+    }
+
+    int nPOpps = pPOppList->size();
+    if(PlaneOpp::s_bStoreOpps)
+    {
+        for(int iPOpp=0; iPOpp<pPOppList->size(); iPOpp++)
+        {
+            PlaneOpp *pPOpp = pPOppList->at(iPOpp);
+
+            if(Settings::isAlignedChildrenStyle())
+            {
+                pPOpp->setStyle(pWPolar->curveStyle());
+                pPOpp->setWidth(pWPolar->curveWidth());
+                pPOpp->setColor(pWPolar->curveColor());
+                pPOpp->setPoints(pWPolar->points());
+            }
+
+            pPOpp->setVisible(true);
+
+            if(PlaneOpp::s_bKeepOutOpps || !pPOpp->isOut())    Objects3d::insertPOpp(pPOpp);
+            else                                               delete pPOpp;
+        }
+        pPOppList->clear();
+    }
+    else
+    {
+        if(pTask->isLLTTask()) pTask->m_ptheLLTAnalysis->clearPOppList();
+        else                   pTask->m_pthePanelAnalysis->clearPOppList();
+    }
+
+    strong.sprintf("   ...%d points", nPOpps);
+    if(pTask->isCancelled())  strong += tr(" ...cancelled");
+    else if(bWarning)         strong += tr(" ...some points are outside the flight envelope");
+    else if(bError)           strong += tr(" ...some points are unconverged");
+    updateOutput(tr("Finished ")+job.analysis.pPlane->planeName()+" / "+pWPolar->polarName()+strong+"\n");
+}
+
+
+/**
+ * Cancels the pending jobs and the running tasks
+ */
+void PlaneBatchDlg::cancelAll()
+{
+    m_bCancel = true;
+    for(int ij=0; ij<m_Job.size(); ij++)
+    {
+        if(m_Job.at(ij).status==PENDINGJOB)
+        {
+            m_Job[ij].status = CANCELLEDJOB;
+            updateJobItem(ij);
+        }
+        else if(m_Job.at(ij).status==RUNNINGJOB)
+        {
+            m_Job.at(ij).pTask->cancel();
+        }
+    }
+}
+
+
+/**
+ * The user has requested the cancellation of the selected job
+ */
+void PlaneBatchDlg::onCancelJob()
+{
+    int iJob = m_pctrlJobList->currentRow();
+    if(iJob<0 || iJob>=m_Job.size()) return;
+
+    PlaneAnalysisJob &job = m_Job[iJob];
+    if(job.status==PENDINGJOB)
+    {
+        job.status = CANCELLEDJOB;
+        updateJobItem(iJob);
+    }
+    else if(job.status==RUNNINGJOB)
+    {
+        job.pTask->cancel();
+    }
+}
+
+
+/**
+ * Clean-up is performed when all the tasks are terminated
+ */
+void PlaneBatchDlg::cleanUp()
+{
+    m_Timer.stop();
+
+    if(m_bCancel) updateOutput(tr("\n_____Analysis cancelled_____\n"));
+    else          updateOutput(tr("\n_____Analysis completed_____\n"));
+
+    m_pctrlClose->setEnabled(true);
+    m_pctrlCancelJob->setEnabled(false);
+    m_pctrlAnalyze->setText(tr("Analyze"));
+    m_bIsRunning = false;
+    m_bCancel    = false;
+    m_pctrlClose->setFocus();
+}
+
+
+/**
+ * Refreshes the display of the progress of the running jobs
+ */
+void PlaneBatchDlg::onProgress()
+{
+    for(int ij=0; ij<m_Job.size(); ij++)
+    {
+        if(m_Job.at(ij).status==RUNNINGJOB) updateJobItem(ij);
+    }
+}
+
+
+/**
+ * Updates the line of the job list which displays the state of a job
+ * @param iJob the index of the job in the queue
+ */
+void PlaneBatchDlg::updateJobItem(int iJob)
+{
+    QListWidgetItem *pItem = m_pctrlJobList->item(iJob);
+    if(!pItem) return;
+
+    PlaneAnalysisJob const &job = m_Job.at(iJob);
+    QString status;
+    switch(job.status)
+    {
+        case PENDINGJOB:    status = tr("pending");    break;
+        case FINISHEDJOB:   status = tr("done");       break;
+        case CANCELLEDJOB:  status = tr("cancelled");  break;
+        case SKIPPEDJOB:    status = tr("skipped");    break;
+        case RUNNINGJOB:
+        {
+            double progress = 0.0;
+            if(job.pTask->isLLTTask()) progress = job.pTask->m_ptheLLTAnalysis->progress();
+            else                       progress = job.pTask->m_pthePanelAnalysis->progress();
+            status.sprintf("%3d%%", int(qBound(0.0, progress, 1.0)*100.0));
+            break;
+        }
+    }
+    pItem->setText(QString("%1  ").arg(status, 10) + job.analysis.pPlane->planeName()+" / "+job.analysis.pWPolar->polarName());
+}
+
+
+/**
+ * Adds a message to the output window, preceded by the counts of started, done and total jobs
+ * @param str the message to output
+ */
+void PlaneBatchDlg::updateOutput(QString const &str)
+{
+    QString strong;
+    strong.sprintf("%3d/%3d/%3d  ", m_nJobStarted, m_nJobDone, m_Job.size());
+    m_pctrlTextOutput->insertPlainText(strong + str);
+    m_pctrlTextOutput->ensureCursorVisible();
+}
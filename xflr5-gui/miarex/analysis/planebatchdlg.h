@@ -0,0 +1,138 @@
+/****************************************************************************
+
+    PlaneBatchDlg Class
+    Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+/** @file
+ * This file implements the multi-threaded batch analysis of the plane polars
+*/
+
+#ifndef PLANEBATCHDLG_H
+#define PLANEBATCHDLG_H
+
+#include <QDialog>
+#include <QPushButton>
+#include <QRadioButton>
+#include <QListWidget>
+#include <QTextEdit>
+#include <QTimer>
+
+#include <analysis3d/plane_analysis/planeanalysistask.h>
+
+class Plane;
+class WPolar;
+class IntEdit;
+class Miarex;
+class PlaneTaskEvent;
+
+
+/**
+ * @struct A job of the queue: a pair of (plane, polar) to analyze, and the task which performs the analysis once the job has been started.
+ */
+struct PlaneAnalysisJob
+{
+    PlaneAnalysis analysis;       /**< the plane, the polar and the range to analyze */
+    PlaneAnalysisTask *pTask;     /**< the running task, or nullptr if the job is not running */
+    int status;                   /**< the state of the job, as an index in PlaneBatchDlg::enumJobStatus */
+};
+
+
+/**
+ * @brief This class implements the queue of the plane analyses, which are run concurrently on the threads of the global pool.
+
+    Each job owns its own task and analysis objects, which are created when the job is started
+    and deleted as soon as the results have been stored, so that the memory in use is bounded by the number of running jobs.
+    The task posts an event when it is finished; the results are added to the arrays of Objects3d
+    in the main thread when the event is processed, and the next pending jobs are started.
+
+    The analyses of a plane modify the plane's wings, so that only one job per plane is run at a time.
+    Each task holds its own panel and node arrays, so that the analyses of different planes run concurrently.
+ */
+class PlaneBatchDlg : public QDialog
+{
+    Q_OBJECT
+    friend class Miarex;
+    friend class MainFrame;
+
+public:
+    /** the state of a job */
+    enum enumJobStatus {PENDINGJOB, RUNNINGJOB, FINISHEDJOB, CANCELLEDJOB, SKIPPEDJOB};
+
+    PlaneBatchDlg(QWidget *pParent=nullptr);
+    ~PlaneBatchDlg();
+    void initDialog(Plane *pCurPlane);
+
+private:
+    void setupLayout();
+    void cleanUp();
+    void cancelAll();
+    void createJobs();
+    bool checkFoils(Plane *pPlane, QString &strong);
+    bool isPlaneBusy(Plane const *pPlane) const;
+    void startJobs();
+    bool startJob(int iJob);
+    void storeResults(PlaneAnalysisJob &job);
+    void updateJobItem(int iJob);
+    void updateOutput(QString const &str);
+
+    void keyPressEvent(QKeyEvent *event);
+    void showEvent(QShowEvent *event);
+    void hideEvent(QHideEvent *event);
+    void reject();
+
+protected:
+    void customEvent(QEvent *event); // This overrides QObject::customEvent()
+
+private:
+    void handlePlaneTaskEvent(const PlaneTaskEvent *event);
+
+private slots:
+    void onAnalyze();
+    void onCancelJob();
+    void onClose();
+    void onProgress();
+
+private:
+    QRadioButton *m_prbCurPlane, *m_prbAllPlanes;
+    IntEdit *m_pctrlMaxThreads;
+    QListWidget *m_pctrlJobList;
+    QPushButton *m_pctrlCancelJob;
+    QPushButton *m_pctrlClose, *m_pctrlAnalyze;
+    QTextEdit *m_pctrlTextOutput;
+
+    static Miarex *s_pMiarex;          /**< a pointer to the unique instance of the Miarex class */
+    static bool s_bCurrentPlane;       /**< true if only the polars of the current plane should be analyzed */
+    static QPoint s_Position;          /**< the position on the client area of the dialog's topleft corner */
+    static int s_nThreads;             /**< the max number of jobs to run concurrently */
+
+    bool m_bCancel;             /**< true if the user has cancelled the batch */
+    bool m_bIsRunning;          /**< true until all the jobs have been finished or cancelled */
+
+    int m_nJobStarted;          /**< the number of started jobs */
+    int m_nJobDone;             /**< the number of finished jobs */
+    int m_nRunning;             /**< the number of running jobs */
+
+    QVector<PlaneAnalysisJob> m_Job;   /**< the queue of all the jobs, in the order in which they are started */
+
+    Plane *m_pCurPlane;                /**< a pointer to the current Plane */
+
+    QTimer m_Timer;                    /**< the timer which refreshes the display of the progress of the running jobs */
+};
+
+#endif // PLANEBATCHDLG_H
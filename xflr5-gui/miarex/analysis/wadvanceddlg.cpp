@@ -33,6 +33,7 @@
 #include <misc/options/units.h>
 #include <misc/text/doubleedit.h>
 #include <misc/text/intedit.h>
+#include <analysis3d/plane_analysis/matrixcache.h>
 
 WAdvancedDlg::WAdvancedDlg(QWidget *pParent) : QDialog(pParent)
 {
@@ -53,6 +54,13 @@ WAdvancedDlg::WAdvancedDlg(QWidget *pParent) : QDialog(pParent)
     m_bDirichlet      = true;
     m_bLogFile        = true;
     m_bKeepOutOpps    = false;
+    m_bLLTMultiThread = false;
+    m_bIncrementalAssembly = false;
+    m_bLowRankUpdate  = false;
+    m_bIterativeSolve = false;
+    m_bSinglePrecision = false;
+    m_MemoryBudget     = 0;
+    m_MatrixCacheSize  = MATRIXCACHESIZE;
 
     m_ControlPos = 0.75;
     m_VortexPos  = 0.25;
@@ -167,6 +175,12 @@ void WAdvancedDlg::setupLayout()
             pLLTLayout->addWidget(m_pctrlRelax,2,2);
             pLLTLayout->addWidget(m_pctrlAlphaPrec,3,2);
             pLLTLayout->addWidget(m_pctrlIterMax,4,2);
+
+            m_pctrlLLTMultiThread = new QCheckBox(tr("Distribute the aoa range on the threads"));
+            m_pctrlLLTMultiThread->setToolTip("Type 1 and 2 polars only.\n"
+                                              "Each thread analyzes a block of neighbouring aoa,\n"
+                                              "each point starting from the previous converged point of the block.");
+            pLLTLayout->addWidget(m_pctrlLLTMultiThread,5,1,1,2);
         }
         pLLTBox->setLayout(pLLTLayout);
     }
@@ -183,6 +197,67 @@ void WAdvancedDlg::setupLayout()
         pPanelBCBox->setLayout((pPanelBCLayout));
     }
 
+    QGroupBox *pPanelSolverBox = new QGroupBox(tr("3D Panel linear solver"));
+    {
+        QVBoxLayout *pPanelSolverLayout = new QVBoxLayout;
+        {
+            m_pctrlIncrementalAssembly = new QCheckBox(tr("Incremental assembly of the influence matrix"));
+            m_pctrlIncrementalAssembly->setToolTip("Keeps a copy of the influence matrix, so that only the rows and columns\n"
+                                                   "of the panels which have changed are built in the next analysis.\n"
+                                                   "Doubles the memory used by the influence matrix.");
+            m_pctrlLowRankUpdate = new QCheckBox(tr("Low-rank update of the LU factors"));
+            m_pctrlLowRankUpdate->setToolTip("Keeps a copy of the influence matrix and of its LU factors,\n"
+                                             "so that a system which differs only by the panels of a few\n"
+                                             "flaps or control surfaces is solved without a new factorization.\n"
+                                             "Requires the incremental assembly.\n"
+                                             "Doubles the memory used by the linear solver.");
+            m_pctrlIterativeSolve = new QCheckBox(tr("Iterative solver"));
+            m_pctrlIterativeSolve->setToolTip("Solves the linear system with a preconditioned GMRES solver\n"
+                                              "which does not store the influence matrix.\n"
+                                              "Recommended for large meshes which do not fit in memory.");
+            m_pctrlSinglePrecision = new QCheckBox(tr("Single precision LU factors"));
+            m_pctrlSinglePrecision->setToolTip("Stores and factors the influence matrix in single precision,\n"
+                                               "and recovers the double precision accuracy by iterative refinement.\n"
+                                               "Halves the memory used by the LU solver.");
+            QHBoxLayout *pBudgetLayout = new QHBoxLayout;
+            {
+                m_pctrlMemoryBudget = new IntEdit(0, this);
+                m_pctrlMemoryBudget->setToolTip("The memory available to the panel analysis.\n"
+                                                "The solver is degraded to fit in the budget if necessary.\n"
+                                                "Set to 0 for no limit.");
+                QLabel *pBudgetLab = new QLabel(tr("Memory budget"));
+                pBudgetLab->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                QLabel *pBudgetUnit = new QLabel("MB");
+                pBudgetLayout->addStretch(1);
+                pBudgetLayout->addWidget(pBudgetLab);
+                pBudgetLayout->addWidget(m_pctrlMemoryBudget);
+                pBudgetLayout->addWidget(pBudgetUnit);
+            }
+            QHBoxLayout *pCacheLayout = new QHBoxLayout;
+            {
+                m_pctrlMatrixCacheSize = new IntEdit(MATRIXCACHESIZE, this);
+                m_pctrlMatrixCacheSize->setToolTip("The memory used to keep the factored influence matrices,\n"
+                                                   "so that the polars of the same plane are analyzed without a new factorization.\n"
+                                                   "Limited to the memory budget if one is set.\n"
+                                                   "Set to 0 to disable the cache.");
+                QLabel *pCacheLab = new QLabel(tr("Factored matrix cache"));
+                pCacheLab->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                QLabel *pCacheUnit = new QLabel("MB");
+                pCacheLayout->addStretch(1);
+                pCacheLayout->addWidget(pCacheLab);
+                pCacheLayout->addWidget(m_pctrlMatrixCacheSize);
+                pCacheLayout->addWidget(pCacheUnit);
+            }
+            pPanelSolverLayout->addWidget(m_pctrlIncrementalAssembly);
+            pPanelSolverLayout->addWidget(m_pctrlLowRankUpdate);
+            pPanelSolverLayout->addWidget(m_pctrlIterativeSolve);
+            pPanelSolverLayout->addWidget(m_pctrlSinglePrecision);
+            pPanelSolverLayout->addLayout(pBudgetLayout);
+            pPanelSolverLayout->addLayout(pCacheLayout);
+        }
+        pPanelSolverBox->setLayout(pPanelSolverLayout);
+    }
+
     m_pButtonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Discard | QDialogButtonBox::Reset);
     {
         connect(m_pButtonBox, SIGNAL(clicked(QAbstractButton*)), this, SLOT(onButton(QAbstractButton*)));
@@ -196,6 +271,8 @@ void WAdvancedDlg::setupLayout()
             pLeftSide->addStretch(1);
             pLeftSide->addWidget(pPanelBCBox);
             pLeftSide->addStretch(1);
+            pLeftSide->addWidget(pPanelSolverBox);
+            pLeftSide->addStretch(1);
         }
         QVBoxLayout *pRightSide = new QVBoxLayout;
         {
@@ -307,6 +384,13 @@ void WAdvancedDlg::onResetDefaults()
     m_bDirichlet       = true;
     m_bTrefftz         = true;
     m_bKeepOutOpps     = false;
+    m_bLLTMultiThread  = false;
+    m_bIncrementalAssembly = false;
+    m_bLowRankUpdate   = false;
+    m_bIterativeSolve  = false;
+    m_bSinglePrecision = false;
+    m_MemoryBudget     = 0;
+    m_MatrixCacheSize  = MATRIXCACHESIZE;
     setParams();
 }
 
@@ -324,6 +408,13 @@ void WAdvancedDlg::readParams()
     m_bDirichlet      = m_pctrlDirichlet->isChecked();
     m_bTrefftz        = true;
     m_bKeepOutOpps    = m_pctrlKeepOutOpps->isChecked();
+    m_bLLTMultiThread = m_pctrlLLTMultiThread->isChecked();
+    m_bIncrementalAssembly = m_pctrlIncrementalAssembly->isChecked();
+    m_bLowRankUpdate  = m_pctrlLowRankUpdate->isChecked();
+    m_bIterativeSolve = m_pctrlIterativeSolve->isChecked();
+    m_bSinglePrecision = m_pctrlSinglePrecision->isChecked();
+    m_MemoryBudget    = qMax(0, m_pctrlMemoryBudget->value());
+    m_MatrixCacheSize = qMax(0, m_pctrlMatrixCacheSize->value());
     m_bLogFile        = m_pctrlLogFile->isChecked();
 }
 
@@ -341,6 +432,13 @@ void WAdvancedDlg::setParams()
 
     m_pctrlLogFile->setChecked(m_bLogFile);
     m_pctrlKeepOutOpps->setChecked(m_bKeepOutOpps);
+    m_pctrlLLTMultiThread->setChecked(m_bLLTMultiThread);
+    m_pctrlIncrementalAssembly->setChecked(m_bIncrementalAssembly);
+    m_pctrlLowRankUpdate->setChecked(m_bLowRankUpdate);
+    m_pctrlIterativeSolve->setChecked(m_bIterativeSolve);
+    m_pctrlSinglePrecision->setChecked(m_bSinglePrecision);
+    m_pctrlMemoryBudget->setValue(m_MemoryBudget);
+    m_pctrlMatrixCacheSize->setValue(m_MatrixCacheSize);
 
     m_pctrlControlPos->setValue(m_ControlPos*100.0);
     m_pctrlVortexPos->setValue(m_VortexPos*100.0);
@@ -58,12 +58,19 @@ private:
 
     QCheckBox *m_pctrlLogFile;
     QCheckBox *m_pctrlKeepOutOpps;
+    QCheckBox *m_pctrlLLTMultiThread;
+    QCheckBox *m_pctrlIncrementalAssembly;
+    QCheckBox *m_pctrlLowRankUpdate;
+    QCheckBox *m_pctrlIterativeSolve;
+    QCheckBox *m_pctrlSinglePrecision;
     QRadioButton *m_pctrlDirichlet, *m_pctrlNeumann;
     DoubleEdit *m_pctrlRelax;
     DoubleEdit *m_pctrlAlphaPrec;
     DoubleEdit *m_pctrlMinPanelSize;
     IntEdit *m_pctrlNStation;
     IntEdit *m_pctrlIterMax;
+    IntEdit *m_pctrlMemoryBudget;
+    IntEdit *m_pctrlMatrixCacheSize;
     DoubleEdit *m_pctrlCoreSize;
     DoubleEdit *m_pctrlVortexPos;
     DoubleEdit *m_pctrlControlPos;
@@ -72,12 +79,19 @@ private:
     bool m_bDirichlet;
     bool m_bTrefftz;
     bool m_bKeepOutOpps;
+    bool m_bLLTMultiThread;
+    bool m_bIncrementalAssembly;
+    bool m_bLowRankUpdate;
+    bool m_bIterativeSolve;
+    bool m_bSinglePrecision;
 
     int m_Iter;
     int m_NLLTStation;
     int m_WakeInterNodes;
     int m_MaxWakeIter;
     int m_InducedDragPoint;
+    int m_MemoryBudget;
+    int m_MatrixCacheSize;
 
     double m_ControlPos, m_VortexPos;
     double m_Relax, m_AlphaPrec;
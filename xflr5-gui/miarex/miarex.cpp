@@ -34,6 +34,7 @@
 #include "miarex.h"
 #include "graphtilewidget.h"
 #include <analysis3d/matrix.h>
+#include <analysis3d/plane_analysis/matrixcache.h>
 #include <globals/globals.h>
 #include <globals/mainframe.h>
 #include <graph/curve.h>
@@ -41,6 +42,7 @@
 #include <miarex/analysis/aerodatadlg.h>
 #include <miarex/analysis/editpolardefdlg.h>
 #include <miarex/analysis/panelanalysisdlg.h>
+#include <miarex/analysis/planebatchdlg.h>
 #include <miarex/analysis/stabpolardlg.h>
 #include <miarex/analysis/stabpolardlg.h>
 #include <miarex/analysis/wadvanceddlg.h>
@@ -1917,6 +1919,60 @@ void Miarex::LLTAnalyze(double V0, double VMax, double VDelta, bool bSequence, b
 
 
 
+/**
+ * Launches the concurrent analysis of a batch of polars.
+ * The analyses modify the plane geometries and the static panel pointers,
+ * so the current plane and polar are set anew once the batch is finished.
+ */
+void Miarex::onBatchAnalysis()
+{
+    if(!Objects3d::s_oaPlane.size()) return;
+
+    bool bHigh = Graph::isHighLighting();
+    Graph::setOppHighlighting(false);
+
+    //prevent an automatic and lengthy redraw of the streamlines after the calculation
+    m_pgl3dMiarexView->m_bStream = m_pgl3dMiarexView->m_bSurfVelocities = false;
+    m_pctrlStream->setChecked(false);
+    m_pctrlSurfVel->setChecked(false);
+
+    // make sure that the latest parameters are loaded
+    onReadAnalysisData();
+
+    LLTAnalysis::s_bInitCalc = m_bInitLLTCalc;
+    LLTAnalysis::s_IterLim = m_LLTMaxIterations;
+
+    m_pctrlAnalyze->setEnabled(false);
+    s_pMainFrame->m_pctrlPlane->setEnabled(false);
+    s_pMainFrame->m_pctrlPlanePolar->setEnabled(false);
+    s_pMainFrame->m_pctrlPlaneOpp->setEnabled(false);
+
+    PlaneBatchDlg::s_pMiarex = this;
+    PlaneBatchDlg batchDlg(s_pMainFrame);
+    batchDlg.initDialog(m_pCurPlane);
+    batchDlg.exec();
+
+    m_pctrlAnalyze->setEnabled(true);
+    s_pMainFrame->m_pctrlPlane->setEnabled(true);
+    s_pMainFrame->m_pctrlPlanePolar->setEnabled(true);
+    s_pMainFrame->m_pctrlPlaneOpp->setEnabled(true);
+
+    Graph::setOppHighlighting(bHigh);
+
+    // rebuild the geometry and the panels of the current plane
+    if(m_pCurPlane) setPlane(m_pCurPlane->planeName());
+    else            setPlane();
+    s_pMainFrame->updatePOppListBox();
+    emit projectModified();
+
+    s_bResetCurves = true;
+    updateView();
+    setControls();
+    s_pMainFrame->setFocus();
+}
+
+
+
 /**
  * Loads the user's saved settings from the configuration file and maps the data.
  *@param a pointer to the QSettings object loaded in the MainFrame class
@@ -2070,9 +2126,19 @@ bool Miarex::loadSettings(QSettings &settings)
         LLTAnalysis::s_CvPrec       = settings.value("CvPrec").toDouble();
         LLTAnalysis::s_RelaxMax     = settings.value("RelaxMax").toDouble();
         LLTAnalysis::s_NLLTStations = settings.value("NLLTStations").toInt();
+        LLTAnalysis::s_bMultiThread = settings.value("LLTMultiThread", false).toBool();
+
+        PlaneBatchDlg::s_bCurrentPlane = settings.value("BatchCurrentPlane", true).toBool();
+        PlaneBatchDlg::s_nThreads      = settings.value("BatchMaxThreads", 1).toInt();
 
         PanelAnalysis::s_bTrefftz   = settings.value("Trefftz", true).toBool();
         PanelAnalysis::s_bTrefftz   = true;
+        PanelAnalysis::setIncrementalAssembly(settings.value("PanelIncrementalAssembly", false).toBool());
+        PanelAnalysis::setLowRankUpdate(settings.value("PanelLowRankUpdate", false).toBool());
+        PanelAnalysis::setIterativeSolve(settings.value("PanelIterativeSolve", false).toBool());
+        PanelAnalysis::setSinglePrecision(settings.value("PanelSinglePrecision", false).toBool());
+        PanelAnalysis::setMemoryBudget(settings.value("PanelMemoryBudget", 0).toInt());
+        PanelAnalysis::setMatrixCacheSize(settings.value("PanelMatrixCacheSize", MATRIXCACHESIZE).toInt());
 
         Panel::s_CtrlPos       = settings.value("CtrlPos").toDouble();
         Panel::s_VortexPos     = settings.value("VortexPos").toDouble();
@@ -2208,6 +2274,46 @@ void Miarex::on3DPrefs()
 
 
 
+/**
+ * Returns the range of the analysis of a polar, as defined in the analysis settings for the type of the polar
+ * @param pWPolar a pointer to the polar
+ * @param V0 the starting value of the range
+ * @param VMax the ending value of the range
+ * @param VDelta the increment of the range
+ */
+void Miarex::analysisRange(WPolar const *pWPolar, double &V0, double &VMax, double &VDelta) const
+{
+    if(pWPolar->polarType()==XFLR5::FIXEDAOAPOLAR)
+    {
+        V0     = m_QInfMin;
+        VMax   = m_QInfMax;
+        VDelta = m_QInfDelta;
+    }
+    else if(pWPolar->polarType()==XFLR5::STABILITYPOLAR)
+    {
+        V0     = m_ControlMin;
+        VMax   = m_ControlMax;
+        VDelta = m_ControlDelta;
+    }
+    else if(pWPolar->polarType()==XFLR5::BETAPOLAR)
+    {
+        V0     = m_BetaMin;
+        VMax   = m_BetaMax;
+        VDelta = m_BetaDelta;
+    }
+    else if(pWPolar->polarType() <XFLR5::FIXEDAOAPOLAR)
+    {
+        V0     = m_AlphaMin;
+        VMax   = m_AlphaMax;
+        VDelta = m_AlphaDelta;
+    }
+    else
+    {
+        V0 = VMax = VDelta = 0.0;
+    }
+}
+
+
 /**
  * The user has requested a launch of the analysis
  * Reads a last time the input parameters from the control box
@@ -2241,34 +2347,7 @@ void Miarex::onAnalyze()
     // make sure that the latest parameters are loaded
     onReadAnalysisData();
 
-    if(m_pCurWPolar->polarType()==XFLR5::FIXEDAOAPOLAR)
-    {
-        V0     = m_QInfMin;
-        VMax   = m_QInfMax;
-        VDelta = m_QInfDelta;
-    }
-    else if(m_pCurWPolar->polarType()==XFLR5::STABILITYPOLAR)
-    {
-        V0     = m_ControlMin;
-        VMax   = m_ControlMax;
-        VDelta = m_ControlDelta;
-    }
-    else if(m_pCurWPolar->polarType()==XFLR5::BETAPOLAR)
-    {
-        V0     = m_BetaMin;
-        VMax   = m_BetaMax;
-        VDelta = m_BetaDelta;
-    }
-    else if(m_pCurWPolar->polarType() <XFLR5::FIXEDAOAPOLAR)
-    {
-        V0     = m_AlphaMin;
-        VMax   = m_AlphaMax;
-        VDelta = m_AlphaDelta;
-    }
-    else
-    {
-        V0 = VMax = VDelta = 0.0;
-    }
+    analysisRange(m_pCurWPolar, V0, VMax, VDelta);
 
     // check if all the foils are in the database...
     // ...could have been deleted or renamed or not imported with AVL wing or whatever
@@ -2612,8 +2691,15 @@ void Miarex::onAdvancedSettings()
     waDlg.m_AlphaPrec       = LLTAnalysis::s_CvPrec;
     waDlg.m_Relax           = LLTAnalysis::s_RelaxMax;
     waDlg.m_NLLTStation     = LLTAnalysis::s_NLLTStations;
+    waDlg.m_bLLTMultiThread = LLTAnalysis::s_bMultiThread;
 
     waDlg.m_bTrefftz        = PanelAnalysis::s_bTrefftz;
+    waDlg.m_bIncrementalAssembly = PanelAnalysis::isIncrementalAssembly();
+    waDlg.m_bLowRankUpdate  = PanelAnalysis::isLowRankUpdate();
+    waDlg.m_bIterativeSolve = PanelAnalysis::isIterativeSolve();
+    waDlg.m_bSinglePrecision = PanelAnalysis::isSinglePrecision();
+    waDlg.m_MemoryBudget    = PanelAnalysis::memoryBudget();
+    waDlg.m_MatrixCacheSize = PanelAnalysis::matrixCacheSize();
 
     waDlg.m_CoreSize        = Panel::s_CoreSize;
     waDlg.m_ControlPos      = Panel::s_CtrlPos;
@@ -2633,8 +2719,15 @@ void Miarex::onAdvancedSettings()
         LLTAnalysis::s_CvPrec        = waDlg.m_AlphaPrec;
         LLTAnalysis::s_RelaxMax      = waDlg.m_Relax;
         LLTAnalysis::s_NLLTStations  = waDlg.m_NLLTStation;
+        LLTAnalysis::s_bMultiThread  = waDlg.m_bLLTMultiThread;
 
         PanelAnalysis::s_bTrefftz  = waDlg.m_bTrefftz;
+        PanelAnalysis::setIncrementalAssembly(waDlg.m_bIncrementalAssembly);
+        PanelAnalysis::setLowRankUpdate(waDlg.m_bLowRankUpdate);
+        PanelAnalysis::setIterativeSolve(waDlg.m_bIterativeSolve);
+        PanelAnalysis::setSinglePrecision(waDlg.m_bSinglePrecision);
+        PanelAnalysis::setMemoryBudget(waDlg.m_MemoryBudget);
+        PanelAnalysis::setMatrixCacheSize(waDlg.m_MatrixCacheSize);
 
         Panel::s_CoreSize          = waDlg.m_CoreSize;
         Panel::s_CtrlPos           = waDlg.m_ControlPos;
@@ -6555,8 +6648,18 @@ bool Miarex::saveSettings(QSettings &settings)
         settings.setValue("CvPrec", LLTAnalysis::s_CvPrec);
         settings.setValue("RelaxMax", LLTAnalysis::s_RelaxMax);
         settings.setValue("NLLTStations", LLTAnalysis::s_NLLTStations);
+        settings.setValue("LLTMultiThread", LLTAnalysis::s_bMultiThread);
+
+        settings.setValue("BatchCurrentPlane", PlaneBatchDlg::s_bCurrentPlane);
+        settings.setValue("BatchMaxThreads", PlaneBatchDlg::s_nThreads);
 
         settings.setValue("Trefftz", PanelAnalysis::s_bTrefftz);
+        settings.setValue("PanelIncrementalAssembly", PanelAnalysis::isIncrementalAssembly());
+        settings.setValue("PanelLowRankUpdate", PanelAnalysis::isLowRankUpdate());
+        settings.setValue("PanelIterativeSolve", PanelAnalysis::isIterativeSolve());
+        settings.setValue("PanelSinglePrecision", PanelAnalysis::isSinglePrecision());
+        settings.setValue("PanelMemoryBudget", PanelAnalysis::memoryBudget());
+        settings.setValue("PanelMatrixCacheSize", PanelAnalysis::matrixCacheSize());
 
 
         switch(m_iView)
@@ -100,6 +100,7 @@ class Miarex : public QWidget
     friend class ManageUFOsDlg;
     friend class PanelAnalysisDlg;
     friend class Plane;
+    friend class PlaneBatchDlg;
     friend class PlaneDlg;
     friend class Settings;
     friend class StabPolarDlg;
@@ -130,6 +131,7 @@ public slots:
     void onAdvancedSettings();
     void onAlignChildrenStyle();
     void onAnalyze();
+    void onBatchAnalysis();
     void onAnimateWOpp();
     void onAnimateWOppSingle();
     void onAnimateWOppSpeed(int val);
@@ -264,6 +266,7 @@ public:
     void LLTAnalyze(double V0, double VMax, double VDelta, bool bSequence, bool bInitCalc);
     bool loadSettings(QSettings &settings);
     int  matSize() {return m_theTask.m_MatSize;}
+    void analysisRange(WPolar const *pWPolar, double &V0, double &VMax, double &VDelta) const;
     void drawColorGradient(QPainter &painter, QRect const & gradientRect);
     void paintCpLegendText(QPainter &painter);
     void paintPanelForceLegendText(QPainter &painter);
@@ -427,6 +427,7 @@ bool gl3dMiarexView::glMakeStreamLines(Wing *PlaneWing[MAXWINGS], Vector3d *pNod
 
     double *Mu    = pPOpp->m_dG;
     double *Sigma = pPOpp->m_dSigma;
+    s_pMiarex->m_theTask.m_pthePanelAnalysis->strengthsChanged();
 
     VInf.set(pPOpp->m_QInf,0.0,0.0);
 
@@ -769,6 +770,7 @@ void gl3dMiarexView::glMakeSurfVelocities(Panel *pPanel, WPolar *pWPolar, PlaneO
 
     Mu    = pPOpp->m_dG;
     Sigma = pPOpp->m_dSigma;
+    s_pMiarex->m_theTask.m_pthePanelAnalysis->strengthsChanged();
 
     // vertices array size:
     //        nPanels x 1 arrow
@@ -94,8 +94,6 @@ BatchDlg::BatchDlg(QWidget *pParent) : QDialog(pParent)
     m_bIsRunning      = false;
     m_bErrors         = false;
 
-    XFoil::setCancel(false);
-
     setupLayout();
 
     m_pRmsGraph = new Graph;
@@ -422,7 +420,7 @@ void BatchDlg::reject()
     if(m_bIsRunning)
     {
         m_bCancel    = true;
-        XFoil::setCancel(true);
+        m_pXFoilTask->cancel();
     }
     else
     {
@@ -444,7 +442,6 @@ void BatchDlg::cleanUp()
     m_pctrlAnalyze->setText(tr("Analyze"));
     m_bIsRunning = false;
     m_bCancel    = false;
-    XFoil::setCancel(false);
     m_pctrlClose->setFocus();
     qApp->processEvents();
 }
@@ -791,8 +788,7 @@ void BatchDlg::onAnalyze()
 {
     if(m_bIsRunning)
     {
-        XFoil::setCancel(true);
-        XFoilTask::s_bCancel = true;
+        m_pXFoilTask->cancel();
         m_bCancel = true;
         return;
     }
@@ -841,8 +837,7 @@ void BatchDlg::onClose()
     if(m_bIsRunning)
     {
         m_bCancel = true;
-        XFoil::setCancel(true);
-        XFoilTask::s_bCancel = true;
+        m_pXFoilTask->cancel();
         return;
     }
 
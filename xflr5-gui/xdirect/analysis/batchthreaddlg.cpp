@@ -27,9 +27,9 @@
 #include <QCoreApplication>
 #include <QThread>
 #include <QThreadPool>
-#include <QTimer>
 #include <QFontDatabase>
 #include <QtDebug>
+#include <algorithm>
 
 #include "batchthreaddlg.h"
 #include "relistdlg.h"
@@ -50,6 +50,7 @@
 
 bool BatchThreadDlg::s_bCurrentFoil=true;
 bool BatchThreadDlg::s_bUpdatePolarView = false;
+bool BatchThreadDlg::s_bWarmStart = false;
 XDirect * BatchThreadDlg::s_pXDirect;
 QPoint BatchThreadDlg::s_Position;
 int BatchThreadDlg::s_nThreads = 1;
@@ -63,6 +64,7 @@ BatchThreadDlg::BatchThreadDlg(QWidget *pParent) : QDialog(pParent)
     setWindowTitle(str);
 
     m_pXFile = nullptr;
+    m_pResultQueue = new XFoilResultQueue(this);
 
     m_PolarType = XFLR5::FIXEDSPEEDPOLAR;
 
@@ -84,6 +86,7 @@ BatchThreadDlg::BatchThreadDlg(QWidget *pParent) : QDialog(pParent)
     m_nTaskDone = 0;
     m_nTaskStarted = 0;
     m_nAnalysis = 0;
+    m_nRunning = 0;
 
     m_bAlpha          = true;
     m_bFromList       = false;
@@ -112,6 +115,7 @@ BatchThreadDlg::BatchThreadDlg(QWidget *pParent) : QDialog(pParent)
     connect(m_pctrlSpecMax,         SIGNAL(editingFinished()), this, SLOT(onSpecChanged()));
     connect(m_pctrlSpecDelta,       SIGNAL(editingFinished()), this, SLOT(onSpecChanged()));
     connect(m_pctrlUpdatePolarView, SIGNAL(clicked(bool)),     this, SLOT(onUpdatePolarView()));
+    connect(m_pctrlWarmStart,       SIGNAL(clicked(bool)),     this, SLOT(onWarmStart()));
 }
 
 
@@ -122,6 +126,7 @@ BatchThreadDlg::BatchThreadDlg(QWidget *pParent) : QDialog(pParent)
 BatchThreadDlg::~BatchThreadDlg()
 {
     if(m_pXFile)     delete m_pXFile;
+    delete m_pResultQueue;
 
     //clean up the rest of the analysis in case of cancellation
     for(int ia=m_AnalysisPair.count()-1; ia>=0; ia--)
@@ -325,6 +330,10 @@ void BatchThreadDlg::setupLayout()
         QFontMetrics fm(Settings::s_TableFont);
         m_pctrlTextOutput->setMinimumWidth(67*fm.averageCharWidth());
         m_pctrlInitBL          = new QCheckBox(tr("Initialize BLs between polars"));
+        m_pctrlWarmStart       = new QCheckBox(tr("Start each polar from the BL at the previous Re"));
+        m_pctrlWarmStart->setToolTip(tr("Analyze the polars of each foil in chains of neighbouring Reynolds numbers,\n"
+                                        "starting each polar from the converged BL of the previous one.\n"
+                                        "Reduces the number of iterations at the start of each polar."));
 
         QHBoxLayout *pOptionsLayout = new QHBoxLayout;
         {
@@ -349,6 +358,7 @@ void BatchThreadDlg::setupLayout()
         }
 
         pRightSide->addWidget(m_pctrlInitBL);
+        pRightSide->addWidget(m_pctrlWarmStart);
         pRightSide->addLayout(pOptionsLayout);
         pRightSide->addLayout(pnThreadLayout);
         pRightSide->addWidget(m_pctrlTextOutput,1);
@@ -369,7 +379,7 @@ void BatchThreadDlg::setupLayout()
  */
 void BatchThreadDlg::cleanUp()
 {
-    if(m_pXFile->isOpen())
+    if(m_pXFile && m_pXFile->isOpen())
     {
         QTextStream out(m_pXFile);
         out<<m_pctrlTextOutput->toPlainText();
@@ -380,6 +390,9 @@ void BatchThreadDlg::cleanUp()
     m_bIsRunning = false;
     m_bCancel    = false;
     XFoil::setCancel(false);
+    // the influence matrices of the batch's foils and the workspaces of its tasks are not needed anymore
+    XFoil::clearInfluenceCache();
+    XFoil::releaseWorkspaces();
     m_pctrlClose->setFocus();
 
     //in case we cancelled, delete all Analysis that are left
@@ -389,6 +402,7 @@ void BatchThreadDlg::cleanUp()
         delete pAnalysis;
         m_AnalysisPair.removeAt(ia);
     }
+    m_PolarTasks.clear();
 }
 
 
@@ -485,7 +499,7 @@ void BatchThreadDlg::keyPressEvent(QKeyEvent *event)
             if(m_bIsRunning)
             {
                 m_bCancel = true;
-                XFoilTask::s_bCancel = true;
+                XFoilTask::setCancel(true);
                 XFoil::setCancel(true);
             }
             else
@@ -564,6 +578,7 @@ void BatchThreadDlg::initDialog()
 
     m_pctrlInitBL->setChecked(true);
     m_pctrlUpdatePolarView->setChecked(s_bUpdatePolarView);
+    m_pctrlWarmStart->setChecked(s_bWarmStart);
     blockSignals(false);
 }
 
@@ -614,8 +629,9 @@ void BatchThreadDlg::onAnalyze()
     if(m_bIsRunning)
     {
         m_bCancel = true;
-        XFoilTask::s_bCancel = true;
+        XFoilTask::setCancel(true);
         XFoil::setCancel(true);
+        endAnalysis();
         return;
     }
 
@@ -646,7 +662,7 @@ void BatchThreadDlg::onClose()
     if(m_bIsRunning) return;
 
     m_bCancel = true;
-    XFoilTask::s_bCancel = true;
+    XFoilTask::setCancel(true);
     QThreadPool::globalInstance()->waitForDone();
     readParams();
 
@@ -670,7 +686,9 @@ void BatchThreadDlg::reject()
     if(m_bIsRunning)
     {
         m_bCancel    = true;
+        XFoilTask::setCancel(true);
         XFoil::setCancel(true);
+        endAnalysis();
     }
     else
     {
@@ -893,8 +911,8 @@ void BatchThreadDlg::writeString(QString &strong)
 
 /**
  * Starts the multithreaded analysis.
- * First, creates a pool list of all (Foil, pairs) to analyze.
- * Then, starts the threads which will pick the pairs from the pool and remove them once the analayis is finished.
+ * First, creates a pool list of all (Foil, pairs) to analyze, ordered by estimated cost.
+ * Then, starts as many tasks as there are threads; the next tasks are started as soon as a running task is finished.
  */
 void BatchThreadDlg::startAnalysis()
 {
@@ -929,6 +947,22 @@ void BatchThreadDlg::startAnalysis()
     m_nAnalysis = 0;
     m_nTaskDone = 0;
     m_nTaskStarted = 0;
+    m_nRunning = 0;
+    m_PolarTasks.clear();
+
+    // In warm start mode, the Re of each foil are split in as many chains as necessary to keep the threads busy;
+    // each chain is analyzed by a single task, each polar starting from the BL of the previous one
+    int chainLength = 1;
+    if(s_bWarmStart && m_PolarType!=XFLR5::FIXEDAOAPOLAR)
+    {
+        int nChains = std::max(1, (s_nThreads+m_FoilList.count()-1)/m_FoilList.count());
+        chainLength = std::max(1, (nRe+nChains-1)/nChains);
+    }
+
+    double SpMin = m_bAlpha ? m_AlphaMin : m_ClMin;
+    double SpMax = m_bAlpha ? m_AlphaMax : m_ClMax;
+    double SpInc = m_bAlpha ? m_AlphaInc : m_ClInc;
+    int nPoints = qAbs(SpInc)>0.0 ? int(qAbs((SpMax-SpMin)/SpInc))+1 : 1;
 
     FoilAnalysis *pAnalysis=nullptr;
     for(int i=0; i<m_FoilList.count(); i++)
@@ -938,115 +972,147 @@ void BatchThreadDlg::startAnalysis()
         {
             for (iRe=0; iRe<nRe; iRe++)
             {
-                pAnalysis = new FoilAnalysis;
-                m_AnalysisPair.append(pAnalysis);
-                pAnalysis->pFoil = pFoil;
-
                 if(!m_bFromList) pPolar = createPolar(pFoil, m_ReMin + iRe *m_ReInc, m_Mach, m_ACrit);
                 else             pPolar = createPolar(pFoil, XDirect::s_ReList[iRe], XDirect::s_MachList[iRe], XDirect::s_NCritList[iRe]);
-                pAnalysis->pPolar=pPolar;
 
+                if(iRe%chainLength==0)
+                {
+                    pAnalysis = new FoilAnalysis;
+                    m_AnalysisPair.append(pAnalysis);
+                    pAnalysis->pFoil = pFoil;
+                    pAnalysis->pPolar=pPolar;
+                    pAnalysis->vMin = m_bAlpha ? m_AlphaMin : m_ClMin;
+                    pAnalysis->vMax = m_bAlpha ? m_AlphaMax : m_ClMax;
+                    pAnalysis->vInc = m_bAlpha ? m_AlphaInc : m_ClInc;
+                    pAnalysis->bFromZero = m_bFromZero;
+                    pAnalysis->bSplit = false;
+                    pAnalysis->cost = 0.0;
+                }
+                else pAnalysis->nextPolar.append(pPolar);
+
+                pAnalysis->cost += nPoints*XFoilTask::pointCost(pFoil, pPolar);
+                m_PolarTasks[pPolar] = 1;
                 m_nAnalysis++;
             }
         }
     }
+
+    // start the longest analyses first, so that the short ones fill the threads at the end of the batch
+    std::sort(m_AnalysisPair.begin(), m_AnalysisPair.end(),
+              [](FoilAnalysis const *pA, FoilAnalysis const *pB){return pA->cost<pB->cost;});
+
     strong = QString(tr("Found %1 foil/polar pairs to analyze\n")).arg(m_nAnalysis);
     m_pctrlTextOutput->insertPlainText(strong);
 
     //Start as many threads as the user has requested
     //    m_nThreads = QThread::idealThreadCount();
 
-    XFoilTask::s_bCancel = false;
+    XFoilTask::setCancel(false);
 
     strong = QString(tr("Starting with %1 threads\n\n")).arg(s_nThreads);
     m_pctrlTextOutput->insertPlainText(strong);
     m_pctrlTextOutput->insertPlainText(tr("\nStarted/Done/Total\n"));
 
-    m_pTimer = new QTimer(this);
-    connect(m_pTimer, SIGNAL(timeout()), this, SLOT(onTimerEvent()));
-    m_pTimer->start(100);
+    startJobs();
+    if(m_nRunning<=0) endAnalysis();
 }
 
 
 /**
- * A timer event used to check at regluar intervals if any threads are inactive
- * in which case it launches a task if any are left
-*/
-void BatchThreadDlg::onTimerEvent()
+ * Starts the pending analyses, by decreasing estimated cost, until all the threads are busy.
+ * Once no analysis is pending, the idle threads take part of the work left to the running tasks,
+ * i.e. the next polars of a chain or the tail of a polar's sequence.
+ * Called when the analysis is started and each time a task is finished.
+ */
+void BatchThreadDlg::startJobs()
 {
-    qApp->processEvents();
-
-    QString strong;
-    //time to launch another analysis, if any are left
-
-    if(m_AnalysisPair.size()<=0 || m_bCancel)
+    while(m_nRunning<s_nThreads && !m_bCancel)
     {
-        //nothing left to launch... just wait and enjoy the show
-        if(m_nTaskDone>=m_nAnalysis || m_bCancel)
+        FoilAnalysis *pAnalysis = nullptr;
+        if(m_AnalysisPair.size())
         {
-            QThreadPool::globalInstance()->waitForDone();
-
-            if(m_bCancel) strong = tr("\n_____Analysis cancelled_____\n");
-            else          strong = tr("\n_____Analysis completed_____\n");
-            m_pctrlTextOutput->insertPlainText(strong);
-            m_pctrlTextOutput->ensureCursorVisible();
-
-            m_pTimer->stop();
-            cleanUp();
-
-            if(s_pXDirect->m_bPolarView && s_bUpdatePolarView)
+            //take the last analysis in the array, i.e. the longest
+            pAnalysis = m_AnalysisPair.takeLast();
+            m_nTaskStarted += 1+pAnalysis->nextPolar.size();
+        }
+        else
+        {
+            pAnalysis = new FoilAnalysis;
+            if(!XFoilTask::stealWork(pAnalysis))
             {
-                s_pXDirect->createPolarCurves();
-                s_pXDirect->updateView();
+                // the work left to the running tasks is too short to be split
+                delete pAnalysis;
+                break;
             }
+            if(pAnalysis->bSplit) m_PolarTasks[pAnalysis->pPolar]++;
         }
-    }
-    else if(m_bIsRunning)
-    {
-        //need to check if we are still running in case a timer event arrives after a cancellation for instance.
-        startThread(); // analyze a new pair
+
+        startTask(pAnalysis);
+        delete pAnalysis;
     }
 }
 
 
 /**
- * Starts an individual thread
+ * Starts the task which analyzes a foil for a polar and its next polars.
+ * The task is added to the list of the tasks from which the idle threads may take work.
+ * @param pAnalysis the foil, the polars and the range to analyze
  */
-void BatchThreadDlg::startThread()
+void BatchThreadDlg::startTask(FoilAnalysis *pAnalysis)
 {
-    FoilAnalysis *pAnalysis;
     QString strong;
-    //  browse through the array until we find an available thread
 
-    if(QThreadPool::globalInstance()->activeThreadCount()<s_nThreads && m_AnalysisPair.count())
+    XFoilTask *pXFoilTask = new XFoilTask(this);
+    pXFoilTask->setResultQueue(m_pResultQueue);
+
+    pAnalysis->pPolar->setVisible(true);
+    for(int ip=0; ip<pAnalysis->nextPolar.size(); ip++)
     {
-        XFoilTask *pXFoilTask = new XFoilTask(this);
+        pAnalysis->nextPolar.at(ip)->setVisible(true);
+        pXFoilTask->appendPolar(pAnalysis->nextPolar.at(ip));
+    }
+
+    //initiate the task
+    pXFoilTask->setSequence(m_bAlpha, pAnalysis->vMin, pAnalysis->vMax, pAnalysis->vInc);
+    pXFoilTask->initializeTask(pAnalysis->pFoil, pAnalysis->pPolar, false, true, m_bInitBL, pAnalysis->bFromZero);
 
-        //take the last analysis in the array
-        pAnalysis = (FoilAnalysis*)m_AnalysisPair.at(m_AnalysisPair.size()-1);
+    //launch it
+    strong = tr("Starting ")+pAnalysis->pFoil->foilName()+" / "+pAnalysis->pPolar->polarName();
+    if(pAnalysis->bSplit) strong += QString(tr(" from %1 to %2")).arg(pAnalysis->vMin, 0, 'f', 3).arg(pAnalysis->vMax, 0, 'f', 3);
+    strong += "\n";
+    updateOutput(strong);
+
+    pXFoilTask->setStealable(true);
+    m_nRunning++;
+    QThreadPool::globalInstance()->start(pXFoilTask);
+}
 
-        pAnalysis->pPolar->setVisible(true);
 
-        //initiate the task
-        if(m_bAlpha) pXFoilTask->setSequence(true,  m_AlphaMin, m_AlphaMax, m_AlphaInc);
-        else         pXFoilTask->setSequence(false, m_ClMin, m_ClMax, m_ClInc);
+/**
+ * Ends the analysis, once all the tasks are finished or when the user has cancelled the analysis.
+ */
+void BatchThreadDlg::endAnalysis()
+{
+    QString strong;
 
+    QThreadPool::globalInstance()->waitForDone();
+    drainResults();
 
-        pXFoilTask->initializeTask(pAnalysis->pFoil, pAnalysis->pPolar, false, true, m_bInitBL, m_bFromZero);
+    if(m_bCancel) strong = tr("\n_____Analysis cancelled_____\n");
+    else          strong = tr("\n_____Analysis completed_____\n");
+    m_pctrlTextOutput->insertPlainText(strong);
+    m_pctrlTextOutput->ensureCursorVisible();
 
-        //launch it
-        m_nTaskStarted++;
-        strong = tr("Starting ")+pAnalysis->pFoil->foilName()+" / "+pAnalysis->pPolar->polarName()+"\n";
-        updateOutput(strong);
-        QThreadPool::globalInstance()->start(pXFoilTask);
+    cleanUp();
 
-        //remove it from the array of pairs to analyze
-        pAnalysis = m_AnalysisPair.last();
-        m_AnalysisPair.removeLast();
-        delete pAnalysis;
+    if(s_pXDirect->m_bPolarView && s_bUpdatePolarView)
+    {
+        s_pXDirect->createPolarCurves();
+        s_pXDirect->updateView();
     }
 }
 
+
 void BatchThreadDlg::customEvent(QEvent * event)
 {
     // When we get here, we've crossed the thread boundary and are now
@@ -1061,24 +1127,56 @@ void BatchThreadDlg::customEvent(QEvent * event)
         XFoilOppEvent *pOppEvent = (XFoilOppEvent*)event;
         Objects2d::addOpPoint(pOppEvent->foilPtr(), pOppEvent->polarPtr(), pOppEvent->oppPtr(), XDirect::s_bStoreOpp);
     }
+    else if(event->type() == XFOIL_RESULTS_EVENT)
+    {
+        drainResults();
+    }
+}
+
+
+/**
+ * Adds the operating points waiting in the result queue to the polars and to the array of operating points.
+ */
+void BatchThreadDlg::drainResults()
+{
+    QVector<XFoilResult> results;
+    if(m_pResultQueue->drain(results))
+        Objects2d::addOpPoints(results, XDirect::s_bStoreOpp);
 }
 
 
 
 void BatchThreadDlg::handleXFoilTaskEvent(const XFoilTaskEvent *event)
 {
+    // the task has pushed the points of the polar before posting this event
+    drainResults();
+
     // Now we can safely do something with our Qt objects.
-    m_nTaskDone++; //one down, more to go
-    QString str = tr("   ...Finished ")+ ((Foil*)event->foilPtr())->foilName()+" / "
-            +((Polar*)event->polarPtr())->polarName()+"\n";
-    updateOutput(str);
+    // the event may arrive after the analysis has been cancelled
+    if(!m_bIsRunning) return;
 
+    if(event->isTaskEnd()) m_nRunning--;
 
-    if(s_bUpdatePolarView)
+    // a polar is finished once all the tasks which share its sequence are finished
+    Polar *pPolar = event->polarPtr();
+    if(--m_PolarTasks[pPolar]<=0)
     {
-        s_pXDirect->createPolarCurves();
-        s_pXDirect->updateView();
+        m_nTaskDone++; //one down, more to go
+        QString str = tr("   ...Finished ")+ ((Foil*)event->foilPtr())->foilName()+" / "
+                +pPolar->polarName()+"\n";
+        updateOutput(str);
+
+        if(s_bUpdatePolarView)
+        {
+            s_pXDirect->createPolarCurves();
+            s_pXDirect->updateView();
+        }
     }
+
+    // keep the threads busy
+    if(event->isTaskEnd()) startJobs();
+
+    if(m_nRunning<=0) endAnalysis();
 }
 
 
@@ -1155,6 +1253,7 @@ void BatchThreadDlg::onAdvancedSettings()
     xfaDlg.m_bAutoInitBL = XFoilTask::s_bAutoInitBL;
     xfaDlg.m_VAccel      = XFoil::VAccel();
     xfaDlg.m_bFullReport = XFoil::fullReport();
+    xfaDlg.m_bAdaptiveStep = XFoilTask::s_bAdaptiveStep;
     xfaDlg.initDialog();
 
     if (QDialog::Accepted == xfaDlg.exec())
@@ -1163,6 +1262,7 @@ void BatchThreadDlg::onAdvancedSettings()
         XFoil::setFullReport(xfaDlg.m_bFullReport);
         XFoilTask::s_bAutoInitBL  = xfaDlg.m_bAutoInitBL;
         XFoilTask::s_IterLim      = xfaDlg.m_IterLimit;
+        XFoilTask::s_bAdaptiveStep = xfaDlg.m_bAdaptiveStep;
     }
 }
 
@@ -1173,6 +1273,12 @@ void BatchThreadDlg::onUpdatePolarView()
 }
 
 
+void BatchThreadDlg::onWarmStart()
+{
+    s_bWarmStart = m_pctrlWarmStart->isChecked();
+}
+
+
 
 
 
@@ -33,6 +33,7 @@
 #include <QLabel>
 #include <QRadioButton>
 #include <QTextEdit>
+#include <QHash>
 
 #include <analysis3d/analysis3d_enums.h>
 
@@ -42,11 +43,19 @@ class IntEdit;
 class DoubleEdit;
 class XFoilTask;
 class XFoilTaskEvent;
+class XFoilResultQueue;
 struct FoilAnalysis;
 class XDirect;
 
 /**
  * @brief This class implements an interface to perform a multi-threaded batch foil analysis.
+
+    The pairs of foil and polar are started by decreasing estimated cost, as many at a time as there are threads.
+    A new task is started each time a task posts its last event, so that the threads are not left idle.
+    Once no pair is pending, an idle thread takes part of the work left to the running tasks: the second half of
+    the polars of a chain, or the tail of a polar's aoa or Cl sequence.
+    The tasks push their operating points to a lock-free queue, which is drained in batches when a polar is finished
+    or when the queue notifies the dialog that results are waiting.
  */
 class BatchThreadDlg : public QDialog
 {
@@ -78,7 +87,9 @@ private:
     void setFileHeader();
     void setPlrName(Polar *pNewPolar);
     void startAnalysis();
-    void startThread();
+    void startJobs();
+    void startTask(FoilAnalysis *pAnalysis);
+    void endAnalysis();
     void updateOutput(QString &str);
     void writeString(QString &strong);
 
@@ -87,6 +98,7 @@ protected:
 
 private:
     void handleXFoilTaskEvent(const XFoilTaskEvent *event);
+    void drainResults();
 
 private slots:
     void onSpecChanged();
@@ -100,8 +112,8 @@ private slots:
     void onFoilList();
     void onFoilSelectionType();
     void onAdvancedSettings();
-    void onTimerEvent();
     void onUpdatePolarView();
+    void onWarmStart();
 
 
 private:
@@ -116,7 +128,7 @@ private:
     IntEdit *m_pctrlMaxThreads;
     QLabel *m_pctrlSpecVar;
     QLabel *m_pctrlMaType, *m_pctrlReType;
-    QCheckBox *m_pctrlInitBL, *m_pctrlFromZero, *m_pctrlUpdatePolarView;
+    QCheckBox *m_pctrlInitBL, *m_pctrlFromZero, *m_pctrlUpdatePolarView, *m_pctrlWarmStart;
 
     QPushButton *m_pctrlClose, *m_pctrlAnalyze;
     QTextEdit *m_pctrlTextOutput;
@@ -124,6 +136,7 @@ private:
     static XDirect* s_pXDirect;           /**< a void pointer to the unique instance of the QXDirect class */
     static bool s_bCurrentFoil;        /**< true if the analysis should be performed only for the current foil */
     static bool s_bUpdatePolarView;    /**< true if the polar graphs should be updated during the analysis */
+    static bool s_bWarmStart;          /**< true if the polars of a foil should be analyzed in chains of increasing Re, each starting from the BL of the previous one */
     static QPoint s_Position;          /**< the position on the client area of the dialog's topleft corner */
     static int s_nThreads;             /**< the number of available threads */
 
@@ -150,6 +163,7 @@ private:
     int m_nAnalysis;            /**< the number of analysis pairs to run */
     int m_nTaskStarted;         /**< the number of started tasks */
     int m_nTaskDone;            /**< the number of finished tasks */
+    int m_nRunning;             /**< the number of running tasks */
     double m_Mach;              /**< the Mach number used if not from the list of Re numbers */
     double m_ACrit;             /**< the transition criterion used if not from the list of Re numbers */
 
@@ -157,16 +171,17 @@ private:
     double m_XBot;            /**< the point of forced transition on the lower surface */
 
 
-    QVector<FoilAnalysis *> m_AnalysisPair;  /**< the list of all analysis to be performed. Once performed, an analysis is removed from the list. */
+    QVector<FoilAnalysis *> m_AnalysisPair;  /**< the list of all analysis to be performed, by increasing estimated cost. Once started, an analysis is removed from the list. */
+    QHash<Polar*, int> m_PolarTasks;         /**< the number of tasks which analyze each polar and have not finished it */
     //    XFoilTask *m_pXFoilTask;           /**< the task for a thread */
 
+    XFoilResultQueue *m_pResultQueue;  /**< the queue through which the tasks hand their operating points */
+
     QFile *m_pXFile;                   /**< a pointer to the output log file */
 
     Foil *m_pCurFoil;                  /**< a pointer to the current Foil */
 
     QStringList m_FoilList;            /**< the list of foils to analyze */
-
-    QTimer *m_pTimer;
 };
 
 #endif // BATCHTHREADDLG_H
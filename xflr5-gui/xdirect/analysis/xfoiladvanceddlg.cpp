@@ -33,6 +33,7 @@ XFoilAdvancedDlg::XFoilAdvancedDlg(QWidget *pParent) : QDialog(pParent)
     m_VAccel = 0.001;
     m_bAutoInitBL = true;
     m_bFullReport = false;
+    m_bAdaptiveStep = false;
 
     connect(m_pctrlDefaults, SIGNAL(clicked()), SLOT(OnDefaults()));
     connect(OKButton, SIGNAL(clicked()),this, SLOT(OnOK()));
@@ -68,6 +69,9 @@ void XFoilAdvancedDlg::SetupLayout()
     m_pctrlInitBL = new QCheckBox(tr("Re-initialize BLs after an unconverged iteration"));
     m_pctrlFullReport = new QCheckBox(tr("Show full log report for an XFoil analysis"));
     m_pctrlKeepErrorsOpen = new QCheckBox(tr("Keep Xfoil interface open if analysis errors"));
+    m_pctrlAdaptiveStep = new QCheckBox(tr("Adaptive step for the aoa and Cl sequences"));
+    m_pctrlAdaptiveStep->setToolTip(tr("Start each point from the BL extrapolated from the two previous points,\n"
+                                       "and bisect the step towards the next point when the iterations do not converge"));
 
     QHBoxLayout *pTimerLayout = new QHBoxLayout;
     {
@@ -103,6 +107,7 @@ void XFoilAdvancedDlg::SetupLayout()
         pMainLayout->addWidget(m_pctrlInitBL);
         pMainLayout->addWidget(m_pctrlFullReport);
         pMainLayout->addWidget(m_pctrlKeepErrorsOpen);
+        pMainLayout->addWidget(m_pctrlAdaptiveStep);
         pMainLayout->addLayout(pTimerLayout);
         pMainLayout->addStretch();
         pMainLayout->addSpacing(15);
@@ -119,6 +124,7 @@ void XFoilAdvancedDlg::OnDefaults()
     m_VAccel = 0.001;
     m_bAutoInitBL = true;
     m_bFullReport = false;
+    m_bAdaptiveStep = false;
     XDirect::s_bKeepOpenErrors = true;
     XDirect::s_TimeUpdateInterval = 100;
     initDialog();
@@ -131,6 +137,7 @@ void XFoilAdvancedDlg::initDialog()
     m_pctrlInitBL->setChecked(m_bAutoInitBL);
     m_pctrlIterLimit->setValue(m_IterLimit);
     m_pctrlFullReport->setChecked(m_bFullReport);
+    m_pctrlAdaptiveStep->setChecked(m_bAdaptiveStep);
     m_pctrlKeepErrorsOpen->setChecked(XDirect::s_bKeepOpenErrors);
     m_pctrlTimerInterval->setValue(XDirect::s_TimeUpdateInterval);
 }
@@ -173,6 +180,7 @@ void XFoilAdvancedDlg::OnOK()
     m_VAccel = m_pctrlVAccel->value();
     m_bAutoInitBL = m_pctrlInitBL->isChecked();
     m_bFullReport = m_pctrlFullReport->isChecked();
+    m_bAdaptiveStep = m_pctrlAdaptiveStep->isChecked();
     XDirect::s_TimeUpdateInterval = m_pctrlTimerInterval->value();
     XDirect::s_bKeepOpenErrors = m_pctrlKeepErrorsOpen->isChecked();
     done(1);
@@ -54,7 +54,7 @@ private slots:
 private:
     void keyPressEvent(QKeyEvent *event);
     void SetupLayout();
-    QCheckBox *m_pctrlInitBL, *m_pctrlFullReport;
+    QCheckBox *m_pctrlInitBL, *m_pctrlFullReport, *m_pctrlAdaptiveStep;
     IntEdit *m_pctrlIterLimit, *m_pctrlTimerInterval;
     DoubleEdit * m_pctrlVAccel;
     QPushButton *OKButton, *CancelButton, *m_pctrlDefaults;
@@ -65,6 +65,7 @@ private:
     double m_VAccel;
     bool m_bAutoInitBL;
     bool m_bFullReport;
+    bool m_bAdaptiveStep;
 
 };
 
@@ -203,8 +203,7 @@ void XFoilAnalysisDlg::initDialog()
 
 void XFoilAnalysisDlg::onCancelAnalysis()
 {
-    XFoil::setCancel(true);
-    XFoilTask::s_bCancel = true;
+    m_pXFoilTask->cancel();
 
     if(m_pXFoilTask->isFinished()) reject();
 }
@@ -215,13 +214,11 @@ void XFoilAnalysisDlg::reject()
 {
     if(!m_pXFoilTask->isFinished())
     {
-        XFoil::setCancel(true);
-        XFoilTask::s_bCancel = true;
+        m_pXFoilTask->cancel();
         return;
     }
 
-    XFoilTask::s_bCancel = true;
-    XFoil::setCancel(true);
+    m_pXFoilTask->cancel();
     if(m_pXFile)
     {
         m_pXFoilTask->m_OutStream.flush();
@@ -234,8 +231,7 @@ void XFoilAnalysisDlg::reject()
 
 void XFoilAnalysisDlg::accept()
 {
-    XFoilTask::s_bCancel = true;
-    XFoil::setCancel(true);
+    m_pXFoilTask->cancel();
     if(m_pXFile)
     {
         m_pXFoilTask->m_OutStream.flush();
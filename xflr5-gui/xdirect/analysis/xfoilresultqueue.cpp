@@ -0,0 +1,129 @@
+/****************************************************************************
+
+    XFoilResultQueue Class
+       Copyright (C) 2011-2017 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+#include <QCoreApplication>
+#include "xfoilresultqueue.h"
+#include "xfoiltaskevent.h"
+
+#include <objects/objects2d/oppoint.h>
+
+
+/**
+* The public constructor
+* @param pReceiver the object to which the events are posted when results are available, or NULL if the queue is polled
+* @param capacity the number of operating points which the queue can hold before a push fails
+*/
+XFoilResultQueue::XFoilResultQueue(QObject *pReceiver, int capacity)
+{
+    quint32 size = 2;
+    while(size<quint32(capacity)) size *= 2;
+
+    m_Slot = new Slot[size];
+    for(quint32 i=0; i<size; i++) m_Slot[i].sequence.store(i);
+    m_Mask = size-1;
+
+    m_Tail.store(0);
+    m_Head = 0;
+    m_bNotified.store(0);
+    m_pReceiver = pReceiver;
+}
+
+
+/**
+* The destructor. Deletes the operating points which have not been drained.
+*/
+XFoilResultQueue::~XFoilResultQueue()
+{
+    clear();
+    delete [] m_Slot;
+}
+
+
+/**
+* Appends an operating point to the queue. May be called concurrently by any number of threads.
+* If the queue was empty, posts an XFOIL_RESULTS_EVENT to the receiver.
+* @return false if the queue is full, in which case the ownership of the operating point stays with the caller.
+*/
+bool XFoilResultQueue::push(Foil *pFoil, Polar *pPolar, OpPoint *pOpPoint)
+{
+    Slot *pSlot = nullptr;
+    quint32 pos = m_Tail.loadAcquire();
+    while(true)
+    {
+        pSlot = m_Slot + (pos & m_Mask);
+        qint32 dif = qint32(pSlot->sequence.loadAcquire() - pos);
+        if(dif==0)
+        {
+            // the slot is free, try to claim it
+            if(m_Tail.testAndSetOrdered(pos, pos+1)) break;
+            pos = m_Tail.loadAcquire();
+        }
+        else if(dif<0) return false; // the slot still holds the result pushed one lap earlier
+        else pos = m_Tail.loadAcquire(); // another producer has claimed the slot
+    }
+
+    pSlot->result.pFoil    = pFoil;
+    pSlot->result.pPolar   = pPolar;
+    pSlot->result.pOpPoint = pOpPoint;
+    pSlot->sequence.storeRelease(pos+1);
+
+    if(m_pReceiver && m_bNotified.testAndSetOrdered(0, 1))
+        qApp->postEvent(m_pReceiver, new QEvent(XFOIL_RESULTS_EVENT));
+
+    return true;
+}
+
+
+/**
+* Moves the results available in the queue to the end of the array. Must be called by the consumer's thread only.
+* The results are in the order in which their slots were claimed.
+* @param results the array to which the results are appended
+* @return the number of results which have been drained.
+*/
+int XFoilResultQueue::drain(QVector<XFoilResult> &results)
+{
+    // let the next push notify the receiver again; this must be visible before the slots are read
+    m_bNotified.fetchAndStoreOrdered(0);
+
+    int n = 0;
+    while(true)
+    {
+        Slot *pSlot = m_Slot + (m_Head & m_Mask);
+        if(pSlot->sequence.loadAcquire()!=m_Head+1) break;
+
+        results.append(pSlot->result);
+        pSlot->sequence.storeRelease(m_Head+m_Mask+1);
+        m_Head++;
+        n++;
+    }
+    return n;
+}
+
+
+/**
+* Deletes the operating points which are left in the queue. Must be called by the consumer's thread only.
+*/
+void XFoilResultQueue::clear()
+{
+    QVector<XFoilResult> results;
+    drain(results);
+    for(int i=0; i<results.size(); i++) delete results.at(i).pOpPoint;
+}
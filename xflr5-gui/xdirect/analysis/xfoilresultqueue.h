@@ -0,0 +1,89 @@
+/****************************************************************************
+
+    XFoilResultQueue Class
+       Copyright (C) 2011-2017 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+/** @file This file implements the channel through which the XFoil tasks hand their operating points to the main thread. */
+
+#ifndef XFOILRESULTQUEUE_H
+#define XFOILRESULTQUEUE_H
+
+#include <QAtomicInteger>
+#include <QVector>
+
+#define RESULTQUEUESIZE 4096   /**< the default number of operating points which the queue can hold; rounded up to a power of 2 */
+
+class QObject;
+class Foil;
+class Polar;
+class OpPoint;
+
+
+/**
+ * @struct XFoilResult an operating point calculated by a task, with the foil and the polar to which it belongs.
+ */
+struct XFoilResult
+{
+    Foil *pFoil;        /**< a pointer to the analyzed Foil */
+    Polar *pPolar;      /**< a pointer to the Polar to which the operating point should be added */
+    OpPoint *pOpPoint;  /**< the operating point; ownership is passed to the consumer of the queue */
+};
+
+
+/**
+*@class XFoilResultQueue
+* A bounded lock-free queue, filled by any number of XFoil tasks and emptied by the thread which owns the receiver.
+*
+* Each slot holds a sequence number which tells whether it is free for the next push or ready for the next pop,
+* so that the producers only contend on the index of the next free slot, and never on a lock or on the event loop.
+* Once the queue holds results, the producers post a single XFOIL_RESULTS_EVENT to the receiver, which is not
+* posted again until the receiver has drained the queue. The receiver thus handles the results in batches,
+* however many operating points the tasks produce.
+*
+* A push fails when the queue is full; the caller is then expected to hand its result by other means.
+*/
+class XFoilResultQueue
+{
+public:
+    XFoilResultQueue(QObject *pReceiver, int capacity=RESULTQUEUESIZE);
+    ~XFoilResultQueue();
+
+    bool push(Foil *pFoil, Polar *pPolar, OpPoint *pOpPoint);
+    int drain(QVector<XFoilResult> &results);
+    void clear();
+
+    int capacity() const {return m_Mask+1;}
+
+private:
+    /** @struct a cell of the ring buffer */
+    struct Slot
+    {
+        QAtomicInteger<quint32> sequence;  /**< equal to the position of the next push in this slot if the slot is free, or to the position+1 if it holds a result */
+        XFoilResult result;
+    };
+
+    Slot *m_Slot;                      /**< the ring buffer */
+    quint32 m_Mask;                    /**< the size of the ring buffer minus 1 */
+    QAtomicInteger<quint32> m_Tail;    /**< the position of the next push, shared by the producers */
+    quint32 m_Head;                    /**< the position of the next pop, used by the consumer only */
+    QAtomicInt m_bNotified;            /**< non-zero if an event has been posted to the receiver and has not been handled yet */
+    QObject *m_pReceiver;              /**< the object to which the events are posted */
+};
+
+#endif // XFOILRESULTQUEUE_H
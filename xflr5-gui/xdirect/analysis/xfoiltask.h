@@ -25,12 +25,20 @@
 #define XFOILTASK_H
 
 #include <QRunnable>
+#include <QAtomicInt>
+#include <QMutex>
 
 #include "xfoil.h"
+#include "xfoilresultqueue.h"
 
 #include <objects/objects2d/polar.h>
 #include <objects/objects2d/foil.h>
 
+#define MAXBISECTIONS 4          /**< the max number of times the step towards a point of an adaptive sequence is halved */
+#define SEQUENCEPRECISION 1.e-6  /**< the values of aoa or Cl of a sequence closer than this are considered equal */
+#define STALLSLOPERATIO 0.5      /**< the ratio of the lift slope to the slope at the start of an adaptive sequence below which the steps are halved ahead of the stall */
+#define MINSTEALPOINTS 3         /**< the min number of points of a sequence which are taken from a running task, and which are left to it */
+
 
 
 /**
@@ -40,7 +48,11 @@ struct FoilAnalysis
 {
     Foil *pFoil;            /**< a pointer to the Foil to be analyzed by the thread */
     Polar *pPolar;          /**< a pointer to the polar to be analyzed by the thread */
-    double vMin, vMax, vInc;
+    double vMin, vMax, vInc;   /**< the range of aoa or Cl to analyze */
+    bool bFromZero;         /**< true if the aoa sequence should start from 0 */
+    bool bSplit;            /**< true if the range is the tail of a polar's sequence, the rest of the polar being analyzed by another task */
+    double cost;            /**< the estimated cost of the analysis, used to start the longest analyses first */
+    QVector<Polar*> nextPolar; /**< the polars of the same foil at the next Reynolds numbers, analyzed by the same thread with a warm-started BL */
 };
 
 // this class runs an XFoil analysis in a thread separate from the main thread
@@ -58,8 +70,15 @@ public:
 public:
     void run();
     bool alphaSequence();
+    bool adaptiveSeries(double SpMin, double SpInc, bool bFirstSeries);
+    bool solvePoint(double value);
+    void outputPoint();
+    void postOpPoint(OpPoint *pOpPoint);
     bool ReSequence();
     bool isFinished(){return m_bIsFinished;}
+    bool isCancelled() const {return s_bCancel.loadAcquire() || m_bCancel.loadAcquire();}
+    void cancel();
+    static void setCancel(bool bCancel) {s_bCancel.storeRelease(bCancel ? 1 : 0);}
 
     bool initializeTask(FoilAnalysis *pFoilAnalysis, bool bStoreOpp, bool bViscous=true, bool bInitBL=true, bool bFromZero=false);
     bool initializeTask(Foil *pFoil, Polar *pPolar, bool bStoreOpp, bool bViscous=true, bool bInitBL=true, bool bFromZero=false);
@@ -67,8 +86,15 @@ public:
 
     void setSequence(double bAlpha, double SpMin, double SpMax, double SpInc);
     void setReRange(double ReMin, double ReMax, double ReInc);
+    void appendPolar(Polar *pPolar) {m_NextPolar.append(pPolar);}
+    void setResultQueue(XFoilResultQueue *pResultQueue) {m_pResultQueue = pResultQueue;}
     void traceLog(QString str);
 
+    void setStealable(bool bStealable);
+    static bool stealWork(FoilAnalysis *pAnalysis);
+    static double pointCost(Foil const *pFoil, Polar const *pPolar);
+    static bool canWarmStart(Polar const *pFromPolar, Polar const *pToPolar);
+
     void setGraphPointers(QVarLengthArray<double, 1024> *x0, QVarLengthArray<double, 1024> *y0, QVarLengthArray<double, 1024> *x1,QVarLengthArray<double, 1024> *y1)
     {
         m_x0 = x0;
@@ -80,12 +106,13 @@ public:
     void addXFoilData(OpPoint *pOpp, XFoil *pXFoil, Foil *pFoil);
 
     static bool s_bSkipPolar;
-    static bool s_bCancel;          /**< true if the user has asked to cancel the analysis */
     static bool s_bAutoInitBL;      /**< true if the BL initialization is left to the code's decision */
-    static int s_IterLim;
+    static bool s_bAdaptiveStep;    /**< true if the aoa and Cl sequences are marched with an adaptive step, false if each point is started from the previous one */
+    static int s_IterLim;           /**< the default max number of iterations, copied to the task when it is initialized */
     static bool s_bSkipOpp;
 
     int m_Iterations;          /**< The number of iterations already performed */
+    int m_IterLim;             /**< The max number of iterations of this task */
     bool m_bIsFinished;        /**< true if the calculation is over */
     XFoil m_XFoilInstance;     /**< An instance of the XFoil class specific for this object */
 
@@ -108,9 +135,39 @@ public:
 
     QVector<OpPoint*> m_OppList;
 
+    QVector<Polar*> m_NextPolar; /**< the polars to analyze after the current one, in the order of the Reynolds numbers */
+    blState m_BLState;           /**< the BL solution at the first point of the current polar, used to start the next polar */
+    bool m_bBLState;             /**< true if m_BLState holds a converged solution of the current polar */
+    bool m_bWarmStart;           /**< true if the current polar starts from the BL solution of the previous polar */
+
     void *m_pParent;
+    XFoilResultQueue *m_pResultQueue;  /**< the queue to which the operating points are pushed, or NULL if they are posted to the parent one event at a time */
 
 private:
+    /** @struct one series of an aoa or Cl sequence, marched from a single start of the BL */
+    struct Series
+    {
+        double vMin, vInc;  /**< the first value and the increment of the series */
+        int last;           /**< the index of the last point of the series */
+    };
+
+    void setSeries();
+    bool claimPoint(int ia);
+    bool splitWork(FoilAnalysis *pAnalysis);
+    double workLeft() const;
+
+    static QAtomicInt s_bCancel;   /**< non-zero if the user has asked to cancel all the running tasks */
+    QAtomicInt m_bCancel;          /**< non-zero if the user has asked to cancel this task only */
+
+    static QMutex s_StealMutex;              /**< protects the list of the tasks from which work can be stolen */
+    static QVector<XFoilTask*> s_StealTask;  /**< the running tasks from which work can be stolen */
+
+    mutable QMutex m_WorkMutex;  /**< protects the work left to this task, i.e. the series, the next polars and the current polar */
+    QVector<Series> m_Series;    /**< the series of the current polar's sequence; the tail of the series may be taken by other tasks */
+    int m_iSeries;               /**< the index of the series in progress */
+    int m_iPoint;                /**< the index in the series of the point in progress, or -1 if the series has not been started */
+    double m_PointCost;          /**< the estimated cost of one point of the current polar */
+
     Foil *m_pFoil;           /**< A pointer to the instance of the Foil object for which the calculation is performed */
     Polar *m_pPolar;         /**< A pointer to the instance of the Polar object for which the calculation is performed */
 };
@@ -29,6 +29,7 @@
 // Custom event identifier
 const QEvent::Type XFOIL_END_TASK_EVENT = static_cast<QEvent::Type>(QEvent::User + 1);
 const QEvent::Type XFOIL_END_OPP_EVENT = static_cast<QEvent::Type>(QEvent::User + 2);
+const QEvent::Type XFOIL_RESULTS_EVENT = static_cast<QEvent::Type>(QEvent::User + 5);  /**< posted by an XFoilResultQueue when results are waiting */
 
 class Foil;
 class Polar;
@@ -38,18 +39,21 @@ class XFoilTaskEvent : public QEvent
 {
 
 public:
-    XFoilTaskEvent(Foil *pFoil, Polar *pPolar): QEvent(XFOIL_END_TASK_EVENT),
+    XFoilTaskEvent(Foil *pFoil, Polar *pPolar, bool bTaskEnd=true): QEvent(XFOIL_END_TASK_EVENT),
         m_pFoil(pFoil),
-        m_pPolar(pPolar)
+        m_pPolar(pPolar),
+        m_bTaskEnd(bTaskEnd)
     {
     }
 
     Foil * foilPtr() const    {return m_pFoil;}
     Polar * polarPtr() const    {return m_pPolar;}
+    bool isTaskEnd() const {return m_bTaskEnd;}
 
 private:
     Foil *m_pFoil=nullptr;
     Polar *m_pPolar=nullptr;
+    bool m_bTaskEnd=true;   /**< true if this is the last polar analyzed by the task */
 };
 
 
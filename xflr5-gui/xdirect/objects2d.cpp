@@ -23,10 +23,13 @@
 #include "objects2d.h"
 
 #include <xdirect/xdirect.h>
+#include <xdirect/analysis/xfoilresultqueue.h>
 #include <globals/globals.h>
 #include <misc/options/settings.h>
 #include <QDebug>
 
+#include <algorithm>
+
 #define PI 3.141592654
 
 QVector<Foil*>    Objects2d::s_oaFoil;
@@ -210,18 +213,7 @@ OpPoint* Objects2d::addOpPoint(Foil *pFoil, Polar *pPolar, OpPoint *pOpPoint, bo
     if(!pPolar) pPolar = XDirect::curPolar();
     if(!pPolar) return nullptr;
 
-    if(Settings::isAlignedChildrenStyle())
-    {
-        pOpPoint->m_Style = pPolar->m_Style;
-        pOpPoint->m_Width = pPolar->m_Width;
-        pOpPoint->setColor(pPolar->m_red, pPolar->m_green, pPolar->m_blue, pPolar->alphaChannel());
-        pOpPoint->m_PointStyle = pPolar->m_PointStyle;
-    }
-    else
-    {
-        QColor clr = randomColor(!Settings::isLightTheme());
-        pOpPoint->setColor(clr.red(), clr.green(), clr.black(), clr.alpha());
-    }
+    setOppStyle(pOpPoint, pPolar);
 
 
     if(pOpPoint ==nullptr)
@@ -264,6 +256,71 @@ OpPoint* Objects2d::addOpPoint(Foil *pFoil, Polar *pPolar, OpPoint *pOpPoint, bo
 }
 
 
+/**
+ * Adds a batch of operating points calculated by the XFoil tasks.
+ * Has the same effect as calling addOpPoint() for each point in turn, but the points are stored in the array
+ * of operating points by a single merge, so that the cost does not grow with the product of the size of the batch
+ * and the number of points already stored.
+ * @param results the operating points, with their foil and polar; the ownership of the points is passed to this class
+ * @param bStoreOpp true if the operating points should be stored, false if only their data should be added to the polars
+ */
+void Objects2d::addOpPoints(QVector<XFoilResult> const &results, bool bStoreOpp)
+{
+    QVector<OpPoint*> newOpp;
+    if(bStoreOpp) newOpp.reserve(results.size());
+
+    for(int i=0; i<results.size(); i++)
+    {
+        Foil *pFoil       = results.at(i).pFoil;
+        Polar *pPolar     = results.at(i).pPolar;
+        OpPoint *pOpPoint = results.at(i).pOpPoint;
+        if(!pOpPoint) continue;
+
+        if(!pPolar) pPolar = XDirect::curPolar();
+        if(!pFoil || !pPolar)
+        {
+            delete pOpPoint;
+            continue;
+        }
+
+        setOppStyle(pOpPoint, pPolar);
+        pOpPoint->foilName()  = pFoil->foilName();
+        pOpPoint->polarName() = pPolar->polarName();
+
+        if(pPolar->polarType()==XFLR5::FIXEDLIFTPOLAR || pPolar->polarType()==XFLR5::RUBBERCHORDPOLAR)
+        {
+            if(pOpPoint->Reynolds()<1.00e8) pPolar->addOpPointData(pOpPoint);
+        }
+        else pPolar->addOpPointData(pOpPoint);
+
+        if(bStoreOpp) newOpp.append(pOpPoint);
+        else          delete pOpPoint;
+    }
+
+    insertOpPoints(newOpp);
+}
+
+
+/**
+ * Sets the style of a new OpPoint, either from its parent Polar or at random.
+ */
+void Objects2d::setOppStyle(OpPoint *pOpPoint, Polar *pPolar)
+{
+    if(Settings::isAlignedChildrenStyle())
+    {
+        pOpPoint->m_Style = pPolar->m_Style;
+        pOpPoint->m_Width = pPolar->m_Width;
+        pOpPoint->setColor(pPolar->m_red, pPolar->m_green, pPolar->m_blue, pPolar->alphaChannel());
+        pOpPoint->m_PointStyle = pPolar->m_PointStyle;
+    }
+    else
+    {
+        QColor clr = randomColor(!Settings::isLightTheme());
+        pOpPoint->setColor(clr.red(), clr.green(), clr.black(), clr.alpha());
+    }
+}
+
+
 
 
 /**
@@ -581,6 +638,109 @@ void Objects2d::insertOpPoint(OpPoint *pNewPoint)
 }
 
 
+/**
+ * Returns true if the two OpPoints have the same foil, Re, aoa and transition settings,
+ * in which case the second replaces the first in the array.
+ */
+bool Objects2d::isSameOpPoint(OpPoint *pOpp0, OpPoint *pOpp1)
+{
+    return pOpp0->foilName()==pOpp1->foilName() &&
+           fabs(pOpp0->Reynolds()-pOpp1->Reynolds())<1.0 &&
+           fabs(pOpp0->aoa() - pOpp1->aoa())<0.005 &&
+           fabs(pOpp0->ACrit-pOpp1->ACrit)<0.1 &&
+           fabs(pOpp0->Xtr1-pOpp1->Xtr1)<0.001 &&
+           fabs(pOpp0->Xtr2-pOpp1->Xtr2)<0.001;
+}
+
+
+/**
+ * Returns true if the first OpPoint is ranked before the second in the array,
+ * i.e. by FoilName first, then by increasing Re number, then by decreasing aoa, as in insertOpPoint().
+ */
+bool Objects2d::isOpPointBefore(OpPoint *pOpp0, OpPoint *pOpp1)
+{
+    int cmp = pOpp0->foilName().compare(pOpp1->foilName());
+    if(cmp!=0) return cmp<0;
+    if(fabs(pOpp0->Reynolds()-pOpp1->Reynolds())>=1.0) return pOpp0->Reynolds()<pOpp1->Reynolds();
+    return pOpp0->aoa()>pOpp1->aoa();
+}
+
+
+/**
+ * Inserts a batch of new OpPoints in the array, with the same sorting and replacement rules as insertOpPoint().
+ * The batch is sorted and then merged with the array in a single pass.
+ * The OpPoints which do not belong to a Polar of the array are deleted.
+ * @param newOpp the array of new OpPoints, in any order; the ownership of the points is passed to this class
+ */
+void Objects2d::insertOpPoints(QVector<OpPoint*> &newOpp)
+{
+    if(!newOpp.size()) return;
+
+    // discard the points of unknown polars; the polars of a batch are few, so remember the last one checked
+    QString lastFoilName, lastPolarName;
+    bool bKnown = false;
+    int n=0;
+    for(int i=0; i<newOpp.size(); i++)
+    {
+        OpPoint *pOpp = newOpp.at(i);
+        if(i==0 || pOpp->foilName()!=lastFoilName || pOpp->polarName()!=lastPolarName)
+        {
+            lastFoilName  = pOpp->foilName();
+            lastPolarName = pOpp->polarName();
+            bKnown = getPolar(lastFoilName, lastPolarName)!=nullptr;
+        }
+        if(bKnown) newOpp[n++] = pOpp;
+        else       delete pOpp;
+    }
+    newOpp.resize(n);
+
+    // the stable sort keeps the points of the batch in the order of their arrival,
+    // so that a point calculated twice is replaced by its latest result
+    std::stable_sort(newOpp.begin(), newOpp.end(), isOpPointBefore);
+    n=0;
+    for(int i=0; i<newOpp.size(); i++)
+    {
+        if(n>0 && isSameOpPoint(newOpp.at(n-1), newOpp.at(i)))
+        {
+            delete newOpp.at(n-1);
+            newOpp[n-1] = newOpp.at(i);
+        }
+        else newOpp[n++] = newOpp.at(i);
+    }
+    newOpp.resize(n);
+
+    QVector<OpPoint*> oaOpp;
+    oaOpp.reserve(s_oaOpp.size()+newOpp.size());
+    int io=0, in=0;
+    while(io<s_oaOpp.size() && in<newOpp.size())
+    {
+        OpPoint *pOldOpp = s_oaOpp.at(io);
+        OpPoint *pNewOpp = newOpp.at(in);
+        if(isSameOpPoint(pOldOpp, pNewOpp))
+        {
+            //replace existing point
+            if(XDirect::curOpp()==pOldOpp) XDirect::setCurOpp(nullptr);
+            delete pOldOpp;
+            io++;
+        }
+        else if(isOpPointBefore(pNewOpp, pOldOpp))
+        {
+            oaOpp.append(pNewOpp);
+            in++;
+        }
+        else
+        {
+            oaOpp.append(pOldOpp);
+            io++;
+        }
+    }
+    for(; io<s_oaOpp.size(); io++)  oaOpp.append(s_oaOpp.at(io));
+    for(; in<newOpp.size();  in++)  oaOpp.append(newOpp.at(in));
+
+    s_oaOpp.swap(oaOpp);
+}
+
+
 /**
  * Inserts a polar in the array, using the foil name, the polar type, the Re number and the a.o.a. as sorting keys.
  * If a Polar with identical foilname and polar name exists, deletes the old and replaces it.
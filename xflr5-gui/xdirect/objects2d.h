@@ -32,6 +32,7 @@
 class Foil;
 class Polar;
 class OpPoint;
+struct XFoilResult;
 
 class Objects2d
 {
@@ -71,10 +72,12 @@ public:
     static OpPoint*  getOpp(Foil *pFoil, Polar *pPolar, double Alpha);
     static OpPoint*  getFoilOpp(Foil *pFoil, Polar *pPolar, double x);
     static void      insertOpPoint(OpPoint *pNewPoint);
+    static void      insertOpPoints(QVector<OpPoint*> &newOpp);
     static void      appendOpp(OpPoint*pOpp) {s_oaOpp.append(pOpp);}
     static bool      deleteOpp(OpPoint *pOpp);
     static void      deleteOppAt(int index);
     static OpPoint*  addOpPoint(Foil *pFoil, Polar *pPolar, OpPoint *pOpPoint, bool bStoreOpp);
+    static void      addOpPoints(QVector<XFoilResult> const &results, bool bStoreOpp);
 
     static int foilCount() {return s_oaFoil.size();}
     static int polarCount() {return s_oaPolar.size();}
@@ -88,6 +91,10 @@ public:
     static QVector<OpPoint*> * pOAOpp() {return &s_oaOpp;}
 
 private:
+    static void setOppStyle(OpPoint *pOpPoint, Polar *pPolar);
+    static bool isSameOpPoint(OpPoint *pOpp0, OpPoint *pOpp1);
+    static bool isOpPointBefore(OpPoint *pOpp0, OpPoint *pOpp1);
+
     // object arrays
     static QVector<Foil *> s_oaFoil;   /**< The array of pointers to the Foil objects. */
     static QVector<Polar *> s_oaPolar;  /**< The array of pointers to the Polar objects. */
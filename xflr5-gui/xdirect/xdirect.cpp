@@ -1298,10 +1298,12 @@ void XDirect::loadSettings(QSettings &settings)
 
         XFoilTask::s_bAutoInitBL    = settings.value("AutoInitBL").toBool();
         XFoilTask::s_IterLim        = settings.value("IterLim", 100).toInt();
+        XFoilTask::s_bAdaptiveStep  = settings.value("AdaptiveStep", false).toBool();
 
         XFoil::setFullReport(settings.value("FullReport").toBool());
 
         BatchThreadDlg::s_bUpdatePolarView = settings.value("BatchUpdatePolarView", false).toBool();
+        BatchThreadDlg::s_bWarmStart = settings.value("BatchWarmStart", false).toBool();
         BatchThreadDlg::s_nThreads = settings.value("MaxThreads", 12).toInt();
 
         s_RefPolar.setNCrit(settings.value("NCrit").toDouble());
@@ -4115,6 +4117,7 @@ void XDirect::onXFoilAdvanced()
     xfaDlg.m_bAutoInitBL     = XFoilTask::s_bAutoInitBL;
     xfaDlg.m_VAccel      = XFoil::VAccel();
     xfaDlg.m_bFullReport = XFoil::fullReport();
+    xfaDlg.m_bAdaptiveStep = XFoilTask::s_bAdaptiveStep;
     xfaDlg.initDialog();
 
     if (QDialog::Accepted == xfaDlg.exec())
@@ -4123,6 +4126,7 @@ void XDirect::onXFoilAdvanced()
         XFoil::setFullReport(xfaDlg.m_bFullReport);
         XFoilTask::s_bAutoInitBL  = xfaDlg.m_bAutoInitBL;
         XFoilTask::s_IterLim      = xfaDlg.m_IterLimit;
+        XFoilTask::s_bAdaptiveStep = xfaDlg.m_bAdaptiveStep;
     }
 }
 
@@ -4227,9 +4231,11 @@ void XDirect::saveSettings(QSettings &settings)
 
         settings.setValue("AutoInitBL", XFoilTask::s_bAutoInitBL);
         settings.setValue("IterLim", XFoilTask::s_IterLim);
+        settings.setValue("AdaptiveStep", XFoilTask::s_bAdaptiveStep);
         settings.setValue("FullReport", XFoil::fullReport());
 
         settings.setValue("BatchUpdatePolarView", BatchThreadDlg::s_bUpdatePolarView);
+        settings.setValue("BatchWarmStart", BatchThreadDlg::s_bWarmStart);
         settings.setValue("MaxThreads", BatchThreadDlg::s_nThreads);
 
         settings.setValue("VAccel", m_XFoil.VAccel());
@@ -23,6 +23,7 @@ SOURCES += \
     miarex/analysis/editpolardefdlg.cpp \
     miarex/analysis/lltanalysisdlg.cpp \
     miarex/analysis/panelanalysisdlg.cpp \
+    miarex/analysis/planebatchdlg.cpp \
     miarex/analysis/stabpolardlg.cpp \
     miarex/analysis/wadvanceddlg.cpp \
     miarex/analysis/wpolardlg.cpp \
@@ -111,6 +112,7 @@ SOURCES += \
     xdirect/analysis/relistdlg.cpp \
     xdirect/analysis/xfoiladvanceddlg.cpp \
     xdirect/analysis/xfoilanalysisdlg.cpp \
+    xdirect/analysis/xfoilresultqueue.cpp \
     xdirect/analysis/xfoiltask.cpp \
     xdirect/geometry/cadddlg.cpp \
     xdirect/geometry/flapdlg.cpp \
@@ -159,6 +161,7 @@ HEADERS += \
     miarex/analysis/editpolardefdlg.h \
     miarex/analysis/lltanalysisdlg.h \
     miarex/analysis/panelanalysisdlg.h \
+    miarex/analysis/planebatchdlg.h \
     miarex/analysis/stabpolardlg.h \
     miarex/analysis/wadvanceddlg.h \
     miarex/analysis/wpolardlg.h \
@@ -247,6 +250,7 @@ HEADERS += \
     xdirect/analysis/relistdlg.h \
     xdirect/analysis/xfoiladvanceddlg.h \
     xdirect/analysis/xfoilanalysisdlg.h \
+    xdirect/analysis/xfoilresultqueue.h \
     xdirect/analysis/xfoiltask.h \
     xdirect/analysis/xfoiltaskevent.h \
     xdirect/geometry/cadddlg.h \
@@ -0,0 +1,157 @@
+/****************************************************************************
+
+    lu-bench Application
+       Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+#include <analysis3d/matrix.h>
+
+#define LURESIDUALTOLERANCE 1.e-12   /**< the max residual of the solution, relative to the norms of the matrix and of the solution */
+
+
+/**
+* Compares the timings and the results of the blocked and of the scalar LU decompositions
+* for a general random matrix, for which the decompositions interchange rows at most steps,
+* and writes the results to the output stream.
+* @return the max residual of the blocked solution, relative to the norms of the matrix and of the solution
+*/
+static double benchmarkLU(int n, QTextStream &out)
+{
+    QAtomicInt bCancel(0);
+    double progress = 0.0;
+    QElapsedTimer t;
+
+    QVector<double> A(n*n), LU0(n*n), LU1(n*n), B(2*n), X0(2*n), X1(2*n);
+    QVector<int> piv0(n), piv1(n);
+
+    for(int i=0; i<n; i++)
+    {
+        for(int j=0; j<n; j++) A[i*n+j] = double(rand())/double(RAND_MAX) - 0.5;
+        B[i]   = double(rand())/double(RAND_MAX);
+        B[n+i] = double(rand())/double(RAND_MAX);
+    }
+    LU0 = A;
+    LU1 = A;
+
+    t.start();
+    Crout_LU_Decomposition_with_Pivoting_Unblocked(LU0.data(), piv0.data(), n, &bCancel, 0.0, progress);
+    qint64 t0 = t.elapsed();
+
+    t.start();
+    Crout_LU_Decomposition_with_Pivoting(LU1.data(), piv1.data(), n, &bCancel, 0.0, progress);
+    qint64 t1 = t.elapsed();
+
+    QVector<double> B0(B);
+    t.start();
+    Crout_LU_with_Pivoting_Solve(LU0.data(), B0.data(),   piv0.data(), X0.data(),   n, &bCancel);
+    Crout_LU_with_Pivoting_Solve(LU0.data(), B0.data()+n, piv0.data(), X0.data()+n, n, &bCancel);
+    qint64 ts0 = t.elapsed();
+
+    QVector<double> B1(B);
+    t.start();
+    Crout_LU_with_Pivoting_Solve(LU1.data(), B1.data(), piv1.data(), X1.data(), n, 2, &bCancel);
+    qint64 ts1 = t.elapsed();
+
+    // row interchanges made by the blocked decomposition
+    int nSwaps = 0;
+    for(int i=0; i<n; i++)
+        if(piv1[i]!=i) nSwaps++;
+
+    // infinity norm of the matrix
+    double Anorm = 0.0;
+    for(int i=0; i<n; i++)
+    {
+        double rowsum = 0.0;
+        for(int j=0; j<n; j++) rowsum += qAbs(A[i*n+j]);
+        Anorm = qMax(Anorm, rowsum);
+    }
+
+    // relative residual of the blocked solution and relative difference with the scalar solution
+    double resmax=0.0, diffmax=0.0;
+    for(int r=0; r<2; r++)
+    {
+        double res=0.0, xnorm=0.0, diff=0.0;
+        for(int i=0; i<n; i++)
+        {
+            double ri = B[r*n+i];
+            for(int j=0; j<n; j++) ri -= A[i*n+j]*X1[r*n+j];
+            res   = qMax(res,   qAbs(ri));
+            xnorm = qMax(xnorm, qAbs(X1[r*n+i]));
+            diff  = qMax(diff,  qAbs(X1[r*n+i]-X0[r*n+i]));
+        }
+        resmax  = qMax(resmax,  res/(Anorm*xnorm));
+        diffmax = qMax(diffmax, diff/xnorm);
+    }
+
+    out << QString::asprintf("LU n=%5d   scalar: %8.3f s   blocked: %8.3f s   speed-up: %6.2f\n",
+                             n, double(t0)/1000.0, double(t1)/1000.0, double(t0)/qMax(double(t1), 1.0));
+    out << QString::asprintf("   solve 2 RHS   scalar: %8.3f s   multi-RHS: %8.3f s\n",
+                             double(ts0)/1000.0, double(ts1)/1000.0);
+    out << QString::asprintf("   row interchanges: %d\n", nSwaps);
+    out << QString::asprintf("   max relative residual=%11.3g   max relative difference with scalar solution=%11.3g\n", resmax, diffmax);
+    out.flush();
+
+    return resmax;
+}
+
+
+/**
+* The console application's point of entry.
+* The matrix sizes are read from the command line, and default to 1000, 4000 and 10000.
+* Caution: a matrix of size 10000 requires about 2.4GB of memory, and the scalar decomposition takes a while.
+* The correctness checks which are run with "make check" are in the lu-test application.
+*
+* Example: lu-bench 1000 4000 10000
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QVector<int> sizes;
+    QStringList args = app.arguments();
+    for(int i=1; i<args.size(); i++)
+    {
+        bool bOK = false;
+        int n = args.at(i).toInt(&bOK);
+        if(!bOK || n<=0)
+        {
+            QTextStream(stderr) << "Usage: lu-bench [size...]\n";
+            return 2;
+        }
+        sizes.append(n);
+    }
+    if(sizes.isEmpty()) sizes << 1000 << 4000 << 10000;
+
+    srand(17);
+
+    int nErrors = 0;
+    for(int is=0; is<sizes.size(); is++)
+    {
+        // partial pivoting is backward stable in practice, so the relative residual should be close to the round-off error
+        if(benchmarkLU(sizes.at(is), out)>LURESIDUALTOLERANCE) nErrors++;
+    }
+
+    return nErrors ? 1 : 0;
+}
@@ -0,0 +1,34 @@
+#-------------------------------------------------
+#
+# Correctness test of the blocked LU decomposition and multi-RHS solve
+# of the xflr5-engine library for general matrices with row interchanges
+#
+#-------------------------------------------------
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+QT       -= gui
+QT       += concurrent
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TARGET = lu-test
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../../xflr5-engine/
+
+DEPENDPATH += $$PWD/../../xflr5-engine/
+
+SOURCES += \
+    main.cpp
+
+OBJECTS_DIR = ./objects
+DESTDIR     = .
+
+win32 {
+#prevent qmake from making useless \debug and \release subdirs
+    CONFIG -= debug_and_release debug_and_release_target
+}
+
+LIBS += -L../../xflr5-engine -lxflr5-engine
@@ -0,0 +1,133 @@
+/****************************************************************************
+
+    lu-test Application
+       Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QVector>
+
+#include <analysis3d/matrix.h>
+
+#define LURESIDUALTOLERANCE   1.e-12   /**< the max residual of the solution, relative to the norms of the matrix and of the solution */
+#define LUDIFFERENCETOLERANCE 1.e-8    /**< the max difference between the blocked and the scalar solutions, relative to the norm of the solution */
+
+
+/**
+* Checks the blocked LU decomposition and the single and multi-RHS solves for a general random matrix.
+* The matrix has no dominant diagonal, so that the decomposition interchanges rows, including across
+* the boundaries of the blocks and of the tiles.
+* @param n the size of the matrix
+* @param nRHS the number of right hand sides
+* @param out the output stream
+* @return true if the residuals and the difference with the scalar decomposition are within the tolerances
+*/
+static bool checkLU(int n, int nRHS, QTextStream &out)
+{
+    QAtomicInt bCancel(0);
+    double progress = 0.0;
+
+    QVector<double> A(n*n), LU0(n*n), LU1(n*n), B(nRHS*n), X0(nRHS*n), X1(nRHS*n), XM(nRHS*n);
+    QVector<int> piv0(n), piv1(n);
+
+    for(int i=0; i<n*n; i++)     A[i] = double(rand())/double(RAND_MAX) - 0.5;
+    for(int i=0; i<nRHS*n; i++) B[i] = double(rand())/double(RAND_MAX) - 0.5;
+    LU0 = A;
+    LU1 = A;
+
+    if(!Crout_LU_Decomposition_with_Pivoting_Unblocked(LU0.data(), piv0.data(), n, &bCancel, 0.0, progress) ||
+       !Crout_LU_Decomposition_with_Pivoting(LU1.data(), piv1.data(), n, &bCancel, 0.0, progress))
+    {
+        out << QString::asprintf("LU n=%4d: singular matrix  FAILED\n", n);
+        return false;
+    }
+
+    // one right hand side at a time, then all at once
+    QVector<double> B0(B), B1(B), BM(B);
+    for(int r=0; r<nRHS; r++)
+    {
+        Crout_LU_with_Pivoting_Solve(LU0.data(), B0.data()+r*n, piv0.data(), X0.data()+r*n, n, &bCancel);
+        Crout_LU_with_Pivoting_Solve(LU1.data(), B1.data()+r*n, piv1.data(), X1.data()+r*n, n, &bCancel);
+    }
+    Crout_LU_with_Pivoting_Solve(LU1.data(), BM.data(), piv1.data(), XM.data(), n, nRHS, &bCancel);
+
+    int nSwaps = 0;
+    for(int i=0; i<n; i++)
+        if(piv1[i]!=i) nSwaps++;
+
+    double Anorm = 0.0;
+    for(int i=0; i<n; i++)
+    {
+        double rowsum = 0.0;
+        for(int j=0; j<n; j++) rowsum += qAbs(A[i*n+j]);
+        Anorm = qMax(Anorm, rowsum);
+    }
+
+    double resmax=0.0, diffmax=0.0;
+    for(int r=0; r<nRHS; r++)
+    {
+        double const *x[] = {X1.constData()+r*n, XM.constData()+r*n};
+        for(int k=0; k<2; k++)
+        {
+            double res=0.0, xnorm=0.0, diff=0.0;
+            for(int i=0; i<n; i++)
+            {
+                double ri = B[r*n+i];
+                for(int j=0; j<n; j++) ri -= A[i*n+j]*x[k][j];
+                res   = qMax(res,   qAbs(ri));
+                xnorm = qMax(xnorm, qAbs(x[k][i]));
+                diff  = qMax(diff,  qAbs(x[k][i]-X0[r*n+i]));
+            }
+            resmax  = qMax(resmax,  res/(Anorm*xnorm));
+            diffmax = qMax(diffmax, diff/xnorm);
+        }
+    }
+
+    // a general matrix of size larger than 2 which requires no row interchange is very unlikely
+    bool bPass = resmax<LURESIDUALTOLERANCE && diffmax<LUDIFFERENCETOLERANCE && (n<=2 || nSwaps>0);
+
+    out << QString::asprintf("LU n=%4d, %d RHS: row interchanges=%4d   relative residual=%11.3g   relative difference=%11.3g  %s\n",
+                             n, nRHS, nSwaps, resmax, diffmax, bPass ? "passed" : "FAILED");
+
+    return bPass;
+}
+
+
+/**
+* The console application's point of entry.
+* The sizes of the matrices are on either side of the sizes of the blocks and of the tiles of the decomposition.
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream out(stdout);
+
+    srand(17);
+
+    int const sizes[] = {1, 2, 17, 31, 32, 33, 63, 64, 65, 127, 129, 200, 333, 513, 700};
+    bool bSuccess = true;
+    for(int n : sizes)
+    {
+        bSuccess = checkLU(n, 1, out) && bSuccess;
+        bSuccess = checkLU(n, 5, out) && bSuccess;
+    }
+
+    out.flush();
+    return bSuccess ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+/****************************************************************************
+
+    vortexarray-test Application
+       Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QVector>
+
+#include <analysis3d/plane_analysis/planeanalysistask.h>
+#include <analysis3d/plane_analysis/vortexarray.h>
+#include <objects/objects3d/panel.h>
+#include <objects/objects3d/plane.h>
+#include <objects/objects3d/wing.h>
+#include <objects/objects3d/wpolar.h>
+
+#define VORTEXTOLERANCE 1.e-12   /**< the max relative difference between the VortexArray and the reference velocities */
+
+
+/**
+* Compares the velocities returned by the VortexArray kernels of the analysis with the sum of the velocities
+* returned by PanelAnalysis::VLMGetVortexInfluence(), with and without the bound vortices.
+* The points are the panels' control points, the end and mid points of their bound vortices,
+* which lie in the vortex cores, and random points around the plane.
+* @param analysis the panel analysis, initialized with the mesh of the plane
+* @param task the task which holds the panel arrays
+* @return the max relative difference
+*/
+static double checkVortexArray(PanelAnalysis &analysis, PlaneAnalysisTask &task)
+{
+    int nPanels = task.matSize();
+    QVector<Vector3d> C;
+    QVector<double> Gamma(nPanels);
+    Vector3d V, VRef;
+    double errmax = 0.0;
+
+    auto rnd = [](){return double(rand())/double(RAND_MAX)-0.5;};
+
+    for(int p=0; p<nPanels; p++)
+    {
+        Panel const &panel = *task.panel(p);
+        C.append(panel.CtrlPt);
+        C.append(panel.VA);
+        C.append((panel.VA+panel.VB)*0.5);
+        Gamma[p] = rnd();
+    }
+    for(int i=0; i<nPanels; i++) C.append(Vector3d(3.0*rnd(), 3.0*rnd(), rnd()));
+
+    int nPts = C.size();
+    QVector<double> x(nPts), y(nPts), z(nPts), vx(nPts), vy(nPts), vz(nPts);
+    for(int i=0; i<nPts; i++)
+    {
+        x[i] = C.at(i).x;
+        y[i] = C.at(i).y;
+        z[i] = C.at(i).z;
+    }
+
+    analysis.makeVortexArray();
+
+    for(int ia=0; ia<2; ia++)
+    {
+        bool bAll = (ia==0);
+
+        // the panel kernels used to build the influence matrix
+        for(int p=0; p<nPanels; p++)
+        {
+            vx.fill(0.0);
+            vy.fill(0.0);
+            vz.fill(0.0);
+            analysis.vortexArray().getVelocities(p, nPts, x.constData(), y.constData(), z.constData(), vx.data(), vy.data(), vz.data(), bAll);
+
+            for(int i=0; i<nPts; i++)
+            {
+                VRef.set(0.0, 0.0, 0.0);
+                if(task.panel(p)->m_Pos==MIDSURFACE) analysis.VLMGetVortexInfluence(task.panel(p), C.at(i), VRef, bAll);
+                V.set(vx.at(i), vy.at(i), vz.at(i));
+                errmax = qMax(errmax, (V-VRef).VAbs()/(1.0+VRef.VAbs()));
+            }
+        }
+
+        // the point kernels used for the wake roll-up and the far-field velocities
+        for(int i=0; i<nPts; i++)
+        {
+            Vector3d VSum;
+            for(int p=0; p<nPanels; p++)
+            {
+                if(task.panel(p)->m_Pos!=MIDSURFACE) continue;
+                analysis.VLMGetVortexInfluence(task.panel(p), C.at(i), VRef, bAll);
+                VSum += VRef * Gamma.at(p);
+            }
+            analysis.getVortexSpeedVector(C.at(i), Gamma.constData(), V, bAll);
+            errmax = qMax(errmax, (V-VSum).VAbs()/(1.0+VSum.VAbs()));
+        }
+    }
+
+    return errmax;
+}
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream out(stdout);
+
+    // the default plane with flat plate sections
+    QVector<Foil*> foils;
+    Wing::s_poaFoil = &foils;
+    Plane plane;
+    plane.computePlane();
+
+    srand(17);
+
+    bool bVectorized = VortexArray::isVectorized();
+    bool bSuccess = true;
+
+    if(!VortexArray::hasVectorKernels())
+        out << "The AVX2 kernels are not available on this processor, only the scalar kernels are tested\n";
+
+    for(int iv=0; iv<2; iv++)
+    {
+        bool bVLM1 = (iv==0);
+        WPolar polar;
+        polar.setAnalysisMethod(XFLR5::VLMMETHOD);
+        polar.bVLM1() = bVLM1;
+
+        PlaneAnalysisTask task;
+        LLTAnalysis lltAnalysis;
+        PanelAnalysis panelAnalysis;
+        task.setLLTAnalysis(lltAnalysis);
+        task.setPanelAnalysis(panelAnalysis);
+        task.setPlaneObject(&plane);
+        if(!task.setWPolarObject(&plane, &polar))
+        {
+            out << "Failed to build the panels of the plane\n";
+            return 1;
+        }
+
+        for(int ik=0; ik<2; ik++)
+        {
+            // the AVX2 kernels, then the scalar kernels
+            bool bAVX2 = (ik==0);
+            if(bAVX2 && !VortexArray::hasVectorKernels()) continue;
+            VortexArray::setVectorized(bAVX2);
+
+            double errmax = checkVortexArray(panelAnalysis, task);
+            bool bPass = errmax<VORTEXTOLERANCE;
+            bSuccess = bSuccess && bPass;
+
+            out << QString::asprintf("%s, %s kernels, %d panels: max relative difference=%11.3g  %s\n",
+                                     bVLM1 ? "VLM1" : "VLM2", bAVX2 ? "AVX2  " : "scalar", task.matSize(), errmax,
+                                     bPass ? "passed" : "FAILED");
+        }
+    }
+
+    VortexArray::setVectorized(bVectorized);
+
+    out.flush();
+    return bSuccess ? 0 : 1;
+}
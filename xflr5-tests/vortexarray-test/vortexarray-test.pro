@@ -0,0 +1,34 @@
+#-------------------------------------------------
+#
+# Test of the vectorized and scalar VortexArray kernels
+# against the reference PanelAnalysis::VLMGetVortexInfluence()
+#
+#-------------------------------------------------
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+QT       -= gui
+QT       += concurrent
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TARGET = vortexarray-test
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../../xflr5-engine/
+
+DEPENDPATH += $$PWD/../../xflr5-engine/
+
+SOURCES += \
+    main.cpp
+
+OBJECTS_DIR = ./objects
+DESTDIR     = .
+
+win32 {
+#prevent qmake from making useless \debug and \release subdirs
+    CONFIG -= debug_and_release debug_and_release_target
+}
+
+LIBS += -L../../xflr5-engine -lxflr5-engine
@@ -0,0 +1,14 @@
+#-------------------------------------------------
+#
+# Console tests and benchmarks of the XFoil-lib and xflr5-engine libraries
+# The tests are run with "make check"
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS = \
+    lu-bench \
+    lu-test \
+    vortexarray-test \
+    xfoil-regression
@@ -0,0 +1,288 @@
+/****************************************************************************
+
+    xfoil-regression Application
+       Copyright (C) 2019 Andre Deperrois
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*****************************************************************************/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+#include <xfoil.h>
+
+#define REGRESSIONITERLIM 100          /**< the max number of viscous iterations for each operating point */
+#define REGRESSIONTOLERANCE 1.e-5      /**< the max difference of Cl, Cm and of the transition locations with the reference values */
+#define REGRESSIONCDTOLERANCE 1.e-4    /**< the max relative difference of Cd with the reference value */
+
+
+/**
+* A converged operating point of the reference solver.
+*/
+struct ReferenceOpp
+{
+    int naca;           /**< the NACA 4-digit designation of the foil */
+    double Re;          /**< the Reynolds number */
+    double alpha;       /**< the aoa in degrees */
+    double Cl, Cd, Cm;  /**< the aerodynamic coefficients */
+    double XtrTop;      /**< the transition location on the top side, in chord fraction */
+    double XtrBot;      /**< the transition location on the bottom side, in chord fraction */
+};
+
+
+/**
+* The operating points calculated by the XFoil-lib solver before the rows of the BL mass influence blocks
+* were reordered in blsolve(), for the foils generated by XFoil::naca4() with 80 panels on each side,
+* with free transition, NCrit=9 and Mach=0.
+*/
+static ReferenceOpp const s_Reference[] = {
+    {  12, 2e+05,   0.0,  -0.0000000022, 0.0102133749,   0.0000000004, 0.9042177871, 0.9042174040},
+    {  12, 2e+05,   2.0,   0.3087081909, 0.0106640424,  -0.0122913783, 0.7010577941, 0.9839158878},
+    {  12, 2e+05,   4.0,   0.5362218454, 0.0117683325,  -0.0145978391, 0.4154806333, 1.0000000000},
+    {  12, 2e+05,   6.0,   0.6974494577, 0.0151541639,  -0.0044479189, 0.1562037235, 1.0000000000},
+    {  12, 2e+05,   8.0,   0.8490130398, 0.0207458035,   0.0075638091, 0.0748026497, 1.0000000000},
+    {  12, 2e+05,  10.0,   1.0068749815, 0.0290657244,   0.0167199606, 0.0502025469, 1.0000000000},
+    {  12, 1e+06,   0.0,   0.0000000000, 0.0053934314,   0.0000000000, 0.6874066790, 0.6874066351},
+    {  12, 1e+06,   2.0,   0.2143542255, 0.0058110457,   0.0029548624, 0.4745371382, 0.8674999543},
+    {  12, 1e+06,   4.0,   0.4281579904, 0.0072925635,   0.0059076581, 0.2528795685, 0.9679817517},
+    {  12, 1e+06,   6.0,   0.6940093224, 0.0097679245,  -0.0041728873, 0.0809501455, 0.9940392399},
+    {  12, 1e+06,   8.0,   0.9106372523, 0.0120803961,  -0.0041677257, 0.0376345538, 1.0000000000},
+    {  12, 1e+06,  10.0,   1.0806397054, 0.0149766322,   0.0052590155, 0.0249697820, 1.0000000000},
+    {  12, 3e+06,   0.0,   0.0000000001, 0.0051028354,   0.0000000000, 0.5130643797, 0.5130647270},
+    {  12, 3e+06,   2.0,   0.2231284547, 0.0053537688,   0.0002655294, 0.3210598712, 0.7029037063},
+    {  12, 3e+06,   4.0,   0.4423656952, 0.0062168065,   0.0013542835, 0.1455388377, 0.8703385851},
+    {  12, 3e+06,   6.0,   0.6553490530, 0.0075322487,   0.0039899784, 0.0567381381, 0.9685770811},
+    {  12, 3e+06,   8.0,   0.8943566031, 0.0092259391,   0.0002068385, 0.0281670407, 0.9961270645},
+    {  12, 3e+06,  10.0,   1.1178384791, 0.0112559319,  -0.0010737394, 0.0180814483, 1.0000000000},
+    {2412, 2e+05,   0.0,   0.2826453639, 0.0099724923,  -0.0607702167, 0.8332971891, 0.9787069995},
+    {2412, 2e+05,   2.0,   0.5168842878, 0.0101061635,  -0.0626125822, 0.6928868275, 1.0000000004},
+    {2412, 2e+05,   4.0,   0.7059482109, 0.0114342459,  -0.0550255563, 0.5608713061, 1.0000000004},
+    {2412, 2e+05,   6.0,   0.8915595359, 0.0132781851,  -0.0471316258, 0.4117194895, 1.0000000004},
+    {2412, 2e+05,   8.0,   1.0459452518, 0.0177764680,  -0.0360819072, 0.1646386855, 1.0000000004},
+    {2412, 2e+05,  10.0,   1.1513892680, 0.0259480426,  -0.0198327825, 0.0711055377, 1.0000000004},
+    {2412, 1e+06,   0.0,   0.2371991705, 0.0056453817,  -0.0520082439, 0.6519799065, 0.6794912350},
+    {2412, 1e+06,   2.0,   0.4500735510, 0.0057783903,  -0.0482089918, 0.5255959244, 0.9668744399},
+    {2412, 1e+06,   4.0,   0.7154427935, 0.0069245235,  -0.0575265528, 0.3976854239, 1.0000000004},
+    {2412, 1e+06,   6.0,   0.9019657390, 0.0090473458,  -0.0505593990, 0.2121647461, 1.0000000004},
+    {2412, 1e+06,   8.0,   1.0869115700, 0.0123333127,  -0.0444618402, 0.0665165966, 1.0000000004},
+    {2412, 1e+06,  10.0,   1.2664421746, 0.0156607709,  -0.0380125295, 0.0321196693, 1.0000000004},
+    {2412, 3e+06,   0.0,   0.2422722801, 0.0054654483,  -0.0527328505, 0.5278046769, 0.3934277331},
+    {2412, 3e+06,   2.0,   0.4652143563, 0.0050904474,  -0.0525995679, 0.4250875517, 0.7445594923},
+    {2412, 3e+06,   4.0,   0.6772838372, 0.0057087908,  -0.0496180838, 0.2853834931, 0.9791609775},
+    {2412, 3e+06,   6.0,   0.9109573479, 0.0079156713,  -0.0529442549, 0.1076069082, 1.0000000004},
+    {2412, 3e+06,   8.0,   1.1088750785, 0.0100102147,  -0.0485126894, 0.0405178364, 1.0000000004},
+    {2412, 3e+06,  10.0,   1.3068320532, 0.0122185124,  -0.0448286310, 0.0221431563, 1.0000000004},
+    {4412, 2e+05,   0.0,   0.4880910518, 0.0100245221,  -0.1078895942, 0.7658544168, 1.0000000007},
+    {4412, 2e+05,   2.0,   0.6953059747, 0.0110118628,  -0.1036703073, 0.6639734220, 1.0000000007},
+    {4412, 2e+05,   4.0,   0.9065416562, 0.0127002129,  -0.1009665824, 0.5847486363, 1.0000000007},
+    {4412, 2e+05,   6.0,   1.1100425651, 0.0146144019,  -0.0971814836, 0.5086627964, 1.0000000007},
+    {4412, 2e+05,   8.0,   1.2867360088, 0.0164984444,  -0.0885839990, 0.4010471091, 1.0000000007},
+    {4412, 2e+05,  10.0,   1.3714009565, 0.0223224239,  -0.0671988327, 0.1841972138, 1.0000000007},
+    {4412, 1e+06,   0.0,   0.4740729855, 0.0068895240,  -0.1034509116, 0.6101772813, 0.3938953337},
+    {4412, 1e+06,   2.0,   0.6979351427, 0.0062444325,  -0.1033738084, 0.5225192167, 1.0000000007},
+    {4412, 1e+06,   4.0,   0.9131937672, 0.0072131930,  -0.1017510863, 0.4603313972, 1.0000000007},
+    {4412, 1e+06,   6.0,   1.1246905055, 0.0084693347,  -0.0998370322, 0.3762249246, 1.0000000007},
+    {4412, 1e+06,   8.0,   1.3043887537, 0.0117808560,  -0.0931482383, 0.1877930608, 1.0000000007},
+    {4412, 1e+06,  10.0,   1.4337348828, 0.0168494232,  -0.0786503562, 0.0518377573, 1.0000000007},
+    {4412, 3e+06,   0.0,   0.4792823899, 0.0060693136,  -0.1043297486, 0.5127174784, 0.2362414684},
+    {4412, 3e+06,   2.0,   0.7041099132, 0.0054723358,  -0.1050595742, 0.4537065262, 0.6969279838},
+    {4412, 3e+06,   4.0,   0.9276787014, 0.0056084858,  -0.1050238201, 0.3922527087, 1.0000000007},
+    {4412, 3e+06,   6.0,   1.1354697550, 0.0074191808,  -0.1026586181, 0.2506426838, 1.0000000007},
+    {4412, 3e+06,   8.0,   1.3187489920, 0.0107743168,  -0.0965423958, 0.0754417512, 1.0000000007},
+    {4412, 3e+06,  10.0,   1.4934660274, 0.0136964213,  -0.0892553458, 0.0285054293, 1.0000000007},
+    {4415, 2e+05,   0.0,   0.4568095011, 0.0112685910,  -0.0985460937, 0.7036000200, 0.9264863979},
+    {4415, 2e+05,   2.0,   0.7161949212, 0.0122658677,  -0.1060110094, 0.6223845871, 0.9999999997},
+    {4415, 2e+05,   4.0,   0.9113046880, 0.0139070345,  -0.1005292135, 0.5591095062, 0.9999999997},
+    {4415, 2e+05,   6.0,   1.1104551666, 0.0158570496,  -0.0961140279, 0.5002584803, 0.9999999997},
+    {4415, 2e+05,   8.0,   1.2920738240, 0.0179094493,  -0.0887858342, 0.4327929024, 0.9999999997},
+    {4415, 2e+05,  10.0,   1.4182210514, 0.0204857763,  -0.0724420004, 0.3486387618, 0.9999999997},
+    {4415, 1e+06,   0.0,   0.4705134606, 0.0076494561,  -0.1012877289, 0.5629419448, 0.3741436323},
+    {4415, 1e+06,   2.0,   0.6750380106, 0.0068803714,  -0.0968174776, 0.4984742042, 0.9361865558},
+    {4415, 1e+06,   4.0,   0.9195599142, 0.0077562202,  -0.1014793171, 0.4497636860, 0.9999999997},
+    {4415, 1e+06,   6.0,   1.1232611585, 0.0088245550,  -0.0977767047, 0.3975834373, 0.9999999997},
+    {4415, 1e+06,   8.0,   1.3122681802, 0.0106492122,  -0.0920547001, 0.3125616834, 0.9999999997},
+    {4415, 1e+06,  10.0,   1.4517378801, 0.0143039741,  -0.0787431385, 0.1951716199, 0.9999999997},
+    {4415, 3e+06,   0.0,   0.4804621596, 0.0065030644,  -0.1031869287, 0.4862080039, 0.2496333970},
+    {4415, 3e+06,   2.0,   0.7060821983, 0.0061460911,  -0.1037654871, 0.4395829878, 0.5628661539},
+    {4415, 3e+06,   4.0,   0.9209178382, 0.0058918973,  -0.1016308539, 0.3970304783, 0.9785083924},
+    {4415, 3e+06,   6.0,   1.1469788114, 0.0071124195,  -0.1029134969, 0.3179083775, 0.9999999997},
+    {4415, 3e+06,   8.0,   1.3354673207, 0.0093427381,  -0.0971985648, 0.2046275890, 0.9999999997},
+    {4415, 3e+06,  10.0,   1.4814784331, 0.0127316844,  -0.0844791820, 0.0996394287, 0.9999999997}
+};
+
+
+/**
+* Calculates an operating point, starting from the BL of the previous point as in a polar's sequence.
+* @param xfoil the XFoil instance, initialized with the foil and the analysis parameters
+* @param alpha the aoa in degrees
+* @param nIter the number of viscous iterations, incremented on output
+* @param nsecs the time spent in the viscous iterations, in ns, incremented on output
+* @return true if the point has converged, false otherwise.
+*/
+static bool solveOpp(XFoil &xfoil, double alpha, int &nIter, qint64 &nsecs)
+{
+    xfoil.setAlpha(alpha*xfoil.dtor);
+    xfoil.lalfa = true;
+    xfoil.setQInf(1.0);
+    if(!xfoil.specal()) return false;
+
+    xfoil.lwake = false;
+    xfoil.lvconv = false;
+    if(!xfoil.viscal()) return false;
+
+    QElapsedTimer t;
+    t.start();
+    int iter = 0;
+    while(iter<REGRESSIONITERLIM && !xfoil.lvconv)
+    {
+        if(!xfoil.ViscousIter()) break;
+        iter++;
+    }
+    nsecs += t.nsecsElapsed();
+    nIter += iter;
+
+    if(!xfoil.ViscalEnd() || !xfoil.lvconv)
+    {
+        // restart the next point from a fresh BL, as XFoilTask does
+        xfoil.setBLInitialized(false);
+        xfoil.lipan = false;
+        return false;
+    }
+    return true;
+}
+
+
+/**
+* Runs the sequence of the reference points of one foil at one Reynolds number, and compares the results.
+* @param first the index of the first reference point of the sequence
+* @param last the index past the last reference point of the sequence
+* @param out the output stream
+* @param nIter the number of viscous iterations, incremented on output
+* @param nsecs the time spent in the viscous iterations, in ns, incremented on output
+* @return the number of points which have failed to converge or which differ from the reference.
+*/
+static int checkSequence(int first, int last, QTextStream &out, int &nIter, qint64 &nsecs)
+{
+    ReferenceOpp const &ref0 = s_Reference[first];
+    QTextStream xfoilStream;
+
+    XFoil *pXFoil = new XFoil;
+    pXFoil->naca4(ref0.naca, 80);
+
+    int nb = pXFoil->nb;
+    QVector<double> x(nb), y(nb), nx(nb), ny(nb);
+    for(int i=0; i<nb; i++)
+    {
+        x[i] = pXFoil->xb[i+1];
+        y[i] = pXFoil->yb[i+1];
+    }
+
+    int nErrors = 0;
+    if(!pXFoil->initXFoilGeometry(nb, x.constData(), y.constData(), nx.data(), ny.data()) ||
+       !pXFoil->initXFoilAnalysis(ref0.Re, 0.0, 0.0, 9.0, 1.0, 1.0, 1, 1, true, xfoilStream))
+    {
+        out << QString::asprintf("NACA %04d: failed to initialize the analysis  FAILED\n", ref0.naca);
+        delete pXFoil;
+        return last-first;
+    }
+
+    for(int ir=first; ir<last; ir++)
+    {
+        ReferenceOpp const &ref = s_Reference[ir];
+        bool bConverged = solveOpp(*pXFoil, ref.alpha, nIter, nsecs);
+
+        bool bPass = bConverged;
+        bPass = bPass && qAbs(pXFoil->cl-ref.Cl)<=REGRESSIONTOLERANCE;
+        bPass = bPass && qAbs(pXFoil->cm-ref.Cm)<=REGRESSIONTOLERANCE;
+        bPass = bPass && qAbs(pXFoil->cd-ref.Cd)<=REGRESSIONCDTOLERANCE*qAbs(ref.Cd);
+        bPass = bPass && qAbs(pXFoil->xoctr[1]-ref.XtrTop)<=REGRESSIONTOLERANCE;
+        bPass = bPass && qAbs(pXFoil->xoctr[2]-ref.XtrBot)<=REGRESSIONTOLERANCE;
+        if(!bPass) nErrors++;
+
+        out << QString::asprintf("NACA %04d  Re=%9.0f  alpha=%5.1f:  Cl=%10.6f  Cd=%9.6f  Cm=%10.6f  XtrTop=%8.5f  XtrBot=%8.5f  %s\n",
+                                 ref.naca, ref.Re, ref.alpha,
+                                 pXFoil->cl, pXFoil->cd, pXFoil->cm, pXFoil->xoctr[1], pXFoil->xoctr[2],
+                                 bPass ? "passed" : (bConverged ? "FAILED" : "FAILED, unconverged"));
+    }
+
+    delete pXFoil;
+    return nErrors;
+}
+
+
+/**
+* The console application's point of entry.
+* Compares the converged operating points of the XFoil-lib solver with the reference values, then reports
+* the mean time per viscous iteration. The optional argument is the number of times the sequences are run
+* for the timing, and defaults to 1.
+*
+* Example: xfoil-regression 5
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    int nRuns = 1;
+    QStringList args = app.arguments();
+    if(args.size()>1)
+    {
+        bool bOK = false;
+        nRuns = args.at(1).toInt(&bOK);
+        if(!bOK || nRuns<=0 || args.size()>2)
+        {
+            QTextStream(stderr) << "Usage: xfoil-regression [runs]\n";
+            return 2;
+        }
+    }
+
+    int nRef = int(sizeof(s_Reference)/sizeof(ReferenceOpp));
+    int nErrors = 0;
+    int nIter = 0;
+    qint64 nsecs = 0;
+
+    for(int iRun=0; iRun<nRuns; iRun++)
+    {
+        int first = 0;
+        while(first<nRef)
+        {
+            // the points of the same foil and Reynolds number are calculated in sequence
+            int last = first+1;
+            while(last<nRef && s_Reference[last].naca==s_Reference[first].naca && s_Reference[last].Re==s_Reference[first].Re) last++;
+
+            QString strange;
+            QTextStream runOut(&strange);
+            int nSeqErrors = checkSequence(first, last, runOut, nIter, nsecs);
+            runOut.flush();
+            if(iRun==0)
+            {
+                out << strange;
+                nErrors += nSeqErrors;
+            }
+            first = last;
+        }
+    }
+
+    out << QString::asprintf("%d points out of %d differ from the reference\n", nErrors, nRef);
+    out << QString::asprintf("%d viscous iterations in %.3f s: %.3f ms per iteration\n",
+                             nIter, double(nsecs)/1.e9, double(nsecs)/1.e6/double(qMax(nIter, 1)));
+    out.flush();
+
+    return nErrors ? 1 : 0;
+}
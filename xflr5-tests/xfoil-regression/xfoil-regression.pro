@@ -0,0 +1,34 @@
+#-------------------------------------------------
+#
+# Regression test of the viscous solver of XFoil-lib
+# against the reference results of the previous solver,
+# and timing of the viscous iterations
+#
+#-------------------------------------------------
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+QT       -= gui
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TARGET = xfoil-regression
+TEMPLATE = app
+
+INCLUDEPATH += $$PWD/../../XFoil-lib/
+
+DEPENDPATH += $$PWD/../../XFoil-lib/
+
+SOURCES += \
+    main.cpp
+
+OBJECTS_DIR = ./objects
+DESTDIR     = .
+
+win32 {
+#prevent qmake from making useless \debug and \release subdirs
+    CONFIG -= debug_and_release debug_and_release_target
+}
+
+LIBS += -L../../XFoil-lib -lXFoil
@@ -5,6 +5,8 @@ TEMPLATE = subdirs
 SUBDIRS = xflr5-gui \
      XFoil-lib \
      xflr5-engine \
+     xflr5-batch \
+     xflr5-tests \
      pythonqt \
 
 TRANSLATIONS = translations/xflr5v6.ts \